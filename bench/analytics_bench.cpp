@@ -0,0 +1,86 @@
+// analytics_bench.cpp
+// Cost of in-situ analytics on a jittered lattice: step time without samples, with a sample
+// folded into every step, and with the same quantities computed by a separate pass over the
+// stepped particles. Also the time and bytes of one full particle dump against one CSV row.
+// Usage: analytics_bench [steps] [particles per metre] [threads] [dump file]
+#include "analytics.hpp"
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps            = args.size() > 1 ? std::stoi(args[1]) : 5;
+  const float ppm            = args.size() > 2 ? std::stof(args[2]) : 150.0F;
+  const int threads          = args.size() > 3 ? std::stoi(args[3]) : 1;
+  std::string const dumpFile = args.size() > 4 ? args[4] : "/tmp/analytics_bench_dump.fld";
+
+  Header header{};
+  std::vector<Particle> input;
+  const ParticleParameters params = makeLatticeInput(ppm, header, input);
+  SimulationOptions options;
+  options.threads = threads;
+
+  std::vector<Particle> particles = input;
+  StepWorkspace<FloatPrecision> workspace;
+  const double plainSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(particles, params, workspace, options); }
+  });
+
+  AnalyticsState fused;
+  fused.mass = static_cast<double>(params.mass);
+  std::ostringstream fusedRows;
+  particles = input;
+  StepWorkspace<FloatPrecision> sampled;
+  sampled.analytics = &fused;
+  const double fusedSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) {
+      beginAnalyticsSample(fused, options.threads);
+      stepParticles(particles, params, sampled, options);
+      writeAnalyticsSample(fused, it + 1, fusedRows);
+    }
+  });
+
+  AnalyticsState separate;
+  separate.mass = fused.mass;
+  std::ostringstream separateRows;
+  particles = input;
+  const double separateSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) {
+      stepParticles(particles, params, workspace, options);
+      beginAnalyticsSample(separate, 1);
+      for (Particle const & particle : particles) {
+        separate.partials[0].addMotion(particle);
+        separate.partials[0].addDensity(particle);
+      }
+      writeAnalyticsSample(separate, it + 1, separateRows);
+    }
+  });
+
+  const double dumpSeconds =
+      timeSeconds([&]() { writeParticlesToFile(dumpFile, header, particles); });
+  (void) std::remove(dumpFile.c_str());
+  std::ostringstream row;
+  writeAnalyticsSample(fused, steps, row);
+
+  std::cout << "Particles: " << input.size() << ", steps: " << steps << ", threads: " << threads
+            << '\n'
+            << std::fixed << std::setprecision(2)
+            << "no analytics:    " << 1000.0 * plainSeconds / steps << " ms per step\n"
+            << "fused sample:    " << 1000.0 * fusedSeconds / steps << " ms per step\n"
+            << "separate pass:   " << 1000.0 * separateSeconds / steps << " ms per step\n"
+            << "particle dump:   " << 1000.0 * dumpSeconds << " ms, "
+            << sizeof(Header) + input.size() * sizeof(Particle) << " bytes\n"
+            << "CSV row:         " << row.str().size() << " bytes\n"
+            << std::defaultfloat
+            << "Same rows: " << (fusedRows.str() == separateRows.str() ? "yes" : "no") << '\n';
+  return 0;
+}
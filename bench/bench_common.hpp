@@ -0,0 +1,84 @@
+// bench_common.hpp
+#pragma once
+
+#include "constants.hpp"
+#include "particle.hpp"
+#include "utils.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Loads an input file and derives the same parameters runSimulation uses
+inline ParticleParameters loadBenchInput(std::string const & inputFile, Header & header,
+                                         std::vector<Particle> & particles) {
+  readInputFile(inputFile, header, particles);
+  const float height     = calculateSmoothingLength(r, header.ppm);
+  const float mass       = calculateParticleMass(rho, header.ppm);
+  const GridSize blocks  = calculateNumberOfBlocks(height);
+  for (Particle & particle : particles) { initializeDensitiesAndAccelerations(particle); }
+  return {height, mass, calculateBlockSize(blocks), blocks};
+}
+
+// Particles on a jittered lattice of spacing 1 / ppm filling the simulation box, with the
+// parameters runSimulation would derive for that ppm
+inline ParticleParameters makeLatticeInput(float ppm, Header & header,
+                                           std::vector<Particle> & particles) {
+  const float spacing = 1.0F / ppm;
+  unsigned int seed   = 12345U;
+  auto jitter         = [&seed, spacing]() {
+    seed = seed * 1664525U + 1013904223U;
+    return (static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U) - 0.5F) * 0.1F *
+           spacing;
+  };
+  particles.clear();
+  for (float z = zmin + spacing; z < zmax - spacing; z += spacing) {
+    for (float y = ymin + spacing; y < ymax - spacing; y += spacing) {
+      for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+        Particle particle{};
+        particle.px = x + jitter();
+        particle.py = y + jitter();
+        particle.pz = z + jitter();
+        initializeDensitiesAndAccelerations(particle);
+        particles.push_back(particle);
+      }
+    }
+  }
+  header              = {ppm, static_cast<int>(particles.size())};
+  const float height  = calculateSmoothingLength(r, ppm);
+  const GridSize blocks = calculateNumberOfBlocks(height);
+  return {height, calculateParticleMass(rho, ppm), calculateBlockSize(blocks), blocks};
+}
+
+// Particles on a regular lattice 1.2 smoothing lengths apart filling the simulation box, a
+// spacing that keeps a run falling under gravity bounded with the current kernels
+inline ParticleParameters makeFallingLatticeInput(float ppm, Header & header,
+                                                  std::vector<Particle> & particles) {
+  const ParticleParameters params = makeLatticeInput(ppm, header, particles);
+  const float spacing             = 1.2F * params.smoothingLength;
+  particles.clear();
+  for (float z = zmin + spacing; z < zmax - spacing; z += spacing) {
+    for (float y = ymin + spacing; y < ymax - spacing; y += spacing) {
+      for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+        Particle particle{};
+        particle.px = x;
+        particle.py = y;
+        particle.pz = z;
+        initializeDensitiesAndAccelerations(particle);
+        particles.push_back(particle);
+      }
+    }
+  }
+  header.np = static_cast<int>(particles.size());
+  return params;
+}
+
+// Wall time of fn() in seconds
+template <typename Function>
+double timeSeconds(Function && fn) {
+  auto start = std::chrono::high_resolution_clock::now();
+  fn();
+  auto finish = std::chrono::high_resolution_clock::now();
+  const std::chrono::duration<double> elapsed = finish - start;
+  return elapsed.count();
+}
@@ -0,0 +1,114 @@
+// cellgrid_bench.cpp
+// Step time and cell list memory with the dense cell grid and with the hashed one, for an input
+// file and for a splash: a ball of particles at the lattice spacing of a high ppm in the middle
+// of the box, so that most cells of the grid stay empty. Every step starts from the input.
+// Usage: cellgrid_bench [repetitions] [input.fld] [splash ppm] [splash radius]
+#include "bench_common.hpp"
+#include "celllist.hpp"
+#include "options.hpp"
+#include "precision.hpp"
+#include "profile.hpp"
+#include "step.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct LayoutRun {
+    double binning;   // ms per step
+    double pairs;     // ms per step, densities and accelerations
+    double total;     // ms per step
+    double megabytes;  // Cell list arrays
+};
+
+template <typename Array>
+double arrayBytes(Array const & array) {
+  return static_cast<double>(array.capacity() * sizeof(typename Array::value_type));
+}
+
+double cellListMegabytes(CellList const & cells) {
+  const double bytes = arrayBytes(cells.cellStart) + arrayBytes(cells.particleOrder) +
+                       arrayBytes(cells.particleCell) + arrayBytes(cells.cursor) +
+                       arrayBytes(cells.colorStart) + arrayBytes(cells.colorCells) +
+                       arrayBytes(cells.cellKeys) + arrayBytes(cells.neighborCells) +
+                       arrayBytes(cells.table.keys) + arrayBytes(cells.table.cells);
+  return bytes / (1024.0 * 1024.0);
+}
+
+LayoutRun runLayout(std::vector<Particle> const & input, ParticleParameters const & params,
+                    CellLayout layout, int repetitions) {
+  SimulationOptions options;
+  options.cellLayout = layout;
+  StepWorkspace<FloatPrecision> workspace;
+  std::vector<Particle> particles = input;
+  // The first step sizes the arrays
+  stepParticles(particles, params, workspace, options);
+  StepProfile profile(false);
+  workspace.profile = &profile;
+  double total      = 0.0;
+  for (int it = 0; it < repetitions; ++it) {
+    particles  = input;
+    total     += timeSeconds([&]() { stepParticles(particles, params, workspace, options); });
+  }
+  const double scale = 1000.0 / repetitions;
+  return {scale * profile.totals(StepPhase::binning).seconds,
+          scale * (profile.totals(StepPhase::densities).seconds +
+                   profile.totals(StepPhase::accelerations).seconds),
+          scale * total, cellListMegabytes(workspace.cells)};
+}
+
+void runInput(std::string const & label, std::vector<Particle> const & input,
+              ParticleParameters const & params, int repetitions) {
+  const CellGrid grid = makeCellGrid(params.blockSize, params.blocks);
+  CellList cells;
+  buildCellList(input, params.blockSize, params.blocks, cells, CellLayout::hashed);
+  const double interior = static_cast<double>(grid.nx) * grid.ny * grid.nz;
+  std::cout << label << ": " << input.size() << " particles, " << grid.nx << "x" << grid.ny
+            << "x" << grid.nz << " cells, " << std::fixed << std::setprecision(2)
+            << 100.0 * static_cast<double>(cells.occupiedCells) / interior << "% occupied\n"
+            << std::left << std::setw(8) << "layout" << std::right << std::setw(12)
+            << "binning ms" << std::setw(12) << "pairs ms" << std::setw(12) << "step ms"
+            << std::setw(12) << "cells MB" << '\n';
+  for (const CellLayout layout : {CellLayout::dense, CellLayout::hashed}) {
+    const LayoutRun run = runLayout(input, params, layout, repetitions);
+    std::cout << std::left << std::setw(8) << (layout == CellLayout::dense ? "dense" : "hashed")
+              << std::right << std::fixed << std::setprecision(2) << std::setw(12) << run.binning
+              << std::setw(12) << run.pairs << std::setw(12) << run.total << std::setw(12)
+              << run.megabytes << '\n';
+  }
+}
+
+// Lattice of spacing 1 / ppm inside a ball of `radius` metres around the middle of the box
+ParticleParameters makeSplashInput(float ppm, float radius, std::vector<Particle> & particles) {
+  Header header{};
+  const ParticleParameters params = makeLatticeInput(ppm, header, particles);
+  const float cx                  = 0.5F * (xmin + xmax);
+  const float cy                  = 0.5F * (ymin + ymax);
+  const float cz                  = 0.5F * (zmin + zmax);
+  std::erase_if(particles, [&](Particle const & particle) {
+    const float dx = particle.px - cx;
+    const float dy = particle.py - cy;
+    const float dz = particle.pz - cz;
+    return dx * dx + dy * dy + dz * dz > radius * radius;
+  });
+  return params;
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/large.fld";
+  const float splashPpm       = args.size() > 3 ? std::stof(args[3]) : 1000.0F;
+  const float splashRadius    = args.size() > 4 ? std::stof(args[4]) : 0.01F;
+
+  Header header{};
+  std::vector<Particle> input;
+  ParticleParameters params = loadBenchInput(inputFile, header, input);
+  runInput(inputFile, input, params, repetitions);
+
+  params = makeSplashInput(splashPpm, splashRadius, input);
+  runInput("splash ppm " + std::to_string(static_cast<int>(splashPpm)), input, params,
+           repetitions);
+  return 0;
+}
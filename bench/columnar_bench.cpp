@@ -0,0 +1,98 @@
+// columnar_bench.cpp
+// Output of a jittered lattice in rows (.fld) and in columns, and a read of the positions
+// from each file: the row file is mapped whole and read record by record, the columnar file
+// maps the px, py and pz columns only. Each read follows a flush of the file from the page
+// cache (posix_fadvise), so it includes the disk reads.
+// Usage: columnar_bench [particles per metre] [output directory]
+#include "bench_common.hpp"
+#include "columnar.hpp"
+#include "mappedfile.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // Writes the file's dirty pages and drops it from the page cache
+  void flushFromCache(std::string const & filename) {
+    const int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) { return; }
+    fdatasync(descriptor);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    close(descriptor);
+  }
+
+}  // namespace
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const float ppm              = args.size() > 1 ? std::stof(args[1]) : 300.0F;
+  std::string const directory  = args.size() > 2 ? args[2] : "/tmp";
+  std::string const rowFile    = directory + "/columnar_bench_rows.fld";
+  std::string const columnFile = directory + "/columnar_bench_columns.fld";
+
+  Header header{};
+  std::vector<Particle> particles;
+  makeLatticeInput(ppm, header, particles);
+  std::vector<std::uint32_t> indices(particles.size());
+  for (std::uint32_t i = 0; i < indices.size(); ++i) { indices[i] = i; }
+
+  const double rowWrite =
+      timeSeconds([&]() { writeParticlesToFile(rowFile, header, particles); });
+  const double columnWrite = timeSeconds([&]() {
+    writeColumnarParticles(columnFile, header, particles, indices, OutputFields{});
+  });
+
+  flushFromCache(rowFile);
+  double rowSum         = 0.0;
+  std::size_t rowBytes  = 0;
+  const double rowRead  = timeSeconds([&]() {
+    const MappedFile file(rowFile);
+    rowBytes = file.size();
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      Particle particle{};
+      std::memcpy(&particle, file.data() + sizeof(Header) + i * sizeof(Particle),
+                  sizeof(Particle));
+      rowSum += static_cast<double>(particle.px + particle.py + particle.pz);
+    }
+  });
+  flushFromCache(columnFile);
+  double columnSum        = 0.0;
+  std::size_t columnBytes = 0;
+  const double columnRead = timeSeconds([&]() {
+    const ColumnarReader reader(columnFile);
+    const MappedColumn px = reader.column("px");
+    const MappedColumn py = reader.column("py");
+    const MappedColumn pz = reader.column("pz");
+    std::span<float const> const x = px.values<float>();
+    std::span<float const> const y = py.values<float>();
+    std::span<float const> const z = pz.values<float>();
+    columnBytes                    = 3 * x.size() * sizeof(float);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      columnSum += static_cast<double>(x[i] + y[i] + z[i]);
+    }
+  });
+  (void) std::remove(rowFile.c_str());
+  (void) std::remove(columnFile.c_str());
+
+  std::cout << "Particles: " << particles.size() << '\n'
+            << std::fixed << std::setprecision(2)
+            << "write rows:        " << 1000.0 * rowWrite << " ms\n"
+            << "write columns:     " << 1000.0 * columnWrite << " ms\n"
+            << "positions, rows:    " << 1000.0 * rowRead << " ms, " << rowBytes
+            << " bytes mapped\n"
+            << "positions, columns: " << 1000.0 * columnRead << " ms, " << columnBytes
+            << " bytes mapped\n"
+            << std::defaultfloat
+            << "Same sums: " << (rowSum == columnSum ? "yes" : "no") << '\n';
+  return rowSum == columnSum ? 0 : 1;
+}
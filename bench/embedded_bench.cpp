@@ -0,0 +1,85 @@
+// embedded_bench.cpp
+// A pipeline that advances a falling lattice a few steps at a time: as separate runs, each
+// reading the particles from the .fld file the previous one wrote and building its cell
+// lists, scratch arrays and worker threads again, and as one Simulation object whose state
+// and resources persist from one call to the next.
+// Usage: embedded_bench [calls] [steps per call] [particles per metre] [threads] [directory]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "precision.hpp"
+#include "simulation.hpp"
+#include "step.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  // An .fld input file: the first nine fields of every particle
+  void writeInputFile(std::string const & filename, Header const & header,
+                      std::vector<Particle> const & particles) {
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+    for (Particle const & particle : particles) {
+      file.write(reinterpret_cast<char const *>(&particle),
+                 static_cast<std::streamsize>(FLD_RECORD_SIZE));
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int calls             = args.size() > 1 ? std::stoi(args[1]) : 40;
+  const int stepsPerCall      = args.size() > 2 ? std::stoi(args[2]) : 1;
+  const float ppm             = args.size() > 3 ? std::stof(args[3]) : 400.0F;
+  const int threads           = args.size() > 4 ? std::stoi(args[4]) : 1;
+  std::string const directory = args.size() > 5 ? args[5] : "/tmp";
+  std::string const stateFile = directory + "/embedded_bench.fld";
+
+  Header header{};
+  std::vector<Particle> initial;
+  const ParticleParameters params = makeFallingLatticeInput(ppm, header, initial);
+  SimulationOptions options;
+  options.threads = threads;
+
+  // Separate runs: file in, steps with a fresh workspace, file out
+  writeInputFile(stateFile, header, initial);
+  std::vector<Particle> particles;
+  const double filesSeconds = timeSeconds([&]() {
+    for (int call = 0; call < calls; ++call) {
+      Header fileHeader{};
+      readInputFile(stateFile, fileHeader, particles);
+      for (Particle & particle : particles) { initializeDensitiesAndAccelerations(particle); }
+      StepWorkspace<FloatPrecision> workspace;
+      for (int it = 0; it < stepsPerCall; ++it) {
+        stepParticles(particles, params, workspace, options);
+      }
+      writeInputFile(stateFile, fileHeader, particles);
+    }
+  });
+
+  Simulation simulation(ppm, initial, options);
+  const double embeddedSeconds = timeSeconds([&]() {
+    for (int call = 0; call < calls; ++call) { simulation.step(stepsPerCall); }
+  });
+  // Both advance the same particles the same steps
+  const bool same = particles.size() == simulation.particles().size() &&
+                    std::memcmp(particles.data(), simulation.particles().data(),
+                                particles.size() * sizeof(Particle)) == 0;
+
+  const auto perCall = [calls](double seconds) { return 1000.0 * seconds / calls; };
+  std::cout << "Particles: " << initial.size() << ", calls: " << calls
+            << ", steps per call: " << stepsPerCall << ", threads: " << threads << '\n'
+            << std::fixed << std::setprecision(2)
+            << "separate runs:     " << perCall(filesSeconds) << " ms per call\n"
+            << "Simulation object: " << perCall(embeddedSeconds) << " ms per call\n"
+            << std::defaultfloat << "Same particles: " << (same ? "yes" : "no") << '\n';
+  (void) std::remove(stateFile.c_str());
+  return same ? 0 : 1;
+}
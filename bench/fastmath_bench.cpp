@@ -0,0 +1,105 @@
+// fastmath_bench.cpp
+// Acceleration pass time with the precise inverse distance (square root and division) and with
+// the fast one (reciprocal square root estimate and one Newton-Raphson step), for the cell list
+// and the 4x4 cluster tiles, float and double storage. Also reports the largest relative
+// difference of the accelerations after one step. Every step starts from the input.
+// Usage: fastmath_bench [repetitions] [input.fld] [lattice ppm]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "profile.hpp"
+#include "step.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <typename Policy>
+struct MathRun {
+    double accelerations;  // ms per step
+    std::vector<PolicyParticle<Policy>> state;
+};
+
+template <typename Policy>
+MathRun<Policy> timeAccelerations(std::vector<PolicyParticle<Policy>> const & input,
+                                  ParticleParameters const & params,
+                                  SimulationOptions const & options, int repetitions) {
+  StepWorkspace<Policy> workspace;
+  StepProfile profile(false);
+  std::vector<PolicyParticle<Policy>> particles = input;
+  // The first step sizes the cell list and the clusters
+  stepParticles(particles, params, workspace, options);
+  workspace.profile = &profile;
+  for (int it = 0; it < repetitions; ++it) {
+    particles = input;
+    stepParticles(particles, params, workspace, options);
+  }
+  return {1000.0 * profile.totals(StepPhase::accelerations).seconds / repetitions, particles};
+}
+
+template <typename T>
+double maxRelativeDifference(std::vector<BasicParticle<T>> const & precise,
+                             std::vector<BasicParticle<T>> const & fast) {
+  double worst = 0.0;
+  for (std::size_t i = 0; i < precise.size(); ++i) {
+    for (auto const member :
+         {&BasicParticle<T>::ax, &BasicParticle<T>::ay, &BasicParticle<T>::az}) {
+      const double expected = static_cast<double>(precise[i].*member);
+      const double actual   = static_cast<double>(fast[i].*member);
+      if (expected != 0.0) {
+        worst = std::max(worst, std::abs(actual - expected) / std::abs(expected));
+      }
+    }
+  }
+  return worst;
+}
+
+template <typename Policy>
+void runPolicy(char const * name, std::vector<PolicyParticle<Policy>> const & input,
+               ParticleParameters const & params, int repetitions) {
+  for (const NeighborSearch neighbors : {NeighborSearch::cells, NeighborSearch::clusters}) {
+    SimulationOptions options;
+    options.neighbors = neighbors;
+    const MathRun<Policy> precise = timeAccelerations<Policy>(input, params, options, repetitions);
+    options.math                  = KernelMath::fast;
+    const MathRun<Policy> fast    = timeAccelerations<Policy>(input, params, options, repetitions);
+    std::cout << std::left << std::setw(8) << name << std::setw(10)
+              << (neighbors == NeighborSearch::cells ? "cells" : "clusters") << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << precise.accelerations
+              << std::setw(10) << fast.accelerations << std::setw(10)
+              << precise.accelerations / fast.accelerations << std::scientific
+              << std::setprecision(2) << std::setw(12)
+              << maxRelativeDifference(precise.state, fast.state) << std::defaultfloat << '\n';
+  }
+}
+
+void runInput(std::string const & label, std::vector<Particle> const & input,
+              ParticleParameters const & params, int repetitions) {
+  std::cout << label << ": " << input.size() << " particles (ms per acceleration pass)\n"
+            << std::left << std::setw(18) << "storage / search" << std::right << std::setw(10)
+            << "precise" << std::setw(10) << "fast" << std::setw(10) << "speed-up"
+            << std::setw(12) << "max rel da" << '\n';
+  runPolicy<FloatPrecision>("float", input, params, repetitions);
+  runPolicy<DoublePrecision>("double", convertParticles<double>(input), params, repetitions);
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/large.fld";
+  const float latticePpm      = args.size() > 3 ? std::stof(args[3]) : 400.0F;
+
+  Header header{};
+  std::vector<Particle> input;
+  ParticleParameters params = loadBenchInput(inputFile, header, input);
+  runInput(inputFile, input, params, repetitions);
+
+  params = makeLatticeInput(latticePpm, header, input);
+  runInput("lattice ppm " + std::to_string(static_cast<int>(latticePpm)), input, params,
+           repetitions);
+  return 0;
+}
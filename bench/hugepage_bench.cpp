@@ -0,0 +1,79 @@
+// hugepage_bench.cpp
+// Step time and data TLB misses with the simulation arrays on 4 KiB pages, transparent huge
+// pages and hugetlbfs pages, for an input file and for a synthetic lattice large enough to
+// span many huge pages. Every step starts from the input state.
+// Usage: hugepage_bench [repetitions] [input.fld] [lattice ppm]
+#include "bench_common.hpp"
+#include "hugepages.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "profile.hpp"
+#include "step.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Mode {
+    char const * name;
+    HugePages hugePages;
+};
+
+void runInput(std::string const & label, std::vector<Particle> const & input,
+              ParticleParameters const & params, int repetitions) {
+  const std::vector<Mode> modes = {
+    {    "4 KiB pages",         HugePages::off},
+    {"transparent 2M", HugePages::transparent},
+    {    "hugetlb 2M",     HugePages::hugetlb},
+  };
+  std::cout << label << ": " << input.size() << " particles\n"
+            << std::left << std::setw(18) << "pages" << std::right << std::setw(12) << "ms/step"
+            << std::setw(18) << "dTLB miss/step" << std::setw(14) << "huge MB" << '\n';
+  const PerfCounters counters;
+  for (Mode const & mode : modes) {
+    SimulationOptions options;
+    options.hugePages = mode.hugePages;
+    StepWorkspace<FloatPrecision> workspace;
+    std::vector<Particle> particles = input;
+    // The first step sizes the arrays and advises the particle storage
+    stepParticles(particles, params, workspace, options);
+    double seconds      = 0.0;
+    std::uint64_t tlb   = 0;
+    for (int it = 0; it < repetitions; ++it) {
+      particles               = input;
+      const PerfValues before = counters.read();
+      seconds += timeSeconds([&]() { stepParticles(particles, params, workspace, options); });
+      const PerfValues after = counters.read();
+      const auto index       = static_cast<std::size_t>(PerfEvent::dtlbMisses);
+      tlb                    += after[index] - before[index];
+    }
+    std::cout << std::left << std::setw(18) << mode.name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(12) << 1000.0 * seconds / repetitions
+              << std::setw(18);
+    if (counters.available(PerfEvent::dtlbMisses)) {
+      std::cout << tlb / static_cast<std::uint64_t>(repetitions);
+    } else {
+      std::cout << "n/a";
+    }
+    std::cout << std::setw(14) << static_cast<double>(hugePageBytes()) / (1024.0 * 1024.0)
+              << '\n';
+  }
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 3;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/large.fld";
+  const float latticePpm      = args.size() > 3 ? std::stof(args[3]) : 600.0F;
+
+  Header header{};
+  std::vector<Particle> input;
+  ParticleParameters params = loadBenchInput(inputFile, header, input);
+  runInput(inputFile, input, params, repetitions);
+
+  params = makeLatticeInput(latticePpm, header, input);
+  runInput("lattice ppm " + std::to_string(static_cast<int>(latticePpm)), input, params,
+           repetitions);
+  return 0;
+}
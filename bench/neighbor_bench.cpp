@@ -0,0 +1,91 @@
+// neighbor_bench.cpp
+// Time of one step from the input state with each neighbour search: all pairs, the 27-cell
+// gather (deterministic reduction), the 13-cell half stencil and the 4x4 cluster tiles with
+// full and half pair lists. Cluster pairs count every lane of a tile, masked or not.
+// Usage: neighbor_bench [repetitions] [input.fld] [threads]
+#include "bench_common.hpp"
+#include "block.hpp"
+#include "celllist.hpp"
+#include "cluster.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Variant {
+    char const * name;
+    NeighborSearch neighbors;
+    ReductionMode reduction;
+};
+
+double candidatePairs(std::vector<Particle> particles, ParticleParameters const & params,
+                      Variant const & variant) {
+  const auto count = static_cast<double>(particles.size());
+  if (variant.neighbors == NeighborSearch::allPairs) {
+    return variant.reduction == ReductionMode::fast ? count * (count - 1.0) / 2.0
+                                                    : count * (count - 1.0);
+  }
+  CellList cells;
+  setCellGrid(cells, params.blockSize, params.blocks);
+  for (Particle & particle : particles) { repositionParticle(particle, cells.grid); }
+  buildCellList(particles, params.blockSize, params.blocks, cells);
+  if (variant.neighbors == NeighborSearch::clusters) {
+    ThreadPool pool(1);
+    ClusterList<FloatPrecision> clusters;
+    buildClusters(particles, cells, params.smoothingLength,
+                  variant.reduction == ReductionMode::fast, pool, clusters);
+    return static_cast<double>(clusters.pairCluster.size() * CLUSTER_SIZE * CLUSTER_SIZE);
+  }
+  double pairs = 0.0;
+  for (std::size_t cell = 0; cell < cells.cellCount(); ++cell) {
+    if (variant.reduction == ReductionMode::fast) {
+      visitHalfStencilPairs(cells, cell, [&](std::uint32_t, std::uint32_t) { pairs += 1.0; });
+    } else {
+      visitFullStencilPairs(cells, cell, [&](std::uint32_t, std::uint32_t) { pairs += 1.0; });
+    }
+  }
+  return pairs;
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/small.fld";
+  const int threads           = args.size() > 3 ? std::stoi(args[3]) : 1;
+
+  Header header{};
+  std::vector<Particle> input;
+  const ParticleParameters params = loadBenchInput(inputFile, header, input);
+
+  const std::vector<Variant> variants = {
+    {      "all pairs", NeighborSearch::allPairs,          ReductionMode::fast},
+    {"27-cell gather",    NeighborSearch::cells, ReductionMode::deterministic},
+    {"13-cell stencil",   NeighborSearch::cells,          ReductionMode::fast},
+    {"4x4 full lists", NeighborSearch::clusters, ReductionMode::deterministic},
+    {"4x4 half lists", NeighborSearch::clusters,          ReductionMode::fast},
+  };
+  std::cout << "Particles: " << input.size() << ", threads: " << threads << '\n'
+            << std::left << std::setw(18) << "search" << std::right << std::setw(14)
+            << "pairs/pass" << std::setw(14) << "ms/step" << '\n';
+  for (Variant const & variant : variants) {
+    SimulationOptions options;
+    options.threads   = threads;
+    options.neighbors = variant.neighbors;
+    options.reduction = variant.reduction;
+    StepWorkspace<FloatPrecision> workspace;
+    double seconds = 0.0;
+    for (int it = 0; it < repetitions; ++it) {
+      std::vector<Particle> particles = input;
+      seconds += timeSeconds([&]() { stepParticles(particles, params, workspace, options); });
+    }
+    std::cout << std::left << std::setw(18) << variant.name << std::right << std::setw(14)
+              << candidatePairs(input, params, variant) << std::setw(14) << std::setprecision(4)
+              << 1000.0 * seconds / repetitions << '\n';
+  }
+  return 0;
+}
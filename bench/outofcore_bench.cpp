@@ -0,0 +1,76 @@
+// outofcore_bench.cpp
+// Time of a run on a jittered lattice in memory and out of core, with the largest window of
+// particles the out-of-core run held and the updates it computed per update kept. Both runs
+// must give the same particles. The out-of-core time includes the slab sort of the input and
+// the output file.
+// Usage: outofcore_bench [steps] [particles per metre] [slab rows] [working directory]
+#include "bench_common.hpp"
+#include "mappedfile.hpp"
+#include "options.hpp"
+#include "outofcore.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps             = args.size() > 1 ? std::stoi(args[1]) : 3;
+  const float ppm             = args.size() > 2 ? std::stof(args[2]) : 300.0F;
+  const int slabCells         = args.size() > 3 ? std::stoi(args[3]) : 4;
+  std::string const directory = args.size() > 4 ? args[4] : "/tmp";
+
+  Header header{};
+  std::vector<Particle> input;
+  const ParticleParameters params = makeLatticeInput(ppm, header, input);
+  std::string const inputFile     = directory + "/outofcore_bench_input.fld";
+  std::string const outputFile    = directory + "/outofcore_bench_output.fld";
+  {
+    std::ofstream file(inputFile, std::ios::binary);
+    file.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+    for (Particle const & particle : input) {
+      file.write(reinterpret_cast<char const *>(&particle),
+                 static_cast<std::streamsize>(FLD_RECORD_SIZE));
+    }
+  }
+  SimulationOptions options;
+  options.outOfCoreDirectory = directory;
+  options.outOfCoreSlabCells = slabCells;
+
+  std::vector<Particle> particles = input;
+  StepWorkspace<FloatPrecision> workspace;
+  const double memorySeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(particles, params, workspace, options); }
+  });
+  OutOfCoreStats stats;
+  bool ran                  = false;
+  const double slabSeconds = timeSeconds([&]() {
+    ran = simulateOutOfCore(steps, inputFile, outputFile, params, options, nullptr, stats);
+  });
+  const MappedFile output(outputFile);
+  const bool same = ran && output.size() == sizeof(Header) + input.size() * sizeof(Particle) &&
+                    std::memcmp(output.data() + sizeof(Header), particles.data(),
+                                input.size() * sizeof(Particle)) == 0;
+  (void) std::remove(inputFile.c_str());
+  (void) std::remove(outputFile.c_str());
+
+  std::cout << "Particles: " << input.size() << ", grid " << params.blocks.nx << "x"
+            << params.blocks.ny << "x" << params.blocks.nz << " cells, steps: " << steps << '\n'
+            << std::fixed << std::setprecision(2)
+            << "in memory:   " << 1000.0 * memorySeconds / steps << " ms per step, "
+            << static_cast<double>(input.size() * sizeof(Particle)) / 1.0e6
+            << " MB of particles\n"
+            << "out of core: " << 1000.0 * slabSeconds / steps << " ms per step, "
+            << static_cast<double>(stats.largestWindow * sizeof(Particle)) / 1.0e6
+            << " MB largest window\n"
+            << std::defaultfloat;
+  printOutOfCoreStats(stats, input.size(), std::cout);
+  std::cout << "Same particles: " << (same ? "yes" : "no") << '\n';
+  return same ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// outputfilter_bench.cpp
+// Time and bytes of the output of a jittered lattice: every particle, a region of 1/k of the
+// box per axis, a stride of k^3, a random share of 1/k^3 and positions only. The region is
+// timed with and without the binning of the particles that it needs once.
+// Usage: outputfilter_bench [particles per metre] [k] [output file]
+#include "bench_common.hpp"
+#include "celllist.hpp"
+#include "options.hpp"
+#include "outputfilter.hpp"
+#include "particle.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const float ppm              = args.size() > 1 ? std::stof(args[1]) : 300.0F;
+  const int k                  = args.size() > 2 ? std::stoi(args[2]) : 4;
+  std::string const outputFile = args.size() > 3 ? args[3] : "/tmp/outputfilter_bench.fld";
+
+  Header header{};
+  std::vector<Particle> particles;
+  const ParticleParameters params = makeLatticeInput(ppm, header, particles);
+  SimulationOptions options;
+
+  auto report = [&](std::string const & name, double seconds) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(8) << 1000.0 * seconds << " ms, "
+              << std::setw(10) << std::filesystem::file_size(outputFile) << " bytes\n"
+              << std::defaultfloat;
+  };
+  std::cout << "Particles: " << particles.size() << ", k: " << k << '\n';
+  report("every particle",
+         timeSeconds([&]() { writeParticlesToFile(outputFile, header, particles); }));
+
+  OutputFilter & region = options.output;
+  region.region         = true;
+  region.regionMin      = {xmin, ymin, zmin};
+  region.regionMax      = {xmin + (xmax - xmin) / static_cast<float>(k),
+                           ymin + (ymax - ymin) / static_cast<float>(k),
+                           zmin + (zmax - zmin) / static_cast<float>(k)};
+  report("region", timeSeconds([&]() {
+           writeFilteredParticles(outputFile, header, particles, params, options);
+         }));
+  CellList cells;
+  buildCellList(particles, params.blockSize, params.blocks, cells);
+  report("region, binned", timeSeconds([&]() {
+           writeSelectedParticles(outputFile, header, particles,
+                                  selectOutputParticles(particles, cells, region), region.fields);
+         }));
+
+  OutputFilter sample;
+  sample.sampling = OutputSampling::stride;
+  sample.stride   = k * k * k;
+  report("stride", timeSeconds([&]() {
+           writeSelectedParticles(outputFile, header, particles,
+                                  selectOutputParticles(particles, cells, sample), sample.fields);
+         }));
+  sample.sampling = OutputSampling::random;
+  sample.fraction = 1.0 / (k * k * k);
+  report("random share", timeSeconds([&]() {
+           writeSelectedParticles(outputFile, header, particles,
+                                  selectOutputParticles(particles, cells, sample), sample.fields);
+         }));
+  OutputFilter positions;
+  positions.fields = {false, true, false, false, false, false};
+  report("positions only", timeSeconds([&]() {
+           writeSelectedParticles(outputFile, header, particles,
+                                  selectOutputParticles(particles, cells, positions),
+                                  positions.fields);
+         }));
+  (void) std::remove(outputFile.c_str());
+  return 0;
+}
@@ -0,0 +1,94 @@
+// paircache_bench.cpp
+// Density and acceleration pass times with the pair geometry recomputed by the acceleration
+// pass and with the pair cache streaming it back, for both reduction modes and for float and
+// double storage. The cache trades the stencil walk and distance test of the acceleration pass
+// for writing and reading one record per interacting pair. Every step starts from the input.
+// Usage: paircache_bench [repetitions] [input.fld] [lattice ppm]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "profile.hpp"
+#include "step.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PhaseTimes {
+    double densities;
+    double accelerations;
+    double cacheMegabytes;
+};
+
+template <typename Policy>
+PhaseTimes timePasses(std::vector<PolicyParticle<Policy>> const & input,
+                      ParticleParameters const & params, SimulationOptions const & options,
+                      int repetitions) {
+  StepWorkspace<Policy> workspace;
+  StepProfile profile(false);
+  std::vector<PolicyParticle<Policy>> particles = input;
+  // The first step sizes the cell list and the cache buffers
+  stepParticles(particles, params, workspace, options);
+  workspace.profile = &profile;
+  for (int it = 0; it < repetitions; ++it) {
+    particles = input;
+    stepParticles(particles, params, workspace, options);
+  }
+  std::size_t records = 0;
+  for (auto const & buffer : workspace.pairCache.threadPairs) { records += buffer.size(); }
+  const double scale = 1000.0 / repetitions;
+  return {scale * profile.totals(StepPhase::densities).seconds,
+          scale * profile.totals(StepPhase::accelerations).seconds,
+          static_cast<double>(records * sizeof(CachedPair<typename Policy::storage_type>)) /
+              (1024.0 * 1024.0)};
+}
+
+template <typename Policy>
+void runPolicy(char const * name, std::vector<PolicyParticle<Policy>> const & input,
+               ParticleParameters const & params, int repetitions) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.reduction      = reduction;
+    const PhaseTimes plain = timePasses<Policy>(input, params, options, repetitions);
+    options.pairCache      = true;
+    const PhaseTimes cache = timePasses<Policy>(input, params, options, repetitions);
+    std::cout << std::left << std::setw(8) << name << std::setw(15)
+              << (reduction == ReductionMode::fast ? "fast" : "deterministic") << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << plain.densities
+              << std::setw(10) << plain.accelerations << std::setw(10) << cache.densities
+              << std::setw(10) << cache.accelerations << std::setw(10)
+              << (plain.densities + plain.accelerations) -
+                     (cache.densities + cache.accelerations)
+              << std::setw(10) << cache.cacheMegabytes << '\n';
+  }
+}
+
+void runInput(std::string const & label, std::vector<Particle> const & input,
+              ParticleParameters const & params, int repetitions) {
+  std::cout << label << ": " << input.size() << " particles (ms per pass)\n"
+            << std::left << std::setw(23) << "storage / reduction" << std::right
+            << std::setw(10) << "dens" << std::setw(10) << "accel" << std::setw(10)
+            << "dens+rec" << std::setw(10) << "replay" << std::setw(10) << "saved"
+            << std::setw(10) << "cache MB" << '\n';
+  runPolicy<FloatPrecision>("float", input, params, repetitions);
+  runPolicy<DoublePrecision>("double", convertParticles<double>(input), params, repetitions);
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/large.fld";
+  const float latticePpm      = args.size() > 3 ? std::stof(args[3]) : 400.0F;
+
+  Header header{};
+  std::vector<Particle> input;
+  ParticleParameters params = loadBenchInput(inputFile, header, input);
+  runInput(inputFile, input, params, repetitions);
+
+  params = makeLatticeInput(latticePpm, header, input);
+  runInput("lattice ppm " + std::to_string(static_cast<int>(latticePpm)), input, params,
+           repetitions);
+  return 0;
+}
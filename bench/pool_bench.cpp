@@ -0,0 +1,48 @@
+// pool_bench.cpp
+// Synchronisation cost of one empty parallel phase: threads started per phase (runOnThreads)
+// against a persistent ThreadPool, plus the cost of one barrier inside a pool phase.
+// Usage: pool_bench [phases] [threads]
+#include "bench_common.hpp"
+#include "parallel.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int phases  = args.size() > 1 ? std::stoi(args[1]) : 20000;
+  const int threads = args.size() > 2 ? std::stoi(args[2]) : 4;
+
+  std::atomic<int> sink{0};
+  const double spawned = timeSeconds([&]() {
+    for (int phase = 0; phase < phases; ++phase) {
+      runOnThreads(threads, [&](int thread) { sink.fetch_add(thread, std::memory_order_relaxed); });
+    }
+  });
+  ThreadPool pool(threads);
+  const double pooled = timeSeconds([&]() {
+    for (int phase = 0; phase < phases; ++phase) {
+      pool.run([&](int thread) { sink.fetch_add(thread, std::memory_order_relaxed); });
+    }
+  });
+  const double barriers = timeSeconds([&]() {
+    pool.run([&](int /*thread*/) {
+      for (int phase = 0; phase < phases; ++phase) { pool.barrier(); }
+    });
+  });
+
+  const double toMicroseconds = 1e6 / phases;
+  std::cout << "Threads: " << threads << (pool.pinned() ? " (pinned)" : " (not pinned)")
+            << ", phases: " << phases << '\n'
+            << std::fixed << std::setprecision(2) << "threads per phase: " << std::setw(10)
+            << spawned * toMicroseconds << " us/phase\n"
+            << "persistent pool:   " << std::setw(10) << pooled * toMicroseconds
+            << " us/phase\n"
+            << "pool barrier:      " << std::setw(10) << barriers * toMicroseconds
+            << " us/barrier\n";
+  return sink.load() < 0 ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// precision_bench.cpp
+// Accuracy and throughput of each precision policy against the double/double reference.
+// Usage: precision_bench [steps] [input.fld]
+#include "bench_common.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PolicyResult {
+    double seconds;
+    std::vector<BasicParticle<double>> state;
+};
+
+struct ErrorSummary {
+    double maxPosition;
+    double maxVelocity;
+    double maxDensity;
+};
+
+template <typename Policy>
+PolicyResult runPolicy(std::vector<Particle> const & input, ParticleParameters const & params,
+                       int steps) {
+  using Storage = typename Policy::storage_type;
+  auto particles = convertParticles<Storage>(input);
+  StepWorkspace<Policy> workspace;
+  const double seconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(particles, params, workspace); }
+  });
+  return {seconds, convertParticles<double>(particles)};
+}
+
+ErrorSummary compareStates(std::vector<BasicParticle<double>> const & state,
+                           std::vector<BasicParticle<double>> const & reference) {
+  ErrorSummary errors{0.0, 0.0, 0.0};
+  for (std::size_t i = 0; i < state.size(); ++i) {
+    auto const & p = state[i];
+    auto const & q = reference[i];
+    errors.maxPosition = std::max({errors.maxPosition, std::abs(p.px - q.px),
+                                   std::abs(p.py - q.py), std::abs(p.pz - q.pz)});
+    errors.maxVelocity = std::max({errors.maxVelocity, std::abs(p.vx - q.vx),
+                                   std::abs(p.vy - q.vy), std::abs(p.vz - q.vz)});
+    errors.maxDensity  = std::max(errors.maxDensity,
+                                  std::abs(p.rho - q.rho) / std::max(std::abs(q.rho), 1e-30));
+  }
+  return errors;
+}
+
+void report(std::string const & name, PolicyResult const & result, PolicyResult const & reference,
+            int steps) {
+  const auto errors     = compareStates(result.state, reference.state);
+  const double pairs    = 0.5 * static_cast<double>(result.state.size()) *
+                       static_cast<double>(result.state.size() - 1);
+  const double stepRate = static_cast<double>(steps) / result.seconds;
+  std::cout << std::left << std::setw(14) << name << std::right << std::setw(12)
+            << std::setprecision(4) << result.seconds << std::setw(12) << stepRate
+            << std::setw(14) << pairs * stepRate * 2.0 << std::setw(14) << errors.maxPosition
+            << std::setw(14) << errors.maxVelocity << std::setw(14) << errors.maxDensity << '\n';
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps               = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile   = args.size() > 2 ? args[2] : "in/small.fld";
+
+  Header header{};
+  std::vector<Particle> particles;
+  const ParticleParameters params = loadBenchInput(inputFile, header, particles);
+
+  const auto reference = runPolicy<DoublePrecision>(particles, params, steps);
+  std::cout << "Particles: " << particles.size() << ", steps: " << steps << '\n'
+            << std::left << std::setw(14) << "policy" << std::right << std::setw(12) << "seconds"
+            << std::setw(12) << "steps/s" << std::setw(14) << "pair-evals/s" << std::setw(14)
+            << "max |dpos|" << std::setw(14) << "max |dvel|" << std::setw(14) << "max rel drho"
+            << '\n';
+  report("float/float", runPolicy<FloatPrecision>(particles, params, steps), reference, steps);
+  report("float/double", runPolicy<MixedPrecision>(particles, params, steps), reference, steps);
+  report("double/double", reference, reference, steps);
+  return 0;
+}
@@ -0,0 +1,83 @@
+// reduction_bench.cpp
+// Cost of the deterministic reduction against the fast one for several thread counts, and
+// check that the deterministic result does not change with the thread count.
+// Usage: reduction_bench [steps] [input.fld] [max_threads]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ModeResult {
+    double seconds;
+    std::vector<Particle> state;
+};
+
+ModeResult runMode(std::vector<Particle> const & input, ParticleParameters const & params,
+                   int steps, SimulationOptions const & options) {
+  std::vector<Particle> particles = input;
+  StepWorkspace<FloatPrecision> workspace;
+  const double seconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(particles, params, workspace, options); }
+  });
+  return {seconds, particles};
+}
+
+bool bitIdentical(std::vector<Particle> const & a, std::vector<Particle> const & b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(Particle)) == 0;
+}
+
+double maxDensityDeviation(std::vector<Particle> const & a, std::vector<Particle> const & b) {
+  double deviation = 0.0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    const double reference = std::max(std::abs(static_cast<double>(b[i].rho)), 1e-30);
+    deviation = std::max(deviation, std::abs(static_cast<double>(a[i].rho - b[i].rho)) / reference);
+  }
+  return deviation;
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps             = args.size() > 1 ? std::stoi(args[1]) : 3;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/small.fld";
+  const int maxThreads        = args.size() > 3 ? std::stoi(args[3])
+                                                : static_cast<int>(std::max(
+                                                      4U, std::thread::hardware_concurrency()));
+
+  Header header{};
+  std::vector<Particle> particles;
+  const ParticleParameters params = loadBenchInput(inputFile, header, particles);
+
+  SimulationOptions options;
+  const ModeResult serial = runMode(particles, params, steps, options);
+  options.reduction       = ReductionMode::deterministic;
+  const ModeResult deterministicSerial = runMode(particles, params, steps, options);
+
+  std::cout << "Particles: " << particles.size() << ", steps: " << steps << '\n'
+            << std::setw(8) << "threads" << std::setw(12) << "fast s" << std::setw(12)
+            << "determ. s" << std::setw(10) << "ratio" << std::setw(16) << "fast max drho"
+            << std::setw(16) << "determ. equal" << '\n';
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+    options.threads                = threads;
+    options.reduction              = ReductionMode::fast;
+    const ModeResult fast          = threads == 1 ? serial : runMode(particles, params, steps, options);
+    options.reduction              = ReductionMode::deterministic;
+    const ModeResult deterministic =
+        threads == 1 ? deterministicSerial : runMode(particles, params, steps, options);
+    std::cout << std::setw(8) << threads << std::setprecision(4) << std::setw(12) << fast.seconds
+              << std::setw(12) << deterministic.seconds << std::setw(10)
+              << deterministic.seconds / fast.seconds << std::setw(16)
+              << maxDensityDeviation(fast.state, serial.state) << std::setw(16)
+              << (bitIdentical(deterministic.state, deterministicSerial.state) ? "yes" : "NO")
+              << '\n';
+  }
+  return 0;
+}
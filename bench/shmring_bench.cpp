@@ -0,0 +1,110 @@
+// shmring_bench.cpp
+// Cost of publishing a frame to the shared memory ring after every step, against writing an
+// .fld file after every step, on a lattice of particles 1.2 smoothing lengths apart falling
+// under gravity. A consumer thread follows the ring meanwhile, reading each frame in place.
+// Usage: shmring_bench [steps] [particles per metre] [slots] [directory]
+#include "bench_common.hpp"
+#include "precision.hpp"
+#include "shmring.hpp"
+#include "step.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  struct ConsumerCounts {
+      std::uint64_t frames = 0;
+      std::uint64_t torn   = 0;
+      double checksum      = 0.0;  // Keeps the reads
+  };
+
+  // Follows the ring until `stop`, summing the positions of every new frame in place
+  void consume(std::string const & name, std::atomic<bool> const & stop, ConsumerCounts & counts) {
+    ShmRingReader const ring(name);
+    std::uint64_t seen = 0;
+    while (!stop.load(std::memory_order_acquire)) {
+      ShmFrame frame;
+      if (ring.published() > seen && ring.acquireLatest(frame)) {
+        double sum = 0.0;
+        for (Particle const & particle : frame.particles) { sum += particle.px + particle.py; }
+        if (ShmRingReader::stillValid(frame)) {
+          seen             = frame.frame + 1;
+          counts.checksum += sum;
+          ++counts.frames;
+        } else {
+          ++counts.torn;
+        }
+        continue;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps             = args.size() > 1 ? std::stoi(args[1]) : 20;
+  const float ppm             = args.size() > 2 ? std::stof(args[2]) : 600.0F;
+  const int slots             = args.size() > 3 ? std::stoi(args[3]) : 4;
+  std::string const directory = args.size() > 4 ? args[4] : "/tmp";
+  std::string const dumpFile  = directory + "/shmring_bench.fld";
+  std::string const name      = "/shmring-bench";
+
+  Header header{};
+  std::vector<Particle> particles;
+  const ParticleParameters params     = makeFallingLatticeInput(ppm, header, particles);
+  std::vector<Particle> const initial = particles;
+  StepWorkspace<FloatPrecision> workspace;
+
+  // Every step followed by `output`; returns the seconds spent in the steps and in the output
+  auto run = [&](auto && output) {
+    particles        = initial;
+    double stepTime  = 0.0;
+    double frameTime = 0.0;
+    for (int it = 1; it <= steps; ++it) {
+      stepTime  += timeSeconds([&]() { stepParticles(particles, params, workspace); });
+      frameTime += timeSeconds([&]() { output(it); });
+    }
+    return std::pair{stepTime, frameTime};
+  };
+
+  const double plainSteps          = run([](int) { }).first;
+  auto const [dumpSteps, dumpTime] = run([&](int) {
+    writeParticlesToFile(dumpFile, header, particles);
+  });
+  ShmRingWriter ring(name, static_cast<std::size_t>(slots), particles.size(), ppm);
+  if (!ring.isOpen()) {
+    std::cerr << "Could not create shared memory ring " << name << '\n';
+    return 1;
+  }
+  std::atomic<bool> stop{false};
+  ConsumerCounts counts;
+  std::thread consumer(consume, name, std::cref(stop), std::ref(counts));
+  auto const [ringSteps, ringTime] = run([&](int it) { ring.publish(it, particles); });
+  stop.store(true, std::memory_order_release);
+  consumer.join();
+
+  const auto perStep = [steps](double seconds) { return 1000.0 * seconds / steps; };
+  std::cout << "Particles: " << particles.size() << ", steps: " << steps << ", slots: " << slots
+            << '\n'
+            << std::fixed << std::setprecision(2)
+            << "no output:        " << perStep(plainSteps) << " ms per step\n"
+            << ".fld every step:  " << perStep(dumpSteps) << " ms per step + "
+            << perStep(dumpTime) << " ms per file\n"
+            << "ring every step:  " << perStep(ringSteps) << " ms per step + "
+            << perStep(ringTime) << " ms per frame\n"
+            << "consumer:         " << counts.frames << " frames read in place, " << counts.torn
+            << " torn reads retried\n"
+            << std::defaultfloat;
+  (void) std::remove(dumpFile.c_str());
+  return 0;
+}
@@ -0,0 +1,104 @@
+// sleep_bench.cpp
+// Speed-up and error of particle sleeping on a partly resting scene: a layer of particles rests
+// on the floor of the box while a block of particles falls towards it. The particles are 1.2
+// smoothing lengths apart and the run ends before the block lands, because denser or colliding
+// scenes do not stay bounded with the current kernels. The same steps run with every particle
+// updated and with sleeping; the report gives the skipped work, both times and the largest
+// position and velocity difference between the two runs.
+// Usage: sleep_bench [steps] [still steps] [velocity] [acceleration] [ppm]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "precision.hpp"
+#include "sleep.hpp"
+#include "step.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Particle spacing in smoothing lengths
+constexpr float SCENE_SPACING = 1.2F;
+// Height of the floor layer above ymin, and of the falling block
+constexpr float FLOOR_HEIGHT   = 1.0e-4F;
+constexpr float FALLING_HEIGHT = 0.05F;
+// Half width of the falling block in spacings
+constexpr int FALLING_HALF_WIDTH = 3;
+
+ParticleParameters makeSettlingScene(float ppm, std::vector<Particle> & particles) {
+  Header header{};
+  ParticleParameters params = makeLatticeInput(ppm, header, particles);
+  particles.clear();
+  const float spacing = SCENE_SPACING * params.smoothingLength;
+  const auto add      = [&particles](float x, float y, float z) {
+    Particle particle{};
+    particle.px = x;
+    particle.py = y;
+    particle.pz = z;
+    initializeDensitiesAndAccelerations(particle);
+    particles.push_back(particle);
+  };
+  for (float z = zmin + spacing; z < zmax - spacing; z += spacing) {
+    for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+      add(x, ymin + FLOOR_HEIGHT, z);
+    }
+  }
+  const float base = ymin + FALLING_HEIGHT;
+  for (int k = -FALLING_HALF_WIDTH; k <= FALLING_HALF_WIDTH; ++k) {
+    for (int j = 0; j <= 2 * FALLING_HALF_WIDTH; ++j) {
+      for (int i = -FALLING_HALF_WIDTH; i <= FALLING_HALF_WIDTH; ++i) {
+        add(static_cast<float>(i) * spacing, base + static_cast<float>(j) * spacing,
+            static_cast<float>(k) * spacing);
+      }
+    }
+  }
+  return params;
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps = args.size() > 1 ? std::stoi(args[1]) : 80;
+  SimulationOptions options;
+  options.sleepSteps        = args.size() > 2 ? std::stoi(args[2]) : 20;
+  options.sleepVelocity     = args.size() > 3 ? std::stof(args[3]) : 0.05F;
+  options.sleepAcceleration = args.size() > 4 ? std::stof(args[4]) : 15.0F;
+  const float ppm           = args.size() > 5 ? std::stof(args[5]) : 400.0F;
+
+  std::vector<Particle> input;
+  const ParticleParameters params = makeSettlingScene(ppm, input);
+
+  std::vector<Particle> full = input;
+  StepWorkspace<FloatPrecision> fullWorkspace;
+  const double fullSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(full, params, fullWorkspace); }
+  });
+  std::vector<Particle> sleeping = input;
+  StepWorkspace<FloatPrecision> sleepWorkspace;
+  const double sleepSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) {
+      stepParticles(sleeping, params, sleepWorkspace, options);
+    }
+  });
+
+  double position = 0.0;
+  double velocity = 0.0;
+  for (std::size_t i = 0; i < full.size(); ++i) {
+    position = std::max({position, static_cast<double>(std::abs(full[i].px - sleeping[i].px)),
+                         static_cast<double>(std::abs(full[i].py - sleeping[i].py)),
+                         static_cast<double>(std::abs(full[i].pz - sleeping[i].pz))});
+    velocity = std::max({velocity, static_cast<double>(std::abs(full[i].vx - sleeping[i].vx)),
+                         static_cast<double>(std::abs(full[i].vy - sleeping[i].vy)),
+                         static_cast<double>(std::abs(full[i].vz - sleeping[i].vz))});
+  }
+  std::cout << "Particles: " << input.size() << ", steps: " << steps << ", still steps "
+            << options.sleepSteps << ", thresholds " << options.sleepVelocity << " m/s, "
+            << options.sleepAcceleration << " m/s^2\n";
+  printSleepStats(sleepWorkspace.sleep.stats, std::cout);
+  std::cout << std::fixed << std::setprecision(3) << "Time: " << fullSeconds << " s full, "
+            << sleepSeconds << " s sleeping (" << fullSeconds / sleepSeconds << "x)\n"
+            << std::scientific << std::setprecision(2) << "Largest difference: " << position
+            << " m in position, " << velocity << " m/s in velocity\n";
+  return 0;
+}
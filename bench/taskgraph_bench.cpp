@@ -0,0 +1,70 @@
+// taskgraph_bench.cpp
+// Step time with the phase by phase schedules (work stealing and static ranges, a barrier
+// between phases and colours) and with the task graph of cell blocks, for both reductions. The
+// deterministic runs must give the same particles with every schedule. Every step starts from
+// the input.
+// Usage: taskgraph_bench [repetitions] [input.fld] [threads] [block cells]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct ScheduleRun {
+    double milliseconds;  // Per step
+    std::vector<Particle> state;
+};
+
+ScheduleRun runSchedule(std::vector<Particle> const & input, ParticleParameters const & params,
+                        int repetitions, SimulationOptions const & options) {
+  std::vector<Particle> particles = input;
+  StepWorkspace<FloatPrecision> workspace;
+  // The first step creates the pool and sizes the arrays
+  stepParticles(particles, params, workspace, options);
+  double seconds = 0.0;
+  for (int it = 0; it < repetitions; ++it) {
+    particles  = input;
+    seconds   += timeSeconds([&]() { stepParticles(particles, params, workspace, options); });
+  }
+  return {1000.0 * seconds / repetitions, particles};
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int repetitions       = args.size() > 1 ? std::stoi(args[1]) : 5;
+  std::string const inputFile = args.size() > 2 ? args[2] : "in/large.fld";
+  const int threads           = args.size() > 3 ? std::stoi(args[3]) : 4;
+  const int blockCells        = args.size() > 4 ? std::stoi(args[4]) : 4;
+
+  Header header{};
+  std::vector<Particle> input;
+  const ParticleParameters params = loadBenchInput(inputFile, header, input);
+  std::cout << inputFile << ": " << input.size() << " particles, " << threads << " threads, blocks of " << blockCells << "^3 cells (ms per step)\n"
+            << std::left << std::setw(15) << "reduction" << std::right << std::setw(10)
+            << "stealing" << std::setw(10) << "static" << std::setw(10) << "graph"
+            << std::setw(12) << "same state" << '\n';
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.threads         = threads;
+    options.reduction       = reduction;
+    options.graphBlockCells = blockCells;
+    const ScheduleRun stealing = runSchedule(input, params, repetitions, options);
+    options.schedule           = CellSchedule::staticRange;
+    const ScheduleRun ranges   = runSchedule(input, params, repetitions, options);
+    options.schedule           = CellSchedule::graph;
+    const ScheduleRun graph    = runSchedule(input, params, repetitions, options);
+    const bool same            = std::memcmp(graph.state.data(), stealing.state.data(),
+                                             input.size() * sizeof(Particle)) == 0;
+    std::cout << std::left << std::setw(15)
+              << (reduction == ReductionMode::fast ? "fast" : "deterministic") << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << stealing.milliseconds
+              << std::setw(10) << ranges.milliseconds << std::setw(10) << graph.milliseconds
+              << std::setw(12) << (same ? "yes" : "no") << '\n';
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+// temporal_bench.cpp
+// Time of a run advanced step by step and in temporal blocks of tiles, on a jittered lattice.
+// Both runs must give the same particles; the blocked run also reports the halo, the reruns and
+// the particle updates it computed per update it kept.
+// Usage: temporal_bench [steps] [particles per metre] [block steps] [tile cells] [threads]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+#include "temporal.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps      = args.size() > 1 ? std::stoi(args[1]) : 8;
+  const float ppm      = args.size() > 2 ? std::stof(args[2]) : 150.0F;
+  const int blockSteps = args.size() > 3 ? std::stoi(args[3]) : 2;
+  const int tileCells  = args.size() > 4 ? std::stoi(args[4]) : 4;
+  const int threads    = args.size() > 5 ? std::stoi(args[5]) : 1;
+
+  Header header{};
+  std::vector<Particle> input;
+  const ParticleParameters params = makeLatticeInput(ppm, header, input);
+  SimulationOptions options;
+  options.threads           = threads;
+  options.temporalSteps     = blockSteps;
+  options.temporalTileCells = tileCells;
+
+  std::vector<Particle> stepped = input;
+  StepWorkspace<FloatPrecision> workspace;
+  const double stepSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; ++it) { stepParticles(stepped, params, workspace, options); }
+  });
+  std::vector<Particle> blocked = input;
+  TemporalWorkspace<FloatPrecision> temporal;
+  const double blockSeconds = timeSeconds([&]() {
+    for (int it = 0; it < steps; it += blockSteps) {
+      advanceTemporalBlock<FloatPrecision>(blocked, params, std::min(blockSteps, steps - it),
+                                           options, temporal);
+    }
+  });
+  const bool same =
+      std::memcmp(stepped.data(), blocked.data(), input.size() * sizeof(Particle)) == 0;
+
+  std::cout << "Particles: " << input.size() << ", grid " << params.blocks.nx << "x"
+            << params.blocks.ny << "x" << params.blocks.nz << " cells, steps: " << steps
+            << ", blocks of " << blockSteps << " steps, tiles of " << tileCells << "^3 cells, "
+            << threads << " threads\n"
+            << std::fixed << std::setprecision(2)
+            << "step by step: " << 1000.0 * stepSeconds / steps
+            << " ms per step\n"
+            << "temporal:     " << 1000.0 * blockSeconds / steps << " ms per step\n"
+            << std::defaultfloat;
+  printTemporalStats(temporal.stats, std::cout);
+  std::cout << "Same particles: " << (same ? "yes" : "no") << '\n';
+  return same ? 0 : 1;
+}
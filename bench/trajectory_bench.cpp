@@ -0,0 +1,80 @@
+// trajectory_bench.cpp
+// Size and cost of trajectory output on a lattice of particles 1.2 smoothing lengths apart
+// falling under gravity (a spacing that keeps the run bounded with the current kernels): a
+// frame after every step, written as full particle dumps and as a delta-encoded trajectory of
+// every field and of positions only. Also the time to seek to the last frame.
+// Usage: trajectory_bench [steps] [particles per metre] [keyframe interval] [directory]
+#include "bench_common.hpp"
+#include "options.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "trajectory.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  const int steps             = args.size() > 1 ? std::stoi(args[1]) : 40;
+  const float ppm             = args.size() > 2 ? std::stof(args[2]) : 600.0F;
+  const int keyframes         = args.size() > 3 ? std::stoi(args[3]) : 16;
+  std::string const directory = args.size() > 4 ? args[4] : "/tmp";
+  std::string const dumpFile  = directory + "/trajectory_bench.fld";
+  std::string const fullFile  = directory + "/trajectory_bench_full.trj";
+  std::string const posFile   = directory + "/trajectory_bench_positions.trj";
+
+  Header header{};
+  std::vector<Particle> particles;
+  const ParticleParameters params = makeFallingLatticeInput(ppm, header, particles);
+
+  OutputFilter positions;
+  positions.fields = {false, true, false, false, false, false};
+  TrajectoryWriter full(fullFile, header, OutputFilter{}, keyframes);
+  TrajectoryWriter positionsOnly(posFile, header, positions, keyframes);
+  StepWorkspace<FloatPrecision> workspace;
+  double dumpSeconds       = 0.0;
+  double fullSeconds       = 0.0;
+  double positionsSeconds  = 0.0;
+  std::uintmax_t dumpBytes = 0;
+  for (int it = 0; it <= steps; ++it) {
+    if (it > 0) { stepParticles(particles, params, workspace); }
+    dumpSeconds      += timeSeconds([&]() { writeParticlesToFile(dumpFile, header, particles); });
+    dumpBytes        += std::filesystem::file_size(dumpFile);
+    fullSeconds      += timeSeconds([&]() { full.writeFrame(it, particles); });
+    positionsSeconds += timeSeconds([&]() { positionsOnly.writeFrame(it, particles); });
+  }
+  full.finish();
+  positionsOnly.finish();
+
+  std::vector<float> values;
+  TrajectoryReader reader(fullFile);
+  const double seekSeconds = timeSeconds([&]() { reader.readFrame(steps, values); });
+  const std::uint64_t seekFrames = reader.decodedFrames();
+  const double frameSeconds      = timeSeconds([&]() { reader.readFrame(steps - 1, values); });
+
+  const auto frames = static_cast<double>(steps + 1);
+  std::cout << "Particles: " << particles.size() << ", frames: " << steps + 1
+            << ", keyframe interval: " << keyframes << '\n'
+            << std::fixed << std::setprecision(2)
+            << "full dumps:        " << 1000.0 * dumpSeconds / frames << " ms per frame, "
+            << static_cast<double>(dumpBytes) / 1.0e6 << " MB\n"
+            << "trajectory:        " << 1000.0 * fullSeconds / frames << " ms per frame, "
+            << static_cast<double>(std::filesystem::file_size(fullFile)) / 1.0e6 << " MB\n"
+            << "positions only:    " << 1000.0 * positionsSeconds / frames << " ms per frame, "
+            << static_cast<double>(std::filesystem::file_size(posFile)) / 1.0e6 << " MB\n"
+            << "seek to last:      " << 1000.0 * seekSeconds << " ms, " << seekFrames
+            << " frames decoded\n"
+            << "seek back by one:  " << 1000.0 * frameSeconds << " ms, "
+            << reader.decodedFrames() - seekFrames << " frames decoded\n"
+            << std::defaultfloat;
+  printTrajectoryStats(full.stats(), fullFile, std::cout);
+  printTrajectoryStats(positionsOnly.stats(), posFile, std::cout);
+  (void) std::remove(dumpFile.c_str());
+  (void) std::remove(fullFile.c_str());
+  (void) std::remove(posFile.c_str());
+  return 0;
+}
@@ -1,268 +1,400 @@
-// ftest.cpp
-#include "block.hpp"
-#include "constants.hpp"
-#include "grid.hpp"
-#include "particle.hpp"
-#include "progargs.hpp"
-#include "simulation.hpp"
-#include "utils.hpp"
-
-#include <filesystem>
-#include <fstream>
-#include <functional>
-#include <gtest/gtest.h>
-#include <iostream>
-#include <string>
-#include <vector>
-
-// Definición de constantes globales para la prueba
-static constexpr float testParticlePosX = 10.0F;
-static constexpr float testParticlePosY = 20.0F;
-static constexpr float testParticlePosZ = 30.0F;
-static constexpr int blockSizeX         = 1;
-static constexpr int blockSizeY         = 1;
-static constexpr int blockSizeZ         = 1;
-static constexpr int blocksNumX         = 10;
-static constexpr int blocksNumY         = 10;
-static constexpr int blocksNumZ         = 10;
-static constexpr float TOLERANCE        = 0.001F;
-
-class BlockManagementTest : public ::testing::Test {
-  private:
-    Particle testParticle = {};
-    GridSize blockSize;
-    GridSize gridDimensions;
-
-  protected:
-    void SetUp() override {
-      // Completa la inicialización con los valores específicos
-      testParticle = {
-        testParticlePosX,
-        testParticlePosY,
-        testParticlePosZ,  // Posición
-        0.0F,
-        0.0F,
-        0.0F,  // Velocidades hvx, hvy, hvz
-        0.0F,
-        0.0F,
-        0.0F,  // Velocidades vx, vy, vz
-        rho,   // Valor para rho
-        0.0F,
-        0.0F,
-        0.0F,  // Aceleraciones ax, ay, az
-      };
-      blockSize      = {blockSizeX, blockSizeY, blockSizeZ};
-      gridDimensions = {blocksNumX, blocksNumY, blocksNumZ};
-    }
-
-    [[nodiscard]] std::vector<int> GetCalculatedIndices() const {
-      auto indicesArray = getBlockIndices(testParticle, blockSize, gridDimensions);
-      return {indicesArray.begin(), indicesArray.end()};
-    }
-};
-
-TEST_F(BlockManagementTest, TestBlockIndexCalculation) {
-  auto const indices                     = GetCalculatedIndices();
-  std::vector<int> const expectedIndices = {9, 9, 9};
-
-  ASSERT_EQ(indices.size(), expectedIndices.size())
-      << "Los tamaños de los vectores de índices no coinciden.";
-
-  for (size_t i = 0; i < expectedIndices.size(); ++i) {
-    EXPECT_EQ(indices[i], expectedIndices[i])
-        << "Índice de bloque en la posición " << i << " es incorrecto.";
-  }
-}
-
-class GridManagementFunctionalTest : public ::testing::Test {
-  private:
-    static int const DomainSizeX     = 100;
-    static int const DomainSizeY     = 200;
-    static int const DomainSizeZ     = 300;
-    static int const ReferenceHeight = 1;
-
-    float referenceHeight = static_cast<float>(ReferenceHeight);
-    GridSize domainSize   = {DomainSizeX, DomainSizeY, DomainSizeZ};
-    GridSize expectedNumberOfBlocks;
-    GridSize expectedBlockSize;
-
-  protected:
-    void SetUp() override {
-      expectedNumberOfBlocks = {DomainSizeX, DomainSizeY, DomainSizeZ};
-      expectedBlockSize      = {ReferenceHeight, ReferenceHeight, ReferenceHeight};
-    }
-
-    [[nodiscard]] float getReferenceHeight() const { return referenceHeight; }
-
-    [[nodiscard]] GridSize getDomainSize() const { return domainSize; }
-
-    [[nodiscard]] GridSize getExpectedNumberOfBlocks() const { return expectedNumberOfBlocks; }
-
-    [[nodiscard]] GridSize getExpectedBlockSize() const { return expectedBlockSize; }
-};
-
-TEST_F(GridManagementFunctionalTest, TestGridSizeAndBlockCalculations) {
-  // Calcular el número de bloques
-  GridSize calculatedNumberOfBlocks;
-  calculateNumberOfBlocks(getReferenceHeight(), getDomainSize(), calculatedNumberOfBlocks);
-  EXPECT_EQ(calculatedNumberOfBlocks.nx, getExpectedNumberOfBlocks().nx);
-  EXPECT_EQ(calculatedNumberOfBlocks.ny, getExpectedNumberOfBlocks().ny);
-  EXPECT_EQ(calculatedNumberOfBlocks.nz, getExpectedNumberOfBlocks().nz);
-
-  // Calcular el tamaño de los bloques
-  GridSize calculatedBlockSize;
-  calculateBlockSize(calculatedNumberOfBlocks, getDomainSize(), calculatedBlockSize);
-  EXPECT_NEAR(calculatedBlockSize.nx, getExpectedBlockSize().nx, TOLERANCE);
-  EXPECT_NEAR(calculatedBlockSize.ny, getExpectedBlockSize().ny, TOLERANCE);
-  EXPECT_NEAR(calculatedBlockSize.nz, getExpectedBlockSize().nz, TOLERANCE);
-
-  // For total grid size comparisons, consider the cumulative error
-  EXPECT_NEAR(getDomainSize().nx, calculatedNumberOfBlocks.nx * calculatedBlockSize.nx,
-              TOLERANCE * calculatedNumberOfBlocks.nx);
-  EXPECT_NEAR(getDomainSize().ny, calculatedNumberOfBlocks.ny * calculatedBlockSize.ny,
-              TOLERANCE * calculatedNumberOfBlocks.ny);
-  EXPECT_NEAR(getDomainSize().nz, calculatedNumberOfBlocks.nz * calculatedBlockSize.nz,
-              TOLERANCE * calculatedNumberOfBlocks.nz);
-}
-
-class CommandLineArgumentsTest : public ::testing::Test {
-  private:
-    static constexpr int DefaultIterations    = 10;
-    static constexpr int DefaultParticleCount = 100;
-
-    std::vector<std::string> args;
-    int iterations{DefaultIterations};
-    int particleCount{DefaultParticleCount};
-    int fileParticleCount{DefaultParticleCount};
-
-  protected:
-    void SetUp() override {
-      args = {"program", std::to_string(DefaultIterations), "input.fld", "output.fld"};
-    }
-
-    [[nodiscard]] std::vector<std::string> const & getArgs() const { return args; }
-
-    [[nodiscard]] int getIterations() const { return iterations; }
-
-    [[nodiscard]] int getParticleCount() const { return particleCount; }
-
-    [[nodiscard]] int getFileParticleCount() const { return fileParticleCount; }
-
-    void modifyArgs(std::function<void(std::vector<std::string> &)> const & modifier) {
-      modifier(args);
-    }
-
-    void setIterations(int newIterations) { iterations = newIterations; }
-
-    void setParticleCount(int newParticleCount) { particleCount = newParticleCount; }
-
-    void setFileParticleCount(int newFileParticleCount) {
-      fileParticleCount = newFileParticleCount;
-    }
-};
-
-TEST_F(CommandLineArgumentsTest, ArgumentCountCorrect) {
-  EXPECT_TRUE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, MissingArguments) {
-  modifyArgs([](auto & args) {
-    args.pop_back();
-  });
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, AdditionalArguments) {
-  modifyArgs([](auto & args) {
-    args.emplace_back("extra_arg");
-  });
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, NonIntegerIterationCount) {
-  modifyArgs([](auto & args) {
-    args[1] = "no_number";
-  });
-  EXPECT_FALSE(ProgArgs::validate(getArgs(), -1, getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, NegativeIterationCount) {
-  setIterations(-1);
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, InvalidInputFile) {
-  modifyArgs([](auto & args) {
-    args[2] = "nonexistent_input.fld";
-  });
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, InvalidOutputFile) {
-  modifyArgs([](auto & args) {
-    args[3] = "nonexistent_output.fld";
-  });
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, InvalidParticleCount) {
-  setParticleCount(-1);
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST_F(CommandLineArgumentsTest, MismatchParticleCount) {
-  setFileParticleCount(getParticleCount() - 1);
-  EXPECT_FALSE(
-      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
-}
-
-TEST(ParticleManagement, TestParticleMotionUpdate) {
-  float const INITIAL_POSITION     = 0.0;
-  float const INITIAL_VELOCITY     = 1.0;
-  float const INITIAL_ACCELERATION = 0.5;
-  float const INITIAL_DENSITY      = 0.0;
-
-  Particle particle = {INITIAL_POSITION,    INITIAL_POSITION,     INITIAL_POSITION,
-                       INITIAL_VELOCITY,    INITIAL_VELOCITY,     INITIAL_VELOCITY,
-                       INITIAL_VELOCITY,    INITIAL_VELOCITY,     INITIAL_VELOCITY,
-                       INITIAL_DENSITY,     INITIAL_ACCELERATION, INITIAL_ACCELERATION,
-                       INITIAL_ACCELERATION};
-
-  updateParticleMotion(particle);
-
-  EXPECT_FLOAT_EQ(particle.px, INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.py, INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.pz, INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.vx, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.vy, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.vz, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.hvx, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.hvy, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-  EXPECT_FLOAT_EQ(particle.hvz, INITIAL_VELOCITY + INITIAL_ACCELERATION);
-}
-
-bool fileExists(std::string const & filename) {
-  if (std::filesystem::exists(filename)) { return true; }
-  std::cerr << "Error: No se pudo abrir el archivo " << filename << '\n';
-  return false;
-}
-
-TEST(SimulationTest, RunSimulation) {
-  std::string archivo_entrada = "/in/small.fld";
-  std::string archivo_salida  = "/out/small_output.fld";
-
-  ASSERT_NO_THROW(runSimulation(10, archivo_entrada, archivo_salida));
-  ASSERT_TRUE(fileExists(archivo_salida));
-}
-
-int main(int argc, char ** argv) {
-  ::testing::InitGoogleTest(&argc, argv);
-  return RUN_ALL_TESTS();
+// ftest.cpp
+#include "block.hpp"
+#include "compare.hpp"
+#include "constants.hpp"
+#include "grid.hpp"
+#include "particle.hpp"
+#include "progargs.hpp"
+#include "simulation.hpp"
+#include "trajectory.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Definición de constantes globales para la prueba
+static constexpr float testParticlePosX = 10.0F;
+static constexpr float testParticlePosY = 20.0F;
+static constexpr float testParticlePosZ = 30.0F;
+static constexpr int blockSizeX         = 1;
+static constexpr int blockSizeY         = 1;
+static constexpr int blockSizeZ         = 1;
+static constexpr int blocksNumX         = 10;
+static constexpr int blocksNumY         = 10;
+static constexpr int blocksNumZ         = 10;
+static constexpr float TOLERANCE        = 0.001F;
+
+class BlockManagementTest : public ::testing::Test {
+  private:
+    Particle testParticle = {};
+    GridSize blockSize;
+    GridSize gridDimensions;
+
+  protected:
+    void SetUp() override {
+      // Completa la inicialización con los valores específicos
+      testParticle = {
+        testParticlePosX,
+        testParticlePosY,
+        testParticlePosZ,  // Posición
+        0.0F,
+        0.0F,
+        0.0F,  // Velocidades hvx, hvy, hvz
+        0.0F,
+        0.0F,
+        0.0F,  // Velocidades vx, vy, vz
+        rho,   // Valor para rho
+        0.0F,
+        0.0F,
+        0.0F,  // Aceleraciones ax, ay, az
+      };
+      blockSize      = {blockSizeX, blockSizeY, blockSizeZ};
+      gridDimensions = {blocksNumX, blocksNumY, blocksNumZ};
+    }
+
+    [[nodiscard]] std::vector<int> GetCalculatedIndices() const {
+      auto indicesArray = getBlockIndices(testParticle, blockSize, gridDimensions);
+      return {indicesArray.begin(), indicesArray.end()};
+    }
+};
+
+TEST_F(BlockManagementTest, TestBlockIndexCalculation) {
+  auto const indices                     = GetCalculatedIndices();
+  std::vector<int> const expectedIndices = {9, 9, 9};
+
+  ASSERT_EQ(indices.size(), expectedIndices.size())
+      << "Los tamaños de los vectores de índices no coinciden.";
+
+  for (size_t i = 0; i < expectedIndices.size(); ++i) {
+    EXPECT_EQ(indices[i], expectedIndices[i])
+        << "Índice de bloque en la posición " << i << " es incorrecto.";
+  }
+}
+
+class GridManagementFunctionalTest : public ::testing::Test {
+  private:
+    static int const DomainSizeX     = 100;
+    static int const DomainSizeY     = 200;
+    static int const DomainSizeZ     = 300;
+    static int const ReferenceHeight = 1;
+
+    float referenceHeight = static_cast<float>(ReferenceHeight);
+    GridSize domainSize   = {DomainSizeX, DomainSizeY, DomainSizeZ};
+    GridSize expectedNumberOfBlocks;
+    GridSize expectedBlockSize;
+
+  protected:
+    void SetUp() override {
+      expectedNumberOfBlocks = {DomainSizeX, DomainSizeY, DomainSizeZ};
+      expectedBlockSize      = {ReferenceHeight, ReferenceHeight, ReferenceHeight};
+    }
+
+    [[nodiscard]] float getReferenceHeight() const { return referenceHeight; }
+
+    [[nodiscard]] GridSize getDomainSize() const { return domainSize; }
+
+    [[nodiscard]] GridSize getExpectedNumberOfBlocks() const { return expectedNumberOfBlocks; }
+
+    [[nodiscard]] GridSize getExpectedBlockSize() const { return expectedBlockSize; }
+};
+
+TEST_F(GridManagementFunctionalTest, TestGridSizeAndBlockCalculations) {
+  // Calcular el número de bloques
+  GridSize calculatedNumberOfBlocks;
+  calculateNumberOfBlocks(getReferenceHeight(), getDomainSize(), calculatedNumberOfBlocks);
+  EXPECT_EQ(calculatedNumberOfBlocks.nx, getExpectedNumberOfBlocks().nx);
+  EXPECT_EQ(calculatedNumberOfBlocks.ny, getExpectedNumberOfBlocks().ny);
+  EXPECT_EQ(calculatedNumberOfBlocks.nz, getExpectedNumberOfBlocks().nz);
+
+  // Calcular el tamaño de los bloques
+  GridSize calculatedBlockSize;
+  calculateBlockSize(calculatedNumberOfBlocks, getDomainSize(), calculatedBlockSize);
+  EXPECT_NEAR(calculatedBlockSize.nx, getExpectedBlockSize().nx, TOLERANCE);
+  EXPECT_NEAR(calculatedBlockSize.ny, getExpectedBlockSize().ny, TOLERANCE);
+  EXPECT_NEAR(calculatedBlockSize.nz, getExpectedBlockSize().nz, TOLERANCE);
+
+  // For total grid size comparisons, consider the cumulative error
+  EXPECT_NEAR(getDomainSize().nx, calculatedNumberOfBlocks.nx * calculatedBlockSize.nx,
+              TOLERANCE * calculatedNumberOfBlocks.nx);
+  EXPECT_NEAR(getDomainSize().ny, calculatedNumberOfBlocks.ny * calculatedBlockSize.ny,
+              TOLERANCE * calculatedNumberOfBlocks.ny);
+  EXPECT_NEAR(getDomainSize().nz, calculatedNumberOfBlocks.nz * calculatedBlockSize.nz,
+              TOLERANCE * calculatedNumberOfBlocks.nz);
+}
+
+class CommandLineArgumentsTest : public ::testing::Test {
+  private:
+    static constexpr int DefaultIterations    = 10;
+    static constexpr int DefaultParticleCount = 100;
+
+    std::vector<std::string> args;
+    int iterations{DefaultIterations};
+    int particleCount{DefaultParticleCount};
+    int fileParticleCount{DefaultParticleCount};
+
+  protected:
+    void SetUp() override {
+      args = {"program", std::to_string(DefaultIterations), "input.fld", "output.fld"};
+    }
+
+    [[nodiscard]] std::vector<std::string> const & getArgs() const { return args; }
+
+    [[nodiscard]] int getIterations() const { return iterations; }
+
+    [[nodiscard]] int getParticleCount() const { return particleCount; }
+
+    [[nodiscard]] int getFileParticleCount() const { return fileParticleCount; }
+
+    void modifyArgs(std::function<void(std::vector<std::string> &)> const & modifier) {
+      modifier(args);
+    }
+
+    void setIterations(int newIterations) { iterations = newIterations; }
+
+    void setParticleCount(int newParticleCount) { particleCount = newParticleCount; }
+
+    void setFileParticleCount(int newFileParticleCount) {
+      fileParticleCount = newFileParticleCount;
+    }
+};
+
+TEST_F(CommandLineArgumentsTest, ArgumentCountCorrect) {
+  EXPECT_TRUE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, MissingArguments) {
+  modifyArgs([](auto & args) {
+    args.pop_back();
+  });
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, AdditionalArguments) {
+  modifyArgs([](auto & args) {
+    args.emplace_back("extra_arg");
+  });
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, NonIntegerIterationCount) {
+  modifyArgs([](auto & args) {
+    args[1] = "no_number";
+  });
+  EXPECT_FALSE(ProgArgs::validate(getArgs(), -1, getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, NegativeIterationCount) {
+  setIterations(-1);
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, InvalidInputFile) {
+  modifyArgs([](auto & args) {
+    args[2] = "nonexistent_input.fld";
+  });
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, InvalidOutputFile) {
+  modifyArgs([](auto & args) {
+    args[3] = "nonexistent_output.fld";
+  });
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, InvalidParticleCount) {
+  setParticleCount(-1);
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST_F(CommandLineArgumentsTest, MismatchParticleCount) {
+  setFileParticleCount(getParticleCount() - 1);
+  EXPECT_FALSE(
+      ProgArgs::validate(getArgs(), getIterations(), getParticleCount(), getFileParticleCount()));
+}
+
+TEST(ParticleManagement, TestParticleMotionUpdate) {
+  float const INITIAL_POSITION     = 0.0;
+  float const INITIAL_VELOCITY     = 1.0;
+  float const INITIAL_ACCELERATION = 0.5;
+  float const INITIAL_DENSITY      = 0.0;
+
+  Particle particle = {INITIAL_POSITION,    INITIAL_POSITION,     INITIAL_POSITION,
+                       INITIAL_VELOCITY,    INITIAL_VELOCITY,     INITIAL_VELOCITY,
+                       INITIAL_VELOCITY,    INITIAL_VELOCITY,     INITIAL_VELOCITY,
+                       INITIAL_DENSITY,     INITIAL_ACCELERATION, INITIAL_ACCELERATION,
+                       INITIAL_ACCELERATION};
+
+  updateParticleMotion(particle);
+
+  EXPECT_FLOAT_EQ(particle.px, INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.py, INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.pz, INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.vx, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.vy, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.vz, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.hvx, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.hvy, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+  EXPECT_FLOAT_EQ(particle.hvz, INITIAL_VELOCITY + INITIAL_ACCELERATION);
+}
+
+bool fileExists(std::string const & filename) {
+  if (std::filesystem::exists(filename)) { return true; }
+  std::cerr << "Error: No se pudo abrir el archivo " << filename << '\n';
+  return false;
+}
+
+TEST(SimulationTest, RunSimulation) {
+  std::string archivo_entrada = "/in/small.fld";
+  std::string archivo_salida  = "/out/small_output.fld";
+
+  ASSERT_NO_THROW(runSimulation(10, archivo_entrada, archivo_salida));
+  ASSERT_TRUE(fileExists(archivo_salida));
+}
+
+class OutputComparisonTest : public ::testing::Test {
+  private:
+    std::string sourceDir{FLUID_SOURCE_DIR};
+    std::string firstOutput{"ftest_first_output.fld"};
+    std::string secondOutput{"ftest_second_output.fld"};
+    std::string trajectoryOutput{"ftest_trajectory.trj"};
+    std::string analyticsOutput{"ftest_analytics.csv"};
+
+  public:
+    [[nodiscard]] std::string path(std::string const & relative) const {
+      return sourceDir + "/" + relative;
+    }
+
+    [[nodiscard]] std::string const & getFirstOutput() const { return firstOutput; }
+
+    [[nodiscard]] std::string const & getSecondOutput() const { return secondOutput; }
+
+    [[nodiscard]] std::string const & getTrajectoryOutput() const { return trajectoryOutput; }
+
+    [[nodiscard]] std::string const & getAnalyticsOutput() const { return analyticsOutput; }
+
+  protected:
+    void TearDown() override {
+      (void) std::remove(firstOutput.c_str());
+      (void) std::remove(secondOutput.c_str());
+      (void) std::remove(trajectoryOutput.c_str());
+      (void) std::remove(analyticsOutput.c_str());
+    }
+};
+
+// Summation order alone (fast math, another neighbour search or reduction) moves the values
+// of one step of in/small.fld by up to about 4e-4 of their size
+static constexpr CompareTolerance REFERENCE_TOLERANCE{0.0, 1.0e-3};
+
+// out/small_1step_output.fld is one step of in/small.fld written by the tree of commit f1bf67f
+// ("[user-026] Add compile-time precision policies ..."), the first with the corrected block
+// size, before the neighbour searches, reductions and kernels that followed it. It was made
+// with `git worktree add /tmp/ref f1bf67f`, `cmake -S /tmp/ref -B /tmp/ref/build`,
+// `cmake --build /tmp/ref/build` and `/tmp/ref/build/fluid/fluid 1 in/small.fld
+// out/small_1step_output.fld`. One step is before the run blows up, so the values are finite
+// and a change in any kernel since then shows as an error far above the tolerance.
+TEST_F(OutputComparisonTest, OneStepMatchesRegressionOutput) {
+  for (const NeighborSearch neighbors : {NeighborSearch::cells, NeighborSearch::allPairs}) {
+    SimulationOptions options;
+    options.neighbors = neighbors;
+    runSimulation(1, path("in/small.fld"), getFirstOutput(), options);
+    const CompareReport report =
+        compareFldFiles(path("out/small_1step_output.fld"), getFirstOutput(), REFERENCE_TOLERANCE);
+    ASSERT_TRUE(report.comparable) << report.error;
+    EXPECT_TRUE(report.headerMatches);
+    EXPECT_TRUE(report.withinTolerance());
+  }
+}
+
+TEST_F(OutputComparisonTest, DeterministicRunsMatchAcrossThreadCounts) {
+  SimulationOptions options;
+  options.reduction = ReductionMode::deterministic;
+  runSimulation(2, path("in/small.fld"), getFirstOutput(), options);
+  options.threads = 3;
+  runSimulation(2, path("in/small.fld"), getSecondOutput(), options);
+  const CompareReport report = compareFldFiles(getFirstOutput(), getSecondOutput(), {});
+  ASSERT_TRUE(report.comparable) << report.error;
+  EXPECT_TRUE(report.withinTolerance());
+}
+
+// The fast kernel's inverse distances are within FAST_INVERSE_SQRT_ERROR (3e-7) of the precise
+// ones; cancellation in the acceleration sums of the exploding small case amplifies that to
+// about 4e-4 after two steps
+TEST_F(OutputComparisonTest, FastMathMatchesPreciseKernel) {
+  const CompareTolerance tolerance{0.0, 1.0e-3};
+  for (const NeighborSearch neighbors : {NeighborSearch::cells, NeighborSearch::clusters}) {
+    SimulationOptions options;
+    options.neighbors = neighbors;
+    runSimulation(2, path("in/small.fld"), getFirstOutput(), options);
+    options.math = KernelMath::fast;
+    runSimulation(2, path("in/small.fld"), getSecondOutput(), options);
+    const CompareReport report =
+        compareFldFiles(getFirstOutput(), getSecondOutput(), tolerance);
+    ASSERT_TRUE(report.comparable) << report.error;
+    EXPECT_TRUE(report.withinTolerance());
+  }
+}
+
+// Blocks of 3 steps end at steps 3 and 4; step 2 is reached in the first block and step 4 at
+// the end of the second, so the trajectory and the ring get the frames of steps 0, 3 and 4
+TEST_F(OutputComparisonTest, TemporalRunsWriteFramesBetweenBlocks) {
+  SimulationOptions options;
+  options.temporalSteps      = 3;
+  options.trajectoryInterval = 2;
+  options.trajectoryFile     = getTrajectoryOutput();
+  options.publishInterval    = 2;
+  options.publishName        = "/ftest-frames";
+  testing::internal::CaptureStdout();
+  runSimulation(4, path("in/small.fld"), getFirstOutput(), options);
+  EXPECT_NE(testing::internal::GetCapturedStdout().find("Published: 3 frames to /ftest-frames"),
+            std::string::npos);
+  TrajectoryReader const reader(options.trajectoryFile);
+  ASSERT_TRUE(reader.isOpen());
+  std::vector<std::uint32_t> steps;
+  for (TrajectoryFrameEntry const & frame : reader.frames()) { steps.push_back(frame.step); }
+  EXPECT_EQ(steps, (std::vector<std::uint32_t>{0, 3, 4}));
+}
+
+// The same blocks give analytics samples of steps 3 and 4, each over every particle
+TEST_F(OutputComparisonTest, TemporalRunsSampleAnalyticsBetweenBlocks) {
+  SimulationOptions options;
+  options.temporalSteps     = 3;
+  options.analyticsInterval = 2;
+  options.analyticsFile     = getAnalyticsOutput();
+  testing::internal::CaptureStdout();
+  runSimulation(4, path("in/small.fld"), getFirstOutput(), options);
+  EXPECT_NE(testing::internal::GetCapturedStdout().find("Analytics: 2 samples written to " +
+                                                         getAnalyticsOutput()),
+            std::string::npos);
+  std::ifstream input(path("in/small.fld"), std::ios::binary);
+  Header header{};
+  ASSERT_TRUE(readHeader(input, header));
+  std::ifstream rows(getAnalyticsOutput());
+  std::string row;
+  ASSERT_TRUE(std::getline(rows, row));
+  EXPECT_EQ(row.rfind("step,particles,", 0), 0U);
+  for (const int step : {3, 4}) {
+    ASSERT_TRUE(std::getline(rows, row));
+    EXPECT_EQ(row.rfind(std::to_string(step) + ',' + std::to_string(header.np) + ',', 0), 0U)
+        << row;
+  }
+  EXPECT_FALSE(std::getline(rows, row));
+}
+
+int main(int argc, char ** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
 }
\ No newline at end of file
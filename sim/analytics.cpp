@@ -0,0 +1,62 @@
+// analytics.cpp
+#include "analytics.hpp"
+
+#include <cmath>
+
+void beginAnalyticsSample(AnalyticsState & state, int threads) {
+  state.partials.assign(static_cast<std::size_t>(std::max(threads, 1)), AnalyticsPartial{});
+}
+
+void sampleParticles(AnalyticsState & state, std::vector<Particle> const & particles) {
+  AnalyticsPartial & partial = state.partials.front();
+  for (Particle const & particle : particles) {
+    partial.addMotion(particle);
+    partial.addDensity(particle);
+  }
+}
+
+void writeAnalyticsHeader(AnalyticsSelection const & selection, std::ostream & output) {
+  output << "step,particles";
+  if (selection.kineticEnergy) { output << ",kinetic_energy"; }
+  if (selection.centerOfMass) { output << ",com_x,com_y,com_z"; }
+  if (selection.maxSpeed) { output << ",max_speed"; }
+  if (selection.density) {
+    output << ",rho_min,rho_mean,rho_max";
+    for (std::size_t bin = 0; bin < ANALYTICS_DENSITY_BINS; ++bin) { output << ",rho_bin_" << bin; }
+  }
+  output << '\n';
+}
+
+void writeAnalyticsSample(AnalyticsState & state, int step, std::ostream & output) {
+  AnalyticsPartial total;
+  for (AnalyticsPartial const & partial : state.partials) {
+    total.particles       += partial.particles;
+    total.speedSquared    += partial.speedSquared;
+    total.maxSpeedSquared  = std::max(total.maxSpeedSquared, partial.maxSpeedSquared);
+    total.densitySum      += partial.densitySum;
+    total.densityMin       = std::min(total.densityMin, partial.densityMin);
+    total.densityMax       = std::max(total.densityMax, partial.densityMax);
+    for (std::size_t axis = 0; axis < 3; ++axis) { total.position[axis] += partial.position[axis]; }
+    for (std::size_t bin = 0; bin < ANALYTICS_DENSITY_BINS; ++bin) {
+      total.histogram[bin] += partial.histogram[bin];
+    }
+  }
+  // Every particle has the same mass, so the centre of mass is the mean position
+  const double count = total.particles == 0 ? 1.0 : static_cast<double>(total.particles);
+  AnalyticsSelection const & selection = state.selection;
+  output << step << ',' << total.particles;
+  if (selection.kineticEnergy) { output << ',' << 0.5 * state.mass * total.speedSquared; }
+  if (selection.centerOfMass) {
+    output << ',' << total.position[0] / count << ',' << total.position[1] / count << ','
+           << total.position[2] / count;
+  }
+  if (selection.maxSpeed) { output << ',' << std::sqrt(total.maxSpeedSquared); }
+  if (selection.density) {
+    const bool any = total.particles != 0;
+    output << ',' << (any ? total.densityMin : 0.0) << ',' << total.densitySum / count << ','
+           << (any ? total.densityMax : 0.0);
+    for (const std::uint64_t bin : total.histogram) { output << ',' << bin; }
+  }
+  output << '\n';
+  ++state.samples;
+}
@@ -0,0 +1,84 @@
+// analytics.hpp
+#pragma once
+
+#include "constants.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+// Density histogram of a sample: equal bins over [0, 2 rho); denser particles count in the last
+constexpr std::size_t ANALYTICS_DENSITY_BINS = 16;
+constexpr double ANALYTICS_DENSITY_RANGE     = 2.0 * static_cast<double>(rho);
+
+// Sums of one pool thread over the particles it visited in a sampled step. The motion pass adds
+// the positions and velocities it has just updated, the density transform the densities.
+struct alignas(64) AnalyticsPartial {
+    std::uint64_t particles = 0;
+    double speedSquared     = 0.0;  // Sum of |v|^2
+    std::array<double, 3> position{};
+    double maxSpeedSquared  = 0.0;
+    double densitySum       = 0.0;
+    double densityMin       = std::numeric_limits<double>::infinity();
+    double densityMax       = -std::numeric_limits<double>::infinity();
+    std::array<std::uint64_t, ANALYTICS_DENSITY_BINS> histogram{};
+
+    template <typename T>
+    void addMotion(BasicParticle<T> const & particle) {
+      const double speed = static_cast<double>(particle.vx * particle.vx +
+                                               particle.vy * particle.vy +
+                                               particle.vz * particle.vz);
+      ++particles;
+      speedSquared    += speed;
+      maxSpeedSquared  = std::max(maxSpeedSquared, speed);
+      position[0]     += static_cast<double>(particle.px);
+      position[1]     += static_cast<double>(particle.py);
+      position[2]     += static_cast<double>(particle.pz);
+    }
+
+    template <typename T>
+    void addDensity(BasicParticle<T> const & particle) {
+      const auto density = static_cast<double>(particle.rho);
+      densitySum += density;
+      densityMin  = std::min(densityMin, density);
+      densityMax  = std::max(densityMax, density);
+      const double bin =
+          std::clamp(density / ANALYTICS_DENSITY_RANGE * static_cast<double>(ANALYTICS_DENSITY_BINS),
+                     0.0, static_cast<double>(ANALYTICS_DENSITY_BINS - 1));
+      ++histogram[static_cast<std::size_t>(bin)];
+    }
+};
+
+// In-situ reductions of a run. On the steps a sample is due, the step passes add every
+// particle to the partial of the thread visiting it (StepWorkspace::analytics), so a sample
+// costs no pass of its own; the partials are then combined in thread order into one row.
+struct AnalyticsState {
+    AnalyticsSelection selection;
+    double mass = 0.0;  // Of one particle
+    std::vector<AnalyticsPartial> partials;
+    std::uint64_t samples = 0;
+};
+
+// Whether a sample is due after `step` steps (1 for the first) every `interval` steps
+inline bool analyticsDue(int step, int interval) {
+  return interval > 0 && step % interval == 0;
+}
+
+// Clears the partials of `threads` threads for the next sampled step
+void beginAnalyticsSample(AnalyticsState & state, int threads);
+
+// Adds every particle to the first partial, for a sample taken between steps rather than by
+// the step passes
+void sampleParticles(AnalyticsState & state, std::vector<Particle> const & particles);
+
+// Column names of the selected quantities, as the first line of the CSV
+void writeAnalyticsHeader(AnalyticsSelection const & selection, std::ostream & output);
+
+// Combines the partials and writes the row of the sample taken after `step` steps
+void writeAnalyticsSample(AnalyticsState & state, int step, std::ostream & output);
@@ -1,29 +1,56 @@
-// block.cpp
-#include "block.hpp"
-
-#include "constants.hpp"
-
-#include <cmath>
-
-std::array<int, 3> getBlockIndices(Particle const & particle, GridSize const & blockSize,
-                                   GridSize const & gridDimensions) {
-  return {std::max(0, std::min(static_cast<int>((particle.px - xmin) / blockSize.nx), static_cast<int>(gridDimensions.nx) - 1)),
-          std::max(0, std::min(static_cast<int>((particle.py - ymin) / blockSize.ny), static_cast<int>(gridDimensions.ny) - 1)),
-          std::max(0, std::min(static_cast<int>((particle.pz - zmin) / blockSize.nz), static_cast<int>(gridDimensions.nz) - 1))};
-}
-
-void repositionParticle(Particle & particle, GridSize const & blockSize,
-                        GridSize const & gridDimensions) {
-  auto indices = getBlockIndices(particle, blockSize, gridDimensions);
-
-  const float baseX = xmin + static_cast<float>(indices[0]) * blockSize.nx - SMALL_NUMBER;
-  const float baseY = ymin + static_cast<float>(indices[1]) * blockSize.ny - SMALL_NUMBER;
-  const float baseZ = zmin + static_cast<float>(indices[2]) * blockSize.nz - SMALL_NUMBER;
-  const float maxX  = baseX + blockSize.nx;
-  const float maxY  = baseY + blockSize.ny;
-  const float maxZ  = baseZ + blockSize.nz;
-
-  particle.px = (particle.px < baseX) ? baseX : ((particle.px > maxX) ? maxX : particle.px);
-  particle.py = (particle.py < baseY) ? baseY : ((particle.py > maxY) ? maxY : particle.py);
-  particle.pz = (particle.pz < baseZ) ? baseZ : ((particle.pz > maxZ) ? maxZ : particle.pz);
-}
+// block.cpp
+#include "block.hpp"
+
+#include "constants.hpp"
+
+#include <cmath>
+
+template <typename T>
+std::array<int, 3> getBlockIndices(BasicParticle<T> const & particle, GridSize const & blockSize,
+                                   GridSize const & gridDimensions) {
+  return {std::max(0, std::min(static_cast<int>((particle.px - xmin) / blockSize.nx), static_cast<int>(gridDimensions.nx) - 1)),
+          std::max(0, std::min(static_cast<int>((particle.py - ymin) / blockSize.ny), static_cast<int>(gridDimensions.ny) - 1)),
+          std::max(0, std::min(static_cast<int>((particle.pz - zmin) / blockSize.nz), static_cast<int>(gridDimensions.nz) - 1))};
+}
+
+namespace {
+
+  // Clamps the particle into the block at `indices` of a grid of blocks `width` wide
+  template <typename T>
+  void clampToBlock(BasicParticle<T> & particle, std::array<int, 3> const & indices,
+                    std::array<float, 3> const & width) {
+    const T baseX = static_cast<T>(xmin + static_cast<float>(indices[0]) * width[0] - SMALL_NUMBER);
+    const T baseY = static_cast<T>(ymin + static_cast<float>(indices[1]) * width[1] - SMALL_NUMBER);
+    const T baseZ = static_cast<T>(zmin + static_cast<float>(indices[2]) * width[2] - SMALL_NUMBER);
+    const T maxX  = baseX + static_cast<T>(width[0]);
+    const T maxY  = baseY + static_cast<T>(width[1]);
+    const T maxZ  = baseZ + static_cast<T>(width[2]);
+
+    particle.px = (particle.px < baseX) ? baseX : ((particle.px > maxX) ? maxX : particle.px);
+    particle.py = (particle.py < baseY) ? baseY : ((particle.py > maxY) ? maxY : particle.py);
+    particle.pz = (particle.pz < baseZ) ? baseZ : ((particle.pz > maxZ) ? maxZ : particle.pz);
+  }
+
+}  // namespace
+
+template <typename T>
+void repositionParticle(BasicParticle<T> & particle, GridSize const & blockSize,
+                        GridSize const & gridDimensions) {
+  clampToBlock(particle, getBlockIndices(particle, blockSize, gridDimensions),
+               {blockSize.nx, blockSize.ny, blockSize.nz});
+}
+
+template <typename T>
+void repositionParticle(BasicParticle<T> & particle, CellGrid const & grid) {
+  clampToBlock(particle, grid.locate(particle), grid.width);
+}
+
+template std::array<int, 3> getBlockIndices<float>(Particle const &, GridSize const &,
+                                                   GridSize const &);
+template std::array<int, 3> getBlockIndices<double>(BasicParticle<double> const &,
+                                                    GridSize const &, GridSize const &);
+template void repositionParticle<float>(Particle &, GridSize const &, GridSize const &);
+template void repositionParticle<double>(BasicParticle<double> &, GridSize const &,
+                                         GridSize const &);
+template void repositionParticle<float>(Particle &, CellGrid const &);
+template void repositionParticle<double>(BasicParticle<double> &, CellGrid const &);
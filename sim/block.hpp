@@ -1,12 +1,18 @@
-// block.hpp
-#pragma once
-
-#include "grid.hpp"
-#include "particle.hpp"
-
-#include <array>
-
-std::array<int, 3> getBlockIndices(Particle const & particle, GridSize const & blockSize,
-                                   GridSize const & gridDimensions);
-void repositionParticle(Particle & particle, GridSize const & blockSize,
-                        GridSize const & gridDimensions);
+// block.hpp
+#pragma once
+
+#include "cellgrid.hpp"
+#include "grid.hpp"
+#include "particle.hpp"
+
+#include <array>
+
+template <typename T>
+std::array<int, 3> getBlockIndices(BasicParticle<T> const & particle, GridSize const & blockSize,
+                                   GridSize const & gridDimensions);
+template <typename T>
+void repositionParticle(BasicParticle<T> & particle, GridSize const & blockSize,
+                        GridSize const & gridDimensions);
+// Same clamp with the reciprocal cell sizes of `grid`: no divisions per particle
+template <typename T>
+void repositionParticle(BasicParticle<T> & particle, CellGrid const & grid);
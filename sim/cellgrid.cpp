@@ -0,0 +1,57 @@
+// cellgrid.cpp
+#include "cellgrid.hpp"
+
+std::array<CellOffset, HALF_STENCIL_SIZE> const & halfStencil() {
+  static std::array<CellOffset, HALF_STENCIL_SIZE> const stencil = []() {
+    std::array<CellOffset, HALF_STENCIL_SIZE> offsets{};
+    std::size_t count = 0;
+    for (CellOffset const & offset : fullStencil()) {
+      const bool forward =
+          offset[2] > 0 || (offset[2] == 0 && (offset[1] > 0 || (offset[1] == 0 && offset[0] > 0)));
+      if (forward) { offsets[count++] = offset; }
+    }
+    return offsets;
+  }();
+  return stencil;
+}
+
+std::array<CellOffset, FULL_STENCIL_SIZE> const & fullStencil() {
+  static std::array<CellOffset, FULL_STENCIL_SIZE> const stencil = []() {
+    std::array<CellOffset, FULL_STENCIL_SIZE> offsets{};
+    std::size_t count = 0;
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) { offsets[count++] = {dx, dy, dz}; }
+      }
+    }
+    return offsets;
+  }();
+  return stencil;
+}
+
+CellOffset CellGrid::cellCoordinates(std::size_t cell) const {
+  const auto linear = static_cast<int>(cell);
+  const int px      = nx + 2;
+  const int py      = ny + 2;
+  return {linear % px - 1, (linear / px) % py - 1, linear / (px * py) - 1};
+}
+
+CellGrid makeCellGrid(GridSize const & blockSize, GridSize const & blocks) {
+  CellGrid grid;
+  grid.nx           = std::max(1, static_cast<int>(blocks.nx));
+  grid.ny           = std::max(1, static_cast<int>(blocks.ny));
+  grid.nz           = std::max(1, static_cast<int>(blocks.nz));
+  grid.width        = {blockSize.nx, blockSize.ny, blockSize.nz};
+  grid.inverseWidth = {1.0F / blockSize.nx, 1.0F / blockSize.ny, 1.0F / blockSize.nz};
+  const auto linear = [&grid](CellOffset const & offset) {
+    return static_cast<std::ptrdiff_t>(grid.cellIndex(offset[0], offset[1], offset[2])) -
+           static_cast<std::ptrdiff_t>(grid.cellIndex(0, 0, 0));
+  };
+  for (std::size_t k = 0; k < HALF_STENCIL_SIZE; ++k) {
+    grid.halfOffsets[k] = linear(halfStencil()[k]);
+  }
+  for (std::size_t k = 0; k < FULL_STENCIL_SIZE; ++k) {
+    grid.fullOffsets[k] = linear(fullStencil()[k]);
+  }
+  return grid;
+}
@@ -0,0 +1,67 @@
+// cellgrid.hpp
+#pragma once
+
+#include "constants.hpp"
+#include "grid.hpp"
+#include "particle.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+using CellOffset = std::array<int, 3>;  // dx, dy, dz
+
+constexpr std::size_t HALF_STENCIL_SIZE = 13;
+constexpr std::size_t FULL_STENCIL_SIZE = 27;
+
+// Forward half of the 27-cell neighbourhood: offsets whose (dz, dy, dx) is lexicographically
+// positive. Visiting the cell itself plus these 13 cells meets every neighbouring pair once.
+std::array<CellOffset, HALF_STENCIL_SIZE> const & halfStencil();
+// All 27 offsets, in increasing (dz, dy, dx) order
+std::array<CellOffset, FULL_STENCIL_SIZE> const & fullStencil();
+
+// Integer cell grid surrounded by one layer of ghost cells on every side. Cells are numbered
+// linearly over the padded box, so every stencil neighbour of an interior cell is a valid cell
+// and the stencils reduce to fixed linear offsets. Ghost cells never hold particles.
+struct CellGrid {
+    int nx = 0, ny = 0, nz = 0;                          // Interior cells per axis
+    std::array<float, 3> width{};                        // Cell size per axis
+    std::array<float, 3> inverseWidth{};                 // 1 / width
+    std::array<std::ptrdiff_t, HALF_STENCIL_SIZE> halfOffsets{};  // Linear half stencil
+    std::array<std::ptrdiff_t, FULL_STENCIL_SIZE> fullOffsets{};  // Linear full stencil
+
+    bool operator==(CellGrid const &) const = default;
+
+    // Cells of the padded box, ghosts included
+    [[nodiscard]] std::size_t cellCount() const {
+      return static_cast<std::size_t>(nx + 2) * static_cast<std::size_t>(ny + 2) *
+             static_cast<std::size_t>(nz + 2);
+    }
+
+    // Linear cell of interior coordinates; -1 and n address the ghost layer
+    [[nodiscard]] std::size_t cellIndex(int cx, int cy, int cz) const {
+      return static_cast<std::size_t>(((cz + 1) * (ny + 2) + cy + 1) * (nx + 2) + cx + 1);
+    }
+
+    // Interior coordinates of a linear cell (-1 or n for ghosts)
+    [[nodiscard]] CellOffset cellCoordinates(std::size_t cell) const;
+
+    // Interior cell containing a position: one multiply and truncation per axis. Positions on
+    // or beyond the domain faces are kept in the outermost interior cell.
+    template <typename T>
+    [[nodiscard]] CellOffset locate(BasicParticle<T> const & particle) const {
+      return {axisCell(particle.px - static_cast<T>(xmin), 0, nx),
+              axisCell(particle.py - static_cast<T>(ymin), 1, ny),
+              axisCell(particle.pz - static_cast<T>(zmin), 2, nz)};
+    }
+
+  private:
+    template <typename T>
+    [[nodiscard]] int axisCell(T offset, std::size_t axis, int count) const {
+      return std::clamp(static_cast<int>(offset * static_cast<T>(inverseWidth[axis])), 0,
+                        count - 1);
+    }
+};
+
+// Grid of `blocks` cells of `blockSize`, at least one cell per axis
+CellGrid makeCellGrid(GridSize const & blockSize, GridSize const & blocks);
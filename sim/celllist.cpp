@@ -0,0 +1,284 @@
+// celllist.cpp
+#include "celllist.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  // Smallest hash table
+  constexpr std::size_t MIN_TABLE_SLOTS = 64;
+
+  // Only interior cells get a colour
+  void buildColors(CellList & cells) {
+    CellGrid const & grid = cells.grid;
+    std::array<std::uint32_t, CELL_COLOR_COUNT + 1> counts{};
+    for (int cz = 0; cz < grid.nz; ++cz) {
+      for (int cy = 0; cy < grid.ny; ++cy) {
+        for (int cx = 0; cx < grid.nx; ++cx) { ++counts[cellColor(cx, cy, cz) + 1]; }
+      }
+    }
+    cells.colorStart.assign(counts.begin(), counts.end());
+    for (std::size_t color = 1; color < cells.colorStart.size(); ++color) {
+      cells.colorStart[color] += cells.colorStart[color - 1];
+    }
+    std::vector<std::uint32_t> next(cells.colorStart.begin(), cells.colorStart.end() - 1);
+    cells.colorCells.resize(cells.colorStart.back());
+    for (int cz = 0; cz < grid.nz; ++cz) {
+      for (int cy = 0; cy < grid.ny; ++cy) {
+        for (int cx = 0; cx < grid.nx; ++cx) {
+          const auto color = static_cast<std::size_t>(cellColor(cx, cy, cz));
+          cells.colorCells[next[color]++] = static_cast<std::uint32_t>(grid.cellIndex(cx, cy, cz));
+        }
+      }
+    }
+  }
+
+  // Occupied cells of the hashed layout by colour, in increasing cell order within each colour
+  void buildOccupiedColors(CellList & cells) {
+    const std::size_t occupied = cells.cellKeys.size();
+    std::vector<std::uint8_t> colors(occupied);
+    std::array<std::uint32_t, CELL_COLOR_COUNT + 1> counts{};
+    for (std::size_t cell = 0; cell < occupied; ++cell) {
+      const CellOffset c = cells.grid.cellCoordinates(cells.cellKeys[cell]);
+      colors[cell]       = static_cast<std::uint8_t>(cellColor(c[0], c[1], c[2]));
+      ++counts[colors[cell] + 1U];
+    }
+    cells.colorStart.assign(counts.begin(), counts.end());
+    std::partial_sum(cells.colorStart.begin(), cells.colorStart.end(), cells.colorStart.begin());
+    std::vector<std::uint32_t> next(cells.colorStart.begin(), cells.colorStart.end() - 1);
+    cells.colorCells.resize(cells.colorStart.back());
+    for (std::size_t cell = 0; cell < occupied; ++cell) {
+      cells.colorCells[next[colors[cell]]++] = static_cast<std::uint32_t>(cell);
+    }
+  }
+
+  // Counting sort of the particles by cell, particleCell filled and cellStart holding the
+  // population of each cell at cellStart[cell + 1]
+  void sortByCell(CellList & cells, std::size_t particleCount) {
+    std::partial_sum(cells.cellStart.begin(), cells.cellStart.end(), cells.cellStart.begin());
+    cells.cursor.assign(cells.cellStart.begin(), cells.cellStart.end() - 1);
+    cells.particleOrder.resize(particleCount);
+    for (std::size_t i = 0; i < particleCount; ++i) {
+      cells.particleOrder[cells.cursor[cells.particleCell[i]]++] = static_cast<std::uint32_t>(i);
+    }
+  }
+
+  template <typename T>
+  void buildDenseCellList(std::vector<BasicParticle<T>> const & particles, CellList & cells) {
+    CellGrid const & grid = cells.grid;
+    cells.cellStart.assign(cells.cellCount() + 1, 0);
+    cells.particleCell.resize(particles.size());
+    cells.occupiedCells = 0;
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      const CellOffset indices = grid.locate(particles[i]);
+      const auto cell =
+          static_cast<std::uint32_t>(grid.cellIndex(indices[0], indices[1], indices[2]));
+      cells.particleCell[i] = cell;
+      if (cells.cellStart[cell + 1]++ == 0) { ++cells.occupiedCells; }
+    }
+    sortByCell(cells, particles.size());
+  }
+
+  // Neighbours of the hashed cells without probing the table. A stencil row (fixed dy, dz) holds
+  // keys key + rowOffset - 1 .. key + rowOffset + 1, which grow with key; since the cells are
+  // in increasing key order, one cursor per row moving forward finds every neighbour.
+  // Unoccupied ones are the empty cell.
+  void buildNeighborCells(CellList & cells) {
+    constexpr std::size_t rowLength = 3;
+    constexpr std::size_t rowCount  = FULL_STENCIL_SIZE / rowLength;
+    const auto occupied             = static_cast<std::uint32_t>(cells.cellKeys.size());
+    auto const & keys               = cells.cellKeys;
+    cells.neighborCells.resize((occupied + 1) * FULL_STENCIL_SIZE);
+    std::array<std::uint64_t, rowCount> rowOffsets{};
+    for (std::size_t row = 0; row < rowCount; ++row) {
+      // fullStencil() runs dx = -1, 0, 1 within a row; start from dx = -1
+      rowOffsets[row] = static_cast<std::uint64_t>(cells.grid.fullOffsets[row * rowLength]);
+    }
+    std::array<std::uint32_t, rowCount> first{};
+    for (std::size_t cell = 0; cell <= occupied; ++cell) {
+      std::uint32_t * neighbors = &cells.neighborCells[cell * FULL_STENCIL_SIZE];
+      if (cell == occupied) {
+        std::fill_n(neighbors, FULL_STENCIL_SIZE, occupied);
+        break;
+      }
+      for (std::size_t row = 0; row < rowCount; ++row) {
+        const std::uint64_t low = keys[cell] + rowOffsets[row];
+        std::uint32_t next      = first[row];
+        while (next < occupied && keys[next] < low) { ++next; }
+        first[row] = next;
+        for (std::size_t dx = 0; dx < rowLength; ++dx) {
+          const bool found = next < occupied && keys[next] == low + dx;
+          neighbors[row * rowLength + dx] = found ? next++ : occupied;
+        }
+      }
+    }
+  }
+
+  // Occupied cells are numbered in order of first appearance while hashing, then renumbered in
+  // increasing linear index so that the passes visit them in the order of the dense layout
+  template <typename T>
+  void buildHashedCellList(std::vector<BasicParticle<T>> const & particles, CellList & cells) {
+    CellGrid const & grid = cells.grid;
+    auto & table          = cells.table;
+    table.reset(std::max(cells.occupiedCells, MIN_TABLE_SLOTS / 2));
+    cells.particleCell.resize(particles.size());
+    cells.cellKeys.clear();
+    // Consecutive particles often share a cell, which then needs no probe
+    std::uint64_t lastKey  = CellHashTable::EMPTY_KEY;
+    std::uint32_t lastCell = 0;
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      const CellOffset indices = grid.locate(particles[i]);
+      const std::uint64_t key  = grid.cellIndex(indices[0], indices[1], indices[2]);
+      if (key != lastKey) {
+        const auto next = static_cast<std::uint32_t>(cells.cellKeys.size());
+        lastCell        = table.insert(key, next);
+        lastKey         = key;
+        if (lastCell == next) { cells.cellKeys.push_back(key); }
+      }
+      cells.particleCell[i] = lastCell;
+    }
+    const auto occupied = static_cast<std::uint32_t>(cells.cellKeys.size());
+    cells.occupiedCells = occupied;
+    // (key, first-seen number) in key order gives rank[first-seen number] = new cell
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> order(occupied);
+    for (std::uint32_t cell = 0; cell < occupied; ++cell) {
+      order[cell] = {cells.cellKeys[cell], cell};
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<std::uint32_t> rank(occupied);
+    for (std::uint32_t cell = 0; cell < occupied; ++cell) {
+      cells.cellKeys[cell]      = order[cell].first;
+      rank[order[cell].second] = cell;
+    }
+    for (std::size_t slot = 0; slot < table.keys.size(); ++slot) {
+      if (table.keys[slot] != CellHashTable::EMPTY_KEY) {
+        table.cells[slot] = rank[table.cells[slot]];
+      }
+    }
+    // Cell `occupied` is the empty one
+    cells.cellStart.assign(occupied + 2, 0);
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      cells.particleCell[i] = rank[cells.particleCell[i]];
+      ++cells.cellStart[cells.particleCell[i] + 1];
+    }
+    sortByCell(cells, particles.size());
+    buildNeighborCells(cells);
+    buildOccupiedColors(cells);
+  }
+
+}  // namespace
+
+void CellHashTable::reset(std::size_t expected) {
+  const std::size_t slots = std::bit_ceil(std::max(2 * expected, MIN_TABLE_SLOTS));
+  keys.assign(slots, EMPTY_KEY);
+  cells.resize(slots);
+  size = 0;
+}
+
+std::uint32_t CellHashTable::insert(std::uint64_t key, std::uint32_t next) {
+  if (2 * (size + 1) > keys.size()) {
+    // Rehash into twice the slots
+    LargeArray<std::uint64_t> oldKeys  = std::move(keys);
+    LargeArray<std::uint32_t> oldCells = std::move(cells);
+    keys  = LargeArray<std::uint64_t>(2 * oldKeys.size(), EMPTY_KEY, oldKeys.get_allocator());
+    cells = LargeArray<std::uint32_t>(keys.size(), 0, oldCells.get_allocator());
+    for (std::size_t slot = 0; slot < oldKeys.size(); ++slot) {
+      if (oldKeys[slot] == EMPTY_KEY) { continue; }
+      std::size_t target = home(oldKeys[slot]);
+      while (keys[target] != EMPTY_KEY) { target = (target + 1) & (keys.size() - 1); }
+      keys[target]  = oldKeys[slot];
+      cells[target] = oldCells[slot];
+    }
+  }
+  std::size_t slot = home(key);
+  for (; keys[slot] != EMPTY_KEY; slot = (slot + 1) & (keys.size() - 1)) {
+    if (keys[slot] == key) { return cells[slot]; }
+  }
+  keys[slot]  = key;
+  cells[slot] = next;
+  ++size;
+  return next;
+}
+
+int cellColor(int cx, int cy, int cz) {
+  return (cz % 2) * 9 + (cy % 3) * 3 + cx % 3;
+}
+
+void setCellGrid(CellList & cells, GridSize const & blockSize, GridSize const & blocks,
+                 CellLayout layout) {
+  const CellGrid grid = makeCellGrid(blockSize, blocks);
+  if (grid == cells.grid && layout == cells.layout) { return; }
+  if (!(grid == cells.grid)) { cells.occupiedCells = 0; }
+  cells.grid   = grid;
+  cells.layout = layout;
+  if (layout == CellLayout::dense) { buildColors(cells); }
+}
+
+template <typename T>
+void buildCellList(std::vector<BasicParticle<T>> const & particles, GridSize const & blockSize,
+                   GridSize const & blocks, CellList & cells, CellLayout layout) {
+  setCellGrid(cells, blockSize, blocks, layout);
+  if (layout == CellLayout::hashed) {
+    buildHashedCellList(particles, cells);
+  } else {
+    buildDenseCellList(particles, cells);
+  }
+}
+
+CellLayout chooseCellLayout(CellList const & cells, GridSize const & blockSize,
+                            GridSize const & blocks, std::size_t particleCount,
+                            SimulationOptions const & options) {
+  if (options.cellLayout != CellLayout::automatic) { return options.cellLayout; }
+  const CellGrid grid = makeCellGrid(blockSize, blocks);
+  const std::size_t occupied =
+      grid == cells.grid && cells.occupiedCells != 0 ? cells.occupiedCells : particleCount;
+  const double interior = static_cast<double>(grid.nx) * grid.ny * grid.nz;
+  return static_cast<double>(occupied) < options.hashedOccupancy * interior ? CellLayout::hashed
+                                                                            : CellLayout::dense;
+}
+
+void buildCellBlocks(CellList const & cells, int size, CellBlocks & blocks) {
+  CellGrid const & grid = cells.grid;
+  blocks.size           = size;
+  blocks.counts         = {(grid.nx + size - 1) / size, (grid.ny + size - 1) / size,
+                           (grid.nz + size - 1) / size};
+  const auto linearBlocks = static_cast<std::size_t>(blocks.counts[0]) *
+                            static_cast<std::size_t>(blocks.counts[1]) *
+                            static_cast<std::size_t>(blocks.counts[2]);
+  // Occupied cells in increasing order (particleOrder is sorted by cell) with their block
+  std::vector<std::uint32_t> occupied;
+  std::vector<std::uint32_t> cellBlock;
+  for (std::size_t k = 0; k < cells.particleOrder.size();) {
+    const std::uint32_t cell = cells.particleCell[cells.particleOrder[k]];
+    const CellOffset c       = grid.cellCoordinates(cells.cellKey(cell));
+    occupied.push_back(cell);
+    cellBlock.push_back(static_cast<std::uint32_t>(
+        ((c[2] / size) * blocks.counts[1] + c[1] / size) * blocks.counts[0] + c[0] / size));
+    k += cells.cellStart[cell + 1] - cells.cellStart[cell];
+  }
+  blocks.rank.assign(linearBlocks, CellBlocks::NO_BLOCK);
+  std::vector<std::uint32_t> counts(linearBlocks, 0);
+  for (const std::uint32_t index : cellBlock) { ++counts[index]; }
+  blocks.blockIndex.clear();
+  blocks.blockStart.assign(1, 0);
+  for (std::size_t index = 0; index < linearBlocks; ++index) {
+    if (counts[index] == 0) { continue; }
+    blocks.rank[index] = static_cast<std::uint32_t>(blocks.blockIndex.size());
+    blocks.blockIndex.push_back(static_cast<std::uint32_t>(index));
+    blocks.blockStart.push_back(blocks.blockStart.back() + counts[index]);
+  }
+  std::vector<std::uint32_t> next(blocks.blockStart.begin(), blocks.blockStart.end() - 1);
+  blocks.cells.resize(occupied.size());
+  for (std::size_t k = 0; k < occupied.size(); ++k) {
+    blocks.cells[next[blocks.rank[cellBlock[k]]]++] = occupied[k];
+  }
+}
+
+template void buildCellList<float>(std::vector<Particle> const &, GridSize const &,
+                                   GridSize const &, CellList &, CellLayout);
+template void buildCellList<double>(std::vector<BasicParticle<double>> const &, GridSize const &,
+                                    GridSize const &, CellList &, CellLayout);
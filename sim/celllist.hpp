@@ -0,0 +1,196 @@
+// celllist.hpp
+#pragma once
+
+#include "cellgrid.hpp"
+#include "grid.hpp"
+#include "hugepages.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr int CELL_COLOR_COUNT = 18;
+
+// The half stencil is the tail of the full one: the offsets after the cell itself
+constexpr std::size_t HALF_STENCIL_BEGIN = FULL_STENCIL_SIZE - HALF_STENCIL_SIZE;
+
+// Open-addressing table (linear probing) from the linear padded-grid index of an occupied cell
+// to its cell in the hashed layout. It grows to keep at most half of its slots used.
+struct CellHashTable {
+    static constexpr std::uint64_t EMPTY_KEY = ~std::uint64_t{0};
+    static constexpr std::uint32_t NO_CELL   = ~std::uint32_t{0};
+    LargeArray<std::uint64_t> keys;   // EMPTY_KEY marks a free slot
+    LargeArray<std::uint32_t> cells;  // Cell of each used slot
+    std::size_t size = 0;             // Used slots
+
+    // Empties the table, sized for about `expected` keys
+    void reset(std::size_t expected);
+    // Cell of `key`, inserting it as cell `next` (and returning it) when absent
+    std::uint32_t insert(std::uint64_t key, std::uint32_t next);
+    // Cell of `key`, or NO_CELL
+    [[nodiscard]] std::uint32_t find(std::uint64_t key) const {
+      for (std::size_t slot = home(key);; slot = (slot + 1) & (keys.size() - 1)) {
+        if (keys[slot] == key) { return cells[slot]; }
+        if (keys[slot] == EMPTY_KEY) { return NO_CELL; }
+      }
+    }
+
+  private:
+    [[nodiscard]] std::size_t home(std::uint64_t key) const {
+      // Fibonacci hashing: the top bits of the product spread neighbouring keys apart
+      constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+      return static_cast<std::size_t>((key * multiplier) >> 32U) & (keys.size() - 1);
+    }
+};
+
+// Particles binned by block of the simulation grid with a counting sort on the cell index. The
+// dense layout indexes every cell of the padded grid; the hashed layout only the occupied cells,
+// in increasing linear index, plus one empty cell that stands for every unoccupied neighbour.
+// Both visit cells, stencils and particles in the same order, so they give the same sums.
+struct CellList {
+    CellGrid grid;
+    CellLayout layout = CellLayout::dense;    // dense or hashed
+    LargeArray<std::uint32_t> cellStart;      // Offsets into particleOrder, cellCount() + 1
+    LargeArray<std::uint32_t> particleOrder;  // Particle indices sorted by cell
+    LargeArray<std::uint32_t> particleCell;   // Cell of each particle
+    LargeArray<std::uint32_t> cursor;         // Scratch insertion points of the sort
+    // Cells grouped by colour (see cellColor): every interior cell, rebuilt only when the grid
+    // changes, in the dense layout; the occupied cells, rebuilt every step, in the hashed one
+    std::vector<std::uint32_t> colorStart;
+    std::vector<std::uint32_t> colorCells;
+    std::size_t occupiedCells = 0;  // Cells holding particles after the last binning
+    // Hashed layout only
+    LargeArray<std::uint64_t> cellKeys;       // Linear padded-grid index of each occupied cell
+    LargeArray<std::uint32_t> neighborCells;  // FULL_STENCIL_SIZE neighbours of every cell
+    CellHashTable table;
+
+    // Dense: cells of the padded grid, the ghost cells always empty. Hashed: the occupied cells
+    // and the empty one after them.
+    [[nodiscard]] std::size_t cellCount() const {
+      return layout == CellLayout::dense ? grid.cellCount() : cellKeys.size() + 1;
+    }
+
+    // Linear padded-grid index of a cell
+    [[nodiscard]] std::uint64_t cellKey(std::size_t cell) const {
+      return layout == CellLayout::dense ? cell : cellKeys[cell];
+    }
+
+    // Neighbour at position k of the full stencil (fullStencil()) of an occupied cell; positions
+    // HALF_STENCIL_BEGIN.. form the half stencil
+    [[nodiscard]] std::size_t neighbor(std::size_t cell, std::size_t k) const {
+      if (layout == CellLayout::dense) {
+        return cell + static_cast<std::size_t>(grid.fullOffsets[k]);
+      }
+      return neighborCells[cell * FULL_STENCIL_SIZE + k];
+    }
+};
+
+// The half stencil of a cell writes to x - 1..x + 1, y - 1..y + 1 and z..z + 1, so cells whose
+// coordinates agree modulo (3, 3, 2) never write to the same cell: 18 colours
+int cellColor(int cx, int cy, int cz);
+
+// Switches the list to the grid of `blocks` cells of `blockSize`. The dense colours are rebuilt
+// only when the grid or the layout changes.
+void setCellGrid(CellList & cells, GridSize const & blockSize, GridSize const & blocks,
+                 CellLayout layout = CellLayout::dense);
+
+// Bins particles (already repositioned inside their block) into the grid of `blocks` cells,
+// stored in `layout` (dense or hashed). The hashed layout takes memory per occupied cell and
+// per particle only; the dense one per cell of the grid.
+template <typename T>
+void buildCellList(std::vector<BasicParticle<T>> const & particles, GridSize const & blockSize,
+                   GridSize const & blocks, CellList & cells,
+                   CellLayout layout = CellLayout::dense);
+
+// Layout for options.cellLayout: automatic hashes while the occupied share of the grid (the
+// last binning's, or the particle count on a new grid) is below options.hashedOccupancy
+CellLayout chooseCellLayout(CellList const & cells, GridSize const & blockSize,
+                            GridSize const & blocks, std::size_t particleCount,
+                            SimulationOptions const & options);
+
+// Occupied cells grouped into cubes of `size` cells per axis, the units of the task graph
+// schedule (CellSchedule::graph). Blocks are numbered in increasing linear block index and list
+// their cells in increasing cell order. Blocks whose coordinates agree modulo 2 on every axis
+// are at least one block apart, so with size >= 2 their half stencils never reach a common
+// cell: 8 colours.
+struct CellBlocks {
+    static constexpr std::uint32_t NO_BLOCK = ~std::uint32_t{0};
+
+    int size = 0;
+    std::array<int, 3> counts{};               // Blocks per axis over the interior cells
+    std::vector<std::uint32_t> blockStart{0};  // Cells of block b: blockStart[b] .. b + 1
+    std::vector<std::uint32_t> cells;
+    std::vector<std::uint32_t> blockIndex;     // Linear block index of each block
+    std::vector<std::uint32_t> rank;           // Block of each linear block index, or NO_BLOCK
+
+    [[nodiscard]] std::size_t count() const { return blockIndex.size(); }
+
+    [[nodiscard]] std::array<int, 3> coordinates(std::size_t block) const {
+      const auto index = static_cast<int>(blockIndex[block]);
+      return {index % counts[0], index / counts[0] % counts[1], index / counts[0] / counts[1]};
+    }
+
+    // Block at block coordinates, NO_BLOCK when outside the grid or empty
+    [[nodiscard]] std::uint32_t find(int bx, int by, int bz) const {
+      if (bx < 0 || by < 0 || bz < 0 || bx >= counts[0] || by >= counts[1] || bz >= counts[2]) {
+        return NO_BLOCK;
+      }
+      return rank[static_cast<std::size_t>((bz * counts[1] + by) * counts[0] + bx)];
+    }
+
+    [[nodiscard]] int color(std::size_t block) const {
+      const std::array<int, 3> c = coordinates(block);
+      return (c[0] & 1) | ((c[1] & 1) << 1) | ((c[2] & 1) << 2);
+    }
+};
+
+constexpr int CELL_BLOCK_COLOR_COUNT = 8;
+
+// Groups the occupied cells of the last binning into blocks of `size` (>= 2) cells per axis
+void buildCellBlocks(CellList const & cells, int size, CellBlocks & blocks);
+
+// Calls visit(i, j) once for every pair with i in `cell`: pairs inside the cell and pairs with
+// the particles of its forward neighbours (half stencil). Empty cells, ghosts included, return
+// at once; the neighbours of an occupied cell are always cells of the list.
+template <typename Visitor>
+void visitHalfStencilPairs(CellList const & cells, std::size_t cell, Visitor && visit) {
+  const std::uint32_t begin = cells.cellStart[cell];
+  const std::uint32_t end   = cells.cellStart[cell + 1];
+  if (begin == end) { return; }
+  for (std::uint32_t a = begin; a < end; ++a) {
+    for (std::uint32_t b = a + 1; b < end; ++b) {
+      visit(cells.particleOrder[a], cells.particleOrder[b]);
+    }
+  }
+  for (std::size_t k = HALF_STENCIL_BEGIN; k < FULL_STENCIL_SIZE; ++k) {
+    const std::size_t neighbor      = cells.neighbor(cell, k);
+    const std::uint32_t neighborEnd = cells.cellStart[neighbor + 1];
+    for (std::uint32_t a = begin; a < end; ++a) {
+      for (std::uint32_t b = cells.cellStart[neighbor]; b < neighborEnd; ++b) {
+        visit(cells.particleOrder[a], cells.particleOrder[b]);
+      }
+    }
+  }
+}
+
+// Calls visit(i, j) for every particle i in `cell` and every j != i in the 27 surrounding
+// cells, always in the same order
+template <typename Visitor>
+void visitFullStencilPairs(CellList const & cells, std::size_t cell, Visitor && visit) {
+  const std::uint32_t begin = cells.cellStart[cell];
+  const std::uint32_t end   = cells.cellStart[cell + 1];
+  if (begin == end) { return; }
+  for (std::uint32_t a = begin; a < end; ++a) {
+    const std::uint32_t i = cells.particleOrder[a];
+    for (std::size_t k = 0; k < FULL_STENCIL_SIZE; ++k) {
+      const std::size_t neighbor = cells.neighbor(cell, k);
+      for (std::uint32_t b = cells.cellStart[neighbor]; b < cells.cellStart[neighbor + 1]; ++b) {
+        const std::uint32_t j = cells.particleOrder[b];
+        if (j != i) { visit(i, j); }
+      }
+    }
+  }
+}
@@ -0,0 +1,348 @@
+// cluster.cpp
+#include "cluster.hpp"
+
+#include "constants.hpp"
+#include "fastmath.hpp"
+#include "precision.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+  // Coordinate of the empty lanes: far enough from the domain that no particle is within a
+  // smoothing length of it, small enough that its square stays finite in float. Empty lanes
+  // may pair with each other, but their sums are never scattered.
+  constexpr float EMPTY_LANE_POSITION = 1.0e6F;
+
+  template <typename Box>
+  auto boxDistanceSquared(Box const & first, Box const & second) {
+    using Storage    = std::remove_cvref_t<decltype(first.low[0])>;
+    Storage distance = 0;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const Storage gap =
+          std::max({Storage{0}, second.low[axis] - first.high[axis],
+                    first.low[axis] - second.high[axis]});
+      distance += gap * gap;
+    }
+    return distance;
+  }
+
+  // Calls visit(cj) for every cluster the list of `ci` (in `cell`) holds, in list order
+  template <typename Policy, typename Visit>
+  void forEachClusterPair(ClusterList<Policy> const & clusters, CellList const & cells,
+                          std::size_t cell, std::uint32_t ci,
+                          typename Policy::storage_type hSquared, Visit && visit) {
+    auto const & box        = clusters.boxes[ci];
+    auto visitCell          = [&](std::size_t neighbor, std::uint32_t first) {
+      for (std::uint32_t cj = first; cj < clusters.cellClusters[neighbor + 1]; ++cj) {
+        if (boxDistanceSquared(box, clusters.boxes[cj]) < hSquared) { visit(cj); }
+      }
+    };
+    if (clusters.halfList) {
+      visitCell(cell, ci);
+      for (std::size_t k = HALF_STENCIL_BEGIN; k < FULL_STENCIL_SIZE; ++k) {
+        const std::size_t neighbor = cells.neighbor(cell, k);
+        visitCell(neighbor, clusters.cellClusters[neighbor]);
+      }
+      return;
+    }
+    for (std::size_t k = 0; k < FULL_STENCIL_SIZE; ++k) {
+      const std::size_t neighbor = cells.neighbor(cell, k);
+      visitCell(neighbor, clusters.cellClusters[neighbor]);
+    }
+  }
+
+  // Lane a of ci and lane b of cj form a pair unless they are the same particle or, with a
+  // half list, the pair was already taken from the other lane
+  constexpr bool tilePair(bool self, bool halfList, std::size_t a, std::size_t b) {
+    return !self || (halfList ? b > a : b != a);
+  }
+
+}  // namespace
+
+template <typename Policy>
+void buildClusters(std::vector<BasicParticle<typename Policy::storage_type>> const & particles,
+                   CellList const & cells, typename Policy::storage_type height, bool halfList,
+                   ThreadPool & pool, ClusterList<Policy> & clusters) {
+  using Storage                = typename Policy::storage_type;
+  using Box                    = typename ClusterList<Policy>::Box;
+  const std::size_t cellCount  = cells.cellCount();
+  auto & cellClusters          = clusters.cellClusters;
+  cellClusters.resize(cellCount + 1);
+  cellClusters[0] = 0;
+  for (std::size_t cell = 0; cell < cellCount; ++cell) {
+    const std::uint32_t count = cells.cellStart[cell + 1] - cells.cellStart[cell];
+    cellClusters[cell + 1] =
+        cellClusters[cell] + static_cast<std::uint32_t>((count + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+  }
+  const std::size_t clusterCount = cellClusters[cellCount];
+  const std::size_t lanes        = clusterCount * CLUSTER_SIZE;
+  for (auto * lane : {&clusters.px, &clusters.py, &clusters.pz, &clusters.vx, &clusters.vy,
+                      &clusters.vz}) {
+    lane->resize(lanes);
+  }
+  clusters.particle.resize(lanes);
+  clusters.boxes.resize(clusterCount);
+  clusters.halfList = halfList;
+
+  pool.parallelFor(cellCount, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t cell = begin; cell < end; ++cell) {
+      const std::uint32_t first = cells.cellStart[cell];
+      const std::uint32_t count = cells.cellStart[cell + 1] - first;
+      for (std::uint32_t c = cellClusters[cell]; c < cellClusters[cell + 1]; ++c) {
+        Box box{};
+        box.low.fill(std::numeric_limits<Storage>::max());
+        box.high.fill(std::numeric_limits<Storage>::lowest());
+        for (std::size_t lane = 0; lane < CLUSTER_SIZE; ++lane) {
+          const std::size_t k     = (c - cellClusters[cell]) * CLUSTER_SIZE + lane;
+          const std::size_t index = c * CLUSTER_SIZE + lane;
+          if (k >= count) {
+            clusters.particle[index] = NO_PARTICLE;
+            clusters.px[index]       = static_cast<Storage>(EMPTY_LANE_POSITION);
+            clusters.py[index]       = static_cast<Storage>(EMPTY_LANE_POSITION);
+            clusters.pz[index]       = static_cast<Storage>(EMPTY_LANE_POSITION);
+            clusters.vx[index]       = Storage{0};
+            clusters.vy[index]       = Storage{0};
+            clusters.vz[index]       = Storage{0};
+            continue;
+          }
+          const std::uint32_t p = cells.particleOrder[first + k];
+          auto const & particle = particles[p];
+          clusters.particle[index] = p;
+          clusters.px[index]       = particle.px;
+          clusters.py[index]       = particle.py;
+          clusters.pz[index]       = particle.pz;
+          clusters.vx[index]       = particle.vx;
+          clusters.vy[index]       = particle.vy;
+          clusters.vz[index]       = particle.vz;
+          const std::array<Storage, 3> position{particle.px, particle.py, particle.pz};
+          for (std::size_t axis = 0; axis < 3; ++axis) {
+            box.low[axis]  = std::min(box.low[axis], position[axis]);
+            box.high[axis] = std::max(box.high[axis], position[axis]);
+          }
+        }
+        clusters.boxes[c] = box;
+      }
+    }
+  });
+
+  // Pair lists: counted, prefix-summed and filled, every pass in parallel over cells
+  const Storage hSquared = height * height;
+  auto & pairStart       = clusters.pairStart;
+  pairStart.assign(clusterCount + 1, 0);
+  pool.parallelFor(cellCount, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t cell = begin; cell < end; ++cell) {
+      for (std::uint32_t ci = cellClusters[cell]; ci < cellClusters[cell + 1]; ++ci) {
+        std::uint32_t count = 0;
+        forEachClusterPair(clusters, cells, cell, ci, hSquared, [&](std::uint32_t) { ++count; });
+        pairStart[ci + 1] = count;
+      }
+    }
+  });
+  for (std::size_t c = 0; c < clusterCount; ++c) { pairStart[c + 1] += pairStart[c]; }
+  clusters.pairCluster.resize(pairStart[clusterCount]);
+  pool.parallelFor(cellCount, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t cell = begin; cell < end; ++cell) {
+      for (std::uint32_t ci = cellClusters[cell]; ci < cellClusters[cell + 1]; ++ci) {
+        std::uint32_t next = pairStart[ci];
+        forEachClusterPair(clusters, cells, cell, ci, hSquared,
+                           [&](std::uint32_t cj) { clusters.pairCluster[next++] = cj; });
+      }
+    }
+  });
+}
+
+template <typename Policy>
+void clusterDensities(ClusterList<Policy> & clusters, std::uint32_t ci,
+                      typename Policy::storage_type height) {
+  using Storage           = typename Policy::storage_type;
+  using Accumulator       = typename Policy::accumulator_type;
+  using Lanes             = std::array<Storage, CLUSTER_SIZE>;
+  const Storage hSquared  = height * height;
+  const bool halfList     = clusters.halfList;
+  const std::size_t iBase = static_cast<std::size_t>(ci) * CLUSTER_SIZE;
+  Lanes xi{};
+  Lanes yi{};
+  Lanes zi{};
+  std::array<Accumulator, CLUSTER_SIZE> sumI{};
+  for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) {
+    xi[a] = clusters.px[iBase + a];
+    yi[a] = clusters.py[iBase + a];
+    zi[a] = clusters.pz[iBase + a];
+  }
+  for (std::uint32_t k = clusters.pairStart[ci]; k < clusters.pairStart[ci + 1]; ++k) {
+    const std::uint32_t cj  = clusters.pairCluster[k];
+    const std::size_t jBase = static_cast<std::size_t>(cj) * CLUSTER_SIZE;
+    const bool self         = cj == ci;
+    std::array<Accumulator, CLUSTER_SIZE> sumJ{};
+    for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) {
+      for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) {
+        const Storage deltaX          = xi[a] - clusters.px[jBase + b];
+        const Storage deltaY          = yi[a] - clusters.py[jBase + b];
+        const Storage deltaZ          = zi[a] - clusters.pz[jBase + b];
+        const Storage distanceSquared = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+        const Storage difference      = hSquared - distanceSquared;
+        const bool inside = distanceSquared < hSquared && tilePair(self, halfList, a, b);
+        const auto term   = static_cast<Accumulator>(
+            inside ? difference * difference * difference : Storage{0});
+        sumI[a] += term;
+        sumJ[b] += term;
+      }
+    }
+    if (!halfList) { continue; }
+    for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) { clusters.rho[jBase + b] += sumJ[b]; }
+  }
+  for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) { clusters.rho[iBase + a] += sumI[a]; }
+}
+
+namespace {
+
+  // Inverse distances of one lane of ci against the lanes of cj
+  template <KernelMath Math, typename Storage>
+  std::array<Storage, CLUSTER_SIZE>
+      inverseDistances(std::array<Storage, CLUSTER_SIZE> const & distanceSquared) {
+    if constexpr (Math == KernelMath::fast) {
+      return fastInverseSqrt(distanceSquared);
+    } else {
+      std::array<Storage, CLUSTER_SIZE> inverse{};
+      for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) {
+        inverse[b] = Storage{1} / std::sqrt(distanceSquared[b]);
+      }
+      return inverse;
+    }
+  }
+
+  template <KernelMath Math, typename Policy>
+  void accelerationTiles(ClusterList<Policy> & clusters, std::uint32_t ci,
+                         typename Policy::storage_type height,
+                         typename Policy::storage_type mass) {
+    using Storage             = typename Policy::storage_type;
+    using Accumulator         = typename Policy::accumulator_type;
+    using Lanes               = std::array<Storage, CLUSTER_SIZE>;
+    using Sums                = std::array<Accumulator, CLUSTER_SIZE>;
+    const Storage hSquared    = height * height;
+    const auto minimum        = static_cast<Storage>(SMALL_NUMBER);
+    const Storage commonTerm  = static_cast<Storage>(PRESSURE_TERM_CONSTANT) /
+                               (static_cast<Storage>(PI) * mass * static_cast<Storage>(ps));
+    const Storage viscosity   = static_cast<Storage>(VISCOSITY_CONSTANT) /
+                              (static_cast<Storage>(PI) * static_cast<Storage>(mu) * mass);
+    const bool halfList       = clusters.halfList;
+    const std::size_t iBase   = static_cast<std::size_t>(ci) * CLUSTER_SIZE;
+    Lanes xi{};
+    Lanes yi{};
+    Lanes zi{};
+    Lanes vxi{};
+    Lanes vyi{};
+    Lanes vzi{};
+    for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) {
+      xi[a]  = clusters.px[iBase + a];
+      yi[a]  = clusters.py[iBase + a];
+      zi[a]  = clusters.pz[iBase + a];
+      vxi[a] = clusters.vx[iBase + a];
+      vyi[a] = clusters.vy[iBase + a];
+      vzi[a] = clusters.vz[iBase + a];
+    }
+    Sums sumIx{};
+    Sums sumIy{};
+    Sums sumIz{};
+    for (std::uint32_t k = clusters.pairStart[ci]; k < clusters.pairStart[ci + 1]; ++k) {
+      const std::uint32_t cj  = clusters.pairCluster[k];
+      const std::size_t jBase = static_cast<std::size_t>(cj) * CLUSTER_SIZE;
+      const bool self         = cj == ci;
+      Sums sumJx{};
+      Sums sumJy{};
+      Sums sumJz{};
+      for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) {
+        Lanes deltaX{};
+        Lanes deltaY{};
+        Lanes deltaZ{};
+        Lanes distanceSquared{};
+        std::array<bool, CLUSTER_SIZE> inside{};
+        for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) {
+          deltaX[b] = xi[a] - clusters.px[jBase + b];
+          deltaY[b] = yi[a] - clusters.py[jBase + b];
+          deltaZ[b] = zi[a] - clusters.pz[jBase + b];
+          const Storage squared =
+              deltaX[b] * deltaX[b] + deltaY[b] * deltaY[b] + deltaZ[b] * deltaZ[b];
+          inside[b] = squared < hSquared && squared > minimum * minimum &&
+                      tilePair(self, halfList, a, b);
+          // Masked lanes take a harmless distance and contribute 0
+          distanceSquared[b] = inside[b] ? squared : hSquared;
+        }
+        const Lanes inverse = inverseDistances<Math>(distanceSquared);
+        for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) {
+          const Storage inverseDistance     = inverse[b];
+          const Storage distance            = Math == KernelMath::fast
+                                                  ? distanceSquared[b] * inverseDistance
+                                                  : std::sqrt(distanceSquared[b]);
+          const Storage heightMinusDistance = height - distance;
+          const Storage pressureTerm =
+              commonTerm * heightMinusDistance * heightMinusDistance * inverseDistance;
+          const Storage viscosityTerm = viscosity * inverseDistance * inverseDistance;
+          const Storage incrementX =
+              inside[b] ? deltaX[b] * pressureTerm +
+                              (clusters.vx[jBase + b] - vxi[a]) * viscosityTerm
+                        : Storage{0};
+          const Storage incrementY =
+              inside[b] ? deltaY[b] * pressureTerm +
+                              (clusters.vy[jBase + b] - vyi[a]) * viscosityTerm
+                        : Storage{0};
+          const Storage incrementZ =
+              inside[b] ? deltaZ[b] * pressureTerm +
+                              (clusters.vz[jBase + b] - vzi[a]) * viscosityTerm
+                        : Storage{0};
+          sumIx[a] += static_cast<Accumulator>(incrementX);
+          sumIy[a] += static_cast<Accumulator>(incrementY);
+          sumIz[a] += static_cast<Accumulator>(incrementZ);
+          sumJx[b] -= static_cast<Accumulator>(incrementX);
+          sumJy[b] -= static_cast<Accumulator>(incrementY);
+          sumJz[b] -= static_cast<Accumulator>(incrementZ);
+        }
+      }
+      if (!halfList) { continue; }
+      for (std::size_t b = 0; b < CLUSTER_SIZE; ++b) {
+        clusters.ax[jBase + b] += sumJx[b];
+        clusters.ay[jBase + b] += sumJy[b];
+        clusters.az[jBase + b] += sumJz[b];
+      }
+    }
+    for (std::size_t a = 0; a < CLUSTER_SIZE; ++a) {
+      clusters.ax[iBase + a] += sumIx[a];
+      clusters.ay[iBase + a] += sumIy[a];
+      clusters.az[iBase + a] += sumIz[a];
+    }
+  }
+
+}  // namespace
+
+template <typename Policy>
+void clusterAccelerations(ClusterList<Policy> & clusters, std::uint32_t ci,
+                          typename Policy::storage_type height, typename Policy::storage_type mass,
+                          KernelMath math) {
+  if (math == KernelMath::fast) {
+    accelerationTiles<KernelMath::fast>(clusters, ci, height, mass);
+  } else {
+    accelerationTiles<KernelMath::precise>(clusters, ci, height, mass);
+  }
+}
+
+template void buildClusters<FloatPrecision>(std::vector<Particle> const &, CellList const &, float,
+                                            bool, ThreadPool &, ClusterList<FloatPrecision> &);
+template void buildClusters<MixedPrecision>(std::vector<Particle> const &, CellList const &, float,
+                                            bool, ThreadPool &, ClusterList<MixedPrecision> &);
+template void buildClusters<DoublePrecision>(std::vector<BasicParticle<double>> const &,
+                                             CellList const &, double, bool, ThreadPool &,
+                                             ClusterList<DoublePrecision> &);
+template void clusterDensities<FloatPrecision>(ClusterList<FloatPrecision> &, std::uint32_t, float);
+template void clusterDensities<MixedPrecision>(ClusterList<MixedPrecision> &, std::uint32_t, float);
+template void clusterDensities<DoublePrecision>(ClusterList<DoublePrecision> &, std::uint32_t,
+                                                double);
+template void clusterAccelerations<FloatPrecision>(ClusterList<FloatPrecision> &, std::uint32_t,
+                                                   float, float, KernelMath);
+template void clusterAccelerations<MixedPrecision>(ClusterList<MixedPrecision> &, std::uint32_t,
+                                                   float, float, KernelMath);
+template void clusterAccelerations<DoublePrecision>(ClusterList<DoublePrecision> &, std::uint32_t,
+                                                    double, double, KernelMath);
@@ -0,0 +1,69 @@
+// cluster.hpp
+#pragma once
+
+#include "celllist.hpp"
+#include "hugepages.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "threadpool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Lanes of a cluster: tiles of CLUSTER_SIZE x CLUSTER_SIZE pairs are evaluated at once
+constexpr std::size_t CLUSTER_SIZE = 4;
+// Particle of an empty lane
+constexpr std::uint32_t NO_PARTICLE = std::numeric_limits<std::uint32_t>::max();
+
+// Particles of a cell list grouped into clusters of CLUSTER_SIZE consecutive particles of one
+// cell, stored lane by lane (structure of arrays). The last cluster of a cell is padded with
+// empty lanes placed far outside the domain, so they never fall within the smoothing length.
+// Each cluster lists the clusters whose bounding boxes come within the smoothing length of its
+// own: the half stencil (own cell from the cluster itself on, then the 13 forward cells) or the
+// full 27-cell stencil.
+template <typename Policy>
+struct ClusterList {
+    using Storage     = typename Policy::storage_type;
+    using Accumulator = typename Policy::accumulator_type;
+
+    struct Box {
+        std::array<Storage, 3> low;
+        std::array<Storage, 3> high;
+    };
+
+    LargeArray<std::uint32_t> cellClusters;  // First cluster of each cell, cellCount() + 1
+    LargeArray<std::uint32_t> particle;      // Particle of each lane, NO_PARTICLE when empty
+    LargeArray<Storage> px, py, pz;          // Lane positions
+    LargeArray<Storage> vx, vy, vz;          // Lane velocities
+    LargeArray<Box> boxes;                   // Bounding box of the occupied lanes
+    LargeArray<std::uint32_t> pairStart;     // Offsets into pairCluster, clusterCount() + 1
+    LargeArray<std::uint32_t> pairCluster;   // Interacting clusters, in stencil order
+    bool halfList = true;                    // Which stencil the lists cover
+    // Lane sums of the pass in progress
+    LargeArray<Accumulator> rho, ax, ay, az;
+
+    [[nodiscard]] std::size_t clusterCount() const { return boxes.size(); }
+};
+
+// Builds the clusters of `cells` (already binned) and their pair lists
+template <typename Policy>
+void buildClusters(std::vector<BasicParticle<typename Policy::storage_type>> const & particles,
+                   CellList const & cells, typename Policy::storage_type height, bool halfList,
+                   ThreadPool & pool, ClusterList<Policy> & clusters);
+
+// Adds the density terms of cluster `ci` and its pair list to the lane sums. With a half list
+// the partner lanes also receive every term (the caller keeps concurrent clusters disjoint);
+// with a full list only the lanes of `ci` are written.
+template <typename Policy>
+void clusterDensities(ClusterList<Policy> & clusters, std::uint32_t ci,
+                      typename Policy::storage_type height);
+
+// Same for the acceleration terms; partners receive the opposite increment. With
+// KernelMath::fast the inverse distances of a tile row come from one fastInverseSqrt call.
+template <typename Policy>
+void clusterAccelerations(ClusterList<Policy> & clusters, std::uint32_t ci,
+                          typename Policy::storage_type height, typename Policy::storage_type mass,
+                          KernelMath math);
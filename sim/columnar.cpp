@@ -0,0 +1,88 @@
+// columnar.cpp
+#include "columnar.hpp"
+
+#include "outputfilter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+  std::uint64_t alignColumn(std::uint64_t offset) {
+    return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+  }
+
+}  // namespace
+
+bool writeColumnarParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            std::vector<std::uint32_t> const & indices,
+                            OutputFields const & fields) {
+  std::vector<OutputColumn> const columns = selectedOutputColumns(fields);
+  ColumnarHeader fileHeader;
+  fileHeader.columns = static_cast<std::uint32_t>(columns.size());
+  fileHeader.ppm     = header.ppm;
+  fileHeader.np      = static_cast<std::int32_t>(indices.size());
+  std::vector<ColumnEntry> entries(columns.size());
+  std::uint64_t end = sizeof(ColumnarHeader) + columns.size() * sizeof(ColumnEntry);
+  for (std::size_t c = 0; c < columns.size(); ++c) {
+    std::strncpy(entries[c].name.data(), columns[c].name, entries[c].name.size());
+    entries[c].elementSize = OUTPUT_COLUMN_BYTES;
+    entries[c].offset      = alignColumn(end);
+    entries[c].bytes       = indices.size() * entries[c].elementSize;
+    end                    = entries[c].offset + entries[c].bytes;
+  }
+
+  WritableMappedFile output(filename, end);
+  if (!output.isOpen()) {
+    std::cerr << "Could not open output file: " << filename << '\n';
+    return false;
+  }
+  char * bytes = output.data();
+  std::memcpy(bytes, &fileHeader, sizeof(ColumnarHeader));
+  std::memcpy(bytes + sizeof(ColumnarHeader), entries.data(),
+              entries.size() * sizeof(ColumnEntry));
+  // Column by column, so each one is written sequentially and then dropped from the process
+  for (std::size_t c = 0; c < columns.size(); ++c) {
+    char * out = bytes + entries[c].offset;
+    if (columns[c].field == &OutputFields::id) {
+      std::memcpy(out, indices.data(), entries[c].bytes);
+    } else {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      auto const * base = reinterpret_cast<char const *>(particles.data()) + columns[c].member;
+      for (std::size_t k = 0; k < indices.size(); ++k) {
+        std::memcpy(out + k * sizeof(float), base + indices[k] * sizeof(Particle),
+                    sizeof(float));
+      }
+    }
+    output.dontNeed(entries[c].offset, entries[c].bytes);
+  }
+  return true;
+}
+
+MappedColumn::MappedColumn(std::string const & filename, ColumnEntry const & entry)
+  : mapping(filename, entry.offset, entry.bytes), elementSize(entry.elementSize) { }
+
+ColumnarReader::ColumnarReader(std::string const & filename) : filename(filename) {
+  std::ifstream input(filename, std::ios::binary);
+  input.read(reinterpret_cast<char *>(&fileHeader), sizeof(ColumnarHeader));
+  if (!input || fileHeader.magic != COLUMNAR_MAGIC || fileHeader.version != COLUMNAR_VERSION) {
+    return;
+  }
+  entries.resize(fileHeader.columns);
+  input.read(reinterpret_cast<char *>(entries.data()),
+             static_cast<std::streamsize>(entries.size() * sizeof(ColumnEntry)));
+  opened = static_cast<bool>(input);
+}
+
+MappedColumn ColumnarReader::column(std::string const & name) const {
+  const auto entry = std::find_if(entries.begin(), entries.end(), [&name](ColumnEntry const & e) {
+    return name.size() < e.name.size() &&
+           std::strncmp(e.name.data(), name.c_str(), e.name.size()) == 0;
+  });
+  if (!opened || entry == entries.end()) { return {}; }
+  return {filename, *entry};
+}
@@ -0,0 +1,92 @@
+// columnar.hpp
+#pragma once
+
+#include "mappedfile.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Columnar output file: a header, a directory of columns, then the columns. Every column holds
+// one scalar field of all the particles written and starts on a multiple of COLUMN_ALIGNMENT,
+// so a reader maps only the pages of the columns it reads.
+constexpr std::array<char, 8> COLUMNAR_MAGIC{'F', 'L', 'D', 'C', 'O', 'L', 'S', '\0'};
+constexpr std::uint32_t COLUMNAR_VERSION = 1;
+constexpr std::size_t COLUMN_ALIGNMENT   = 64;
+
+struct ColumnarHeader {
+    std::array<char, 8> magic = COLUMNAR_MAGIC;
+    std::uint32_t version     = COLUMNAR_VERSION;
+    std::uint32_t columns     = 0;
+    float ppm                 = 0.0F;
+    std::int32_t np           = 0;  // Particles written
+    std::uint64_t reserved    = 0;
+};
+
+// Directory entry of one column: px, py, pz, hvx, hvy, hvz, vx, vy, vz, rho, ax, ay, az or id
+struct ColumnEntry {
+    std::array<char, 12> name{};   // Zero-padded
+    std::uint32_t elementSize = 0;  // 4: float, or uint32 for id
+    std::uint64_t offset      = 0;  // From the start of the file
+    std::uint64_t bytes       = 0;
+};
+
+static_assert(sizeof(ColumnarHeader) == 32 && sizeof(ColumnEntry) == 32);
+
+// Writes the selected particles as one column per scalar field of `fields`, directly into a
+// mapping of the output file
+bool writeColumnarParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            std::vector<std::uint32_t> const & indices,
+                            OutputFields const & fields);
+
+// One column mapped on its own
+class MappedColumn {
+  public:
+    MappedColumn() = default;
+    MappedColumn(std::string const & filename, ColumnEntry const & entry);
+
+    [[nodiscard]] bool isOpen() const { return mapping.isOpen(); }
+
+    [[nodiscard]] std::size_t size() const {
+      return elementSize == 0 ? 0 : mapping.size() / elementSize;
+    }
+
+    // The values, empty unless T has the element size of the column
+    template <typename T>
+    [[nodiscard]] std::span<T const> values() const {
+      if (sizeof(T) != elementSize || mapping.data() == nullptr) { return {}; }
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return {reinterpret_cast<T const *>(mapping.data()), size()};
+    }
+
+  private:
+    MappedFile mapping{"", 0, 0};
+    std::uint32_t elementSize = 0;
+};
+
+// Reader of a columnar file: opening it reads the header and the directory only
+class ColumnarReader {
+  public:
+    explicit ColumnarReader(std::string const & filename);
+
+    [[nodiscard]] bool isOpen() const { return opened; }
+
+    [[nodiscard]] ColumnarHeader const & header() const { return fileHeader; }
+
+    [[nodiscard]] std::vector<ColumnEntry> const & directory() const { return entries; }
+
+    // Maps the column `name`; not open when the file has no such column
+    [[nodiscard]] MappedColumn column(std::string const & name) const;
+
+  private:
+    std::string filename;
+    ColumnarHeader fileHeader;
+    std::vector<ColumnEntry> entries;
+    bool opened = false;
+};
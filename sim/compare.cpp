@@ -0,0 +1,133 @@
+// compare.cpp
+#include "compare.hpp"
+
+#include "mappedfile.hpp"
+#include "parallel.hpp"
+#include "particle.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+  constexpr std::size_t HEADER_BYTES = sizeof(Header);
+
+  using FieldErrors = std::array<FieldError, OUTPUT_FIELD_COUNT>;
+
+  // Number of floats per particle deduced from the file size, or 0 if it fits neither layout
+  int detectFieldCount(std::size_t fileSize, int particleCount) {
+    if (fileSize < HEADER_BYTES || particleCount < 0) { return 0; }
+    const std::size_t payload = fileSize - HEADER_BYTES;
+    const auto count          = static_cast<std::size_t>(particleCount);
+    for (int fields : {OUTPUT_FIELD_COUNT, INPUT_FIELD_COUNT}) {
+      if (payload == count * static_cast<std::size_t>(fields) * sizeof(float)) { return fields; }
+    }
+    return 0;
+  }
+
+  Header readMappedHeader(MappedFile const & file) {
+    Header header{};
+    if (file.size() >= HEADER_BYTES) { std::memcpy(&header, file.data(), HEADER_BYTES); }
+    return header;
+  }
+
+  float readValue(char const * records, std::size_t index) {
+    float value = 0.0F;
+    std::memcpy(&value, records + index * sizeof(float), sizeof(float));
+    return value;
+  }
+
+  void recordValue(FieldError & error, float expected, float actual, std::size_t particle,
+                   CompareTolerance const & tolerance) {
+    // Identical bit patterns (including NaN and infinities of the same sign) always match
+    if (std::memcmp(&expected, &actual, sizeof(float)) == 0) { return; }
+    const double reference = static_cast<double>(expected);
+    double absolute        = std::abs(static_cast<double>(actual) - reference);
+    if (std::isnan(absolute)) { absolute = std::numeric_limits<double>::infinity(); }
+    const double relative = absolute / std::max(std::abs(reference), 1e-30);
+    if (absolute > error.maxAbsolute) {
+      error.maxAbsolute = absolute;
+      error.worstIndex  = particle;
+    }
+    error.maxRelative = std::max(error.maxRelative, relative);
+    if (!(absolute <= tolerance.absolute + tolerance.relative * std::abs(reference))) {
+      ++error.mismatches;
+    }
+  }
+
+  void mergeErrors(FieldErrors & total, FieldErrors const & partial) {
+    for (std::size_t field = 0; field < total.size(); ++field) {
+      if (partial[field].maxAbsolute > total[field].maxAbsolute) {
+        total[field].maxAbsolute = partial[field].maxAbsolute;
+        total[field].worstIndex  = partial[field].worstIndex;
+      }
+      total[field].maxRelative  = std::max(total[field].maxRelative, partial[field].maxRelative);
+      total[field].mismatches  += partial[field].mismatches;
+    }
+  }
+
+}  // namespace
+
+std::array<char const *, OUTPUT_FIELD_COUNT> const & fieldNames() {
+  static std::array<char const *, OUTPUT_FIELD_COUNT> const names = {
+    "px", "py", "pz", "hvx", "hvy", "hvz", "vx", "vy", "vz", "rho", "ax", "ay", "az"};
+  return names;
+}
+
+bool CompareReport::withinTolerance() const {
+  return comparable && headerMatches &&
+         std::all_of(fields.begin(), fields.end(),
+                     [](FieldError const & field) { return field.mismatches == 0; });
+}
+
+CompareReport compareFldFiles(std::string const & expectedFile, std::string const & actualFile,
+                              CompareTolerance const & tolerance, int threads) {
+  CompareReport report;
+  const MappedFile expected(expectedFile);
+  const MappedFile actual(actualFile);
+  if (!expected.isOpen() || !actual.isOpen()) {
+    report.error = "Cannot open " + (expected.isOpen() ? actualFile : expectedFile);
+    return report;
+  }
+
+  const Header expectedHeader = readMappedHeader(expected);
+  const Header actualHeader   = readMappedHeader(actual);
+  const int expectedFields    = detectFieldCount(expected.size(), expectedHeader.np);
+  const int actualFields      = detectFieldCount(actual.size(), actualHeader.np);
+  if (expectedFields == 0 || actualFields == 0) {
+    report.error = "File size does not match the particle count in the header of " +
+                   (expectedFields == 0 ? expectedFile : actualFile);
+    return report;
+  }
+  if (expectedFields != actualFields || expectedHeader.np != actualHeader.np) {
+    report.error = "Files have different particle counts or record layouts";
+    return report;
+  }
+
+  report.comparable    = true;
+  report.headerMatches = expectedHeader.ppm == actualHeader.ppm;
+  report.fieldCount    = expectedFields;
+  report.particles     = static_cast<std::size_t>(expectedHeader.np);
+
+  const int workers = std::max(threads, 1);
+  std::vector<FieldErrors> partials(static_cast<std::size_t>(workers));
+  char const * expectedRecords = expected.data() + HEADER_BYTES;
+  char const * actualRecords   = actual.data() + HEADER_BYTES;
+  const auto fields            = static_cast<std::size_t>(report.fieldCount);
+  runOnThreads(workers, [&](int thread) {
+    const IndexRange range = threadRange(report.particles, thread, workers);
+    FieldErrors & errors   = partials[static_cast<std::size_t>(thread)];
+    for (std::size_t particle = range.begin; particle < range.end; ++particle) {
+      for (std::size_t field = 0; field < fields; ++field) {
+        const std::size_t index = particle * fields + field;
+        recordValue(errors[field], readValue(expectedRecords, index),
+                    readValue(actualRecords, index), particle, tolerance);
+      }
+    }
+  });
+  for (auto const & partial : partials) { mergeErrors(report.fields, partial); }
+  return report;
+}
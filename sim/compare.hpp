@@ -0,0 +1,42 @@
+// compare.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+// Input files carry 9 floats per particle (position, half-step and full velocity), output
+// files carry the 13 fields of Particle
+constexpr int INPUT_FIELD_COUNT  = 9;
+constexpr int OUTPUT_FIELD_COUNT = 13;
+
+std::array<char const *, OUTPUT_FIELD_COUNT> const & fieldNames();
+
+// A value passes when |actual - expected| <= absolute + relative * |expected|
+struct CompareTolerance {
+    double absolute = 0.0;
+    double relative = 0.0;
+};
+
+struct FieldError {
+    double maxAbsolute     = 0.0;
+    double maxRelative     = 0.0;
+    std::size_t worstIndex = 0;  // Particle with the largest absolute error
+    std::size_t mismatches = 0;  // Values outside the tolerance
+};
+
+struct CompareReport {
+    bool comparable = false;  // Both files read and have the same layout
+    std::string error;        // Why they could not be compared
+    bool headerMatches    = false;
+    int fieldCount        = 0;
+    std::size_t particles = 0;
+    std::array<FieldError, OUTPUT_FIELD_COUNT> fields{};
+
+    [[nodiscard]] bool withinTolerance() const;
+};
+
+// Compares two .fld files field by field; the files are memory-mapped and the particles are
+// split among `threads` threads
+CompareReport compareFldFiles(std::string const & expectedFile, std::string const & actualFile,
+                              CompareTolerance const & tolerance, int threads = 1);
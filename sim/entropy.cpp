@@ -0,0 +1,169 @@
+// entropy.cpp
+#include "entropy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+  constexpr std::uint32_t SCALE      = 1U << ENTROPY_SCALE_BITS;
+  constexpr std::uint32_t LOWER      = 1U << 23U;  // Coder state stays in [LOWER, LOWER << 8)
+  constexpr std::size_t SYMBOLS      = 256;
+  constexpr std::size_t TABLE_BYTES  = SYMBOLS * sizeof(std::uint16_t);
+  constexpr std::size_t HEADER_BYTES = sizeof(std::uint32_t) + TABLE_BYTES;
+
+  using Frequencies = std::array<std::uint32_t, SYMBOLS>;
+
+  // Counts scaled to sum to SCALE, every byte present keeping at least 1
+  Frequencies normalize(std::span<std::uint8_t const> input) {
+    Frequencies counts{};
+    for (const std::uint8_t byte : input) { ++counts[byte]; }
+    Frequencies frequencies{};
+    std::uint32_t total = 0;
+    for (std::size_t s = 0; s < SYMBOLS; ++s) {
+      if (counts[s] == 0) { continue; }
+      frequencies[s] = std::max<std::uint32_t>(
+          1, static_cast<std::uint32_t>(static_cast<std::uint64_t>(counts[s]) * SCALE /
+                                        input.size()));
+      total += frequencies[s];
+    }
+    // Rounding error goes to the most frequent bytes, where it costs the least
+    while (total != SCALE) {
+      auto largest = std::max_element(frequencies.begin(), frequencies.end());
+      if (total < SCALE) {
+        *largest += SCALE - total;
+        total     = SCALE;
+      } else {
+        const std::uint32_t cut = std::min(total - SCALE, *largest - 1);
+        *largest               -= cut;
+        total                  -= cut;
+        if (cut == 0) { break; }
+      }
+    }
+    return frequencies;
+  }
+
+  Frequencies cumulative(Frequencies const & frequencies) {
+    Frequencies starts{};
+    for (std::size_t s = 1; s < SYMBOLS; ++s) {
+      starts[s] = starts[s - 1] + frequencies[s - 1];
+    }
+    return starts;
+  }
+
+  // Encoder constants of one byte value, so that encoding needs no division: x / f is
+  // (x * reciprocal) >> shift, and x + bias + (x / f) * (SCALE - f) equals
+  // ((x / f) << SCALE_BITS) + x % f + start
+  struct EncoderSymbol {
+      std::uint32_t limit      = 0;  // Renormalise while the state reaches this
+      std::uint32_t reciprocal = 0;
+      std::uint32_t shift      = 0;
+      std::uint32_t bias       = 0;
+      std::uint32_t complement = 0;
+  };
+
+  EncoderSymbol makeEncoderSymbol(std::uint32_t start, std::uint32_t frequency) {
+    EncoderSymbol symbol;
+    symbol.limit      = ((LOWER >> ENTROPY_SCALE_BITS) << 8U) * frequency;
+    symbol.complement = SCALE - frequency;
+    if (frequency < 2) {
+      // x / 1 = x: a reciprocal of 2^32 - 1 gives x - 1 for x > 0, made up by the bias
+      symbol.reciprocal = ~0U;
+      symbol.shift      = 32;
+      symbol.bias       = start + SCALE - 1;
+    } else {
+      std::uint32_t bits = 0;
+      while (frequency > (1U << bits)) { ++bits; }
+      symbol.reciprocal = static_cast<std::uint32_t>(
+          ((std::uint64_t{1} << (bits + 31)) + frequency - 1) / frequency);
+      symbol.shift = bits - 1 + 32;
+      symbol.bias  = start;
+    }
+    return symbol;
+  }
+
+  void appendWord(std::uint32_t value, std::vector<std::uint8_t> & output) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      output.push_back(static_cast<std::uint8_t>(value >> static_cast<unsigned>(shift)));
+    }
+  }
+
+  std::uint32_t readWord(std::uint8_t const * bytes) {
+    std::uint32_t value = 0;
+    for (int k = 3; k >= 0; --k) { value = (value << 8U) | bytes[k]; }
+    return value;
+  }
+
+}  // namespace
+
+void encodeBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t> & output) {
+  appendWord(static_cast<std::uint32_t>(input.size()), output);
+  if (input.empty()) { return; }
+  Frequencies const frequencies = normalize(input);
+  Frequencies const starts      = cumulative(frequencies);
+  for (const std::uint32_t frequency : frequencies) {
+    output.push_back(static_cast<std::uint8_t>(frequency));
+    output.push_back(static_cast<std::uint8_t>(frequency >> 8U));
+  }
+  std::array<EncoderSymbol, SYMBOLS> symbols{};
+  for (std::size_t s = 0; s < SYMBOLS; ++s) {
+    if (frequencies[s] != 0) { symbols[s] = makeEncoderSymbol(starts[s], frequencies[s]); }
+  }
+  // rANS encodes backwards, so the decoder reads the last bytes written first
+  std::vector<std::uint8_t> emitted;
+  emitted.reserve(input.size());
+  std::uint32_t state = LOWER;
+  for (std::size_t i = input.size(); i-- > 0;) {
+    EncoderSymbol const & symbol = symbols[input[i]];
+    while (state >= symbol.limit) {
+      emitted.push_back(static_cast<std::uint8_t>(state));
+      state >>= 8U;
+    }
+    // state / frequency by a multiply and shift, then the usual state update folded in
+    const auto quotient = static_cast<std::uint32_t>(
+        (static_cast<std::uint64_t>(state) * symbol.reciprocal) >> symbol.shift);
+    state += symbol.bias + quotient * symbol.complement;
+  }
+  appendWord(state, output);
+  appendWord(static_cast<std::uint32_t>(emitted.size()), output);
+  output.insert(output.end(), emitted.rbegin(), emitted.rend());
+}
+
+std::size_t decodeBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t> & output) {
+  output.clear();
+  if (input.size() < sizeof(std::uint32_t)) { return 0; }
+  const std::uint32_t count = readWord(input.data());
+  if (count == 0) { return sizeof(std::uint32_t); }
+  if (input.size() < HEADER_BYTES + 2 * sizeof(std::uint32_t)) { return 0; }
+  Frequencies frequencies{};
+  std::uint32_t total = 0;
+  for (std::size_t s = 0; s < SYMBOLS; ++s) {
+    frequencies[s] = input[4 + 2 * s] | static_cast<std::uint32_t>(input[5 + 2 * s] << 8U);
+    total         += frequencies[s];
+  }
+  if (total != SCALE) { return 0; }
+  Frequencies const starts = cumulative(frequencies);
+  std::array<std::uint8_t, SCALE> symbolOf{};
+  for (std::size_t s = 0; s < SYMBOLS; ++s) {
+    std::fill_n(symbolOf.begin() + starts[s], frequencies[s], static_cast<std::uint8_t>(s));
+  }
+  std::uint32_t state           = readWord(input.data() + HEADER_BYTES);
+  const std::uint32_t available = readWord(input.data() + HEADER_BYTES + 4);
+  const std::size_t size        = HEADER_BYTES + 2 * sizeof(std::uint32_t) + available;
+  if (input.size() < size) { return 0; }
+  std::uint8_t const * next = input.data() + HEADER_BYTES + 2 * sizeof(std::uint32_t);
+  std::uint8_t const * end  = input.data() + size;
+  output.resize(count);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    const std::uint32_t slot = state & (SCALE - 1);
+    const std::uint8_t symbol = symbolOf[slot];
+    output[i] = symbol;
+    state     = frequencies[symbol] * (state >> ENTROPY_SCALE_BITS) + slot - starts[symbol];
+    while (state < LOWER) {
+      if (next == end) { return 0; }
+      state = (state << 8U) | *next++;
+    }
+  }
+  return size;
+}
@@ -0,0 +1,19 @@
+// entropy.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Order-0 byte entropy coder: a static rANS coder with 12-bit frequencies (ENTROPY_SCALE_BITS).
+// A stream holds the byte count, the 256 frequencies, the final coder state and the
+// renormalisation bytes, so a run of one byte value costs 524 bytes whatever its length.
+constexpr std::uint32_t ENTROPY_SCALE_BITS = 12;
+
+// Appends the stream of `input` to `output`
+void encodeBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t> & output);
+
+// Decodes one stream from the start of `input` into `output`. Returns the stream size, or 0
+// when the stream is cut short or corrupt.
+std::size_t decodeBytes(std::span<std::uint8_t const> input, std::vector<std::uint8_t> & output);
@@ -0,0 +1,79 @@
+// hugepages.cpp
+#include "hugepages.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+
+namespace {
+
+  // MADV_COLLAPSE (Linux 6.1) is missing from older headers
+#ifdef MADV_COLLAPSE
+  constexpr int COLLAPSE_ADVICE = MADV_COLLAPSE;
+#else
+  constexpr int COLLAPSE_ADVICE = 25;
+#endif
+
+  constexpr std::uint64_t BYTES_PER_KB = 1024;
+
+  std::size_t roundToHugePages(std::size_t bytes) {
+    return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+  }
+
+}  // namespace
+
+void * mapLargeArray(std::size_t bytes, HugePages mode) {
+  const std::size_t length = roundToHugePages(bytes);
+  if (mode == HugePages::hugetlb) {
+    void * data = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) { return data; }
+  }
+  // Over-map by one huge page so that the array can start on a 2 MiB boundary, then return
+  // the unused head and tail to the kernel
+  const std::size_t padded = length + HUGE_PAGE_BYTES;
+  void * raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) { return nullptr; }
+  const auto start   = reinterpret_cast<std::uintptr_t>(raw);
+  const auto aligned = (start + HUGE_PAGE_BYTES - 1) & ~(std::uintptr_t{HUGE_PAGE_BYTES} - 1);
+  if (aligned > start) { munmap(raw, aligned - start); }
+  const std::uintptr_t tail = start + padded - (aligned + length);
+  if (tail > 0) { munmap(reinterpret_cast<void *>(aligned + length), tail); }
+  void * data = reinterpret_cast<void *>(aligned);
+  madvise(data, length, MADV_HUGEPAGE);
+  return data;
+}
+
+void unmapLargeArray(void * data, std::size_t bytes) {
+  munmap(data, roundToHugePages(bytes));
+}
+
+bool adviseHugePages(void const * data, std::size_t bytes) {
+  const auto address      = reinterpret_cast<std::uintptr_t>(data);
+  const std::uintptr_t mask = ~(std::uintptr_t{HUGE_PAGE_BYTES} - 1);
+  const std::uintptr_t begin = (address + HUGE_PAGE_BYTES - 1) & mask;
+  const std::uintptr_t end   = (address + bytes) & mask;
+  if (begin >= end) { return false; }
+  void * range = reinterpret_cast<void *>(begin);
+  if (madvise(range, end - begin, MADV_HUGEPAGE) != 0) { return false; }
+  // Collapsing is best effort: without it khugepaged still converts the range later
+  (void) madvise(range, end - begin, COLLAPSE_ADVICE);
+  return true;
+}
+
+std::uint64_t hugePageBytes() {
+  std::ifstream file("/proc/self/smaps_rollup");
+  std::uint64_t total = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.starts_with("AnonHugePages:") || line.starts_with("Shared_Hugetlb:") ||
+        line.starts_with("Private_Hugetlb:")) {
+      std::istringstream fields(line.substr(line.find(':') + 1));
+      std::uint64_t kilobytes = 0;
+      fields >> kilobytes;
+      total += kilobytes * BYTES_PER_KB;
+    }
+  }
+  return total;
+}
@@ -0,0 +1,79 @@
+// hugepages.hpp
+#pragma once
+
+#include "options.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+constexpr std::size_t HUGE_PAGE_BYTES = std::size_t{2} << 20U;
+
+// Maps `bytes` rounded up to whole 2 MiB pages, 2 MiB aligned. `hugetlb` asks for MAP_HUGETLB
+// first; when the pool is empty, and for `transparent`, it falls back to normal pages advised
+// with MADV_HUGEPAGE. Returns nullptr when even the fallback fails.
+void * mapLargeArray(std::size_t bytes, HugePages mode);
+void unmapLargeArray(void * data, std::size_t bytes);
+
+// Advises MADV_HUGEPAGE on the 2 MiB aligned part of an existing range and, where the kernel
+// supports MADV_COLLAPSE, turns its resident pages into huge pages right away
+bool adviseHugePages(void const * data, std::size_t bytes);
+
+// Bytes of the process backed by huge pages (transparent and hugetlb), from
+// /proc/self/smaps_rollup; 0 when the file cannot be read
+std::uint64_t hugePageBytes();
+
+// Allocator of the large simulation arrays. With a mode other than off, allocations of at
+// least one huge page come from mapLargeArray; smaller ones, and every allocation with off, use
+// operator new. The mode is part of the allocator, so an array is always freed the way it was
+// allocated.
+template <typename T>
+class LargePageAllocator {
+  public:
+    using value_type                             = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    LargePageAllocator() = default;
+
+    explicit LargePageAllocator(HugePages mode) : mode(mode) { }
+
+    template <typename U>
+    explicit LargePageAllocator(LargePageAllocator<U> const & other) : mode(other.hugePages()) { }
+
+    [[nodiscard]] HugePages hugePages() const { return mode; }
+
+    T * allocate(std::size_t count) {
+      const std::size_t bytes = count * sizeof(T);
+      if (!mapped(bytes)) { return static_cast<T *>(::operator new(bytes)); }
+      void * data = mapLargeArray(bytes, mode);
+      if (data == nullptr) { throw std::bad_alloc(); }
+      return static_cast<T *>(data);
+    }
+
+    void deallocate(T * data, std::size_t count) {
+      const std::size_t bytes = count * sizeof(T);
+      if (!mapped(bytes)) {
+        ::operator delete(data);
+        return;
+      }
+      unmapLargeArray(data, bytes);
+    }
+
+    template <typename U>
+    bool operator==(LargePageAllocator<U> const & other) const {
+      return mode == other.hugePages();
+    }
+
+  private:
+    [[nodiscard]] bool mapped(std::size_t bytes) const {
+      return mode != HugePages::off && bytes >= HUGE_PAGE_BYTES;
+    }
+
+    HugePages mode = HugePages::off;
+};
+
+template <typename T>
+using LargeArray = std::vector<T, LargePageAllocator<T>>;
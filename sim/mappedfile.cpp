@@ -0,0 +1,119 @@
+// mappedfile.cpp
+#include "mappedfile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+MappedFile::MappedFile(std::string const & filename) {
+  map(filename, 0, SIZE_MAX);
+}
+
+MappedFile::MappedFile(std::string const & filename, std::size_t offset, std::size_t count) {
+  map(filename, offset, count);
+}
+
+MappedFile::~MappedFile() {
+  release();
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+  : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)),
+    skipped(std::exchange(other.skipped, 0)), opened(std::exchange(other.opened, false)) { }
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept {
+  if (this != &other) {
+    release();
+    bytes   = std::exchange(other.bytes, nullptr);
+    length  = std::exchange(other.length, 0);
+    skipped = std::exchange(other.skipped, 0);
+    opened  = std::exchange(other.opened, false);
+  }
+  return *this;
+}
+
+void MappedFile::map(std::string const & filename, std::size_t offset, std::size_t count) {
+  const int descriptor = open(filename.c_str(), O_RDONLY);
+  if (descriptor < 0) { return; }
+  struct stat info {};
+  if (fstat(descriptor, &info) == 0) {
+    const auto fileSize = static_cast<std::size_t>(info.st_size);
+    // mmap starts on a page, so the range is extended down to one
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    opened          = true;
+    skipped         = std::min(offset, fileSize) % page;
+    length          = offset >= fileSize ? 0 : std::min(count, fileSize - offset);
+    if (length > 0) {
+      void * mapping = mmap(nullptr, length + skipped, PROT_READ, MAP_PRIVATE, descriptor,
+                            static_cast<off_t>(offset - skipped));
+      if (mapping == MAP_FAILED) {
+        opened  = false;
+        length  = 0;
+        skipped = 0;
+      } else {
+        madvise(mapping, length + skipped, MADV_SEQUENTIAL);
+        bytes = static_cast<char const *>(mapping) + skipped;
+      }
+    }
+  }
+  close(descriptor);
+}
+
+void MappedFile::release() {
+  if (bytes != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    munmap(const_cast<char *>(bytes - skipped), length + skipped);
+  }
+  bytes   = nullptr;
+  length  = 0;
+  skipped = 0;
+  opened  = false;
+}
+
+WritableMappedFile::WritableMappedFile(std::string const & filename, std::size_t size,
+                                       bool temporary) {
+  const int descriptor = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (descriptor < 0) { return; }
+  if (temporary) { unlink(filename.c_str()); }
+  if (ftruncate(descriptor, static_cast<off_t>(size)) == 0) {
+    opened = true;
+    length = size;
+    if (length > 0) {
+      void * mapping =
+          mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+      if (mapping == MAP_FAILED) {
+        opened = false;
+        length = 0;
+      } else {
+        bytes = static_cast<char *>(mapping);
+      }
+    }
+  }
+  close(descriptor);
+}
+
+WritableMappedFile::~WritableMappedFile() {
+  if (bytes != nullptr) { munmap(bytes, length); }
+}
+
+void WritableMappedFile::willNeed(std::size_t offset, std::size_t count) const {
+  advise(offset, count, MADV_WILLNEED);
+}
+
+void WritableMappedFile::dontNeed(std::size_t offset, std::size_t count) const {
+  advise(offset, count, MADV_DONTNEED);
+}
+
+void WritableMappedFile::advise(std::size_t offset, std::size_t count, int advice) const {
+  // madvise takes whole pages. Dropping a page of a shared mapping keeps its data in the file,
+  // so the range can grow to the pages it touches.
+  const auto page        = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t begin = offset / page * page;
+  const std::size_t end   = std::min((offset + count + page - 1) / page * page, length);
+  if (bytes == nullptr || end <= begin) { return; }
+  madvise(bytes + begin, end - begin, advice);
+}
@@ -0,0 +1,62 @@
+// mappedfile.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file, or of a range of it; unmapped on destruction
+class MappedFile {
+  public:
+    explicit MappedFile(std::string const & filename);
+    // Maps only the pages of [offset, offset + count), cut at the end of the file
+    MappedFile(std::string const & filename, std::size_t offset, std::size_t count);
+    ~MappedFile();
+    MappedFile(MappedFile const &)             = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+
+    [[nodiscard]] bool isOpen() const { return opened; }
+
+    [[nodiscard]] char const * data() const { return bytes; }
+
+    [[nodiscard]] std::size_t size() const { return length; }
+
+  private:
+    char const * bytes  = nullptr;
+    std::size_t length  = 0;
+    std::size_t skipped = 0;  // Bytes mapped before `bytes` to start on a page
+    bool opened         = false;
+    void map(std::string const & filename, std::size_t offset, std::size_t count);
+    void release();
+};
+
+// Shared read-write mapping of a file created (or truncated) to `size` bytes; unmapped on
+// destruction. A temporary file is removed as soon as it is mapped, so it disappears with the
+// mapping even if the process dies.
+class WritableMappedFile {
+  public:
+    WritableMappedFile(std::string const & filename, std::size_t size, bool temporary = false);
+    ~WritableMappedFile();
+    WritableMappedFile(WritableMappedFile const &)             = delete;
+    WritableMappedFile & operator=(WritableMappedFile const &) = delete;
+    WritableMappedFile(WritableMappedFile &&)                  = delete;
+    WritableMappedFile & operator=(WritableMappedFile &&)      = delete;
+
+    [[nodiscard]] bool isOpen() const { return opened; }
+
+    [[nodiscard]] char * data() const { return bytes; }
+
+    [[nodiscard]] std::size_t size() const { return length; }
+
+    // Starts reading [offset, offset + count) in the background
+    void willNeed(std::size_t offset, std::size_t count) const;
+    // Drops [offset, offset + count) from the process; written pages stay in the file
+    void dontNeed(std::size_t offset, std::size_t count) const;
+
+  private:
+    char * bytes       = nullptr;
+    std::size_t length = 0;
+    bool opened        = false;
+    void advise(std::size_t offset, std::size_t count, int advice) const;
+};
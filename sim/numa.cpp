@@ -0,0 +1,111 @@
+// numa.cpp
+#include "numa.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+  constexpr std::size_t MASK_WORDS   = 16;  // Up to 1024 nodes
+  constexpr std::size_t MASK_BITS    = MASK_WORDS * 64;
+  constexpr std::size_t QUERY_BATCH  = 4096;  // Pages asked to move_pages per call
+
+  std::uintptr_t pageSize() {
+    static const auto size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    return size;
+  }
+
+  // Nodes of a sysfs list such as "0-1,3"
+  std::vector<int> parseNodeList(std::string const & text) {
+    std::vector<int> nodes;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+      if (item.empty()) { continue; }
+      const std::size_t dash = item.find('-');
+      const int first        = std::stoi(item.substr(0, dash));
+      const int last         = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+      for (int node = first; node <= last; ++node) { nodes.push_back(node); }
+    }
+    return nodes;
+  }
+
+  std::vector<int> onlineNodes() {
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string text;
+    if (!file || !std::getline(file, text)) { return {0}; }
+    std::vector<int> nodes = parseNodeList(text);
+    if (nodes.empty()) { nodes.push_back(0); }
+    return nodes;
+  }
+
+}  // namespace
+
+int numaNodeCount() {
+  static const int count = onlineNodes().back() + 1;
+  return count;
+}
+
+int currentNumaNode() {
+  unsigned int cpu  = 0;
+  unsigned int node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) { return 0; }
+  return static_cast<int>(node);
+}
+
+bool placePages(void const * data, std::size_t bytes, NumaPlacement placement, int node) {
+  if (placement == NumaPlacement::off || bytes == 0) { return true; }
+  const std::uintptr_t page  = pageSize();
+  const auto address         = reinterpret_cast<std::uintptr_t>(data);
+  const std::uintptr_t begin = address & ~(page - 1);
+  const std::uintptr_t end   = (address + bytes + page - 1) & ~(page - 1);
+
+  std::array<unsigned long, MASK_WORDS> mask{};
+  int mode = MPOL_BIND;
+  if (placement == NumaPlacement::interleave) {
+    mode = MPOL_INTERLEAVE;
+    for (const int online : onlineNodes()) {
+      mask[static_cast<std::size_t>(online) / 64] |= 1UL << (static_cast<unsigned>(online) % 64);
+    }
+  } else {
+    if (node < 0 || static_cast<std::size_t>(node) >= MASK_BITS) { return false; }
+    mask[static_cast<std::size_t>(node) / 64] |= 1UL << (static_cast<unsigned>(node) % 64);
+  }
+  return syscall(SYS_mbind, begin, end - begin, mode, mask.data(), MASK_BITS, MPOL_MF_MOVE) == 0;
+}
+
+std::vector<std::uint64_t> residentBytesPerNode(void const * data, std::size_t bytes) {
+  std::vector<std::uint64_t> resident(static_cast<std::size_t>(numaNodeCount()), 0);
+  if (bytes == 0) { return resident; }
+  const std::uintptr_t page  = pageSize();
+  const auto address         = reinterpret_cast<std::uintptr_t>(data);
+  const std::uintptr_t begin = address & ~(page - 1);
+  const std::uintptr_t end   = (address + bytes + page - 1) & ~(page - 1);
+
+  std::vector<void *> pages;
+  std::vector<int> status;
+  for (std::uintptr_t first = begin; first < end; first += QUERY_BATCH * page) {
+    pages.clear();
+    for (std::uintptr_t current = first; current < std::min(end, first + QUERY_BATCH * page);
+         current += page) {
+      pages.push_back(reinterpret_cast<void *>(current));
+    }
+    status.assign(pages.size(), -1);
+    // With no target nodes move_pages only reports where every page lives
+    if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+      continue;
+    }
+    for (const int pageNode : status) {
+      if (pageNode >= 0 && static_cast<std::size_t>(pageNode) < resident.size()) {
+        resident[static_cast<std::size_t>(pageNode)] += page;
+      }
+    }
+  }
+  return resident;
+}
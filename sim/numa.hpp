@@ -0,0 +1,51 @@
+// numa.hpp
+#pragma once
+
+#include "options.hpp"
+#include "parallel.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// NUMA placement through the mbind / move_pages / getcpu system calls, without libnuma.
+// Every function degrades to a no-op on kernels or containers that refuse the calls.
+
+// Nodes listed in /sys/devices/system/node/online (1 when the file is missing)
+int numaNodeCount();
+
+// Node of the CPU the calling thread runs on
+int currentNumaNode();
+
+// Applies `placement` to every page overlapping [data, data + bytes) and migrates the pages
+// already present. `local` binds to `node`, which callers set to the node of the owning thread.
+bool placePages(void const * data, std::size_t bytes, NumaPlacement placement, int node);
+
+// Resident bytes of [data, data + bytes) on each node, indexed by node
+std::vector<std::uint64_t> residentBytesPerNode(void const * data, std::size_t bytes);
+
+// Places an array the way the step phases use it. With `local` every pool thread moves the
+// pages of its static share (threadRange) to its own node, which is what first touch by that
+// thread would have done; a page shared by two shares ends up on the node of either.
+// Returns false when the kernel refused any part.
+template <typename T, typename Allocator>
+bool placeArray(std::vector<T, Allocator> const & array, ThreadPool & pool, NumaPlacement placement,
+                int node) {
+  if (placement == NumaPlacement::off || array.empty()) { return true; }
+  if (placement != NumaPlacement::local) {
+    return placePages(array.data(), array.size() * sizeof(T), placement, node);
+  }
+  const int threads = pool.size();
+  std::atomic<bool> placed{true};
+  pool.run([&](int thread) {
+    const IndexRange range = threadRange(array.size(), thread, threads);
+    if (range.begin == range.end) { return; }
+    if (!placePages(array.data() + range.begin, (range.end - range.begin) * sizeof(T),
+                    NumaPlacement::local, currentNumaNode())) {
+      placed = false;
+    }
+  });
+  return placed;
+}
@@ -0,0 +1,143 @@
+// options.hpp
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// How per-particle sums are reduced when the neighbour passes run on several threads
+enum class ReductionMode {
+  fast,          // Each pair evaluated once and applied to both particles
+  deterministic  // Each particle gathers all its pairs in index order; bit-identical for any count
+};
+
+// How interacting pairs are found
+enum class NeighborSearch {
+  cells,     // Particles binned by grid block; only the neighbouring blocks are searched
+  allPairs,  // Every pair of particles is tested against the smoothing length
+  clusters   // Blocks split into clusters of 4 particles; cluster pairs evaluated as 4x4 tiles
+};
+
+// How the cells of the neighbour passes are shared among threads
+enum class CellSchedule {
+  stealing,     // Tasks sized by cell occupancy; idle threads steal from busy ones
+  staticRange,  // Equal cell counts per thread (guided chunks for the 27-cell gather)
+  graph         // Cell list: every phase of every cell block is a task of a dependency graph,
+                // so phases overlap across blocks without barriers; clusters use stealing
+};
+
+// NUMA placement of the particle, cell and accumulator arrays
+enum class NumaPlacement {
+  off,         // Pages stay where the loading thread touched them
+  local,       // Each thread's share on the node the thread runs on
+  interleave,  // Pages spread round-robin over all nodes
+  bind         // Every page on SimulationOptions::numaNode
+};
+
+// Page size backing the large simulation arrays
+enum class HugePages {
+  off,          // Normal 4 KiB pages
+  transparent,  // 2 MiB transparent huge pages (MADV_HUGEPAGE)
+  hugetlb       // 2 MiB pages from the hugetlbfs pool, transparent ones when it is empty
+};
+
+// Inverse distance of the acceleration kernels
+enum class KernelMath {
+  precise,  // Square root and division
+  fast      // Hardware reciprocal square root estimate and one Newton-Raphson step (fastmath.hpp)
+};
+
+// Storage of the cell list
+enum class CellLayout {
+  dense,     // Every cell of the padded grid, addressed by its linear index
+  hashed,    // Occupied cells only, found through an open-addressing table on the linear index
+  automatic  // Hashed while fewer than SimulationOptions::hashedOccupancy of the cells are occupied
+};
+
+// Quantities of the in-situ analytics samples (analytics.hpp)
+struct AnalyticsSelection {
+    bool kineticEnergy = true;
+    bool centerOfMass  = true;
+    bool maxSpeed      = true;
+    bool density       = true;  // Minimum, mean, maximum and histogram
+};
+
+// Which particles of the output file are kept by index (outputfilter.hpp)
+enum class OutputSampling {
+  all,
+  stride,  // Indices that are multiples of OutputFilter::stride
+  random   // A seeded random share OutputFilter::fraction of the indices
+};
+
+// Fields of an output record, written in Particle order. The defaults give the full layout.
+struct OutputFields {
+    bool id           = false;  // Index of the particle in the input file (uint32)
+    bool position     = true;
+    bool halfVelocity = true;
+    bool velocity     = true;
+    bool density      = true;
+    bool acceleration = true;
+
+    bool operator==(OutputFields const &) const = default;
+};
+
+// How the records of the output file are laid out
+enum class OutputLayout {
+  rows,    // One record of the selected fields per particle (.fld)
+  columns  // One 64-byte aligned column per scalar field, found through a directory (columnar.hpp)
+};
+
+// Particles and fields written to the output file
+struct OutputFilter {
+    bool region = false;                // Only particles inside [regionMin, regionMax]
+    std::array<float, 3> regionMin{};
+    std::array<float, 3> regionMax{};
+    OutputSampling sampling = OutputSampling::all;
+    int stride              = 1;
+    double fraction         = 1.0;
+    std::uint64_t seed      = 1;
+    OutputFields fields;
+    OutputLayout layout = OutputLayout::rows;
+};
+
+// Execution options of a run
+struct SimulationOptions {
+    int threads              = 1;
+    ReductionMode reduction  = ReductionMode::fast;
+    NeighborSearch neighbors = NeighborSearch::cells;
+    CellSchedule schedule    = CellSchedule::stealing;
+    int graphBlockCells      = 4;  // Cells per axis of a task graph block (at least 2)
+    NumaPlacement numa       = NumaPlacement::off;
+    int numaNode             = 0;
+    HugePages hugePages      = HugePages::off;
+    KernelMath math          = KernelMath::precise;
+    CellLayout cellLayout    = CellLayout::automatic;
+    float hashedOccupancy    = 0.02F;  // Occupied share of the grid below which auto hashes
+    bool pinThreads          = true;   // Pin pool workers to their own CPUs when there are enough
+    bool pairCache           = false;  // Cell passes: reuse density pair geometry for accelerations
+    // Cell passes: cells at rest for sleepSteps steps are frozen (sleep.hpp); 0 disables it
+    int sleepSteps           = 0;
+    float sleepVelocity      = 1.0e-2F;  // Largest speed at rest (m/s)
+    float sleepAcceleration  = 1.0F;     // Largest acceleration at rest (m/s^2)
+    // Steps each tile of cells advances at a time (temporal.hpp); 0 or 1 steps one at a time
+    int temporalSteps        = 0;
+    int temporalTileCells    = 8;  // Cells per axis of a temporal blocking tile
+    // Directory of the working files of an out-of-core run (outofcore.hpp); empty runs in memory
+    std::string outOfCoreDirectory;
+    int outOfCoreSlabCells   = 4;  // Cell rows along y per out-of-core slab
+    // Steps between in-situ analytics samples written to analyticsFile; 0 disables them
+    int analyticsInterval    = 0;
+    std::string analyticsFile = "analytics.csv";
+    AnalyticsSelection analytics;
+    OutputFilter output;  // Particles and fields of the output file
+    // Steps between the frames written to trajectoryFile (trajectory.hpp); 0 disables them
+    int trajectoryInterval     = 0;
+    std::string trajectoryFile = "trajectory.trj";
+    int trajectoryKeyframes    = 16;  // Frames from one keyframe to the next
+    // Steps between the frames published to the shared memory ring publishName (shmring.hpp);
+    // 0 disables it
+    int publishInterval     = 0;
+    std::string publishName = "/fluid-frames";
+    int publishSlots        = 4;  // Frames the ring holds
+    bool profile             = false;  // Per-phase time and hardware counters in the summary
+};
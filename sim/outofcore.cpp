@@ -0,0 +1,239 @@
+// outofcore.cpp
+#include "outofcore.hpp"
+
+#include "cellgrid.hpp"
+#include "mappedfile.hpp"
+#include "step.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // Cell rows along y grouped into slabs
+  struct SlabGrid {
+      CellGrid grid;
+      int slabCells = 1;
+      int haloCells = 1;
+      int slabs     = 1;
+
+      [[nodiscard]] int row(Particle const & particle) const { return grid.locate(particle)[1]; }
+
+      [[nodiscard]] int slab(Particle const & particle) const {
+        return row(particle) / slabCells;
+      }
+  };
+
+  // A particle's step reads particles up to two smoothing lengths away, so a slab needs that
+  // many rows of its neighbours. Slabs are at least that thick, so the rows come from the two
+  // neighbouring slabs only.
+  SlabGrid makeSlabGrid(ParticleParameters const & params, int slabCells) {
+    SlabGrid slabs{makeCellGrid(params.blockSize, params.blocks)};
+    const double reach = 2.0 * static_cast<double>(params.smoothingLength) /
+                         static_cast<double>(slabs.grid.width[1]);
+    slabs.haloCells = static_cast<int>(std::floor(reach)) + 1;
+    slabs.slabCells = std::min(std::max(slabCells, slabs.haloCells), slabs.grid.ny);
+    slabs.slabs     = (slabs.grid.ny + slabs.slabCells - 1) / slabs.slabCells;
+    return slabs;
+  }
+
+  SlabRecord * records(WritableMappedFile const & file) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<SlabRecord *>(file.data());
+  }
+
+  // First records of every slab, and the total at the end
+  using SlabStarts = std::vector<std::uint64_t>;
+
+  // Counting sort of the input particles into slab order
+  void sortInput(MappedFile const & input, std::uint32_t count, SlabGrid const & slabs,
+                 WritableMappedFile const & target, SlabStarts & starts) {
+    const auto read = [&input](std::uint32_t i) {
+      Particle particle{};
+      std::memcpy(&particle, input.data() + FLD_HEADER_SIZE + i * FLD_RECORD_SIZE,
+                  FLD_RECORD_SIZE);
+      initializeDensitiesAndAccelerations(particle);
+      return particle;
+    };
+    starts.assign(static_cast<std::size_t>(slabs.slabs) + 1, 0);
+    for (std::uint32_t i = 0; i < count; ++i) {
+      ++starts[static_cast<std::size_t>(slabs.slab(read(i))) + 1];
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    SlabStarts cursor(starts.begin(), starts.end() - 1);
+    SlabRecord * out = records(target);
+    for (std::uint32_t i = 0; i < count; ++i) {
+      const Particle particle = read(i);
+      out[cursor[static_cast<std::size_t>(slabs.slab(particle))]++] = {particle, i};
+    }
+  }
+
+  // Copy of one slab in index order; its pages are dropped from the mapping
+  std::vector<SlabRecord> loadSlab(WritableMappedFile const & file, SlabStarts const & starts,
+                                   int slab) {
+    if (slab < 0 || static_cast<std::size_t>(slab) + 1 >= starts.size()) { return {}; }
+    const std::uint64_t begin = starts[static_cast<std::size_t>(slab)];
+    const std::uint64_t end   = starts[static_cast<std::size_t>(slab) + 1];
+    std::vector<SlabRecord> slabRecords(records(file) + begin, records(file) + end);
+    std::sort(slabRecords.begin(), slabRecords.end(),
+              [](SlabRecord const & a, SlabRecord const & b) { return a.id < b.id; });
+    file.dontNeed(begin * sizeof(SlabRecord), (end - begin) * sizeof(SlabRecord));
+    return slabRecords;
+  }
+
+  // One step over all the slabs: stepped particles go to `target` at their old positions
+  // and their new slabs are counted
+  void stepSlabs(WritableMappedFile const & source, WritableMappedFile const & target,
+                 SlabStarts const & starts, SlabGrid const & slabs,
+                 ParticleParameters const & params, SimulationOptions const & options,
+                 StepWorkspace<FloatPrecision> & workspace, SlabStarts & counts,
+                 OutOfCoreStats & stats) {
+    counts.assign(starts.size(), 0);
+    std::vector<SlabRecord> previous;
+    std::vector<SlabRecord> current = loadSlab(source, starts, 0);
+    std::vector<SlabRecord> next    = loadSlab(source, starts, 1);
+    std::vector<Particle> window;
+    SlabRecord * out = records(target);
+    for (int slab = 0; slab < slabs.slabs; ++slab) {
+      auto pending = std::async(std::launch::async, [&source, &starts, slab]() {
+        return loadSlab(source, starts, slab + 2);
+      });
+      const int firstRow = slab * slabs.slabCells;
+      const int lastRow  = firstRow + slabs.slabCells - 1;
+      window.clear();
+      for (SlabRecord const & record : previous) {
+        if (slabs.row(record.particle) >= firstRow - slabs.haloCells) {
+          window.push_back(record.particle);
+        }
+      }
+      const std::size_t owned = window.size();
+      for (SlabRecord const & record : current) { window.push_back(record.particle); }
+      for (SlabRecord const & record : next) {
+        if (slabs.row(record.particle) <= lastRow + slabs.haloCells) {
+          window.push_back(record.particle);
+        }
+      }
+      stepParticles(window, params, workspace, options);
+      const std::uint64_t begin = starts[static_cast<std::size_t>(slab)];
+      for (std::size_t k = 0; k < current.size(); ++k) {
+        const Particle & particle = window[owned + k];
+        const int destination     = slabs.slab(particle);
+        out[begin + k]            = {particle, current[k].id};
+        ++counts[static_cast<std::size_t>(destination) + 1];
+        if (destination != slab) { ++stats.movedBetweenSlabs; }
+      }
+      target.dontNeed(begin * sizeof(SlabRecord), current.size() * sizeof(SlabRecord));
+      stats.largestWindow        = std::max<std::uint64_t>(stats.largestWindow, window.size());
+      stats.windowParticleSteps += window.size();
+      stats.ownedParticleSteps  += current.size();
+      previous = std::move(current);
+      current  = std::move(next);
+      next     = pending.get();
+    }
+  }
+
+  // Sequential pass putting the stepped particles back into slab order
+  void resortSlabs(WritableMappedFile const & source, WritableMappedFile const & target,
+                   SlabGrid const & slabs, SlabStarts & starts, SlabStarts & counts) {
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+    SlabStarts cursor(counts.begin(), counts.end() - 1);
+    SlabRecord const * in = records(source);
+    SlabRecord * out      = records(target);
+    for (std::uint64_t i = 0; i < starts.back(); ++i) {
+      out[cursor[static_cast<std::size_t>(slabs.slab(in[i].particle))]++] = in[i];
+    }
+    starts.swap(counts);
+    source.dontNeed(0, source.size());
+    target.dontNeed(0, target.size());
+  }
+
+  // The particles in index order, with the in-memory output layout
+  bool writeOutput(std::string const & filename, Header const & header,
+                   WritableMappedFile const & state, std::uint64_t count) {
+    WritableMappedFile output(filename, sizeof(Header) + count * sizeof(Particle));
+    if (!output.isOpen()) {
+      std::cerr << "Could not open output file: " << filename << '\n';
+      return false;
+    }
+    std::memcpy(output.data(), &header, sizeof(Header));
+    SlabRecord const * in = records(state);
+    for (std::uint64_t i = 0; i < count; ++i) {
+      std::memcpy(output.data() + sizeof(Header) + in[i].id * sizeof(Particle), &in[i].particle,
+                  sizeof(Particle));
+    }
+    return true;
+  }
+
+}  // namespace
+
+bool simulateOutOfCore(int iterations, std::string const & inputFile,
+                       std::string const & outputFile, ParticleParameters const & params,
+                       SimulationOptions const & options, StepProfile * profile,
+                       OutOfCoreStats & stats) {
+  const MappedFile input(inputFile);
+  if (!input.isOpen() || input.size() < FLD_HEADER_SIZE) {
+    std::cerr << "Could not open input file: " << inputFile << '\n';
+    return false;
+  }
+  Header header{};
+  std::memcpy(&header, input.data(), sizeof(Header));
+  const auto count = static_cast<std::uint32_t>(std::max(header.np, 0));
+  if (input.size() < FLD_HEADER_SIZE + count * FLD_RECORD_SIZE) {
+    std::cerr << "Error reading particles from file.\n";
+    return false;
+  }
+  std::string const prefix =
+      options.outOfCoreDirectory + "/fluid-" + std::to_string(getpid()) + "-";
+  const std::size_t bytes = count * sizeof(SlabRecord);
+  WritableMappedFile state(prefix + "state.slabs", bytes, true);
+  WritableMappedFile stepped(prefix + "stepped.slabs", bytes, true);
+  if (!state.isOpen() || !stepped.isOpen()) {
+    std::cerr << "Could not create working files in " << options.outOfCoreDirectory << '\n';
+    return false;
+  }
+
+  const SlabGrid slabs = makeSlabGrid(params, options.outOfCoreSlabCells);
+  stats.slabs          = slabs.slabs;
+  stats.slabCells      = slabs.slabCells;
+  stats.haloCells      = slabs.haloCells;
+  SlabStarts starts;
+  sortInput(input, count, slabs, state, starts);
+
+  SimulationOptions windowOptions = options;
+  windowOptions.sleepSteps        = 0;
+  windowOptions.temporalSteps     = 0;
+  StepWorkspace<FloatPrecision> workspace;
+  workspace.profile = profile;
+  SlabStarts counts;
+  for (int it = 0; it < iterations; ++it) {
+    stepSlabs(state, stepped, starts, slabs, params, windowOptions, workspace, counts, stats);
+    resortSlabs(stepped, state, slabs, starts, counts);
+  }
+  return writeOutput(outputFile, header, state, count);
+}
+
+void printOutOfCoreStats(OutOfCoreStats const & stats, std::uint64_t particles,
+                         std::ostream & output) {
+  const double redundant =
+      stats.ownedParticleSteps == 0
+          ? 0.0
+          : static_cast<double>(stats.windowParticleSteps) /
+                static_cast<double>(stats.ownedParticleSteps);
+  const double window = particles == 0 ? 0.0
+                                       : 100.0 * static_cast<double>(stats.largestWindow) /
+                                             static_cast<double>(particles);
+  output << "Out of core: " << stats.slabs << " slabs of " << stats.slabCells
+         << " cell rows, halo " << stats.haloCells << " rows, largest window "
+         << stats.largestWindow << " particles (" << std::fixed << std::setprecision(1) << window
+         << "%), " << std::setprecision(2) << redundant
+         << " particle updates computed per update kept, " << stats.movedBetweenSlabs
+         << " slab changes\n"
+         << std::defaultfloat;
+}
@@ -0,0 +1,51 @@
+// outofcore.hpp
+#pragma once
+
+#include "options.hpp"
+#include "particle.hpp"
+#include "profile.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Particle state of an out-of-core run: the particle and its index in the input file
+struct SlabRecord {
+    Particle particle;
+    std::uint32_t id;
+};
+
+// Work and memory of an out-of-core run
+struct OutOfCoreStats {
+    int slabs                         = 0;  // Slabs of cell rows along y
+    int slabCells                     = 0;  // Cell rows per slab
+    int haloCells                     = 0;  // Rows of each neighbouring slab in a window
+    std::uint64_t largestWindow       = 0;  // Particles stepped together
+    std::uint64_t windowParticleSteps = 0;  // Particle updates computed, halos included
+    std::uint64_t ownedParticleSteps  = 0;  // Particle updates kept
+    std::uint64_t movedBetweenSlabs   = 0;  // Particles re-sorted into another slab
+};
+
+// Whether runs with `options` keep the particles in working files instead of memory
+inline bool usesOutOfCore(SimulationOptions const & options) {
+  return !options.outOfCoreDirectory.empty();
+}
+
+// Runs `iterations` steps on particles that stay in a memory-mapped working file in
+// options.outOfCoreDirectory, sorted by slab: options.outOfCoreSlabCells cell rows along y.
+// A step walks the slabs in order with a sliding window of three of them in memory. Slab s is
+// stepped together with the rows of slabs s - 1 and s + 1 within two smoothing lengths, which
+// is all its particles read in a step, while a worker thread loads slab s + 2. The stepped
+// particles go to a second working file, and a sequential pass moves those that changed slab
+// back into slab order. Particles stay in index order within a slab, so every cell lists them
+// as the in-memory run does. The sleep and temporal blocking options, which keep state of the
+// whole grid, are ignored. The output file has the in-memory layout.
+bool simulateOutOfCore(int iterations, std::string const & inputFile,
+                       std::string const & outputFile, ParticleParameters const & params,
+                       SimulationOptions const & options, StepProfile * profile,
+                       OutOfCoreStats & stats);
+
+// One summary line of the slabs, windows and redundant work
+void printOutOfCoreStats(OutOfCoreStats const & stats, std::uint64_t particles,
+                         std::ostream & output);
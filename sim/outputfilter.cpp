@@ -0,0 +1,177 @@
+// outputfilter.cpp
+#include "outputfilter.hpp"
+
+#include "columnar.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+  bool inRegion(Particle const & particle, OutputFilter const & filter) {
+    return particle.px >= filter.regionMin[0] && particle.px <= filter.regionMax[0] &&
+           particle.py >= filter.regionMin[1] && particle.py <= filter.regionMax[1] &&
+           particle.pz >= filter.regionMin[2] && particle.pz <= filter.regionMax[2];
+  }
+
+  // Cells from the one holding the lower corner to the one holding the upper corner. Cells on
+  // the faces of the grid also hold the particles beyond them, so corners outside the domain
+  // map to those cells.
+  void visitRegionCells(CellList const & cells, OutputFilter const & filter,
+                        std::vector<std::uint32_t> & candidates) {
+    CellGrid const & grid = cells.grid;
+    Particle lower{};
+    lower.px = filter.regionMin[0];
+    lower.py = filter.regionMin[1];
+    lower.pz = filter.regionMin[2];
+    Particle upper{};
+    upper.px               = filter.regionMax[0];
+    upper.py               = filter.regionMax[1];
+    upper.pz               = filter.regionMax[2];
+    const CellOffset first = grid.locate(lower);
+    const CellOffset last  = grid.locate(upper);
+    for (int cz = first[2]; cz <= last[2]; ++cz) {
+      for (int cy = first[1]; cy <= last[1]; ++cy) {
+        for (int cx = first[0]; cx <= last[0]; ++cx) {
+          const std::uint64_t key = grid.cellIndex(cx, cy, cz);
+          std::size_t cell        = key;
+          if (cells.layout == CellLayout::hashed) {
+            const std::uint32_t found = cells.table.find(key);
+            if (found == CellHashTable::NO_CELL) { continue; }
+            cell = found;
+          }
+          for (std::uint32_t k = cells.cellStart[cell]; k < cells.cellStart[cell + 1]; ++k) {
+            candidates.push_back(cells.particleOrder[k]);
+          }
+        }
+      }
+    }
+  }
+
+}  // namespace
+
+std::vector<OutputColumn> selectedOutputColumns(OutputFields const & fields) {
+  std::vector<OutputColumn> columns;
+  for (OutputColumn const & column : OUTPUT_COLUMNS) {
+    if (fields.*column.field) { columns.push_back(column); }
+  }
+  return columns;
+}
+
+std::uint32_t outputFieldMask(OutputFields const & fields) {
+  std::uint32_t mask = 0;
+  for (OutputColumn const & column : OUTPUT_COLUMNS) {
+    if (fields.*column.field) { mask |= column.fieldBit; }
+  }
+  return mask;
+}
+
+OutputFields outputFieldsOfMask(std::uint32_t mask) {
+  OutputFields fields{false, false, false, false, false, false};
+  for (OutputColumn const & column : OUTPUT_COLUMNS) {
+    fields.*column.field = (mask & column.fieldBit) != 0;
+  }
+  return fields;
+}
+
+std::size_t outputRecordSize(OutputFields const & fields) {
+  return selectedOutputColumns(fields).size() * OUTPUT_COLUMN_BYTES;
+}
+
+std::vector<std::uint32_t> sampleOutputIndices(std::size_t count, OutputFilter const & filter) {
+  std::vector<std::uint32_t> indices;
+  if (filter.sampling == OutputSampling::stride) {
+    const auto stride = static_cast<std::size_t>(std::max(filter.stride, 1));
+    indices.reserve((count + stride - 1) / stride);
+    for (std::size_t i = 0; i < count; i += stride) {
+      indices.push_back(static_cast<std::uint32_t>(i));
+    }
+  } else if (filter.sampling == OutputSampling::random && filter.fraction < 1.0) {
+    if (filter.fraction <= 0.0) { return indices; }
+    indices.reserve(static_cast<std::size_t>(filter.fraction * static_cast<double>(count)));
+    std::mt19937_64 generator(filter.seed);
+    // Indices skipped before the next one kept
+    std::geometric_distribution<std::uint64_t> skip(filter.fraction);
+    for (std::uint64_t i = skip(generator); i < count; i += skip(generator) + 1) {
+      indices.push_back(static_cast<std::uint32_t>(i));
+    }
+  } else {
+    indices.resize(count);
+    for (std::size_t i = 0; i < count; ++i) { indices[i] = static_cast<std::uint32_t>(i); }
+  }
+  return indices;
+}
+
+std::vector<std::uint32_t> selectOutputParticles(std::vector<Particle> const & particles,
+                                                 CellList const & cells,
+                                                 OutputFilter const & filter) {
+  if (!filter.region) { return sampleOutputIndices(particles.size(), filter); }
+  std::vector<std::uint32_t> candidates;
+  visitRegionCells(cells, filter, candidates);
+  std::sort(candidates.begin(), candidates.end());
+  std::vector<std::uint32_t> sample;
+  if (filter.sampling == OutputSampling::random) {
+    sample = sampleOutputIndices(particles.size(), filter);
+  }
+  std::vector<std::uint32_t> indices;
+  for (const std::uint32_t i : candidates) {
+    if (!inRegion(particles[i], filter)) { continue; }
+    const bool sampled =
+        filter.sampling == OutputSampling::stride
+            ? i % static_cast<std::uint32_t>(std::max(filter.stride, 1)) == 0
+            : filter.sampling != OutputSampling::random ||
+                  std::binary_search(sample.begin(), sample.end(), i);
+    if (sampled) { indices.push_back(i); }
+  }
+  return indices;
+}
+
+bool writeSelectedParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            std::vector<std::uint32_t> const & indices,
+                            OutputFields const & fields) {
+  std::ofstream outFile(filename, std::ios::binary);
+  if (!outFile.is_open()) {
+    std::cerr << "Could not open output file: " << filename << '\n';
+    return false;
+  }
+  Header written = header;
+  written.np     = static_cast<int>(indices.size());
+  outFile.write(reinterpret_cast<char const *>(&written), sizeof(Header));
+
+  std::vector<OutputColumn> const columns = selectedOutputColumns(fields);
+  std::vector<char> buffer(indices.size() * columns.size() * OUTPUT_COLUMN_BYTES);
+  char * out = buffer.data();
+  for (const std::uint32_t i : indices) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const * particle = reinterpret_cast<char const *>(&particles[i]);
+    for (OutputColumn const & column : columns) {
+      std::memcpy(out, column.field == &OutputFields::id ? reinterpret_cast<char const *>(&i)
+                                                          : particle + column.member,
+                  OUTPUT_COLUMN_BYTES);
+      out += OUTPUT_COLUMN_BYTES;
+    }
+  }
+  outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  return outFile.good();
+}
+
+bool writeFilteredParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            ParticleParameters const & params, SimulationOptions const & options) {
+  CellList cells;
+  if (options.output.region) {
+    const CellLayout layout =
+        chooseCellLayout(cells, params.blockSize, params.blocks, particles.size(), options);
+    buildCellList(particles, params.blockSize, params.blocks, cells, layout);
+  }
+  std::vector<std::uint32_t> const indices =
+      selectOutputParticles(particles, cells, options.output);
+  if (options.output.layout == OutputLayout::columns) {
+    return writeColumnarParticles(filename, header, particles, indices, options.output.fields);
+  }
+  return writeSelectedParticles(filename, header, particles, indices, options.output.fields);
+}
@@ -0,0 +1,85 @@
+// outputfilter.hpp
+#pragma once
+
+#include "celllist.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whether `filter` writes anything but every field of every particle
+inline bool usesOutputFilter(OutputFilter const & filter) {
+  return filter.region || filter.sampling != OutputSampling::all ||
+         !(filter.fields == OutputFields{}) || filter.layout != OutputLayout::rows;
+}
+
+// Scalar column of an output record. Every column is 4 bytes: the id a uint32 and the rest
+// floats of Particle.
+struct OutputColumn {
+    char const * name;
+    bool OutputFields::*field;  // Field the column belongs to
+    std::uint32_t fieldBit;     // Bit of that field in a field mask
+    std::size_t member;         // Offset of the value in Particle; unused for id
+};
+
+// Every column in record order, id first
+inline constexpr std::array<OutputColumn, 14> OUTPUT_COLUMNS{{
+    {"id", &OutputFields::id, 32, 0},
+    {"px", &OutputFields::position, 1, offsetof(Particle, px)},
+    {"py", &OutputFields::position, 1, offsetof(Particle, py)},
+    {"pz", &OutputFields::position, 1, offsetof(Particle, pz)},
+    {"hvx", &OutputFields::halfVelocity, 2, offsetof(Particle, hvx)},
+    {"hvy", &OutputFields::halfVelocity, 2, offsetof(Particle, hvy)},
+    {"hvz", &OutputFields::halfVelocity, 2, offsetof(Particle, hvz)},
+    {"vx", &OutputFields::velocity, 4, offsetof(Particle, vx)},
+    {"vy", &OutputFields::velocity, 4, offsetof(Particle, vy)},
+    {"vz", &OutputFields::velocity, 4, offsetof(Particle, vz)},
+    {"rho", &OutputFields::density, 8, offsetof(Particle, rho)},
+    {"ax", &OutputFields::acceleration, 16, offsetof(Particle, ax)},
+    {"ay", &OutputFields::acceleration, 16, offsetof(Particle, ay)},
+    {"az", &OutputFields::acceleration, 16, offsetof(Particle, az)},
+}};
+
+constexpr std::size_t OUTPUT_COLUMN_BYTES = sizeof(float);
+
+static_assert(sizeof(std::uint32_t) == OUTPUT_COLUMN_BYTES);
+
+// Columns of `fields` in record order
+std::vector<OutputColumn> selectedOutputColumns(OutputFields const & fields);
+
+// Mask of the field bits of `fields`, and the fields of a mask
+std::uint32_t outputFieldMask(OutputFields const & fields);
+OutputFields outputFieldsOfMask(std::uint32_t mask);
+
+// Bytes of one output record holding `fields`
+std::size_t outputRecordSize(OutputFields const & fields);
+
+// Indices below `count` kept by the sampling of `filter`, in increasing order. The stride
+// steps over the indices and the random share jumps between them with geometric skips, so
+// both take time proportional to the indices kept. A seed always gives the same indices.
+std::vector<std::uint32_t> sampleOutputIndices(std::size_t count, OutputFilter const & filter);
+
+// Indices of the particles `filter` writes, in increasing order. A region is searched through
+// `cells`, binned from the current positions: only the cells overlapping the region are read
+// and only their particles are tested, so the work follows the size of the region.
+std::vector<std::uint32_t> selectOutputParticles(std::vector<Particle> const & particles,
+                                                 CellList const & cells,
+                                                 OutputFilter const & filter);
+
+// Writes the header, with the number of selected particles, and one record of `fields` for
+// each of them
+bool writeSelectedParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            std::vector<std::uint32_t> const & indices,
+                            OutputFields const & fields);
+
+// Output of a run with options.output: bins the particles when a region is set, then selects
+// them and writes them in the layout of the filter
+bool writeFilteredParticles(std::string const & filename, Header const & header,
+                            std::vector<Particle> const & particles,
+                            ParticleParameters const & params, SimulationOptions const & options);
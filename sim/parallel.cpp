@@ -0,0 +1,35 @@
+// parallel.cpp
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+IndexRange threadRange(std::size_t count, int thread, int threads) {
+  const auto total = static_cast<std::size_t>(std::max(threads, 1));
+  const auto index = static_cast<std::size_t>(thread);
+  const std::size_t chunk     = count / total;
+  const std::size_t remainder = count % total;
+  const std::size_t begin     = index * chunk + std::min(index, remainder);
+  return {begin, begin + chunk + (index < remainder ? 1 : 0)};
+}
+
+void runOnThreads(int threads, std::function<void(int)> const & body) {
+  if (threads <= 1) {
+    body(0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  workers.reserve(static_cast<std::size_t>(threads - 1));
+  for (int thread = 1; thread < threads; ++thread) { workers.emplace_back(body, thread); }
+  body(0);
+  for (auto & worker : workers) { worker.join(); }
+}
+
+void parallelFor(int threads, std::size_t count,
+                 std::function<void(std::size_t, std::size_t)> const & body) {
+  runOnThreads(threads, [&](int thread) {
+    const IndexRange range = threadRange(count, thread, threads);
+    if (range.begin < range.end) { body(range.begin, range.end); }
+  });
+}
@@ -0,0 +1,21 @@
+// parallel.hpp
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+struct IndexRange {
+    std::size_t begin;
+    std::size_t end;
+};
+
+// Contiguous share of [0, count) assigned to one of `threads` threads
+IndexRange threadRange(std::size_t count, int thread, int threads);
+
+// Runs body(thread) for thread = 0 .. threads - 1 and waits for all of them. The calling thread
+// runs thread 0; the others are started for this call only.
+void runOnThreads(int threads, std::function<void(int)> const & body);
+
+// Splits [0, count) into one contiguous range per thread and runs body(begin, end) on each
+void parallelFor(int threads, std::size_t count,
+                 std::function<void(std::size_t, std::size_t)> const & body);
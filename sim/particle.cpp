@@ -1,160 +1,295 @@
-// particle.cpp
-#include "particle.hpp"
-
-#include "block.hpp"
-#include "constants.hpp"
-#include "grid.hpp"
-
-#include <algorithm>
-#include <cmath>
-#include <limits>
-#include <thread>
-#include <vector>
-
-float calculateParticleMass(float density, float ppm) {
-  return density / (ppm * ppm * ppm);
-}
-
-float calculateSmoothingLength(float radiusMultiplier, float ppm) {
-  return radiusMultiplier / ppm;
-}
-
-GridSize calculateNumberOfBlocks(float height) {
-  GridSize blocks;
-  blocks.nx = std::floor((xmax - xmin) / height);
-  blocks.ny = std::floor((ymax - ymin) / height);
-  blocks.nz = std::floor((zmax - zmin) / height);
-  return blocks;
-}
-
-GridSize calculateBlockSize(GridSize blocks) {
-  GridSize blockSize;
-  blockSize.nx = (xmax - xmin) / blocks.nx;
-  blockSize.ny = (ymax - ymin) / blocks.ny;
-  blockSize.nz = (zmax - zmin) / blocks.nz;
-  return blockSize;
-}
-
-float calculateIncrementedDensity(Particle & parti, Particle & partj, float height) {
-  const float deltaX                       = parti.px - partj.px;
-  const float deltaY                       = parti.py - partj.py;
-  const float deltaZ                       = parti.pz - partj.pz;
-  const float distanceSquared              = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
-  const float hSquared                     = height * height;
-  const float hSquaredMinusDistanceSquared = hSquared - distanceSquared;
-
-  if (distanceSquared < hSquared) {
-    return hSquaredMinusDistanceSquared * hSquaredMinusDistanceSquared *
-           hSquaredMinusDistanceSquared;
-  }
-
-  return CERO;
-}
-
-void initializeDensitiesAndAccelerations(Particle & particle) {
-  particle.rho = 0;
-  particle.ax  = a_ext_x;
-  particle.ay  = a_ext_y;
-  particle.az  = a_ext_z;
-}
-
-void updateDensity(Particle & particle, Particle & particle2, float height) {
-  const float densityIncrement  = calculateIncrementedDensity(particle, particle2, height);
-  particle.rho           += densityIncrement;
-  particle2.rho          += densityIncrement;
-}
-
-void transformDensity(Particle & particle, float height, float mass) {
-  const float height_p6 = height * height * height * height * height * height;
-  const float height_p9 = height * height * height * height * height * height * height * height * height;
-  particle.rho    = (particle.rho + height_p6) *
-                 (STIFFNESS_CONSTANT / (DENSITY_MULTIPLIER * PI * height_p9)) * mass;
-}
-
-void updateAcceleration(Particle & pi, Particle & pj, float height, float mass) {
-  const float deltaX          = pi.px - pj.px;
-  const float deltaY          = pi.py - pj.py;
-  const float deltaZ          = pi.pz - pj.pz;
-  const float distanceSquared = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
-  const float hSquared        = height * height;
-
-  if (distanceSquared < hSquared && distanceSquared > SMALL_NUMBER * SMALL_NUMBER) {
-    const float distance            = std::sqrt(distanceSquared);
-    const float inverseDistance     = 1.0F / distance;
-    const float heightMinusDistance = height - distance;
-    const float commonTerm          = PRESSURE_TERM_CONSTANT / (PI * mass * ps);
-    const float pressureTerm  = commonTerm * heightMinusDistance * heightMinusDistance * inverseDistance;
-    const float viscosityTerm = VISCOSITY_CONSTANT / (PI * mu * mass) * inverseDistance * inverseDistance;
-    const float axIncrement   = deltaX * pressureTerm + (pj.vx - pi.vx) * viscosityTerm;
-    pi.ax             += axIncrement;
-    pj.ax             -= axIncrement;
-    const float ayIncrement  = deltaY * pressureTerm + (pj.vy - pi.vy) * viscosityTerm;
-    pi.ay             += ayIncrement;
-    pj.ay             -= ayIncrement;
-    const float azIncrement  = deltaZ * pressureTerm + (pj.vz - pi.vz) * viscosityTerm;
-    pi.az             += azIncrement;
-    pj.az             -= azIncrement;
-  }
-}
-
-bool checkCollision(float pos, float velocity, Bounds const & bounds, float dp) {
-  return (pos + velocity - dp < bounds.min) || (pos + velocity + dp > bounds.max);
-}
-
-void processCollisions(Particle & particle) {
-  const Bounds xBounds{xmin, xmax};
-  const Bounds yBounds{ymin, ymax};
-  const Bounds zBounds{zmin, zmax};
-  const CollisionInfo xCollisionInfo = {particle.px + particle.hvx * delta_t,
-                                  checkCollision(particle.px, particle.hvx * delta_t, xBounds, dp),
-                                  xBounds, 'x'};
-  const CollisionInfo yCollisionInfo = {particle.py + particle.hvy * delta_t,
-                                  checkCollision(particle.py, particle.hvy * delta_t, yBounds, dp),
-                                  yBounds, 'y'};
-  const CollisionInfo zCollisionInfo = {particle.pz + particle.hvz * delta_t,
-                                  checkCollision(particle.pz, particle.hvz * delta_t, zBounds, dp),
-                                  zBounds, 'z'};
-  if (xCollisionInfo.isCollision || yCollisionInfo.isCollision || zCollisionInfo.isCollision) {
-    processCollisionResponse(particle, xCollisionInfo, yCollisionInfo, zCollisionInfo);
-  }
-}
-
-void processCollisionResponse(Particle & particle, CollisionInfo const & xInfo,
-                              CollisionInfo const & yInfo, CollisionInfo const & zInfo) {
-  handleCollisionAxis(particle, xInfo);
-  handleCollisionAxis(particle, yInfo);
-  handleCollisionAxis(particle, zInfo);
-}
-
-void handleCollisionAxis(Particle & particle, CollisionInfo const & info) {
-  if (!info.isCollision) { return; }
-
-  const float boundary = info.isCollision ? info.bounds.min : info.bounds.max;
-  const float delta =
-      dp - (info.isCollision ? (info.newPos - info.bounds.min) : (info.bounds.max - info.newPos));
-  float & pos  = (info.axis == 'x') ? particle.px : (info.axis == 'y') ? particle.py : particle.pz;
-  float & vel  = (info.axis == 'x') ? particle.vx : (info.axis == 'y') ? particle.vy : particle.vz;
-  float & hvel = (info.axis == 'x')   ? particle.hvx
-                 : (info.axis == 'y') ? particle.hvy
-                                      : particle.hvz;
-  float & acc  = (info.axis == 'x') ? particle.ax : (info.axis == 'y') ? particle.ay : particle.az;
-
-  if (delta > SMALL_NUMBER) {
-    acc  += info.isCollision ? (sc * delta - dv * vel) : -(sc * delta + dv * vel);
-    pos   = boundary + (info.isCollision ? delta : -delta);
-    vel   = -vel;
-    hvel  = -hvel;
-  }
-}
-
-void updateParticleMotion(Particle & particle) {
-  particle.px  += particle.hvx * delta_t + HALF * particle.ax * delta_t * delta_t;
-  particle.py  += particle.hvy * delta_t + HALF * particle.ay * delta_t * delta_t;
-  particle.pz  += particle.hvz * delta_t + HALF * particle.az * delta_t * delta_t;
-  particle.vx   = particle.hvx + particle.ax * delta_t;
-  particle.vy   = particle.hvy + particle.ay * delta_t;
-  particle.vz   = particle.hvz + particle.az * delta_t;
-  particle.hvx += particle.ax * delta_t;
-  particle.hvy += particle.ay * delta_t;
-  particle.hvz += particle.az * delta_t;
-}
+// particle.cpp
+#include "particle.hpp"
+
+#include "block.hpp"
+#include "constants.hpp"
+#include "fastmath.hpp"
+#include "grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+float calculateParticleMass(float density, float ppm) {
+  return density / (ppm * ppm * ppm);
+}
+
+float calculateSmoothingLength(float radiusMultiplier, float ppm) {
+  return radiusMultiplier / ppm;
+}
+
+GridSize calculateNumberOfBlocks(float height) {
+  GridSize blocks;
+  blocks.nx = std::floor((xmax - xmin) / height);
+  blocks.ny = std::floor((ymax - ymin) / height);
+  blocks.nz = std::floor((zmax - zmin) / height);
+  return blocks;
+}
+
+GridSize calculateBlockSize(GridSize blocks) {
+  GridSize blockSize;
+  blockSize.nx = (xmax - xmin) / blocks.nx;
+  blockSize.ny = (ymax - ymin) / blocks.ny;
+  blockSize.nz = (zmax - zmin) / blocks.nz;
+  return blockSize;
+}
+
+template <typename T>
+PairGeometry<T> calculatePairGeometry(BasicParticle<T> const & pi, BasicParticle<T> const & pj) {
+  const T deltaX = pi.px - pj.px;
+  const T deltaY = pi.py - pj.py;
+  const T deltaZ = pi.pz - pj.pz;
+  return {deltaX, deltaY, deltaZ, deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ};
+}
+
+template <typename T>
+T calculateIncrementedDensity(BasicParticle<T> const & parti, BasicParticle<T> const & partj,
+                              T height) {
+  return calculateIncrementedDensity(calculatePairGeometry(parti, partj), height);
+}
+
+template <typename T>
+T calculateIncrementedDensity(PairGeometry<T> const & geometry, T height) {
+  const T distanceSquared              = geometry.distanceSquared;
+  const T hSquared                     = height * height;
+  const T hSquaredMinusDistanceSquared = hSquared - distanceSquared;
+
+  if (distanceSquared < hSquared) {
+    return hSquaredMinusDistanceSquared * hSquaredMinusDistanceSquared *
+           hSquaredMinusDistanceSquared;
+  }
+
+  return T{CERO};
+}
+
+template <typename T>
+T calculateTransformedDensity(T densitySum, T height, T mass) {
+  const T height_p6 = height * height * height * height * height * height;
+  const T height_p9 = height * height * height * height * height * height * height * height * height;
+  return (densitySum + height_p6) *
+         (static_cast<T>(STIFFNESS_CONSTANT) /
+          (static_cast<T>(DENSITY_MULTIPLIER) * static_cast<T>(PI) * height_p9)) *
+         mass;
+}
+
+template <typename T>
+bool calculateAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                    T height, T mass, std::array<T, 3> & increment) {
+  return calculateAccelerationIncrement(pi, pj, calculatePairGeometry(pi, pj), height, mass,
+                                        increment);
+}
+
+namespace {
+
+  // Acceleration increment of an in-range pair, with 1 / distance from a square root and a
+  // division or, when Fast, from fastInverseSqrt
+  template <bool Fast, typename T>
+  bool accelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                             PairGeometry<T> const & geometry, T height, T mass,
+                             std::array<T, 3> & increment) {
+    const T distanceSquared = geometry.distanceSquared;
+    const T hSquared        = height * height;
+    const T minimumDistance = static_cast<T>(SMALL_NUMBER);
+    const bool inRange =
+        distanceSquared < hSquared && distanceSquared > minimumDistance * minimumDistance;
+    if (!inRange) { return false; }
+    T distance        = 0;
+    T inverseDistance = 0;
+    if constexpr (Fast) {
+      inverseDistance = fastInverseSqrt(distanceSquared);
+      distance        = distanceSquared * inverseDistance;
+    } else {
+      distance        = std::sqrt(distanceSquared);
+      inverseDistance = T{1} / distance;
+    }
+    const T heightMinusDistance = height - distance;
+    const T commonTerm          = static_cast<T>(PRESSURE_TERM_CONSTANT) /
+                         (static_cast<T>(PI) * mass * static_cast<T>(ps));
+    const T pressureTerm = commonTerm * heightMinusDistance * heightMinusDistance * inverseDistance;
+    const T viscosityTerm = static_cast<T>(VISCOSITY_CONSTANT) /
+                            (static_cast<T>(PI) * static_cast<T>(mu) * mass) * inverseDistance *
+                            inverseDistance;
+    increment[0] = geometry.deltaX * pressureTerm + (pj.vx - pi.vx) * viscosityTerm;
+    increment[1] = geometry.deltaY * pressureTerm + (pj.vy - pi.vy) * viscosityTerm;
+    increment[2] = geometry.deltaZ * pressureTerm + (pj.vz - pi.vz) * viscosityTerm;
+    return true;
+  }
+
+}  // namespace
+
+template <typename T>
+bool calculateAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                    PairGeometry<T> const & geometry, T height, T mass,
+                                    std::array<T, 3> & increment) {
+  return accelerationIncrement<false>(pi, pj, geometry, height, mass, increment);
+}
+
+template <typename T>
+bool calculateFastAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                        T height, T mass, std::array<T, 3> & increment) {
+  return accelerationIncrement<true>(pi, pj, calculatePairGeometry(pi, pj), height, mass,
+                                     increment);
+}
+
+template <typename T>
+bool calculateFastAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                        PairGeometry<T> const & geometry, T height, T mass,
+                                        std::array<T, 3> & increment) {
+  return accelerationIncrement<true>(pi, pj, geometry, height, mass, increment);
+}
+
+void initializeDensitiesAndAccelerations(Particle & particle) {
+  particle.rho = 0;
+  particle.ax  = a_ext_x;
+  particle.ay  = a_ext_y;
+  particle.az  = a_ext_z;
+}
+
+void updateDensity(Particle & particle, Particle & particle2, float height) {
+  const float densityIncrement  = calculateIncrementedDensity(particle, particle2, height);
+  particle.rho           += densityIncrement;
+  particle2.rho          += densityIncrement;
+}
+
+void transformDensity(Particle & particle, float height, float mass) {
+  particle.rho = calculateTransformedDensity(particle.rho, height, mass);
+}
+
+void updateAcceleration(Particle & pi, Particle & pj, float height, float mass) {
+  std::array<float, 3> increment{};
+  if (calculateAccelerationIncrement(pi, pj, height, mass, increment)) {
+    pi.ax += increment[0];
+    pj.ax -= increment[0];
+    pi.ay += increment[1];
+    pj.ay -= increment[1];
+    pi.az += increment[2];
+    pj.az -= increment[2];
+  }
+}
+
+template <typename T>
+bool checkCollision(T pos, T velocity, BasicBounds<T> const & bounds, T dp) {
+  return (pos + velocity - dp < bounds.min) || (pos + velocity + dp > bounds.max);
+}
+
+template <typename T>
+void processCollisions(BasicParticle<T> & particle) {
+  const T step = static_cast<T>(delta_t);
+  const T penetration = static_cast<T>(dp);
+  const BasicBounds<T> xBounds{static_cast<T>(xmin), static_cast<T>(xmax)};
+  const BasicBounds<T> yBounds{static_cast<T>(ymin), static_cast<T>(ymax)};
+  const BasicBounds<T> zBounds{static_cast<T>(zmin), static_cast<T>(zmax)};
+  const BasicCollisionInfo<T> xCollisionInfo = {
+    particle.px + particle.hvx * step,
+    checkCollision(particle.px, particle.hvx * step, xBounds, penetration), xBounds, 'x'};
+  const BasicCollisionInfo<T> yCollisionInfo = {
+    particle.py + particle.hvy * step,
+    checkCollision(particle.py, particle.hvy * step, yBounds, penetration), yBounds, 'y'};
+  const BasicCollisionInfo<T> zCollisionInfo = {
+    particle.pz + particle.hvz * step,
+    checkCollision(particle.pz, particle.hvz * step, zBounds, penetration), zBounds, 'z'};
+  if (xCollisionInfo.isCollision || yCollisionInfo.isCollision || zCollisionInfo.isCollision) {
+    processCollisionResponse(particle, xCollisionInfo, yCollisionInfo, zCollisionInfo);
+  }
+}
+
+template <typename T>
+void processCollisionResponse(BasicParticle<T> & particle, BasicCollisionInfo<T> const & xInfo,
+                              BasicCollisionInfo<T> const & yInfo,
+                              BasicCollisionInfo<T> const & zInfo) {
+  handleCollisionAxis(particle, xInfo);
+  handleCollisionAxis(particle, yInfo);
+  handleCollisionAxis(particle, zInfo);
+}
+
+template <typename T>
+void handleCollisionAxis(BasicParticle<T> & particle, BasicCollisionInfo<T> const & info) {
+  if (!info.isCollision) { return; }
+
+  const T penetration = static_cast<T>(dp);
+  const T boundary    = info.isCollision ? info.bounds.min : info.bounds.max;
+  const T delta       = penetration - (info.isCollision ? (info.newPos - info.bounds.min)
+                                                        : (info.bounds.max - info.newPos));
+  T & pos  = (info.axis == 'x') ? particle.px : (info.axis == 'y') ? particle.py : particle.pz;
+  T & vel  = (info.axis == 'x') ? particle.vx : (info.axis == 'y') ? particle.vy : particle.vz;
+  T & hvel = (info.axis == 'x')   ? particle.hvx
+             : (info.axis == 'y') ? particle.hvy
+                                  : particle.hvz;
+  T & acc  = (info.axis == 'x') ? particle.ax : (info.axis == 'y') ? particle.ay : particle.az;
+
+  if (delta > static_cast<T>(SMALL_NUMBER)) {
+    const T spring  = static_cast<T>(sc);
+    const T damping = static_cast<T>(dv);
+    acc  += info.isCollision ? (spring * delta - damping * vel) : -(spring * delta + damping * vel);
+    pos   = boundary + (info.isCollision ? delta : -delta);
+    vel   = -vel;
+    hvel  = -hvel;
+  }
+}
+
+template <typename T>
+void updateParticleMotion(BasicParticle<T> & particle) {
+  const T step = static_cast<T>(delta_t);
+  const T half = static_cast<T>(HALF);
+  particle.px  += particle.hvx * step + half * particle.ax * step * step;
+  particle.py  += particle.hvy * step + half * particle.ay * step * step;
+  particle.pz  += particle.hvz * step + half * particle.az * step * step;
+  particle.vx   = particle.hvx + particle.ax * step;
+  particle.vy   = particle.hvy + particle.ay * step;
+  particle.vz   = particle.hvz + particle.az * step;
+  particle.hvx += particle.ax * step;
+  particle.hvy += particle.ay * step;
+  particle.hvz += particle.az * step;
+}
+
+template bool checkCollision<float>(float, float, Bounds const &, float);
+template bool checkCollision<double>(double, double, BasicBounds<double> const &, double);
+template void processCollisions<float>(Particle &);
+template void processCollisions<double>(BasicParticle<double> &);
+template void processCollisionResponse<float>(Particle &, CollisionInfo const &,
+                                              CollisionInfo const &, CollisionInfo const &);
+template void processCollisionResponse<double>(BasicParticle<double> &,
+                                               BasicCollisionInfo<double> const &,
+                                               BasicCollisionInfo<double> const &,
+                                               BasicCollisionInfo<double> const &);
+template void handleCollisionAxis<float>(Particle &, CollisionInfo const &);
+template void handleCollisionAxis<double>(BasicParticle<double> &,
+                                          BasicCollisionInfo<double> const &);
+template void updateParticleMotion<float>(Particle &);
+template void updateParticleMotion<double>(BasicParticle<double> &);
+template float calculateIncrementedDensity<float>(Particle const &, Particle const &, float);
+template double calculateIncrementedDensity<double>(BasicParticle<double> const &,
+                                                    BasicParticle<double> const &, double);
+template float calculateTransformedDensity<float>(float, float, float);
+template double calculateTransformedDensity<double>(double, double, double);
+template bool calculateAccelerationIncrement<float>(Particle const &, Particle const &, float,
+                                                    float, std::array<float, 3> &);
+template bool calculateAccelerationIncrement<double>(BasicParticle<double> const &,
+                                                     BasicParticle<double> const &, double,
+                                                     double, std::array<double, 3> &);
+template PairGeometry<float> calculatePairGeometry<float>(Particle const &, Particle const &);
+template PairGeometry<double> calculatePairGeometry<double>(BasicParticle<double> const &,
+                                                           BasicParticle<double> const &);
+template float calculateIncrementedDensity<float>(PairGeometry<float> const &, float);
+template double calculateIncrementedDensity<double>(PairGeometry<double> const &, double);
+template bool calculateAccelerationIncrement<float>(Particle const &, Particle const &,
+                                                    PairGeometry<float> const &, float, float,
+                                                    std::array<float, 3> &);
+template bool calculateAccelerationIncrement<double>(BasicParticle<double> const &,
+                                                     BasicParticle<double> const &,
+                                                     PairGeometry<double> const &, double, double,
+                                                     std::array<double, 3> &);
+template bool calculateFastAccelerationIncrement<float>(Particle const &, Particle const &,
+                                                        PairGeometry<float> const &, float, float,
+                                                        std::array<float, 3> &);
+template bool calculateFastAccelerationIncrement<double>(BasicParticle<double> const &,
+                                                         BasicParticle<double> const &,
+                                                         PairGeometry<double> const &, double,
+                                                         double, std::array<double, 3> &);
+template bool calculateFastAccelerationIncrement<float>(Particle const &, Particle const &, float,
+                                                        float, std::array<float, 3> &);
+template bool calculateFastAccelerationIncrement<double>(BasicParticle<double> const &,
+                                                         BasicParticle<double> const &, double,
+                                                         double, std::array<double, 3> &);
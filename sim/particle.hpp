@@ -1,62 +1,118 @@
-// particle.hpp
-#pragma once
-#include "constants.hpp"
-#include "grid.hpp"
-
-#include <vector>
-
-struct Header {
-    float ppm;
-    int np;
-};
-
-struct Particle {
-    float px, py, pz;
-    float hvx, hvy, hvz;
-    float vx, vy, vz;
-    float rho;
-    float ax, ay, az;
-};
-
-struct ParticlePair {
-    Particle * pi;
-    Particle * pj;
-};
-
-struct DeltaValues {
-    float deltaX;
-    float deltaY;
-    float deltaZ;
-    float deltaVX;
-    float deltaVY;
-    float deltaVZ;
-};
-
-struct Bounds {
-    float min;
-    float max;
-};
-
-struct CollisionInfo {
-    float newPos;
-    bool isCollision;
-    Bounds bounds;
-    char axis;
-};
-
-float calculateParticleMass(float density, float ppm);
-float calculateSmoothingLength(float radiusMultiplier, float ppm);
-GridSize calculateNumberOfBlocks(float height);
-GridSize calculateBlockSize(GridSize blocks);
-float calculateIncrementedDensity(Particle & parti, Particle & partj, float height);
-void initializeDensitiesAndAccelerations(Particle & particle);
-void updateDensity(Particle & particle, Particle & particle2, float height);
-void transformDensity(Particle & particle, float height, float mass);
-void calculateTerms(ParticlePair & pair, DeltaValues & deltas, float height, float mass);
-void updateAcceleration(Particle & pi, Particle & pj, float height, float mass);
-bool checkCollision(float pos, float velocity, Bounds const & bounds, float dp);
-void processCollisions(Particle & particle);
-void processCollisionResponse(Particle & particle, CollisionInfo const & xInfo,
-                              CollisionInfo const & yInfo, CollisionInfo const & zInfo);
-void handleCollisionAxis(Particle & particle, CollisionInfo const & info);
-void updateParticleMotion(Particle & particle);
+// particle.hpp
+#pragma once
+#include "constants.hpp"
+#include "grid.hpp"
+
+#include <array>
+#include <vector>
+
+struct Header {
+    float ppm;
+    int np;
+};
+
+// Particle state; the storage type is chosen by the precision policy (precision.hpp)
+template <typename T>
+struct BasicParticle {
+    T px, py, pz;
+    T hvx, hvy, hvz;
+    T vx, vy, vz;
+    T rho;
+    T ax, ay, az;
+};
+
+using Particle = BasicParticle<float>;
+
+struct ParticlePair {
+    Particle * pi;
+    Particle * pj;
+};
+
+struct DeltaValues {
+    float deltaX;
+    float deltaY;
+    float deltaZ;
+    float deltaVX;
+    float deltaVY;
+    float deltaVZ;
+};
+
+// Separation pi - pj of a pair, shared by its density and acceleration terms
+template <typename T>
+struct PairGeometry {
+    T deltaX, deltaY, deltaZ;
+    T distanceSquared;
+};
+
+template <typename T>
+struct BasicBounds {
+    T min;
+    T max;
+};
+
+using Bounds = BasicBounds<float>;
+
+template <typename T>
+struct BasicCollisionInfo {
+    T newPos;
+    bool isCollision;
+    BasicBounds<T> bounds;
+    char axis;
+};
+
+using CollisionInfo = BasicCollisionInfo<float>;
+
+float calculateParticleMass(float density, float ppm);
+float calculateSmoothingLength(float radiusMultiplier, float ppm);
+GridSize calculateNumberOfBlocks(float height);
+GridSize calculateBlockSize(GridSize blocks);
+
+// Pair kernels, instantiated for float and double in particle.cpp
+template <typename T>
+PairGeometry<T> calculatePairGeometry(BasicParticle<T> const & pi, BasicParticle<T> const & pj);
+template <typename T>
+T calculateIncrementedDensity(BasicParticle<T> const & parti, BasicParticle<T> const & partj,
+                              T height);
+// Same from a precomputed geometry, bit-identical to the overload above
+template <typename T>
+T calculateIncrementedDensity(PairGeometry<T> const & geometry, T height);
+template <typename T>
+T calculateTransformedDensity(T densitySum, T height, T mass);
+// Acceleration pj exerts on pi (pj receives the opposite); false when out of range
+template <typename T>
+bool calculateAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                    T height, T mass, std::array<T, 3> & increment);
+// Same with the separation of pi and pj already computed; only the velocities are read
+template <typename T>
+bool calculateAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                    PairGeometry<T> const & geometry, T height, T mass,
+                                    std::array<T, 3> & increment);
+// Both forms with 1 / distance from fastInverseSqrt (fastmath.hpp) instead of a square root and
+// a division; every term within a few FAST_INVERSE_SQRT_ERROR of the precise one
+template <typename T>
+bool calculateFastAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                        T height, T mass, std::array<T, 3> & increment);
+template <typename T>
+bool calculateFastAccelerationIncrement(BasicParticle<T> const & pi, BasicParticle<T> const & pj,
+                                        PairGeometry<T> const & geometry, T height, T mass,
+                                        std::array<T, 3> & increment);
+
+void initializeDensitiesAndAccelerations(Particle & particle);
+void updateDensity(Particle & particle, Particle & particle2, float height);
+void transformDensity(Particle & particle, float height, float mass);
+void calculateTerms(ParticlePair & pair, DeltaValues & deltas, float height, float mass);
+void updateAcceleration(Particle & pi, Particle & pj, float height, float mass);
+
+// Collisions and motion, instantiated for float and double storage in particle.cpp
+template <typename T>
+bool checkCollision(T pos, T velocity, BasicBounds<T> const & bounds, T dp);
+template <typename T>
+void processCollisions(BasicParticle<T> & particle);
+template <typename T>
+void processCollisionResponse(BasicParticle<T> & particle, BasicCollisionInfo<T> const & xInfo,
+                              BasicCollisionInfo<T> const & yInfo,
+                              BasicCollisionInfo<T> const & zInfo);
+template <typename T>
+void handleCollisionAxis(BasicParticle<T> & particle, BasicCollisionInfo<T> const & info);
+template <typename T>
+void updateParticleMotion(BasicParticle<T> & particle);
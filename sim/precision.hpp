@@ -0,0 +1,14 @@
+// precision.hpp
+#pragma once
+
+// Precision policy: type used to store particle state and type used to accumulate the
+// density and acceleration sums over neighbours
+template <typename StorageType, typename AccumulatorType>
+struct PrecisionPolicy {
+    using storage_type     = StorageType;
+    using accumulator_type = AccumulatorType;
+};
+
+using FloatPrecision  = PrecisionPolicy<float, float>;  // Fast path, used by runSimulation
+using MixedPrecision  = PrecisionPolicy<float, double>;
+using DoublePrecision = PrecisionPolicy<double, double>;
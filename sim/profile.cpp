@@ -0,0 +1,288 @@
+// profile.cpp
+#include "profile.hpp"
+
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+  struct EventConfig {
+      std::uint32_t type;
+      std::uint64_t config;
+  };
+
+  constexpr std::array<EventConfig, PERF_EVENT_COUNT> EVENT_CONFIGS = {
+    {{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+     {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)}}
+  };
+
+  constexpr std::array<char const *, STEP_PHASE_COUNT> PHASE_NAMES = {
+    "reposition", "binning", "densities", "transform", "accelerations", "motion", "phase graph"};
+
+  constexpr double CACHE_LINE_BYTES = 64.0;
+  constexpr double BYTES_PER_MB     = 1024.0 * 1024.0;
+  constexpr double BYTES_PER_GB     = 1e9;
+  // Full passes over the simulation arrays in one step: reposition, binning, both pair passes,
+  // density transform and motion
+  constexpr double ARRAY_SWEEPS_PER_STEP = 6.0;
+
+  // Counts user-space events of this thread and, through inherit, of the threads it creates
+  // after opening; their counts are added when they exit
+  int openCounter(EventConfig const & event) {
+    perf_event_attr attr{};
+    attr.size           = sizeof(attr);
+    attr.type           = event.type;
+    attr.config         = event.config;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  std::size_t eventIndex(PerfEvent event) {
+    return static_cast<std::size_t>(event);
+  }
+
+  // Busy time of each thread in the neighbour passes and max / mean, 1.00 being perfect balance
+  void printThreadLoad(std::vector<ThreadLoad> const & loads, std::ostream & output) {
+    if (loads.empty()) { return; }
+    double total   = 0.0;
+    double busiest = 0.0;
+    output << "Neighbour pass load:\n"
+           << std::setw(8) << "thread" << std::setw(12) << "busy (s)" << std::setw(10) << "tasks"
+           << std::setw(10) << "steals" << '\n';
+    for (std::size_t thread = 0; thread < loads.size(); ++thread) {
+      ThreadLoad const & load = loads[thread];
+      output << std::setw(8) << thread << std::setw(12) << std::setprecision(6)
+             << load.busySeconds << std::setw(10) << load.tasks << std::setw(10) << load.steals
+             << '\n';
+      total   += load.busySeconds;
+      busiest  = std::max(busiest, load.busySeconds);
+    }
+    const double mean = total / static_cast<double>(loads.size());
+    output << "Imbalance (max / mean busy time): " << std::setprecision(2)
+           << (mean > 0.0 ? busiest / mean : 1.0) << '\n';
+  }
+
+  // Memory of each node and its share of the step traffic. The traffic is the measured LLC
+  // misses when available and ARRAY_SWEEPS_PER_STEP passes over the arrays otherwise; either
+  // way it is split between nodes in proportion to the pages they hold.
+  void printNodeTraffic(StepProfile const & profile, std::ostream & output) {
+    std::vector<std::uint64_t> const & residency = profile.nodeResidency();
+    if (residency.empty()) { return; }
+    double seconds = 0.0;
+    double misses  = 0.0;
+    for (std::size_t index = 0; index < STEP_PHASE_COUNT; ++index) {
+      PhaseTotals const & totals  = profile.totals(static_cast<StepPhase>(index));
+      seconds                    += totals.seconds;
+      misses += static_cast<double>(totals.events[eventIndex(PerfEvent::llcMisses)]);
+    }
+    double resident = 0.0;
+    for (const std::uint64_t bytes : residency) { resident += static_cast<double>(bytes); }
+    const bool measured  = profile.countersAvailable(PerfEvent::llcMisses);
+    const double steps   = static_cast<double>(profile.totals(StepPhase::reposition).calls);
+    const double traffic = measured ? misses * CACHE_LINE_BYTES
+                                    : resident * steps * ARRAY_SWEEPS_PER_STEP;
+    output << "Memory per NUMA node (bandwidth "
+           << (measured ? "from LLC misses" : "estimated from array sweeps") << "):\n"
+           << std::setw(8) << "node" << std::setw(14) << "resident MB" << std::setw(10) << "GB/s"
+           << '\n';
+    for (std::size_t node = 0; node < residency.size(); ++node) {
+      const auto bytes   = static_cast<double>(residency[node]);
+      const double share = resident > 0.0 ? bytes / resident : 0.0;
+      output << std::setw(8) << node << std::setw(14) << std::setprecision(2)
+             << bytes / BYTES_PER_MB << std::setw(10)
+             << (seconds > 0.0 ? traffic * share / seconds / BYTES_PER_GB : 0.0) << '\n';
+    }
+    output << "Huge pages in use: "
+           << static_cast<double>(profile.hugePageResidency()) / BYTES_PER_MB << " MB\n";
+  }
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  for (std::size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+    descriptors[event] = openCounter(EVENT_CONFIGS[event]);
+    if (descriptors[event] < 0 && reason.empty()) {
+      reason = std::string("perf_event_open: ") + std::strerror(errno);
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (const int descriptor : descriptors) {
+    if (descriptor >= 0) { close(descriptor); }
+  }
+}
+
+bool PerfCounters::available(PerfEvent event) const {
+  return descriptors[eventIndex(event)] >= 0;
+}
+
+bool PerfCounters::anyAvailable() const {
+  for (const int descriptor : descriptors) {
+    if (descriptor >= 0) { return true; }
+  }
+  return false;
+}
+
+PerfValues PerfCounters::read() const {
+  PerfValues values{};
+  for (std::size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+    if (descriptors[event] < 0) { continue; }
+    std::uint64_t value = 0;
+    if (::read(descriptors[event], &value, sizeof(value)) == sizeof(value)) {
+      values[event] = value;
+    }
+  }
+  return values;
+}
+
+StepProfile::StepProfile(bool useCounters) : useCounters(useCounters) { }
+
+void StepProfile::attach(ThreadPool & workers) {
+  if (!useCounters || (pool == &workers && poolSerial == workers.id())) { return; }
+  pool       = &workers;
+  poolSerial = workers.id();
+  workerCounters.clear();
+  workerCounters.resize(static_cast<std::size_t>(workers.size()));
+  workerValues.assign(workerCounters.size(), PerfValues{});
+  workers.run([&](int thread) {
+    if (thread > 0) {
+      workerCounters[static_cast<std::size_t>(thread)] = std::make_unique<PerfCounters>();
+    }
+  });
+}
+
+PerfValues StepProfile::read() {
+  PerfValues values = counters.read();
+  if (pool == nullptr || pool->size() <= 1) { return values; }
+  pool->run([&](int thread) {
+    if (thread > 0) {
+      const auto index    = static_cast<std::size_t>(thread);
+      workerValues[index] = workerCounters[index]->read();
+    }
+  });
+  for (PerfValues const & worker : workerValues) {
+    for (std::size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+      values[event] += worker[event];
+    }
+  }
+  return values;
+}
+
+void StepProfile::begin(StepPhase /*phase*/) {
+  if (useCounters) { startValues = read(); }
+  phaseStart = std::chrono::steady_clock::now();
+}
+
+void StepProfile::end(StepPhase phase) {
+  const auto finish    = std::chrono::steady_clock::now();
+  PhaseTotals & totals = phases[static_cast<std::size_t>(phase)];
+  totals.seconds       += std::chrono::duration<double>(finish - phaseStart).count();
+  ++totals.calls;
+  if (useCounters) {
+    const PerfValues values = read();
+    for (std::size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+      totals.events[event] += values[event] - startValues[event];
+    }
+  }
+}
+
+void StepProfile::recordLoad(std::vector<ThreadLoad> const & load) {
+  if (loads.size() < load.size()) { loads.resize(load.size()); }
+  for (std::size_t thread = 0; thread < load.size(); ++thread) {
+    loads[thread].busySeconds += load[thread].busySeconds;
+    loads[thread].tasks       += load[thread].tasks;
+    loads[thread].steals      += load[thread].steals;
+  }
+}
+
+bool StepProfile::countersAvailable(PerfEvent event) const {
+  return useCounters && counters.available(event);
+}
+
+std::string StepProfile::unavailableReason() const {
+  if (!useCounters) { return "disabled"; }
+  return counters.unavailableReason();
+}
+
+PhaseScope::PhaseScope(StepProfile * profile, StepPhase phase) : profile(profile), phase(phase) {
+  if (profile != nullptr) { profile->begin(phase); }
+}
+
+PhaseScope::~PhaseScope() {
+  if (profile != nullptr) { profile->end(phase); }
+}
+
+char const * phaseName(StepPhase phase) {
+  return PHASE_NAMES[static_cast<std::size_t>(phase)];
+}
+
+void printStepProfile(StepProfile const & profile, std::ostream & output) {
+  const auto column = [&](PerfEvent event, PhaseTotals const & totals, int width) {
+    output << std::setw(width);
+    if (profile.countersAvailable(event)) {
+      output << totals.events[eventIndex(event)];
+    } else {
+      output << "n/a";
+    }
+  };
+
+  output << "Phase profile:\n"
+         << std::left << std::setw(15) << "phase" << std::right << std::setw(7) << "calls"
+         << std::setw(12) << "time (s)" << std::setw(16) << "cycles" << std::setw(16)
+         << "instructions" << std::setw(7) << "IPC" << std::setw(14) << "LLC misses"
+         << std::setw(11) << "LLC MB" << std::setw(14) << "branch miss" << std::setw(14)
+         << "dTLB miss" << '\n';
+  for (std::size_t index = 0; index < STEP_PHASE_COUNT; ++index) {
+    const auto phase           = static_cast<StepPhase>(index);
+    PhaseTotals const & totals = profile.totals(phase);
+    output << std::left << std::setw(15) << phaseName(phase) << std::right << std::setw(7)
+           << totals.calls << std::setw(12) << std::fixed << std::setprecision(6)
+           << totals.seconds;
+    column(PerfEvent::cycles, totals, 16);
+    column(PerfEvent::instructions, totals, 16);
+    output << std::setw(7) << std::setprecision(2);
+    const auto cycles = totals.events[eventIndex(PerfEvent::cycles)];
+    if (profile.countersAvailable(PerfEvent::cycles) &&
+        profile.countersAvailable(PerfEvent::instructions) && cycles > 0) {
+      output << static_cast<double>(totals.events[eventIndex(PerfEvent::instructions)]) /
+                    static_cast<double>(cycles);
+    } else {
+      output << "n/a";
+    }
+    column(PerfEvent::llcMisses, totals, 14);
+    output << std::setw(11);
+    if (profile.countersAvailable(PerfEvent::llcMisses)) {
+      output << static_cast<double>(totals.events[eventIndex(PerfEvent::llcMisses)]) *
+                    CACHE_LINE_BYTES / BYTES_PER_MB;
+    } else {
+      output << "n/a";
+    }
+    column(PerfEvent::branchMisses, totals, 14);
+    column(PerfEvent::dtlbMisses, totals, 14);
+    output << '\n';
+  }
+  printThreadLoad(profile.threadLoad(), output);
+  printNodeTraffic(profile, output);
+  output << std::defaultfloat;
+  for (std::size_t event = 0; event < PERF_EVENT_COUNT; ++event) {
+    if (!profile.countersAvailable(static_cast<PerfEvent>(event))) {
+      output << "Some hardware counters are unavailable (" << profile.unavailableReason()
+             << "), reported as n/a\n";
+      break;
+    }
+  }
+}
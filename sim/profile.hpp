@@ -0,0 +1,141 @@
+// profile.hpp
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+enum class PerfEvent { cycles, instructions, llcMisses, branchMisses, dtlbMisses };
+constexpr std::size_t PERF_EVENT_COUNT = 5;
+
+using PerfValues = std::array<std::uint64_t, PERF_EVENT_COUNT>;
+
+// Hardware counters of the calling thread and of the threads it starts afterwards, read with
+// perf_event_open. Counters the kernel refuses (containers, perf_event_paranoid, virtual
+// machines without a PMU) are reported as unavailable instead of failing the run.
+class PerfCounters {
+  public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(PerfCounters const &)             = delete;
+    PerfCounters & operator=(PerfCounters const &) = delete;
+    PerfCounters(PerfCounters &&)                  = delete;
+    PerfCounters & operator=(PerfCounters &&)      = delete;
+
+    [[nodiscard]] bool available(PerfEvent event) const;
+    [[nodiscard]] bool anyAvailable() const;
+    [[nodiscard]] std::string const & unavailableReason() const { return reason; }
+
+    [[nodiscard]] PerfValues read() const;
+
+  private:
+    std::array<int, PERF_EVENT_COUNT> descriptors{};
+    std::string reason;
+};
+
+// phaseGraph covers densities to motion when CellSchedule::graph overlaps them
+enum class StepPhase {
+  reposition,
+  binning,
+  densities,
+  densityTransform,
+  accelerations,
+  motion,
+  phaseGraph
+};
+constexpr std::size_t STEP_PHASE_COUNT = 7;
+
+struct PhaseTotals {
+    double seconds      = 0.0;
+    std::uint64_t calls = 0;
+    PerfValues events{};
+};
+
+// Work done by one thread in the scheduled neighbour passes
+struct ThreadLoad {
+    double busySeconds   = 0.0;
+    std::uint64_t tasks  = 0;
+    std::uint64_t steals = 0;
+};
+
+// Wall time and counter deltas accumulated per step phase over a run
+class StepProfile {
+  public:
+    explicit StepProfile(bool useCounters = true);
+
+    // Opens counters on the workers of `pool`, which are then added to every phase. Workers of
+    // a persistent pool never exit, so inherited counters alone would miss their events.
+    void attach(ThreadPool & pool);
+
+    void begin(StepPhase phase);
+    void end(StepPhase phase);
+
+    [[nodiscard]] PhaseTotals const & totals(StepPhase phase) const {
+      return phases[static_cast<std::size_t>(phase)];
+    }
+
+    // Adds the per-thread load of a step; the list grows to the largest thread count seen
+    void recordLoad(std::vector<ThreadLoad> const & load);
+
+    [[nodiscard]] std::vector<ThreadLoad> const & threadLoad() const { return loads; }
+
+    // Resident bytes of the simulation arrays on each NUMA node and bytes of the process
+    // backed by huge pages, at the end of the run
+    void recordResidency(std::vector<std::uint64_t> const & bytesPerNode,
+                         std::uint64_t hugePageBytes) {
+      residency = bytesPerNode;
+      hugeBytes = hugePageBytes;
+    }
+
+    [[nodiscard]] std::uint64_t hugePageResidency() const { return hugeBytes; }
+
+    [[nodiscard]] std::vector<std::uint64_t> const & nodeResidency() const { return residency; }
+
+    [[nodiscard]] bool countersAvailable(PerfEvent event) const;
+    [[nodiscard]] std::string unavailableReason() const;
+
+  private:
+    bool useCounters;
+    PerfValues read();
+
+    PerfCounters counters;
+    ThreadPool * pool        = nullptr;
+    std::uint64_t poolSerial = 0;
+    std::vector<std::unique_ptr<PerfCounters>> workerCounters;
+    std::vector<PerfValues> workerValues;
+    std::array<PhaseTotals, STEP_PHASE_COUNT> phases{};
+    std::vector<ThreadLoad> loads;
+    std::vector<std::uint64_t> residency;
+    std::uint64_t hugeBytes = 0;
+    std::chrono::steady_clock::time_point phaseStart;
+    PerfValues startValues{};
+};
+
+// Measures one phase for the lifetime of the scope; does nothing without a profile
+class PhaseScope {
+  public:
+    PhaseScope(StepProfile * profile, StepPhase phase);
+    ~PhaseScope();
+    PhaseScope(PhaseScope const &)             = delete;
+    PhaseScope & operator=(PhaseScope const &) = delete;
+    PhaseScope(PhaseScope &&)                  = delete;
+    PhaseScope & operator=(PhaseScope &&)      = delete;
+
+  private:
+    StepProfile * profile;
+    StepPhase phase;
+};
+
+char const * phaseName(StepPhase phase);
+
+// Table with time, cycles, instructions, IPC, LLC misses (and the bytes they move, one cache
+// line each), branch misses and data TLB load misses per phase, followed by the load of each thread and the memory
+// of each NUMA node when recorded
+void printStepProfile(StepProfile const & profile, std::ostream & output);
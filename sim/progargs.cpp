@@ -1,93 +1,567 @@
-// progargs.cpp
-#include "progargs.hpp"
-
-#include "utils.hpp"
-
-#include <array>
-#include <cstdint>
-#include <cstring>
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <vector>
-
-constexpr size_t const ARG_COUNT = 4;
-
-ProgArgs::ProgArgs(std::vector<std::string> const & args) : args(args) { }
-
-bool ProgArgs::checkArgCount(std::vector<std::string> const & args) {
-  if (args.size() != ARG_COUNT) {
-    std::cerr << "Error: Incorrect number of arguments.\n";
-    std::cerr << "Usage: " << args[0]
-              << " <iterations> <input_filename>.fld <output_filename>.fld\n";
-    exit(ERROR_INCORRECT_ARG_COUNT);
-  }
-  return true;
-}
-
-bool ProgArgs::checkFirstArg(std::vector<std::string> const & args) {
-  if (!isInteger(args[1])) {
-    std::cerr << "Error: First argument ('" << args[1] << "') must be an integer.\n";
-    exit(ERROR_INVALID_FIRST_ARG);
-  }
-  return true;
-}
-
-bool ProgArgs::checkIterations(int iterations) {
-  if (iterations < 0) {
-    std::cerr << "Error: Number of iterations (" << iterations << ") cannot be negative.\n";
-    exit(ERROR_NEGATIVE_ITERATIONS);
-  }
-  return true;
-}
-
-bool ProgArgs::checkInputFile(std::vector<std::string> const & args) {
-  const std::ifstream infile(args[2]);
-  if (!infile.good()) {
-    std::cerr << "Error: Cannot open " << args[2] << " for reading.\n";
-    exit(ERROR_INPUT_FILE_OPEN);
-  }
-  return true;
-}
-
-bool ProgArgs::checkOutputFile(std::vector<std::string> const & args) {
-  const std::ofstream outfile(args[3]);
-  if (!outfile.good()) {
-    std::cerr << "Error: Cannot open " << args[3] << " for writing.\n";
-    exit(ERROR_OUTPUT_FILE_OPEN);
-  }
-  return true;
-}
-
-bool ProgArgs::checkParticleCount(int particleCount) {
-  if (particleCount <= 0) {
-    std::cerr << "Error: Invalid number of particles: " << particleCount << ".\n";
-    exit(ERROR_INVALID_PARTICLE_COUNT);
-  }
-  return true;
-}
-
-bool ProgArgs::checkParticleCountMatch(int headerCount, int fileCount) {
-  if (headerCount != fileCount) {
-    std::cerr << "Error: Number of particles mismatch. Header: " << headerCount
-              << ", Found: " << fileCount << ".\n";
-    exit(ERROR_INVALID_PARTICLE_COUNT);
-  }
-  return true;
-}
-
-bool ProgArgs::validate(std::vector<std::string> const & args, int iterations, int particleCount,
-                        int fileParticleCount) {
-  if (args.empty()) {
-    std::cerr << "Error: No arguments provided.\n";
-    exit(ERROR_INCORRECT_ARG_COUNT);
-  }
-  checkArgCount(args);
-  checkFirstArg(args);
-  checkIterations(iterations);
-  checkInputFile(args);
-  checkOutputFile(args);
-  checkParticleCount(particleCount);
-  checkParticleCountMatch(particleCount, fileParticleCount);
-  return true;
-}
+// progargs.cpp
+#include "progargs.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+constexpr size_t const ARG_COUNT = 4;
+
+namespace {
+
+  using OptionHandler = std::function<bool(std::string const &, SimulationOptions &)>;
+
+  bool isOption(std::string const & arg) {
+    return arg.starts_with("--");
+  }
+
+  bool readPositive(std::string const & value, int & target) {
+    if (!isInteger(value) || value.size() > std::to_string(INT32_MAX).size() ||
+        std::stoll(value) <= 0 || std::stoll(value) > INT32_MAX) {
+      return false;
+    }
+    target = std::stoi(value);
+    return true;
+  }
+
+  // A finite, non-negative decimal number
+  bool readNonNegative(std::string const & value, float & target) {
+    char * end         = nullptr;
+    const float parsed = std::strtof(value.c_str(), &end);
+    if (value.empty() || end != value.c_str() + value.size() || !std::isfinite(parsed) ||
+        parsed < 0.0F) {
+      return false;
+    }
+    target = parsed;
+    return true;
+  }
+
+  // A finite decimal number of any sign
+  bool readFinite(std::string const & value, float & target) {
+    char * end         = nullptr;
+    const float parsed = std::strtof(value.c_str(), &end);
+    if (value.empty() || end != value.c_str() + value.size() || !std::isfinite(parsed)) {
+      return false;
+    }
+    target = parsed;
+    return true;
+  }
+
+  // Comma-separated values of a list option, empty names included
+  std::vector<std::string> splitList(std::string const & value) {
+    std::vector<std::string> names;
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+      const std::size_t comma = std::min(value.find(',', begin), value.size());
+      names.push_back(value.substr(begin, comma - begin));
+      begin = comma + 1;
+    }
+    return names;
+  }
+
+  std::map<std::string, OptionHandler> const & optionHandlers() {
+    static std::map<std::string, OptionHandler> const handlers = {
+      {  "--threads",
+       [](std::string const & value, SimulationOptions & options) {
+         return readPositive(value, options.threads);
+       }},
+      {"--reduction",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "fast") {
+           options.reduction = ReductionMode::fast;
+         } else if (value == "deterministic") {
+           options.reduction = ReductionMode::deterministic;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--neighbors",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "cells") {
+           options.neighbors = NeighborSearch::cells;
+         } else if (value == "allpairs") {
+           options.neighbors = NeighborSearch::allPairs;
+         } else if (value == "clusters") {
+           options.neighbors = NeighborSearch::clusters;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--schedule",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "stealing") {
+           options.schedule = CellSchedule::stealing;
+         } else if (value == "static") {
+           options.schedule = CellSchedule::staticRange;
+         } else if (value == "graph") {
+           options.schedule = CellSchedule::graph;
+         } else if (value.starts_with("graph:") &&
+                    readPositive(value.substr(6), options.graphBlockCells) &&
+                    options.graphBlockCells >= 2) {
+           options.schedule = CellSchedule::graph;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--numa",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.numa = NumaPlacement::off;
+         } else if (value == "local") {
+           options.numa = NumaPlacement::local;
+         } else if (value == "interleave") {
+           options.numa = NumaPlacement::interleave;
+         } else if (value.starts_with("bind:") && isInteger(value.substr(5)) &&
+                    value.size() < 10 && std::stoi(value.substr(5)) >= 0) {
+           options.numa     = NumaPlacement::bind;
+           options.numaNode = std::stoi(value.substr(5));
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--hugepages",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.hugePages = HugePages::off;
+         } else if (value == "thp") {
+           options.hugePages = HugePages::transparent;
+         } else if (value == "hugetlb") {
+           options.hugePages = HugePages::hugetlb;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--pin",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "on") {
+           options.pinThreads = true;
+         } else if (value == "off") {
+           options.pinThreads = false;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--profile",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "on") {
+           options.profile = true;
+         } else if (value == "off") {
+           options.profile = false;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--pair-cache",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "on") {
+           options.pairCache = true;
+         } else if (value == "off") {
+           options.pairCache = false;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--sleep",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.sleepSteps = 0;
+           return true;
+         }
+         return readPositive(value, options.sleepSteps);
+       }},
+      {"--sleep-velocity",
+       [](std::string const & value, SimulationOptions & options) {
+         return readNonNegative(value, options.sleepVelocity);
+       }},
+      {"--sleep-acceleration",
+       [](std::string const & value, SimulationOptions & options) {
+         return readNonNegative(value, options.sleepAcceleration);
+       }},
+      {"--cell-grid",
+       [](std::string const & value, SimulationOptions & options) {
+         float occupancy = 0.0F;
+         if (value == "dense") {
+           options.cellLayout = CellLayout::dense;
+         } else if (value == "hashed") {
+           options.cellLayout = CellLayout::hashed;
+         } else if (value == "auto") {
+           options.cellLayout = CellLayout::automatic;
+         } else if (value.starts_with("auto:") && readNonNegative(value.substr(5), occupancy) &&
+                    occupancy <= 1.0F) {
+           options.cellLayout      = CellLayout::automatic;
+           options.hashedOccupancy = occupancy;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--temporal",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.temporalSteps = 0;
+           return true;
+         }
+         const std::size_t colon = value.find(':');
+         if (colon == std::string::npos) { return readPositive(value, options.temporalSteps); }
+         return readPositive(value.substr(0, colon), options.temporalSteps) &&
+                readPositive(value.substr(colon + 1), options.temporalTileCells);
+       }},
+      {"--out-of-core",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.outOfCoreDirectory.clear();
+           return true;
+         }
+         // A trailing :<rows> sets the slab thickness; the directory may hold colons itself
+         const std::size_t colon = value.rfind(':');
+         std::string directory   = value;
+         if (colon != std::string::npos && isInteger(value.substr(colon + 1))) {
+           if (!readPositive(value.substr(colon + 1), options.outOfCoreSlabCells)) {
+             return false;
+           }
+           directory = value.substr(0, colon);
+         }
+         if (directory.empty() || !std::filesystem::is_directory(directory)) { return false; }
+         options.outOfCoreDirectory = directory;
+         return true;
+       }},
+      {"--analytics",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.analyticsInterval = 0;
+           return true;
+         }
+         const std::size_t colon = value.find(':');
+         if (colon == std::string::npos) {
+           return readPositive(value, options.analyticsInterval);
+         }
+         options.analyticsFile = value.substr(colon + 1);
+         return readPositive(value.substr(0, colon), options.analyticsInterval) &&
+                !options.analyticsFile.empty();
+       }},
+      {"--analytics-quantities",
+       [](std::string const & value, SimulationOptions & options) {
+         AnalyticsSelection selection{false, false, false, false};
+         for (std::string const & name : splitList(value)) {
+           if (name == "energy") {
+             selection.kineticEnergy = true;
+           } else if (name == "com") {
+             selection.centerOfMass = true;
+           } else if (name == "speed") {
+             selection.maxSpeed = true;
+           } else if (name == "density") {
+             selection.density = true;
+           } else {
+             return false;
+           }
+         }
+         options.analytics = selection;
+         return true;
+       }},
+      {"--output-region",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "all") {
+           options.output.region = false;
+           return true;
+         }
+         std::vector<std::string> const corners = splitList(value);
+         if (corners.size() != 6) { return false; }
+         OutputFilter & output = options.output;
+         for (std::size_t axis = 0; axis < 3; ++axis) {
+           if (!readFinite(corners[axis], output.regionMin[axis]) ||
+               !readFinite(corners[axis + 3], output.regionMax[axis]) ||
+               output.regionMin[axis] > output.regionMax[axis]) {
+             return false;
+           }
+         }
+         output.region = true;
+         return true;
+       }},
+      {"--output-sample",
+       [](std::string const & value, SimulationOptions & options) {
+         OutputFilter & output = options.output;
+         if (value == "all") {
+           output.sampling = OutputSampling::all;
+           return true;
+         }
+         if (value.starts_with("every:")) {
+           output.sampling = OutputSampling::stride;
+           return readPositive(value.substr(6), output.stride);
+         }
+         if (!value.starts_with("random:")) { return false; }
+         // random:<fraction>[:<seed>]
+         std::string fraction    = value.substr(7);
+         const std::size_t colon = fraction.find(':');
+         if (colon != std::string::npos) {
+           std::string const seed = fraction.substr(colon + 1);
+           if (!isInteger(seed) || seed.starts_with('-') || seed.size() > 19) { return false; }
+           output.seed = std::stoull(seed);
+           fraction    = fraction.substr(0, colon);
+         }
+         float share = 0.0F;
+         if (!readNonNegative(fraction, share) || share <= 0.0F || share > 1.0F) { return false; }
+         output.sampling = OutputSampling::random;
+         output.fraction = static_cast<double>(share);
+         return true;
+       }},
+      {"--output-fields",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "all") {
+           options.output.fields = OutputFields{};
+           return true;
+         }
+         OutputFields fields{false, false, false, false, false, false};
+         for (std::string const & name : splitList(value)) {
+           if (name == "id") {
+             fields.id = true;
+           } else if (name == "position") {
+             fields.position = true;
+           } else if (name == "half-velocity") {
+             fields.halfVelocity = true;
+           } else if (name == "velocity") {
+             fields.velocity = true;
+           } else if (name == "density") {
+             fields.density = true;
+           } else if (name == "acceleration") {
+             fields.acceleration = true;
+           } else {
+             return false;
+           }
+         }
+         options.output.fields = fields;
+         return true;
+       }},
+      {"--output-layout",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "rows") {
+           options.output.layout = OutputLayout::rows;
+         } else if (value == "columns") {
+           options.output.layout = OutputLayout::columns;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+      {"--trajectory",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.trajectoryInterval = 0;
+           return true;
+         }
+         const std::size_t colon = value.find(':');
+         if (colon == std::string::npos) {
+           return readPositive(value, options.trajectoryInterval);
+         }
+         options.trajectoryFile = value.substr(colon + 1);
+         return readPositive(value.substr(0, colon), options.trajectoryInterval) &&
+                !options.trajectoryFile.empty();
+       }},
+      {"--trajectory-keyframes",
+       [](std::string const & value, SimulationOptions & options) {
+         return readPositive(value, options.trajectoryKeyframes);
+       }},
+      {"--publish",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "off") {
+           options.publishInterval = 0;
+           return true;
+         }
+         const std::size_t colon = value.find(':');
+         if (colon == std::string::npos) { return readPositive(value, options.publishInterval); }
+         // A shared memory name is one slash and a name without slashes
+         options.publishName = value.substr(colon + 1);
+         return readPositive(value.substr(0, colon), options.publishInterval) &&
+                options.publishName.size() > 1 && options.publishName.front() == '/' &&
+                options.publishName.find('/', 1) == std::string::npos;
+       }},
+      {"--publish-slots",
+       [](std::string const & value, SimulationOptions & options) {
+         return readPositive(value, options.publishSlots);
+       }},
+      {"--math",
+       [](std::string const & value, SimulationOptions & options) {
+         if (value == "precise") {
+           options.math = KernelMath::precise;
+         } else if (value == "fast") {
+           options.math = KernelMath::fast;
+         } else {
+           return false;
+         }
+         return true;
+       }},
+    };
+    return handlers;
+  }
+
+}  // namespace
+
+ProgArgs::ProgArgs(std::vector<std::string> const & args) : args(args) { }
+
+bool ProgArgs::checkArgCount(std::vector<std::string> const & args) {
+  const bool positionalOk =
+      args.size() >= ARG_COUNT && std::none_of(args.begin(), args.begin() + ARG_COUNT, isOption) &&
+      std::all_of(args.begin() + ARG_COUNT, args.end(), isOption);
+  if (!positionalOk) {
+    std::cerr << "Error: Incorrect number of arguments.\n";
+    std::cerr << "Usage: " << args[0]
+              << " <iterations> <input_filename>.fld <output_filename>.fld"
+                 " [--threads=<n>] [--reduction=fast|deterministic]"
+                 " [--neighbors=cells|allpairs|clusters]"
+                 " [--schedule=stealing|static|graph[:<cells>]]"
+                 " [--numa=off|local|interleave|bind:<node>] [--hugepages=off|thp|hugetlb]"
+                 " [--pin=on|off]"
+                 " [--profile=on|off] [--pair-cache=on|off] [--math=precise|fast]"
+                 " [--sleep=off|<steps>] [--sleep-velocity=<m/s>]"
+                 " [--sleep-acceleration=<m/s^2>] [--cell-grid=dense|hashed|auto[:<occupancy>]]"
+                 " [--temporal=off|<steps>[:<tile cells>]]"
+                 " [--out-of-core=off|<directory>[:<slab rows>]]"
+                 " [--analytics=off|<steps>[:<file>]]"
+                 " [--analytics-quantities=energy,com,speed,density]"
+                 " [--output-region=all|<xmin>,<ymin>,<zmin>,<xmax>,<ymax>,<zmax>]"
+                 " [--output-sample=all|every:<k>|random:<fraction>[:<seed>]]"
+                 " [--output-fields=all|id,position,half-velocity,velocity,density,"
+                 "acceleration] [--output-layout=rows|columns]"
+                 " [--trajectory=off|<steps>[:<file>]] [--trajectory-keyframes=<frames>]"
+                 " [--publish=off|<steps>[:/<name>]] [--publish-slots=<slots>]\n";
+    exit(ERROR_INCORRECT_ARG_COUNT);
+  }
+  return true;
+}
+
+bool ProgArgs::checkFirstArg(std::vector<std::string> const & args) {
+  if (!isInteger(args[1])) {
+    std::cerr << "Error: First argument ('" << args[1] << "') must be an integer.\n";
+    exit(ERROR_INVALID_FIRST_ARG);
+  }
+  return true;
+}
+
+bool ProgArgs::checkIterations(int iterations) {
+  if (iterations < 0) {
+    std::cerr << "Error: Number of iterations (" << iterations << ") cannot be negative.\n";
+    exit(ERROR_NEGATIVE_ITERATIONS);
+  }
+  return true;
+}
+
+bool ProgArgs::checkInputFile(std::vector<std::string> const & args) {
+  const std::ifstream infile(args[2]);
+  if (!infile.good()) {
+    std::cerr << "Error: Cannot open " << args[2] << " for reading.\n";
+    exit(ERROR_INPUT_FILE_OPEN);
+  }
+  return true;
+}
+
+bool ProgArgs::checkOutputFile(std::vector<std::string> const & args) {
+  const std::ofstream outfile(args[3]);
+  if (!outfile.good()) {
+    std::cerr << "Error: Cannot open " << args[3] << " for writing.\n";
+    exit(ERROR_OUTPUT_FILE_OPEN);
+  }
+  return true;
+}
+
+bool ProgArgs::checkParticleCount(int particleCount) {
+  if (particleCount <= 0) {
+    std::cerr << "Error: Invalid number of particles: " << particleCount << ".\n";
+    exit(ERROR_INVALID_PARTICLE_COUNT);
+  }
+  return true;
+}
+
+bool ProgArgs::checkParticleCountMatch(int headerCount, int fileCount) {
+  if (headerCount != fileCount) {
+    std::cerr << "Error: Number of particles mismatch. Header: " << headerCount
+              << ", Found: " << fileCount << ".\n";
+    exit(ERROR_INVALID_PARTICLE_COUNT);
+  }
+  return true;
+}
+
+bool ProgArgs::checkFileSize(FldFileLayout const & input) {
+  const auto expected = FLD_HEADER_SIZE + static_cast<std::uintmax_t>(input.header.np) *
+                                               FLD_RECORD_SIZE;
+  if (input.size != expected) {
+    std::cerr << "Error: Number of particles mismatch. Header: " << input.header.np
+              << " (" << expected << " bytes), Found: " << input.records << " records in "
+              << input.size << " bytes";
+    if (input.partialBytes != 0) {
+      std::cerr << ", the last record truncated after " << input.partialBytes << " of "
+                << FLD_RECORD_SIZE << " bytes";
+    }
+    std::cerr << ".\n";
+    exit(ERROR_INVALID_PARTICLE_COUNT);
+  }
+  return true;
+}
+
+bool ProgArgs::validate(std::vector<std::string> const & args, int iterations, int particleCount,
+                        int fileParticleCount) {
+  if (args.empty()) {
+    std::cerr << "Error: No arguments provided.\n";
+    exit(ERROR_INCORRECT_ARG_COUNT);
+  }
+  checkArgCount(args);
+  checkFirstArg(args);
+  checkIterations(iterations);
+  checkInputFile(args);
+  checkOutputFile(args);
+  checkParticleCount(particleCount);
+  checkParticleCountMatch(particleCount, fileParticleCount);
+  return true;
+}
+
+bool ProgArgs::validate(std::vector<std::string> const & args, int iterations,
+                        FldFileLayout const & input) {
+  if (args.empty()) {
+    std::cerr << "Error: No arguments provided.\n";
+    exit(ERROR_INCORRECT_ARG_COUNT);
+  }
+  checkArgCount(args);
+  checkFirstArg(args);
+  checkIterations(iterations);
+  checkInputFile(args);
+  checkOutputFile(args);
+  checkParticleCount(input.header.np);
+  checkFileSize(input);
+  return true;
+}
+
+bool ProgArgs::parseOption(std::string const & option, SimulationOptions & options) {
+  const auto separator    = option.find('=');
+  const std::string name  = option.substr(0, separator);
+  const std::string value = separator == std::string::npos ? "" : option.substr(separator + 1);
+  auto const & handlers   = optionHandlers();
+  auto const handler      = handlers.find(name);
+  if (handler == handlers.end() || !handler->second(value, options)) {
+    std::cerr << "Error: Invalid option '" << option << "'.\n";
+    exit(ERROR_INVALID_OPTION);
+  }
+  return true;
+}
+
+bool ProgArgs::parseOptions(std::vector<std::string> const & args, SimulationOptions & options) {
+  for (size_t i = ARG_COUNT; i < args.size(); ++i) { parseOption(args[i], options); }
+  return true;
+}
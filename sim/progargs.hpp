@@ -1,23 +1,33 @@
-// progargs.hpp
-#pragma once
-
-#include <fstream>
-#include <string>
-#include <vector>
-
-class ProgArgs {
-  public:
-    ProgArgs(std::vector<std::string> const & args);
-    static bool validate(std::vector<std::string> const & args, int iterations, int particleCount,
-                         int fileParticleCount);
-
-  private:
-    std::vector<std::string> args;
-    static bool checkArgCount(std::vector<std::string> const & args);
-    static bool checkFirstArg(std::vector<std::string> const & args);
-    static bool checkIterations(int iterations);
-    static bool checkInputFile(std::vector<std::string> const & args);
-    static bool checkOutputFile(std::vector<std::string> const & args);
-    static bool checkParticleCount(int particleCount);
-    static bool checkParticleCountMatch(int headerCount, int fileCount);
-};
+// progargs.hpp
+#pragma once
+
+#include "options.hpp"
+#include "utils.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class ProgArgs {
+  public:
+    ProgArgs(std::vector<std::string> const & args);
+    static bool validate(std::vector<std::string> const & args, int iterations, int particleCount,
+                         int fileParticleCount);
+    // Same checks, with the particle count of the input checked against its size
+    static bool validate(std::vector<std::string> const & args, int iterations,
+                         FldFileLayout const & input);
+    // Reads the optional --name=value arguments that follow the output file
+    static bool parseOptions(std::vector<std::string> const & args, SimulationOptions & options);
+
+  private:
+    std::vector<std::string> args;
+    static bool checkArgCount(std::vector<std::string> const & args);
+    static bool checkFirstArg(std::vector<std::string> const & args);
+    static bool checkIterations(int iterations);
+    static bool checkInputFile(std::vector<std::string> const & args);
+    static bool checkOutputFile(std::vector<std::string> const & args);
+    static bool checkParticleCount(int particleCount);
+    static bool checkParticleCountMatch(int headerCount, int fileCount);
+    static bool checkFileSize(FldFileLayout const & input);
+    static bool parseOption(std::string const & option, SimulationOptions & options);
+};
@@ -0,0 +1,67 @@
+// scheduler.cpp
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+void appendWeightedGroup(std::vector<std::uint64_t> const & weights, std::size_t targetTasks,
+                         TaskGroups & groups) {
+  const std::uint64_t total = std::accumulate(weights.begin(), weights.end(), std::uint64_t{0});
+  const std::uint64_t target =
+      std::max<std::uint64_t>(1, total / std::max<std::size_t>(targetTasks, 1));
+  std::size_t begin    = 0;
+  std::uint64_t weight = 0;
+  for (std::size_t item = 0; item < weights.size(); ++item) {
+    weight += weights[item];
+    if (weight >= target) {
+      groups.tasks.push_back({begin, item + 1});
+      begin  = item + 1;
+      weight = 0;
+    }
+  }
+  if (begin < weights.size()) { groups.tasks.push_back({begin, weights.size()}); }
+  groups.groupStart.push_back(static_cast<std::uint32_t>(groups.tasks.size()));
+}
+
+void WorkStealingScheduler::prepare(int count) {
+  if (count == threads) { return; }
+  threads = count;
+  deques  = std::make_unique<Deque[]>(static_cast<std::size_t>(2 * count));
+  loads.assign(static_cast<std::size_t>(count), PaddedLoad{});
+}
+
+void WorkStealingScheduler::seed(int thread, TaskGroups const & groups, std::size_t group,
+                                 int slot) {
+  const std::uint32_t first = groups.groupStart[group];
+  const IndexRange share    = threadRange(groups.groupStart[group + 1] - first, thread, threads);
+  deque(slot, thread).range.store(packRange(first + static_cast<std::uint32_t>(share.begin),
+                                            first + static_cast<std::uint32_t>(share.end)),
+                                  std::memory_order_release);
+}
+
+bool WorkStealingScheduler::steal(int thread, int slot) {
+  for (int offset = 1; offset < threads; ++offset) {
+    Deque & victim      = deque(slot, (thread + offset) % threads);
+    std::uint64_t range = victim.range.load(std::memory_order_acquire);
+    while (rangeFront(range) < rangeBack(range)) {
+      const std::uint32_t back = rangeBack(range);
+      const std::uint32_t mid  = back - (back - rangeFront(range) + 1) / 2;
+      if (victim.range.compare_exchange_weak(range, packRange(rangeFront(range), mid),
+                                             std::memory_order_acq_rel)) {
+        deque(slot, thread).range.store(packRange(mid, back), std::memory_order_release);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::vector<ThreadLoad> WorkStealingScheduler::takeLoad() {
+  std::vector<ThreadLoad> taken;
+  taken.reserve(loads.size());
+  for (PaddedLoad & padded : loads) {
+    taken.push_back(padded.load);
+    padded.load = ThreadLoad{};
+  }
+  return taken;
+}
@@ -0,0 +1,106 @@
+// scheduler.hpp
+#pragma once
+
+#include "parallel.hpp"
+#include "profile.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Tasks of several groups (e.g. cell colours) that run one group at a time. Task t covers the
+// items tasks[t]; group g owns tasks groupStart[g] .. groupStart[g + 1] - 1.
+struct TaskGroups {
+    std::vector<IndexRange> tasks;
+    std::vector<std::uint32_t> groupStart{0};
+
+    void clear() {
+      tasks.clear();
+      groupStart.assign(1, 0);
+    }
+
+    [[nodiscard]] std::size_t groupCount() const { return groupStart.size() - 1; }
+};
+
+// Appends a group over items [0, weights.size()) split into contiguous tasks of about
+// total / targetTasks weight. An item heavier than that becomes a task of its own.
+void appendWeightedGroup(std::vector<std::uint64_t> const & weights, std::size_t targetTasks,
+                         TaskGroups & groups);
+
+// Work-stealing execution of one task group by all threads of a pool. Every thread starts with a
+// contiguous share of the group and pops tasks from its front; a thread that runs out takes
+// the back half of another thread's remaining range. Ranges live in one atomic word per thread,
+// so popping and stealing are single compare-exchanges.
+class WorkStealingScheduler {
+  public:
+    // Sizes the deques and load counters; called outside of a parallel phase
+    void prepare(int threads);
+
+    // Gives `thread` its share of group `group`. The group must not be executed before every
+    // thread has seeded it (a barrier), and two consecutive groups use different slots.
+    void seed(int thread, TaskGroups const & groups, std::size_t group, int slot);
+
+    // Runs body(items) for tasks until no thread has any left in `slot`
+    template <typename Body>
+    void execute(int thread, TaskGroups const & groups, int slot, Body && body) {
+      Deque & own         = deque(slot, thread);
+      ThreadLoad & load   = loads[static_cast<std::size_t>(thread)].load;
+      std::uint64_t range = own.range.load(std::memory_order_acquire);
+      while (true) {
+        const std::uint32_t front = rangeFront(range);
+        if (front < rangeBack(range)) {
+          if (!own.range.compare_exchange_weak(range, packRange(front + 1, rangeBack(range)),
+                                               std::memory_order_acq_rel)) {
+            continue;
+          }
+          const auto start = std::chrono::steady_clock::now();
+          body(groups.tasks[front]);
+          load.busySeconds +=
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          ++load.tasks;
+          range = own.range.load(std::memory_order_acquire);
+          continue;
+        }
+        if (!steal(thread, slot)) { return; }
+        ++load.steals;
+        range = own.range.load(std::memory_order_acquire);
+      }
+    }
+
+    // Load of each thread since the last call
+    std::vector<ThreadLoad> takeLoad();
+
+  private:
+    struct alignas(64) Deque {
+        std::atomic<std::uint64_t> range{0};
+    };
+
+    struct alignas(64) PaddedLoad {
+        ThreadLoad load;
+    };
+
+    static std::uint64_t packRange(std::uint32_t front, std::uint32_t back) {
+      return (static_cast<std::uint64_t>(front) << 32U) | back;
+    }
+
+    static std::uint32_t rangeFront(std::uint64_t range) {
+      return static_cast<std::uint32_t>(range >> 32U);
+    }
+
+    static std::uint32_t rangeBack(std::uint64_t range) {
+      return static_cast<std::uint32_t>(range);
+    }
+
+    Deque & deque(int slot, int thread) {
+      return deques[static_cast<std::size_t>(slot * threads + thread)];
+    }
+
+    bool steal(int thread, int slot);
+
+    int threads = 0;
+    std::unique_ptr<Deque[]> deques;
+    std::vector<PaddedLoad> loads;
+};
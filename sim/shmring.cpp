@@ -0,0 +1,169 @@
+// shmring.cpp
+#include "shmring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+
+  constexpr std::size_t RING_ALIGNMENT = 64;
+
+  std::size_t slotBytesFor(std::size_t capacity) {
+    const std::size_t records = capacity * sizeof(Particle);
+    return sizeof(ShmSlotHeader) + (records + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+  }
+
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  ShmRingHeader * headerOf(char * ring) {
+    return std::launder(reinterpret_cast<ShmRingHeader *>(ring));
+  }
+
+  ShmSlotHeader * slotAt(char * ring, std::uint64_t slotBytes, std::uint64_t slot) {
+    return std::launder(
+        reinterpret_cast<ShmSlotHeader *>(ring + sizeof(ShmRingHeader) + slot * slotBytes));
+  }
+
+  ShmSlotHeader const * slotAt(char const * ring, std::uint64_t slotBytes, std::uint64_t slot) {
+    return std::launder(reinterpret_cast<ShmSlotHeader const *>(ring + sizeof(ShmRingHeader) +
+                                                                slot * slotBytes));
+  }
+
+  Particle * recordsOf(ShmSlotHeader * slot) { return reinterpret_cast<Particle *>(slot + 1); }
+
+  Particle const * recordsOf(ShmSlotHeader const * slot) {
+    return reinterpret_cast<Particle const *>(slot + 1);
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+}  // namespace
+
+ShmRingWriter::ShmRingWriter(std::string ringName, std::size_t slots, std::size_t capacity,
+                             float ppm)
+  : name(std::move(ringName)) {
+  slots            = std::max<std::size_t>(slots, 1);
+  const auto bytes = slotBytesFor(capacity);
+  // A ring left by a run that died is unlinked; its readers keep their old mapping
+  shm_unlink(name.c_str());
+  const int descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (descriptor < 0) { return; }
+  const std::size_t size = sizeof(ShmRingHeader) + slots * bytes;
+  if (ftruncate(descriptor, static_cast<off_t>(size)) == 0) {
+    void * mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      ring   = static_cast<char *>(mapping);
+      length = size;
+    }
+  }
+  close(descriptor);
+  if (ring == nullptr) {
+    shm_unlink(name.c_str());
+    return;
+  }
+  // The object starts zero-filled, so every slot begins with an even sequence
+  auto * header     = new (ring) ShmRingHeader{};
+  header->slots     = static_cast<std::uint32_t>(slots);
+  header->capacity  = static_cast<std::uint32_t>(capacity);
+  header->ppm       = ppm;
+  header->slotBytes = bytes;
+  for (std::size_t s = 0; s < slots; ++s) {
+    new (ring + sizeof(ShmRingHeader) + s * bytes) ShmSlotHeader{};
+  }
+}
+
+ShmRingWriter::~ShmRingWriter() {
+  if (ring == nullptr) { return; }
+  headerOf(ring)->closed.store(1, std::memory_order_release);
+  munmap(ring, length);
+  shm_unlink(name.c_str());
+}
+
+bool ShmRingWriter::publish(int step, std::vector<Particle> const & particles) {
+  if (ring == nullptr) { return false; }
+  ShmRingHeader * header = headerOf(ring);
+  if (particles.size() > header->capacity) { return false; }
+  ShmSlotHeader * slot = slotAt(ring, header->slotBytes, frames % header->slots);
+  const std::uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+  // Readers that see any of the records below also see the odd sequence
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->frame     = frames;
+  slot->step      = step;
+  slot->particles = static_cast<std::uint32_t>(particles.size());
+  std::memcpy(recordsOf(slot), particles.data(), particles.size() * sizeof(Particle));
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+  header->published.store(++frames, std::memory_order_release);
+  return true;
+}
+
+ShmRingReader::ShmRingReader(std::string const & name) {
+  const int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+  if (descriptor < 0) { return; }
+  struct stat info {};
+  if (fstat(descriptor, &info) == 0 &&
+      static_cast<std::size_t>(info.st_size) >= sizeof(ShmRingHeader)) {
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void * mapping  = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      ring   = static_cast<char const *>(mapping);
+      length = size;
+    }
+  }
+  close(descriptor);
+  if (ring == nullptr) { return; }
+  ShmRingHeader const * header = ringHeader();
+  const bool valid = header->magic == SHM_RING_MAGIC && header->version == SHM_RING_VERSION &&
+                     header->slots > 0 && header->slotBytes >= slotBytesFor(header->capacity) &&
+                     sizeof(ShmRingHeader) + header->slots * header->slotBytes <= length;
+  if (!valid) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    munmap(const_cast<char *>(ring), length);
+    ring   = nullptr;
+    length = 0;
+  }
+}
+
+ShmRingReader::~ShmRingReader() {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  if (ring != nullptr) { munmap(const_cast<char *>(ring), length); }
+}
+
+ShmRingHeader const * ShmRingReader::ringHeader() const {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::launder(reinterpret_cast<ShmRingHeader const *>(ring));
+}
+
+std::uint64_t ShmRingReader::published() const {
+  return ring == nullptr ? 0 : ringHeader()->published.load(std::memory_order_acquire);
+}
+
+bool ShmRingReader::closed() const {
+  return ring == nullptr || ringHeader()->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool ShmRingReader::acquireLatest(ShmFrame & frame) const {
+  const std::uint64_t frames = published();
+  if (frames == 0) { return false; }
+  ShmRingHeader const * header = ringHeader();
+  ShmSlotHeader const * slot   = slotAt(ring, header->slotBytes, (frames - 1) % header->slots);
+  frame.sequence = slot->sequence.load(std::memory_order_acquire);
+  if (frame.sequence % 2 != 0) { return false; }
+  frame.slot      = slot;
+  frame.frame     = slot->frame;
+  frame.step      = slot->step;
+  frame.particles = std::span<Particle const>(
+      recordsOf(slot), std::min<std::size_t>(slot->particles, header->capacity));
+  return true;
+}
+
+bool ShmRingReader::stillValid(ShmFrame const & frame) {
+  if (frame.slot == nullptr) { return false; }
+  // Orders the reads of the records before the second look at the sequence
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return frame.slot->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
@@ -0,0 +1,113 @@
+// shmring.hpp
+#pragma once
+
+#include "particle.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Ring of particle frames in a POSIX shared memory object (shm_open), for local processes
+// that watch a run while it steps. A 64-byte header is followed by `slots` slots, each a
+// 64-byte slot header and the particle records of one frame. Frame n goes to slot
+// n % slots. Every slot is guarded by a seqlock: its sequence is odd while the writer fills
+// it and even otherwise, so the writer never waits for readers. A reader reads the records
+// in place and then checks that the sequence did not change while it read.
+constexpr std::array<char, 8> SHM_RING_MAGIC{'F', 'L', 'D', 'S', 'H', 'M', 'R', '\0'};
+constexpr std::uint32_t SHM_RING_VERSION = 1;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              std::atomic<std::uint32_t>::is_always_lock_free);
+
+struct alignas(64) ShmRingHeader {
+    std::array<char, 8> magic = SHM_RING_MAGIC;
+    std::uint32_t version     = SHM_RING_VERSION;
+    std::uint32_t slots       = 0;
+    std::uint32_t capacity    = 0;  // Particles a slot holds
+    float ppm                 = 0.0F;
+    std::uint64_t slotBytes   = 0;  // Distance from one slot to the next
+    std::atomic<std::uint64_t> published{0};  // Frames published so far
+    std::atomic<std::uint32_t> closed{0};     // 1 once the writer is done
+};
+
+struct alignas(64) ShmSlotHeader {
+    std::atomic<std::uint64_t> sequence{0};
+    std::uint64_t frame     = 0;
+    std::int32_t step       = 0;
+    std::uint32_t particles = 0;
+};
+
+static_assert(sizeof(ShmRingHeader) == 64 && sizeof(ShmSlotHeader) == 64);
+
+// Frame of a slot as seen by a reader; valid while ShmRingReader::stillValid says so
+struct ShmFrame {
+    std::uint64_t frame = 0;
+    int step            = 0;
+    std::span<Particle const> particles;
+    std::uint64_t sequence     = 0;
+    ShmSlotHeader const * slot = nullptr;
+};
+
+// Creates the ring `name` (a shared memory name, "/" and no other slash) for frames of up to
+// `capacity` particles, replacing any ring left with that name. Marks the ring closed and
+// removes the name on destruction; readers that have it mapped keep their mapping.
+class ShmRingWriter {
+  public:
+    ShmRingWriter(std::string name, std::size_t slots, std::size_t capacity, float ppm);
+    ~ShmRingWriter();
+    ShmRingWriter(ShmRingWriter const &)             = delete;
+    ShmRingWriter & operator=(ShmRingWriter const &) = delete;
+    ShmRingWriter(ShmRingWriter &&)                  = delete;
+    ShmRingWriter & operator=(ShmRingWriter &&)      = delete;
+
+    [[nodiscard]] bool isOpen() const { return ring != nullptr; }
+
+    [[nodiscard]] std::uint64_t published() const { return frames; }
+
+    // Copies `particles` into the next slot as the frame after `step` steps; false when
+    // they do not fit
+    bool publish(int step, std::vector<Particle> const & particles);
+
+  private:
+    std::string name;
+    char * ring          = nullptr;
+    std::size_t length   = 0;
+    std::uint64_t frames = 0;
+};
+
+// Read-only mapping of the ring `name`
+class ShmRingReader {
+  public:
+    explicit ShmRingReader(std::string const & name);
+    ~ShmRingReader();
+    ShmRingReader(ShmRingReader const &)             = delete;
+    ShmRingReader & operator=(ShmRingReader const &) = delete;
+    ShmRingReader(ShmRingReader &&)                  = delete;
+    ShmRingReader & operator=(ShmRingReader &&)      = delete;
+
+    [[nodiscard]] bool isOpen() const { return ring != nullptr; }
+
+    [[nodiscard]] ShmRingHeader const & header() const { return *ringHeader(); }
+
+    [[nodiscard]] std::uint64_t published() const;
+
+    [[nodiscard]] bool closed() const;
+
+    // Points `frame` at the newest frame; false when there is none yet or the writer is
+    // filling its slot
+    bool acquireLatest(ShmFrame & frame) const;
+
+    // Whether the records of `frame` were not overwritten since acquireLatest; anything read
+    // from them before this returns true is a consistent frame
+    [[nodiscard]] static bool stillValid(ShmFrame const & frame);
+
+  private:
+    char const * ring  = nullptr;
+    std::size_t length = 0;
+
+    [[nodiscard]] ShmRingHeader const * ringHeader() const;
+};
@@ -1,36 +1,118 @@
-// simulation.cpp
-#include "simulation.hpp"
-
-#include "block.hpp"
-#include "constants.hpp"
-#include "grid.hpp"
-#include "particle.hpp"
-#include "progargs.hpp"
-#include "utils.hpp"
-
-#include <chrono>
-#include <iostream>
-#include <string>
-#include <vector>
-
-void runSimulation(int iterations, std::string const & inputFile, std::string const & outputFile) {
-  Header header{};
-  std::vector<Particle> particles;
-  readInputFile(inputFile, header, particles);
-  const float height       = calculateSmoothingLength(r, header.ppm);
-  const float mass         = calculateParticleMass(rho, header.ppm);
-  GridSize numBlocks = calculateNumberOfBlocks(height);
-  GridSize blockSize = calculateBlockSize(numBlocks);
-  const SimulationParameters simParams{
-    iterations, {   height,      mass},
-     {numBlocks, blockSize}
-  };
-  simulationWithIterations(particles, simParams);
-  writeParticlesToFile(outputFile, header, particles);
-  const SalidaParameters salidaParams{
-    header.np, header.ppm, {   height,      mass},
-      {numBlocks, blockSize}
-  };
-  salida(salidaParams);
-  std::cout << "Simulacion realizada con exito.\n";
-}
+// simulation.cpp
+#include "simulation.hpp"
+
+#include "block.hpp"
+#include "constants.hpp"
+#include "grid.hpp"
+#include "outofcore.hpp"
+#include "outputfilter.hpp"
+#include "particle.hpp"
+#include "progargs.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  // Steps the particles from the working files and writes the output from them
+  void simulateFromWorkingFiles(int iterations, std::string const & inputFile,
+                                std::string const & outputFile, Header const & header,
+                                SimulationParameters const & params, StepProfile * profile) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const ParticleParameters particleParams = {params.parametros[0], params.parametros[1],
+                                               params.bloques[1], params.bloques[0]};
+    OutOfCoreStats stats;
+    if (!simulateOutOfCore(iterations, inputFile, outputFile, particleParams, params.options,
+                           profile, stats)) {
+      exit(ERROR_OUTPUT_FILE_OPEN);
+    }
+    printOutOfCoreStats(stats, static_cast<std::uint64_t>(header.np), std::cout);
+    const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "La función de simulacion tardó: " << elapsed.count() << " segundos.\n";
+  }
+
+}  // namespace
+
+void runSimulation(int iterations, std::string const & inputFile, std::string const & outputFile,
+                   SimulationOptions const & options) {
+  Header header{};
+  std::vector<Particle> particles;
+  if (usesOutOfCore(options)) {
+    // Only the header: the particles stay in the working files
+    FldFileLayout input{};
+    if (!inspectInputFile(inputFile, input)) { exit(ERROR_INPUT_FILE_OPEN); }
+    header = input.header;
+  } else {
+    readInputFile(inputFile, header, particles);
+  }
+  const float height       = calculateSmoothingLength(r, header.ppm);
+  const float mass         = calculateParticleMass(rho, header.ppm);
+  GridSize numBlocks = calculateNumberOfBlocks(height);
+  GridSize blockSize = calculateBlockSize(numBlocks);
+  const SimulationParameters simParams{
+    iterations, {   height,      mass},
+     {numBlocks, blockSize},
+     options, header.ppm
+  };
+  // Counters are opened before the first step so that worker threads inherit them
+  std::unique_ptr<StepProfile> profile;
+  if (options.profile) { profile = std::make_unique<StepProfile>(); }
+  if (usesOutOfCore(options)) {
+    if (usesOutputFilter(options.output)) {
+      std::cerr << "Output filters are ignored out of core.\n";
+    }
+    simulateFromWorkingFiles(iterations, inputFile, outputFile, header, simParams, profile.get());
+  } else {
+    simulationWithIterations(particles, simParams, profile.get());
+    if (usesOutputFilter(options.output)) {
+      writeFilteredParticles(outputFile, header, particles, {height, mass, blockSize, numBlocks},
+                             options);
+    } else {
+      writeParticlesToFile(outputFile, header, particles);
+    }
+  }
+  const SalidaParameters salidaParams{
+    header.np, header.ppm, {   height,      mass},
+      {numBlocks, blockSize},
+      profile.get()
+  };
+  salida(salidaParams);
+  std::cout << "Simulacion realizada con exito.\n";
+}
+
+Simulation::Simulation(float ppm, std::vector<Particle> particles, SimulationOptions options)
+  : state(std::move(particles)), stepOptions(std::move(options)), particlesPerMetre(ppm) {
+  const float height       = calculateSmoothingLength(r, ppm);
+  const float mass         = calculateParticleMass(rho, ppm);
+  const GridSize numBlocks = calculateNumberOfBlocks(height);
+  params = {height, mass, calculateBlockSize(numBlocks), numBlocks};
+  for (Particle & particle : state) { initializeDensitiesAndAccelerations(particle); }
+}
+
+void Simulation::step(int count) {
+  if (usesTemporalBlocking(stepOptions)) {
+    while (count > 0) {
+      const int blockSteps = std::min(stepOptions.temporalSteps, count);
+      advanceTemporalBlock(state, params, blockSteps, stepOptions, temporal);
+      steps += blockSteps;
+      count -= blockSteps;
+      notify();
+    }
+    return;
+  }
+  for (; count > 0; --count) {
+    stepParticles(state, params, workspace, stepOptions);
+    ++steps;
+    notify();
+  }
+}
+
+void Simulation::notify() const {
+  for (StepObserver const & observer : observers) { observer(steps, state); }
+}
@@ -1,6 +1,67 @@
-// simulation.hpp
-#pragma once
-
-#include <string>
-
-void runSimulation(int iterations, std::string const & inputFile, std::string const & outputFile);
+// simulation.hpp
+#pragma once
+
+#include "options.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "temporal.hpp"
+#include "utils.hpp"
+
+#include <functional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+void runSimulation(int iterations, std::string const & inputFile, std::string const & outputFile,
+                   SimulationOptions const & options = {});
+
+// Called after the steps of Simulation::step with the steps taken so far and the particles
+using StepObserver = std::function<void(int step, std::span<Particle const> particles)>;
+
+// A simulation held in memory, for programs that embed the solver: it owns the particles and
+// the cell lists, scratch arrays and worker threads of its steps, which persist from one
+// call to step() to the next. The step options of `options` apply (threads, neighbours,
+// schedule, sleep, temporal blocking, ...); the file outputs and out-of-core mode are those
+// of runSimulation only.
+class Simulation {
+  public:
+    Simulation(float ppm, std::vector<Particle> particles, SimulationOptions options = {});
+    Simulation(Simulation const &)             = delete;
+    Simulation & operator=(Simulation const &) = delete;
+    Simulation(Simulation &&)                  = delete;
+    Simulation & operator=(Simulation &&)      = delete;
+    ~Simulation()                              = default;
+
+    // Advances `count` steps. Observers are called after every step, or after every block
+    // of steps under temporal blocking.
+    void step(int count = 1);
+
+    // The particles in place; valid until the next step
+    [[nodiscard]] std::span<Particle const> particles() const { return state; }
+
+    [[nodiscard]] int stepsTaken() const { return steps; }
+
+    [[nodiscard]] float ppm() const { return particlesPerMetre; }
+
+    [[nodiscard]] ParticleParameters const & parameters() const { return params; }
+
+    [[nodiscard]] SimulationOptions const & options() const { return stepOptions; }
+
+    void addObserver(StepObserver observer) { observers.push_back(std::move(observer)); }
+
+    void clearObservers() { observers.clear(); }
+
+  private:
+    std::vector<Particle> state;
+    SimulationOptions stepOptions;
+    float particlesPerMetre;
+    ParticleParameters params{};
+    StepWorkspace<FloatPrecision> workspace;
+    TemporalWorkspace<FloatPrecision> temporal;
+    std::vector<StepObserver> observers;
+    int steps = 0;
+
+    void notify() const;
+};
@@ -0,0 +1,194 @@
+// sleep.cpp
+#include "sleep.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+  std::uint32_t cellPopulation(CellList const & cells, std::size_t cell) {
+    return cells.cellStart[cell + 1] - cells.cellStart[cell];
+  }
+
+  // Frozen or empty: no pair of the cell needs evaluating for its own particles
+  bool resting(SleepState const & state, CellList const & cells, std::size_t cell) {
+    return state.frozen[cell] != 0 || cellPopulation(cells, cell) == 0;
+  }
+
+  // A frozen cell whose population changes (emptied included) counts as woken
+  void countWakeUp(SleepState & state, std::size_t cell, std::uint32_t limit) {
+    if (state.stillSteps[cell] >= limit && state.population[cell] != 0) { ++state.stats.wakeUps; }
+  }
+
+  // Hashed cells are renumbered every step, so their counters follow the cell keys, which both
+  // steps list in increasing order. The flags start cleared.
+  void followHashedCells(SleepState & state, CellList const & cells, std::uint32_t limit) {
+    const std::size_t count    = cells.cellCount();
+    const bool sameGrid        = state.grid == cells.grid && state.layout == CellLayout::hashed;
+    const std::size_t previous = sameGrid ? state.keys.size() : 0;
+    LargeArray<std::uint32_t> stillSteps(count, 0, state.stillSteps.get_allocator());
+    LargeArray<std::uint32_t> population(count, 0, state.population.get_allocator());
+    std::size_t p = 0;
+    for (std::size_t cell = 0; cell < cells.cellKeys.size(); ++cell) {
+      const std::uint64_t key = cells.cellKeys[cell];
+      for (; p < previous && state.keys[p] < key; ++p) { countWakeUp(state, p, limit); }
+      if (p < previous && state.keys[p] == key) {
+        stillSteps[cell] = state.stillSteps[p];
+        population[cell] = state.population[p];
+        ++p;
+      }
+    }
+    for (; p < previous; ++p) { countWakeUp(state, p, limit); }
+    state.grid   = cells.grid;
+    state.layout = CellLayout::hashed;
+    state.keys.assign(cells.cellKeys.begin(), cells.cellKeys.end());
+    state.stillSteps = std::move(stillSteps);
+    state.population = std::move(population);
+    state.frozen.assign(count, 0);
+    state.skipped.assign(count, 0);
+    state.moving.assign(count, 0);
+    state.occupied.clear();
+  }
+
+  double percentage(std::uint64_t part, std::uint64_t total) {
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+  }
+
+}  // namespace
+
+void markSleepingCells(SleepState & state, CellList const & cells, int steps, bool halfStencil,
+                       ThreadPool & pool) {
+  const std::size_t count = cells.cellCount();
+  const auto limit        = static_cast<std::uint32_t>(steps);
+  if (cells.layout == CellLayout::hashed) {
+    followHashedCells(state, cells, limit);
+  } else if (!(state.grid == cells.grid) || state.layout != CellLayout::dense ||
+             state.stillSteps.size() != count) {
+    state.grid   = cells.grid;
+    state.layout = CellLayout::dense;
+    state.stillSteps.assign(count, 0);
+    state.population.assign(count, 0);
+    state.frozen.assign(count, 0);
+    state.skipped.assign(count, 0);
+    state.moving.assign(count, 0);
+    state.occupied.clear();
+  }
+  const auto restart = [&](std::size_t cell, std::uint32_t population) {
+    // A particle entering or leaving a cell (too fast for its old neighbourhood to notice)
+    // wakes it
+    if (population == state.population[cell]) { return; }
+    countWakeUp(state, cell, limit);
+    state.stillSteps[cell] = 0;
+    state.population[cell] = population;
+  };
+  // Only the cells occupied in the previous step hold flags; the cells they left are cleared
+  for (std::uint32_t cell : state.occupied) {
+    state.frozen[cell]  = 0;
+    state.skipped[cell] = 0;
+    state.moving[cell]  = 0;
+    if (cellPopulation(cells, cell) == 0) { restart(cell, 0); }
+  }
+  // particleOrder is sorted by cell, so every occupied cell appears once
+  state.occupied.clear();
+  for (std::size_t k = 0; k < cells.particleOrder.size();) {
+    const std::uint32_t cell = cells.particleCell[cells.particleOrder[k]];
+    state.occupied.push_back(cell);
+    const std::uint32_t population = cellPopulation(cells, cell);
+    restart(cell, population);
+    state.frozen[cell] = state.stillSteps[cell] >= limit ? 1 : 0;
+    k += population;
+  }
+  pool.parallelFor(state.occupied.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k) {
+      const std::size_t cell = state.occupied[k];
+      bool skip              = state.frozen[cell] != 0;
+      if (skip && halfStencil) {
+        for (std::size_t k = HALF_STENCIL_BEGIN; k < FULL_STENCIL_SIZE && skip; ++k) {
+          skip = resting(state, cells, cells.neighbor(cell, k));
+        }
+      }
+      state.skipped[cell] = skip ? 1 : 0;
+    }
+  });
+  for (std::uint32_t cell : state.occupied) {
+    const std::uint32_t population = state.population[cell];
+    state.stats.particleSteps += population;
+    state.stats.cellSteps     += 1;
+    if (state.frozen[cell] != 0) { state.stats.frozenParticleSteps += population; }
+    if (state.skipped[cell] != 0) { state.stats.skippedCellSteps += 1; }
+  }
+}
+
+template <typename T>
+void updateSleepState(SleepState & state, CellList const & cells,
+                      std::vector<BasicParticle<T>> const & particles,
+                      SleepThresholds const & thresholds, ThreadPool & pool) {
+  const auto speedLimit = static_cast<T>(thresholds.velocity * thresholds.velocity);
+  const auto accelerationLimit =
+      static_cast<T>(thresholds.acceleration * thresholds.acceleration);
+  const auto aboveLimits = [&](BasicParticle<T> const & particle) {
+    return particle.vx * particle.vx + particle.vy * particle.vy + particle.vz * particle.vz >
+               speedLimit ||
+           particle.ax * particle.ax + particle.ay * particle.ay + particle.az * particle.az >
+               accelerationLimit;
+  };
+  pool.parallelFor(state.occupied.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k) {
+      const std::size_t cell = state.occupied[k];
+      bool moving            = false;
+      if (state.frozen[cell] == 0) {
+        for (std::uint32_t m = cells.cellStart[cell]; m < cells.cellStart[cell + 1] && !moving;
+             ++m) {
+          moving = aboveLimits(particles[cells.particleOrder[m]]);
+        }
+      }
+      state.moving[cell] = moving ? 1 : 0;
+    }
+  });
+  // Empty cells never freeze, and the full stencil of an occupied cell only holds cells of the
+  // list
+  const auto limit = static_cast<std::uint32_t>(thresholds.steps);
+  for (std::uint32_t cell : state.occupied) {
+    bool nearMotion = false;
+    for (std::size_t k = 0; k < FULL_STENCIL_SIZE && !nearMotion; ++k) {
+      nearMotion = state.moving[cells.neighbor(cell, k)] != 0;
+    }
+    if (nearMotion) {
+      if (state.frozen[cell] != 0) { ++state.stats.wakeUps; }
+      state.stillSteps[cell] = 0;
+      continue;
+    }
+    state.stillSteps[cell] = std::min(state.stillSteps[cell] + 1, limit);
+    if (state.stillSteps[cell] != limit || state.frozen[cell] != 0) { continue; }
+    // The cell freezes from the next step on with the state its particles have now
+    for (std::uint32_t m = cells.cellStart[cell]; m < cells.cellStart[cell + 1]; ++m) {
+      auto const & particle = particles[cells.particleOrder[m]];
+      state.stats.frozenSpeed = std::max(
+          state.stats.frozenSpeed,
+          std::sqrt(static_cast<double>(particle.vx * particle.vx + particle.vy * particle.vy +
+                                        particle.vz * particle.vz)));
+      state.stats.frozenAcceleration = std::max(
+          state.stats.frozenAcceleration,
+          std::sqrt(static_cast<double>(particle.ax * particle.ax + particle.ay * particle.ay +
+                                        particle.az * particle.az)));
+    }
+  }
+}
+
+void printSleepStats(SleepStats const & stats, std::ostream & output) {
+  output << "Sleeping: " << std::fixed << std::setprecision(1)
+         << percentage(stats.frozenParticleSteps, stats.particleSteps)
+         << "% of particle updates and "
+         << percentage(stats.skippedCellSteps, stats.cellSteps)
+         << "% of cell pair passes skipped, " << stats.wakeUps << " wake-ups, "
+         << std::defaultfloat << std::setprecision(3)
+         << "largest speed at freeze " << stats.frozenSpeed << " m/s, acceleration "
+         << stats.frozenAcceleration << " m/s^2\n";
+}
+
+template void updateSleepState<float>(SleepState &, CellList const &, std::vector<Particle> const &,
+                                      SleepThresholds const &, ThreadPool &);
+template void updateSleepState<double>(SleepState &, CellList const &,
+                                       std::vector<BasicParticle<double>> const &,
+                                       SleepThresholds const &, ThreadPool &);
@@ -0,0 +1,72 @@
+// sleep.hpp
+#pragma once
+
+#include "cellgrid.hpp"
+#include "celllist.hpp"
+#include "hugepages.hpp"
+#include "particle.hpp"
+#include "threadpool.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// When a particle counts as at rest (SimulationOptions::sleep*)
+struct SleepThresholds {
+    int steps;            // Still steps before a cell freezes
+    double velocity;      // Largest speed at rest
+    double acceleration;  // Largest acceleration at rest
+};
+
+// Work skipped over a run. A frozen particle keeps the state it had when its cell froze, so
+// frozenSpeed * delta_t bounds how far it falls behind the full run per frozen step.
+struct SleepStats {
+    std::uint64_t particleSteps       = 0;  // Particle updates of the run
+    std::uint64_t frozenParticleSteps = 0;  // Of which skipped
+    std::uint64_t cellSteps           = 0;  // Occupied cells visited by each pair pass
+    std::uint64_t skippedCellSteps    = 0;  // Of which skipped
+    std::uint64_t wakeUps             = 0;  // Frozen cells woken by motion nearby
+    double frozenSpeed                = 0;  // Largest speed of a particle when its cell froze
+    double frozenAcceleration         = 0;  // Same for the acceleration
+};
+
+// Rest state of the cells of a CellList. A cell freezes once its particles and those of its 26
+// neighbours have stayed below the thresholds for SleepThresholds::steps steps; the particles
+// of a frozen cell are neither summed nor moved. Motion in the neighbourhood, or a particle
+// entering the cell, wakes it again. With the hashed cell layout the counters follow the cell
+// keys from step to step.
+struct SleepState {
+    CellGrid grid;                          // Grid and layout the counters belong to
+    CellLayout layout = CellLayout::dense;
+    LargeArray<std::uint64_t> keys;         // Hashed layout: key of each counter's cell
+    LargeArray<std::uint32_t> stillSteps;   // Consecutive still steps of each cell
+    LargeArray<std::uint32_t> population;   // Particles of each cell in the previous step
+    LargeArray<std::uint8_t> frozen;        // Particles skipped in this step
+    LargeArray<std::uint8_t> skipped;       // Pair pass work of the cell skipped in this step
+    LargeArray<std::uint8_t> moving;        // Scratch: a particle above the thresholds
+    LargeArray<std::uint32_t> occupied;     // Cells holding particles, the only nonzero flags
+    SleepStats stats;
+};
+
+// Marks the frozen cells of the step (cells binned in `cells`) and the cells whose pair pass
+// work is skipped: every pair the cell visits joins two frozen or empty cells, either in its
+// half stencil (halfStencil) or within the cell itself for the 27-cell gather. Only occupied
+// cells are visited, so the cost follows the particles rather than the grid. The counters
+// start over when the grid changes.
+void markSleepingCells(SleepState & state, CellList const & cells, int steps, bool halfStencil,
+                       ThreadPool & pool);
+
+// Counts one more still step for cells whose 27-cell neighbourhood stayed below the
+// thresholds after the motion of the step, and resets the others
+template <typename T>
+void updateSleepState(SleepState & state, CellList const & cells,
+                      std::vector<BasicParticle<T>> const & particles,
+                      SleepThresholds const & thresholds, ThreadPool & pool);
+
+// Whether particle i belongs to a frozen cell in this step
+inline bool isFrozen(SleepState const & state, CellList const & cells, std::size_t i) {
+  return state.frozen[cells.particleCell[i]] != 0;
+}
+
+// One summary line of the work sleeping skipped
+void printSleepStats(SleepStats const & stats, std::ostream & output);
@@ -0,0 +1,909 @@
+// step.cpp
+#include "step.hpp"
+
+#include "block.hpp"
+#include "cluster.hpp"
+#include "constants.hpp"
+#include "numa.hpp"
+#include "scheduler.hpp"
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+  template <typename Policy>
+  using Accumulators = LargeArray<ParticleAccumulator<Policy>>;
+
+  // Density pair kernel: both particles receive the same increment
+  template <typename Policy>
+  struct DensityKernel {
+      using Storage        = typename Policy::storage_type;
+      using Accumulator    = typename Policy::accumulator_type;
+      using increment_type = Storage;
+
+      Storage height;
+
+      bool evaluate(PolicyParticle<Policy> const & pi, PolicyParticle<Policy> const & pj,
+                    increment_type & increment) const {
+        increment = calculateIncrementedDensity(pi, pj, height);
+        return true;
+      }
+
+      bool evaluate(PolicyParticle<Policy> const & /*pi*/, PolicyParticle<Policy> const & /*pj*/,
+                    PairGeometry<Storage> const & geometry, increment_type & increment) const {
+        increment = calculateIncrementedDensity(geometry, height);
+        return true;
+      }
+
+      static void apply(ParticleAccumulator<Policy> & acc, increment_type increment) {
+        acc.rho += static_cast<Accumulator>(increment);
+      }
+
+      static void applyReaction(ParticleAccumulator<Policy> & acc, increment_type increment) {
+        acc.rho += static_cast<Accumulator>(increment);
+      }
+  };
+
+  // Acceleration pair kernel: the second particle receives the opposite increment
+  template <typename Policy, KernelMath Math = KernelMath::precise>
+  struct AccelerationKernel {
+      using Storage        = typename Policy::storage_type;
+      using Accumulator    = typename Policy::accumulator_type;
+      using increment_type = std::array<Storage, 3>;
+
+      Storage height;
+      Storage mass;
+
+      bool evaluate(PolicyParticle<Policy> const & pi, PolicyParticle<Policy> const & pj,
+                    increment_type & increment) const {
+        if constexpr (Math == KernelMath::fast) {
+          return calculateFastAccelerationIncrement(pi, pj, height, mass, increment);
+        } else {
+          return calculateAccelerationIncrement(pi, pj, height, mass, increment);
+        }
+      }
+
+      bool evaluate(PolicyParticle<Policy> const & pi, PolicyParticle<Policy> const & pj,
+                    PairGeometry<Storage> const & geometry, increment_type & increment) const {
+        if constexpr (Math == KernelMath::fast) {
+          return calculateFastAccelerationIncrement(pi, pj, geometry, height, mass, increment);
+        } else {
+          return calculateAccelerationIncrement(pi, pj, geometry, height, mass, increment);
+        }
+      }
+
+      static void apply(ParticleAccumulator<Policy> & acc, increment_type const & increment) {
+        acc.ax += static_cast<Accumulator>(increment[0]);
+        acc.ay += static_cast<Accumulator>(increment[1]);
+        acc.az += static_cast<Accumulator>(increment[2]);
+      }
+
+      static void applyReaction(ParticleAccumulator<Policy> & acc,
+                                increment_type const & increment) {
+        acc.ax -= static_cast<Accumulator>(increment[0]);
+        acc.ay -= static_cast<Accumulator>(increment[1]);
+        acc.az -= static_cast<Accumulator>(increment[2]);
+      }
+  };
+
+  // Smallest guided chunk of the cell passes
+  constexpr std::size_t GUIDED_MIN_CELLS = 8;
+  // Tasks per thread and colour of the work-stealing cell passes
+  constexpr std::size_t TASKS_PER_THREAD = 4;
+
+  // The task graph covers the cell list passes; cluster passes fall back to work stealing
+  bool usesGraph(SimulationOptions const & options) {
+    return options.schedule == CellSchedule::graph && options.neighbors == NeighborSearch::cells;
+  }
+
+  bool usesStealing(SimulationOptions const & options, ThreadPool const & pool) {
+    return options.neighbors != NeighborSearch::allPairs &&
+           options.schedule != CellSchedule::staticRange && !usesGraph(options) &&
+           pool.size() > 1;
+  }
+
+  bool usesSleeping(SimulationOptions const & options) {
+    return options.sleepSteps > 0 && options.neighbors == NeighborSearch::cells;
+  }
+
+  // The pool lives as long as the workspace and is only rebuilt when the options change
+  template <typename Policy>
+  ThreadPool & workspacePool(StepWorkspace<Policy> & workspace, SimulationOptions const & options) {
+    const int threads = std::max(options.threads, 1);
+    if (!workspace.pool || workspace.pool->size() != threads ||
+        workspace.pinThreads != options.pinThreads) {
+      workspace.pool.reset();
+      workspace.pool       = std::make_unique<ThreadPool>(threads, options.pinThreads);
+      workspace.pinThreads = options.pinThreads;
+      workspace.scheduler.prepare(threads);
+      workspace.memoryPrepared = false;
+    }
+    return *workspace.pool;
+  }
+
+  template <typename Policy>
+  void initializeAccumulators(Accumulators<Policy> & accumulators, std::size_t count) {
+    using Accumulator = typename Policy::accumulator_type;
+    accumulators.assign(count, {Accumulator{0}, static_cast<Accumulator>(a_ext_x),
+                                static_cast<Accumulator>(a_ext_y),
+                                static_cast<Accumulator>(a_ext_z)});
+  }
+
+  // Replaces the (empty or stale) workspace arrays by arrays whose allocator uses `mode`; they
+  // are sized again by the next step
+  template <typename Policy>
+  void useHugePages(StepWorkspace<Policy> & workspace, HugePages mode) {
+    const LargePageAllocator<std::uint32_t> indices(mode);
+    workspace.accumulators =
+        Accumulators<Policy>(LargePageAllocator<ParticleAccumulator<Policy>>(mode));
+    workspace.threadAccumulators.clear();
+    workspace.cells.cellStart     = LargeArray<std::uint32_t>(indices);
+    workspace.cells.particleOrder = LargeArray<std::uint32_t>(indices);
+    workspace.cells.particleCell  = LargeArray<std::uint32_t>(indices);
+    workspace.cells.cursor        = LargeArray<std::uint32_t>(indices);
+    workspace.cells.neighborCells = LargeArray<std::uint32_t>(indices);
+    workspace.cells.cellKeys =
+        LargeArray<std::uint64_t>(LargePageAllocator<std::uint64_t>(mode));
+    workspace.pairCache.threadPairs.clear();
+    workspace.pairCache.cellSpans = LargeArray<PairSpan>(LargePageAllocator<PairSpan>(mode));
+    workspace.hugePages           = mode;
+    workspace.memoryPrepared      = false;
+  }
+
+  // Prepares the memory of the step once, after the first binning has sized the arrays: the
+  // particles (owned by the caller, so not allocated here) are advised for huge pages and every
+  // array is placed on its NUMA node. The arrays keep their capacity from then on, so this
+  // holds for the rest of the run.
+  template <typename Policy>
+  void prepareMemory(std::vector<PolicyParticle<Policy>> const & particles,
+                     StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                     ThreadPool & pool) {
+    initializeAccumulators<Policy>(workspace.accumulators, particles.size());
+    if (options.hugePages != HugePages::off) {
+      (void) adviseHugePages(particles.data(), particles.size() * sizeof(PolicyParticle<Policy>));
+    }
+    workspace.memoryPrepared = true;
+    if (options.numa == NumaPlacement::off) { return; }
+    bool placed      = true;
+    const auto place = [&](auto const & array) {
+      placed = placeArray(array, pool, options.numa, options.numaNode) && placed;
+    };
+    place(particles);
+    place(workspace.accumulators);
+    place(workspace.cells.cellStart);
+    place(workspace.cells.particleOrder);
+    place(workspace.cells.particleCell);
+    if (!placed) {
+      std::cerr << "Warning: the kernel refused part of the NUMA placement; "
+                   "those pages stay where they are.\n";
+    }
+  }
+
+  // Each pair i < j is evaluated once. Thread 0 writes the shared accumulators, the rest write
+  // private copies that are added afterwards in thread order, so the sums depend on the number
+  // of threads but not on scheduling.
+  template <typename Policy, typename Kernel>
+  void halfPairPass(std::vector<PolicyParticle<Policy>> const & particles,
+                    StepWorkspace<Policy> & workspace, ThreadPool & pool, Kernel const & kernel) {
+    const std::size_t count = particles.size();
+    const int threads       = pool.size();
+    const Accumulators<Policy> empty(workspace.accumulators.get_allocator());
+    workspace.threadAccumulators.resize(static_cast<std::size_t>(threads - 1), empty);
+    for (auto & privateAccumulators : workspace.threadAccumulators) {
+      privateAccumulators.assign(count, ParticleAccumulator<Policy>{});
+    }
+    pool.run([&](int thread) {
+      auto & accumulators = thread == 0 ? workspace.accumulators
+                                        : workspace.threadAccumulators[thread - 1];
+      typename Kernel::increment_type increment{};
+      // Rows are dealt round-robin so the triangular workload stays balanced
+      for (auto i = static_cast<std::size_t>(thread); i < count;
+           i += static_cast<std::size_t>(threads)) {
+        for (std::size_t j = i + 1; j < count; ++j) {
+          if (!kernel.evaluate(particles[i], particles[j], increment)) { continue; }
+          Kernel::apply(accumulators[i], increment);
+          Kernel::applyReaction(accumulators[j], increment);
+        }
+      }
+    });
+    if (threads <= 1) { return; }
+    pool.parallelFor(count, [&](std::size_t begin, std::size_t end) {
+      for (auto const & privateAccumulators : workspace.threadAccumulators) {
+        for (std::size_t i = begin; i < end; ++i) {
+          workspace.accumulators[i].rho += privateAccumulators[i].rho;
+          workspace.accumulators[i].ax  += privateAccumulators[i].ax;
+          workspace.accumulators[i].ay  += privateAccumulators[i].ay;
+          workspace.accumulators[i].az  += privateAccumulators[i].az;
+        }
+      }
+    });
+  }
+
+  // Each particle gathers every pair itself, in increasing neighbour index. Pairs are evaluated
+  // twice but every sum has a fixed order, independent of the number of threads.
+  template <typename Policy, typename Kernel>
+  void gatherPass(std::vector<PolicyParticle<Policy>> const & particles,
+                  StepWorkspace<Policy> & workspace, ThreadPool & pool, Kernel const & kernel) {
+    const std::size_t count = particles.size();
+    pool.parallelFor(count, [&](std::size_t begin, std::size_t end) {
+      typename Kernel::increment_type increment{};
+      for (std::size_t i = begin; i < end; ++i) {
+        for (std::size_t j = 0; j < count; ++j) {
+          if (j == i || !kernel.evaluate(particles[i], particles[j], increment)) { continue; }
+          Kernel::apply(workspace.accumulators[i], increment);
+        }
+      }
+    });
+  }
+
+  // Which stage of the pair cache a cell pass is
+  enum class PairCacheStage { unused, record, replay };
+
+  // Pair sources of the cell passes: visit(thread, cell, half, pair) calls pair(i, j) or
+  // pair(i, j, geometry) for the pairs of `cell`, in the order of visitHalfStencilPairs (half)
+  // or visitFullStencilPairs
+  struct StencilPairs {
+      CellList const & cells;
+
+      template <typename Pair>
+      void visit(int /*thread*/, std::size_t cell, bool half, Pair && pair) const {
+        if (half) {
+          visitHalfStencilPairs(cells, cell, pair);
+        } else {
+          visitFullStencilPairs(cells, cell, pair);
+        }
+      }
+  };
+
+  // Walks the stencil like StencilPairs and appends the pairs inside the smoothing length, with
+  // their geometry, to the buffer of the visiting thread. Pairs outside would add 0 to the
+  // densities and are skipped, so the sums match StencilPairs bit for bit.
+  template <typename Policy>
+  struct RecordedPairs {
+      using Storage = typename Policy::storage_type;
+
+      CellList const & cells;
+      std::vector<PolicyParticle<Policy>> const & particles;
+      PairCache<Storage> & cache;
+      Storage hSquared;
+
+      template <typename Pair>
+      void visit(int thread, std::size_t cell, bool half, Pair && pair) const {
+        auto & buffer           = cache.threadPairs[static_cast<std::size_t>(thread)];
+        const std::size_t begin = buffer.size();
+        auto record             = [&](std::uint32_t i, std::uint32_t j) {
+          const PairGeometry<Storage> geometry = calculatePairGeometry(particles[i], particles[j]);
+          if (!(geometry.distanceSquared < hSquared)) { return; }
+          buffer.push_back({i, j, geometry});
+          pair(i, j, geometry);
+        };
+        StencilPairs{cells}.visit(thread, cell, half, record);
+        cache.cellSpans[cell] = {static_cast<std::uint32_t>(thread),
+                                 static_cast<std::uint32_t>(buffer.size() - begin), begin};
+      }
+  };
+
+  // Streams back the pairs RecordedPairs kept for the cell, whichever thread recorded them
+  template <typename Policy>
+  struct CachedPairs {
+      PairCache<typename Policy::storage_type> const & cache;
+
+      template <typename Pair>
+      void visit(int /*thread*/, std::size_t cell, bool /*half*/, Pair && pair) const {
+        const PairSpan span = cache.cellSpans[cell];
+        auto const & buffer = cache.threadPairs[span.thread];
+        for (std::size_t k = span.begin; k < span.begin + span.count; ++k) {
+          pair(buffer[k].i, buffer[k].j, buffer[k].geometry);
+        }
+      }
+  };
+
+  // Empties the thread buffers (keeping their capacity) before the density pass records
+  template <typename Policy>
+  void resetPairCache(StepWorkspace<Policy> & workspace, int threads) {
+    using Storage = typename Policy::storage_type;
+    auto & cache  = workspace.pairCache;
+    const LargeArray<CachedPair<Storage>> empty(
+        LargePageAllocator<CachedPair<Storage>>(workspace.hugePages));
+    cache.threadPairs.resize(static_cast<std::size_t>(threads), empty);
+    for (auto & buffer : cache.threadPairs) { buffer.clear(); }
+    cache.cellSpans.resize(workspace.cells.cellCount());
+  }
+
+  // Pairs a cell evaluates: its particles times those of the cells of its stencil (the half
+  // stencil plus the cell itself, or the full stencil)
+  std::uint64_t cellPairWeight(CellList const & cells, std::size_t cell, bool halfStencil) {
+    const std::uint64_t own = cells.cellStart[cell + 1] - cells.cellStart[cell];
+    if (own == 0) { return 0; }
+    std::uint64_t neighbors = halfStencil ? own : 0;
+    for (std::size_t k = halfStencil ? HALF_STENCIL_BEGIN : 0; k < FULL_STENCIL_SIZE; ++k) {
+      const std::size_t neighbor  = cells.neighbor(cell, k);
+      neighbors                  += cells.cellStart[neighbor + 1] - cells.cellStart[neighbor];
+    }
+    return own * neighbors;
+  }
+
+  // Task groups of the scheduled cell passes: one group per colour for the half stencil (items
+  // index the colour's slice of colorCells), a single group over all cells for the gather.
+  // Cells skipped by sleeping weigh nothing.
+  template <typename Policy>
+  void buildCellTasks(StepWorkspace<Policy> & workspace, bool halfStencilPass, bool sleeping,
+                      int threads) {
+    CellList const & cells = workspace.cells;
+    auto & weights         = workspace.cellWeights;
+    const std::size_t target = static_cast<std::size_t>(threads) * TASKS_PER_THREAD;
+    const auto awake         = [&](std::size_t cell) {
+      return !sleeping || workspace.sleep.skipped[cell] == 0;
+    };
+    workspace.cellTasks.clear();
+    if (!halfStencilPass) {
+      weights.resize(cells.cellCount());
+      for (std::size_t cell = 0; cell < cells.cellCount(); ++cell) {
+        weights[cell] = awake(cell) ? cellPairWeight(cells, cell, false) : 0;
+      }
+      appendWeightedGroup(weights, target, workspace.cellTasks);
+      return;
+    }
+    for (std::size_t color = 0; color < CELL_COLOR_COUNT; ++color) {
+      const std::size_t first = cells.colorStart[color];
+      weights.resize(cells.colorStart[color + 1] - first);
+      for (std::size_t k = 0; k < weights.size(); ++k) {
+        const std::size_t cell = cells.colorCells[first + k];
+        weights[k]             = awake(cell) ? cellPairWeight(cells, cell, true) : 0;
+      }
+      appendWeightedGroup(weights, target, workspace.cellTasks);
+    }
+  }
+
+  // Half-stencil cell traversal: each cell pairs its own particles and those of its 13 forward
+  // neighbours, so every pair is evaluated once. Colours run one after another and the cells of
+  // a colour are split among threads; cells of one colour write disjoint accumulators, so no
+  // private copies are needed and the sums depend neither on the thread count nor on which
+  // thread runs a cell. With `stealing` the cells of a colour are weighted tasks of the
+  // work-stealing scheduler; a colour's tasks are seeded before the barrier that opens it.
+  // makeWork(thread) returns the per-thread callable that processes one cell.
+  template <typename Policy, typename MakeWork>
+  void cellHalfStencilPass(StepWorkspace<Policy> & workspace, ThreadPool & pool, bool stealing,
+                           MakeWork const & makeWork) {
+    CellList const & cells = workspace.cells;
+    const int threads      = pool.size();
+    pool.run([&](int thread) {
+      auto work = makeWork(thread);
+      if (stealing) {
+        TaskGroups const & groups         = workspace.cellTasks;
+        WorkStealingScheduler & scheduler = workspace.scheduler;
+        scheduler.seed(thread, groups, 0, 0);
+        pool.barrier();
+        for (std::size_t color = 0; color < CELL_COLOR_COUNT; ++color) {
+          const std::size_t first = cells.colorStart[color];
+          scheduler.execute(thread, groups, static_cast<int>(color % 2), [&](IndexRange items) {
+            for (std::size_t k = items.begin; k < items.end; ++k) {
+              work(cells.colorCells[first + k]);
+            }
+          });
+          if (color + 1 < CELL_COLOR_COUNT) {
+            scheduler.seed(thread, groups, color + 1, static_cast<int>((color + 1) % 2));
+          }
+          pool.barrier();
+        }
+        return;
+      }
+      for (std::size_t color = 0; color < CELL_COLOR_COUNT; ++color) {
+        const std::size_t first = cells.colorStart[color];
+        const IndexRange range  = threadRange(cells.colorStart[color + 1] - first, thread, threads);
+        for (std::size_t k = range.begin; k < range.end; ++k) { work(cells.colorCells[first + k]); }
+        pool.barrier();
+      }
+    });
+  }
+
+  // Owner-computes cell traversal: each cell only writes the sums of its own particles, so the
+  // cells can run in any order on any thread
+  template <typename Policy, typename MakeWork>
+  void cellGatherPass(StepWorkspace<Policy> & workspace, ThreadPool & pool, bool stealing,
+                      MakeWork const & makeWork) {
+    if (stealing) {
+      pool.run([&](int thread) {
+        auto work = makeWork(thread);
+        workspace.scheduler.seed(thread, workspace.cellTasks, 0, 0);
+        pool.barrier();
+        workspace.scheduler.execute(thread, workspace.cellTasks, 0, [&](IndexRange cellRange) {
+          for (std::size_t cell = cellRange.begin; cell < cellRange.end; ++cell) { work(cell); }
+        });
+      });
+      return;
+    }
+    // Occupancy varies a lot between cells, so the cells are handed out in guided chunks
+    pool.parallelFor(workspace.cells.cellCount(), [&](std::size_t begin, std::size_t end,
+                                                      int thread) {
+      auto work = makeWork(thread);
+      for (std::size_t cell = begin; cell < end; ++cell) { work(cell); }
+    }, Partition::guided, GUIDED_MIN_CELLS);
+  }
+
+  // makeWork(thread) of the cell passes: the callable that evaluates the pairs of one cell
+  template <typename Policy, typename Kernel, typename Pairs>
+  auto cellWorkFactory(std::vector<PolicyParticle<Policy>> const & particles,
+                       StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                       Kernel const & kernel, Pairs const & pairs) {
+    const bool sleeping = usesSleeping(options);
+    const bool gather   = options.reduction == ReductionMode::deterministic;
+    return [&particles, &workspace, &kernel, &pairs, sleeping, gather](int thread) {
+      return [&, thread, increment = typename Kernel::increment_type{}](std::size_t cell) mutable {
+        if (sleeping && workspace.sleep.skipped[cell] != 0) { return; }
+        auto & accumulators = workspace.accumulators;
+        pairs.visit(thread, cell, !gather,
+                    [&](std::uint32_t i, std::uint32_t j, auto const &... geometry) {
+                      if (!kernel.evaluate(particles[i], particles[j], geometry..., increment)) {
+                        return;
+                      }
+                      Kernel::apply(accumulators[i], increment);
+                      if (!gather) { Kernel::applyReaction(accumulators[j], increment); }
+                    });
+      };
+    };
+  }
+
+  // Pair-by-pair cell passes: the half stencil applies every pair to both particles, the
+  // 27-cell gather (deterministic reduction) lets each particle gather its pairs in a fixed
+  // order. Cells whose pairs only join frozen particles are skipped.
+  template <typename Policy, typename Kernel, typename Pairs>
+  void cellPass(std::vector<PolicyParticle<Policy>> const & particles,
+                StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                ThreadPool & pool, Kernel const & kernel, Pairs const & pairs) {
+    const bool stealing = usesStealing(options, pool);
+    const auto makeWork = cellWorkFactory(particles, workspace, options, kernel, pairs);
+    if (options.reduction == ReductionMode::deterministic) {
+      cellGatherPass(workspace, pool, stealing, makeWork);
+    } else {
+      cellHalfStencilPass(workspace, pool, stealing, makeWork);
+    }
+  }
+
+  // Cluster passes: the same cell schedules, but each cell evaluates the tiles of its clusters
+  // into lane sums, which are added to the particle accumulators afterwards. The fast reduction
+  // uses half pair lists (colours keep the written clusters disjoint), the deterministic one
+  // full lists.
+  template <typename Policy, typename Tiles>
+  void clusterPass(StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                   ThreadPool & pool, bool densities, Tiles const & tiles) {
+    using Accumulator                = typename Policy::accumulator_type;
+    ClusterList<Policy> & clusters   = workspace.clusters;
+    const std::size_t lanes          = clusters.particle.size();
+    if (densities) {
+      clusters.rho.assign(lanes, Accumulator{0});
+    } else {
+      clusters.ax.assign(lanes, Accumulator{0});
+      clusters.ay.assign(lanes, Accumulator{0});
+      clusters.az.assign(lanes, Accumulator{0});
+    }
+    const auto makeWork = [&](int /*thread*/) {
+      return [&](std::size_t cell) {
+        for (std::uint32_t ci = clusters.cellClusters[cell]; ci < clusters.cellClusters[cell + 1];
+             ++ci) {
+          tiles(ci);
+        }
+      };
+    };
+    const bool stealing = usesStealing(options, pool);
+    if (options.reduction == ReductionMode::deterministic) {
+      cellGatherPass(workspace, pool, stealing, makeWork);
+    } else {
+      cellHalfStencilPass(workspace, pool, stealing, makeWork);
+    }
+    auto & accumulators = workspace.accumulators;
+    pool.parallelFor(lanes, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t lane = begin; lane < end; ++lane) {
+        const std::uint32_t particle = clusters.particle[lane];
+        if (particle == NO_PARTICLE) { continue; }
+        if (densities) {
+          accumulators[particle].rho += clusters.rho[lane];
+        } else {
+          accumulators[particle].ax += clusters.ax[lane];
+          accumulators[particle].ay += clusters.ay[lane];
+          accumulators[particle].az += clusters.az[lane];
+        }
+      }
+    });
+  }
+
+  // `stage` only matters for the cell passes; the all-pairs passes never use the pair cache
+  template <typename Policy, typename Kernel>
+  void pairPass(std::vector<PolicyParticle<Policy>> const & particles,
+                StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                ThreadPool & pool, Kernel const & kernel,
+                PairCacheStage stage = PairCacheStage::unused) {
+    const bool deterministic = options.reduction == ReductionMode::deterministic;
+    if (options.neighbors == NeighborSearch::cells) {
+      if (stage == PairCacheStage::record) {
+        resetPairCache(workspace, pool.size());
+        cellPass(particles, workspace, options, pool, kernel,
+                 RecordedPairs<Policy>{workspace.cells, particles, workspace.pairCache,
+                                       kernel.height * kernel.height});
+      } else if (stage == PairCacheStage::replay) {
+        cellPass(particles, workspace, options, pool, kernel,
+                 CachedPairs<Policy>{workspace.pairCache});
+      } else {
+        cellPass(particles, workspace, options, pool, kernel, StencilPairs{workspace.cells});
+      }
+    } else if (deterministic) {
+      gatherPass(particles, workspace, pool, kernel);
+    } else {
+      halfPairPass(particles, workspace, pool, kernel);
+    }
+  }
+
+  // Particles of frozen cells keep the density and motion they froze with
+  template <typename Policy>
+  bool frozenParticle(StepWorkspace<Policy> const & workspace, bool sleeping, std::size_t i) {
+    return sleeping && isFrozen(workspace.sleep, workspace.cells, i);
+  }
+
+  template <typename Policy>
+  void transformParticle(PolicyParticle<Policy> & particle,
+                         ParticleAccumulator<Policy> const & accumulator,
+                         typename Policy::storage_type height, typename Policy::storage_type mass) {
+    using Storage     = typename Policy::storage_type;
+    using Accumulator = typename Policy::accumulator_type;
+    particle.rho      = static_cast<Storage>(calculateTransformedDensity(
+        accumulator.rho, static_cast<Accumulator>(height), static_cast<Accumulator>(mass)));
+  }
+
+  template <typename Policy>
+  void integrateParticle(PolicyParticle<Policy> & particle,
+                         ParticleAccumulator<Policy> const & accumulator) {
+    using Storage = typename Policy::storage_type;
+    particle.ax   = static_cast<Storage>(accumulator.ax);
+    particle.ay   = static_cast<Storage>(accumulator.ay);
+    particle.az   = static_cast<Storage>(accumulator.az);
+    processCollisions(particle);
+    updateParticleMotion(particle);
+  }
+
+  // Partial of `thread` when an analytics sample is due in this step
+  template <typename Policy>
+  AnalyticsPartial * analyticsPartial(StepWorkspace<Policy> const & workspace, int thread) {
+    return workspace.analytics == nullptr
+               ? nullptr
+               : &workspace.analytics->partials[static_cast<std::size_t>(thread)];
+  }
+
+  // Frozen particles are sampled with the density and motion they keep
+  template <typename Policy>
+  void transformDensities(std::vector<PolicyParticle<Policy>> & particles,
+                          StepWorkspace<Policy> const & workspace, bool sleeping,
+                          ThreadPool & pool, typename Policy::storage_type height,
+                          typename Policy::storage_type mass) {
+    auto const & accumulators = workspace.accumulators;
+    pool.parallelFor(particles.size(), [&](std::size_t begin, std::size_t end, int thread) {
+      AnalyticsPartial * partial = analyticsPartial(workspace, thread);
+      for (std::size_t i = begin; i < end; ++i) {
+        if (!frozenParticle(workspace, sleeping, i)) {
+          transformParticle<Policy>(particles[i], accumulators[i], height, mass);
+        }
+        if (partial != nullptr) { partial->addDensity(particles[i]); }
+      }
+    });
+  }
+
+  template <typename Policy>
+  void integrateParticles(std::vector<PolicyParticle<Policy>> & particles,
+                          StepWorkspace<Policy> const & workspace, bool sleeping,
+                          ThreadPool & pool) {
+    auto const & accumulators = workspace.accumulators;
+    pool.parallelFor(particles.size(), [&](std::size_t begin, std::size_t end, int thread) {
+      AnalyticsPartial * partial = analyticsPartial(workspace, thread);
+      for (std::size_t i = begin; i < end; ++i) {
+        if (!frozenParticle(workspace, sleeping, i)) {
+          integrateParticle<Policy>(particles[i], accumulators[i]);
+        }
+        if (partial != nullptr) { partial->addMotion(particles[i]); }
+      }
+    });
+  }
+
+  // Task graph schedule: task phase * blocks + block runs `phase` over the cells of `block`.
+  // A block's density transform waits for every density pass that writes its particles, its
+  // accelerations for the transforms of the blocks around it (whose densities it reads) and
+  // its motion for every acceleration pass that reads or writes its particles. With the half
+  // stencil, neighbouring blocks also write to each other's particles, so their pair passes
+  // run in block colour order; the sums then have the same order for any thread count.
+  enum class BlockPhase : std::uint32_t { densities, densityTransform, accelerations, motion };
+  constexpr std::uint32_t BLOCK_PHASE_COUNT = 4;
+
+  void buildStepGraph(CellBlocks const & blocks, bool halfStencil, TaskGraph & graph) {
+    const auto count = static_cast<std::uint32_t>(blocks.count());
+    const auto task  = [count](BlockPhase phase, std::uint32_t block) {
+      return static_cast<std::uint32_t>(phase) * count + block;
+    };
+    graph.reset(static_cast<std::size_t>(BLOCK_PHASE_COUNT) * count);
+    for (std::uint32_t block = 0; block < count; ++block) {
+      const std::array<int, 3> c = blocks.coordinates(block);
+      const int color            = blocks.color(block);
+      for (const CellOffset & offset : fullStencil()) {
+        const std::uint32_t other = blocks.find(c[0] + offset[0], c[1] + offset[1],
+                                                c[2] + offset[2]);
+        if (other == CellBlocks::NO_BLOCK) { continue; }
+        if (halfStencil || other == block) {
+          graph.addDependency(task(BlockPhase::densities, other),
+                              task(BlockPhase::densityTransform, block));
+        }
+        graph.addDependency(task(BlockPhase::densityTransform, other),
+                            task(BlockPhase::accelerations, block));
+        graph.addDependency(task(BlockPhase::accelerations, other),
+                            task(BlockPhase::motion, block));
+        if (halfStencil && blocks.color(other) < color) {
+          graph.addDependency(task(BlockPhase::densities, other),
+                              task(BlockPhase::densities, block));
+          graph.addDependency(task(BlockPhase::accelerations, other),
+                              task(BlockPhase::accelerations, block));
+        }
+      }
+    }
+    graph.finalize();
+  }
+
+  // Densities to motion of the cell list as one task graph run
+  template <typename Policy, typename DensityPairs, typename Kernel, typename AccelerationPairs>
+  void runStepGraph(std::vector<PolicyParticle<Policy>> & particles,
+                    StepWorkspace<Policy> & workspace, SimulationOptions const & options,
+                    ThreadPool & pool, DensityPairs const & densityPairs, Kernel const & kernel,
+                    AccelerationPairs const & accelerationPairs) {
+    using Storage                   = typename Policy::storage_type;
+    const DensityKernel<Policy> densityKernel{kernel.height};
+    const auto densityWork =
+        cellWorkFactory(particles, workspace, options, densityKernel, densityPairs);
+    const auto accelerationWork =
+        cellWorkFactory(particles, workspace, options, kernel, accelerationPairs);
+    CellBlocks const & blocks = workspace.blocks;
+    CellList const & cells    = workspace.cells;
+    auto const & accumulators = workspace.accumulators;
+    const bool sleeping       = usesSleeping(options);
+    const Storage height      = kernel.height;
+    const Storage mass        = kernel.mass;
+    const auto count          = static_cast<std::uint32_t>(blocks.count());
+    workspace.graph.execute(pool, [&](std::uint32_t task, int thread) {
+      const std::uint32_t block  = task % count;
+      const auto phase           = static_cast<BlockPhase>(task / count);
+      AnalyticsPartial * partial = analyticsPartial(workspace, thread);
+      // body(i) for the particles that are not frozen; sample(i) for all when a sample is due
+      const auto eachParticle = [&](auto && body, auto && sample) {
+        for (std::uint32_t k = blocks.blockStart[block]; k < blocks.blockStart[block + 1]; ++k) {
+          const std::uint32_t cell = blocks.cells[k];
+          const bool frozen        = sleeping && workspace.sleep.frozen[cell] != 0;
+          if (frozen && partial == nullptr) { continue; }
+          for (std::uint32_t m = cells.cellStart[cell]; m < cells.cellStart[cell + 1]; ++m) {
+            const std::uint32_t i = cells.particleOrder[m];
+            if (!frozen) { body(i); }
+            if (partial != nullptr) { sample(i); }
+          }
+        }
+      };
+      const auto eachCell = [&](auto && work) {
+        for (std::uint32_t k = blocks.blockStart[block]; k < blocks.blockStart[block + 1]; ++k) {
+          work(blocks.cells[k]);
+        }
+      };
+      switch (phase) {
+        case BlockPhase::densities:
+          eachCell(densityWork(thread));
+          break;
+        case BlockPhase::densityTransform:
+          eachParticle(
+              [&](std::uint32_t i) {
+                transformParticle<Policy>(particles[i], accumulators[i], height, mass);
+              },
+              [&](std::uint32_t i) { partial->addDensity(particles[i]); });
+          break;
+        case BlockPhase::accelerations:
+          eachCell(accelerationWork(thread));
+          break;
+        case BlockPhase::motion:
+          eachParticle(
+              [&](std::uint32_t i) { integrateParticle<Policy>(particles[i], accumulators[i]); },
+              [&](std::uint32_t i) { partial->addMotion(particles[i]); });
+          break;
+      }
+    });
+  }
+
+  // Picks the pair sources (pair cache stages) and the acceleration kernel of the graph run
+  template <typename Policy>
+  void stepGraph(std::vector<PolicyParticle<Policy>> & particles, StepWorkspace<Policy> & workspace,
+                 SimulationOptions const & options, ThreadPool & pool,
+                 typename Policy::storage_type height, typename Policy::storage_type mass) {
+    const auto withKernel = [&](auto const & kernel) {
+      if (options.pairCache) {
+        resetPairCache(workspace, pool.size());
+        runStepGraph(particles, workspace, options, pool,
+                     RecordedPairs<Policy>{workspace.cells, particles, workspace.pairCache,
+                                           height * height},
+                     kernel, CachedPairs<Policy>{workspace.pairCache});
+      } else {
+        runStepGraph(particles, workspace, options, pool, StencilPairs{workspace.cells}, kernel,
+                     StencilPairs{workspace.cells});
+      }
+    };
+    if (options.math == KernelMath::fast) {
+      withKernel(AccelerationKernel<Policy, KernelMath::fast>{height, mass});
+    } else {
+      withKernel(AccelerationKernel<Policy>{height, mass});
+    }
+  }
+
+}  // namespace
+
+template <typename Policy>
+void stepParticles(std::vector<PolicyParticle<Policy>> & particles,
+                   ParticleParameters const & params, StepWorkspace<Policy> & workspace,
+                   SimulationOptions const & options) {
+  using Storage     = typename Policy::storage_type;
+  const auto height = static_cast<Storage>(params.smoothingLength);
+  const auto mass   = static_cast<Storage>(params.mass);
+  ThreadPool & pool = workspacePool(workspace, options);
+  StepProfile * profile = workspace.profile;
+  if (workspace.analytics != nullptr &&
+      workspace.analytics->partials.size() < static_cast<std::size_t>(pool.size())) {
+    workspace.analytics->partials.resize(static_cast<std::size_t>(pool.size()));
+  }
+  if (profile != nullptr) { profile->attach(pool); }
+  if (workspace.hugePages != options.hugePages) { useHugePages(workspace, options.hugePages); }
+
+  const CellLayout layout = chooseCellLayout(workspace.cells, params.blockSize, params.blocks,
+                                             particles.size(), options);
+  setCellGrid(workspace.cells, params.blockSize, params.blocks, layout);
+  CellGrid const & grid = workspace.cells.grid;
+  {
+    const PhaseScope scope(profile, StepPhase::reposition);
+    pool.parallelFor(particles.size(), [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        repositionParticle(particles[i], grid);
+      }
+    });
+  }
+  const bool sleeping = usesSleeping(options);
+  if (options.neighbors != NeighborSearch::allPairs) {
+    const PhaseScope scope(profile, StepPhase::binning);
+    buildCellList(particles, params.blockSize, params.blocks, workspace.cells, layout);
+    if (options.neighbors == NeighborSearch::clusters) {
+      buildClusters(particles, workspace.cells, height, options.reduction == ReductionMode::fast,
+                    pool, workspace.clusters);
+    }
+    if (sleeping) {
+      markSleepingCells(workspace.sleep, workspace.cells, options.sleepSteps,
+                        options.reduction == ReductionMode::fast, pool);
+    }
+    if (usesStealing(options, pool)) {
+      buildCellTasks(workspace, options.reduction == ReductionMode::fast, sleeping, pool.size());
+    }
+    if (usesGraph(options)) {
+      buildCellBlocks(workspace.cells, std::max(options.graphBlockCells, 2), workspace.blocks);
+      buildStepGraph(workspace.blocks, options.reduction == ReductionMode::fast, workspace.graph);
+    }
+  }
+  if ((options.numa != NumaPlacement::off || options.hugePages != HugePages::off) &&
+      !workspace.memoryPrepared) {
+    prepareMemory(particles, workspace, options, pool);
+  }
+  const SleepThresholds thresholds{options.sleepSteps, options.sleepVelocity,
+                                   options.sleepAcceleration};
+  if (usesGraph(options)) {
+    const PhaseScope scope(profile, StepPhase::phaseGraph);
+    initializeAccumulators<Policy>(workspace.accumulators, particles.size());
+    stepGraph(particles, workspace, options, pool, height, mass);
+    if (sleeping) {
+      updateSleepState(workspace.sleep, workspace.cells, particles, thresholds, pool);
+    }
+  } else {
+    {
+      const PhaseScope scope(profile, StepPhase::densities);
+      initializeAccumulators<Policy>(workspace.accumulators, particles.size());
+      if (options.neighbors == NeighborSearch::clusters) {
+        clusterPass(workspace, options, pool, true, [&](std::uint32_t ci) {
+          clusterDensities(workspace.clusters, ci, height);
+        });
+      } else {
+        pairPass(particles, workspace, options, pool, DensityKernel<Policy>{height},
+                 options.pairCache ? PairCacheStage::record : PairCacheStage::unused);
+      }
+    }
+    {
+      const PhaseScope scope(profile, StepPhase::densityTransform);
+      transformDensities<Policy>(particles, workspace, sleeping, pool, height, mass);
+    }
+    {
+      const PhaseScope scope(profile, StepPhase::accelerations);
+      if (options.neighbors == NeighborSearch::clusters) {
+        clusterPass(workspace, options, pool, false, [&](std::uint32_t ci) {
+          clusterAccelerations(workspace.clusters, ci, height, mass, options.math);
+        });
+      } else {
+        const PairCacheStage stage =
+            options.pairCache ? PairCacheStage::replay : PairCacheStage::unused;
+        if (options.math == KernelMath::fast) {
+          pairPass(particles, workspace, options, pool,
+                   AccelerationKernel<Policy, KernelMath::fast>{height, mass}, stage);
+        } else {
+          pairPass(particles, workspace, options, pool, AccelerationKernel<Policy>{height, mass},
+                   stage);
+        }
+      }
+    }
+    {
+      const PhaseScope scope(profile, StepPhase::motion);
+      integrateParticles<Policy>(particles, workspace, sleeping, pool);
+      if (sleeping) {
+        updateSleepState(workspace.sleep, workspace.cells, particles, thresholds, pool);
+      }
+    }
+  }
+  if (profile != nullptr && usesStealing(options, pool)) {
+    profile->recordLoad(workspace.scheduler.takeLoad());
+  } else if (profile != nullptr && usesGraph(options)) {
+    profile->recordLoad(workspace.graph.takeLoad());
+  }
+}
+
+template <typename Policy>
+std::vector<std::uint64_t> residentBytesPerNode(std::vector<PolicyParticle<Policy>> const & particles,
+                                                StepWorkspace<Policy> const & workspace) {
+  std::vector<std::uint64_t> total(static_cast<std::size_t>(numaNodeCount()), 0);
+  const auto add = [&](void const * data, std::size_t bytes) {
+    const std::vector<std::uint64_t> resident = residentBytesPerNode(data, bytes);
+    for (std::size_t node = 0; node < total.size(); ++node) { total[node] += resident[node]; }
+  };
+  add(particles.data(), particles.size() * sizeof(PolicyParticle<Policy>));
+  add(workspace.accumulators.data(),
+      workspace.accumulators.size() * sizeof(ParticleAccumulator<Policy>));
+  add(workspace.cells.cellStart.data(), workspace.cells.cellStart.size() * sizeof(std::uint32_t));
+  add(workspace.cells.particleOrder.data(),
+      workspace.cells.particleOrder.size() * sizeof(std::uint32_t));
+  add(workspace.cells.particleCell.data(),
+      workspace.cells.particleCell.size() * sizeof(std::uint32_t));
+  return total;
+}
+
+template <typename To, typename From>
+std::vector<BasicParticle<To>> convertParticles(std::vector<BasicParticle<From>> const & particles) {
+  std::vector<BasicParticle<To>> converted;
+  converted.reserve(particles.size());
+  for (auto const & p : particles) {
+    converted.push_back({static_cast<To>(p.px), static_cast<To>(p.py), static_cast<To>(p.pz),
+                         static_cast<To>(p.hvx), static_cast<To>(p.hvy), static_cast<To>(p.hvz),
+                         static_cast<To>(p.vx), static_cast<To>(p.vy), static_cast<To>(p.vz),
+                         static_cast<To>(p.rho), static_cast<To>(p.ax), static_cast<To>(p.ay),
+                         static_cast<To>(p.az)});
+  }
+  return converted;
+}
+
+template void stepParticles<FloatPrecision>(std::vector<Particle> &, ParticleParameters const &,
+                                            StepWorkspace<FloatPrecision> &, SimulationOptions const &);
+template void stepParticles<MixedPrecision>(std::vector<Particle> &, ParticleParameters const &,
+                                            StepWorkspace<MixedPrecision> &, SimulationOptions const &);
+template void stepParticles<DoublePrecision>(std::vector<BasicParticle<double>> &,
+                                             ParticleParameters const &,
+                                             StepWorkspace<DoublePrecision> &,
+                                             SimulationOptions const &);
+template std::vector<std::uint64_t>
+    residentBytesPerNode<FloatPrecision>(std::vector<Particle> const &,
+                                         StepWorkspace<FloatPrecision> const &);
+template std::vector<std::uint64_t>
+    residentBytesPerNode<MixedPrecision>(std::vector<Particle> const &,
+                                         StepWorkspace<MixedPrecision> const &);
+template std::vector<std::uint64_t>
+    residentBytesPerNode<DoublePrecision>(std::vector<BasicParticle<double>> const &,
+                                          StepWorkspace<DoublePrecision> const &);
+template std::vector<Particle> convertParticles<float, float>(std::vector<Particle> const &);
+template std::vector<BasicParticle<double>>
+    convertParticles<double, float>(std::vector<Particle> const &);
+template std::vector<BasicParticle<double>>
+    convertParticles<double, double>(std::vector<BasicParticle<double>> const &);
+template std::vector<Particle>
+    convertParticles<float, double>(std::vector<BasicParticle<double>> const &);
@@ -0,0 +1,101 @@
+// step.hpp
+#pragma once
+
+#include "analytics.hpp"
+#include "celllist.hpp"
+#include "cluster.hpp"
+#include "hugepages.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "profile.hpp"
+#include "scheduler.hpp"
+#include "sleep.hpp"
+#include "taskgraph.hpp"
+#include "threadpool.hpp"
+#include "utils.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Density and acceleration sums of one particle, kept in the accumulator type of the policy
+template <typename Policy>
+struct ParticleAccumulator {
+    typename Policy::accumulator_type rho;
+    typename Policy::accumulator_type ax, ay, az;
+};
+
+// A pair within the smoothing length, as found by the density pass
+template <typename T>
+struct CachedPair {
+    std::uint32_t i, j;
+    PairGeometry<T> geometry;
+};
+
+// The pairs of one cell in the buffer of the thread that visited it
+struct PairSpan {
+    std::uint32_t thread;
+    std::uint32_t count;
+    std::size_t begin;
+};
+
+// Interacting pairs of the cell passes with their separations, recorded by the density pass
+// and streamed back by the acceleration pass in the same order (SimulationOptions::pairCache)
+template <typename T>
+struct PairCache {
+    std::vector<LargeArray<CachedPair<T>>> threadPairs;  // One buffer per pool thread
+    LargeArray<PairSpan> cellSpans;                      // Indexed by cell
+};
+
+// Scratch memory reused between steps
+template <typename Policy>
+struct StepWorkspace {
+    LargeArray<ParticleAccumulator<Policy>> accumulators;
+    // Private sums of threads 1..n-1 in the fast reduction mode
+    std::vector<LargeArray<ParticleAccumulator<Policy>>> threadAccumulators;
+    CellList cells;
+    PairCache<typename Policy::storage_type> pairCache;
+    ClusterList<Policy> clusters;
+    // Frozen cells and the work they saved over the run (SimulationOptions::sleepSteps)
+    SleepState sleep;
+    // Worker threads of the run, created by the first step
+    std::unique_ptr<ThreadPool> pool;
+    bool pinThreads = true;
+    HugePages hugePages = HugePages::off;  // Allocator mode of the arrays above
+    // Particles advised for huge pages and arrays placed according to SimulationOptions::numa
+    bool memoryPrepared = false;
+    // Occupancy-weighted cell tasks of the work-stealing passes, rebuilt every step
+    WorkStealingScheduler scheduler;
+    TaskGroups cellTasks;
+    std::vector<std::uint64_t> cellWeights;
+    // Cell blocks and phase tasks of the task graph schedule, rebuilt every step
+    CellBlocks blocks;
+    TaskGraph graph;
+    // Per-phase measurements, owned by the caller; nullptr disables them
+    StepProfile * profile = nullptr;
+    // Partials of a due analytics sample, owned by the caller; nullptr on the other steps
+    AnalyticsState * analytics = nullptr;
+};
+
+template <typename Policy>
+using PolicyParticle = BasicParticle<typename Policy::storage_type>;
+
+// One time step: reposition, densities, density transform, accelerations, collisions and
+// motion. Sums are carried in Policy::accumulator_type and rounded to storage once per step.
+// options.neighbors selects the pair search and options.threads / options.reduction how the pair
+// passes are split across threads.
+template <typename Policy>
+void stepParticles(std::vector<PolicyParticle<Policy>> & particles,
+                   ParticleParameters const & params, StepWorkspace<Policy> & workspace,
+                   SimulationOptions const & options = {});
+
+// Resident bytes of the particle, accumulator and cell arrays on each NUMA node
+template <typename Policy>
+std::vector<std::uint64_t> residentBytesPerNode(std::vector<PolicyParticle<Policy>> const & particles,
+                                                StepWorkspace<Policy> const & workspace);
+
+// Converts particles between storage types (e.g. to run the double precision policy)
+template <typename To, typename From>
+std::vector<BasicParticle<To>> convertParticles(std::vector<BasicParticle<From>> const & particles);
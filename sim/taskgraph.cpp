@@ -0,0 +1,57 @@
+// taskgraph.cpp
+#include "taskgraph.hpp"
+
+#include <numeric>
+
+void TaskGraph::reset(std::size_t count) {
+  edges.clear();
+  dependencies.assign(count, 0);
+  successorStart.assign(count + 1, 0);
+  successors.clear();
+}
+
+void TaskGraph::finalize() {
+  for (auto const & [before, after] : edges) {
+    ++successorStart[before + 1];
+    ++dependencies[after];
+  }
+  std::partial_sum(successorStart.begin(), successorStart.end(), successorStart.begin());
+  std::vector<std::uint32_t> next(successorStart.begin(), successorStart.end() - 1);
+  successors.resize(edges.size());
+  for (auto const & [before, after] : edges) { successors[next[before]++] = after; }
+}
+
+void TaskGraph::prepareRun(int threads) {
+  const std::size_t count = size();
+  if (capacity < count) {
+    remaining = std::make_unique<std::atomic<std::uint32_t>[]>(count);
+    queue     = std::make_unique<std::atomic<std::uint32_t>[]>(count);
+    capacity  = count;
+  }
+  if (loads.size() < static_cast<std::size_t>(threads)) {
+    loads.resize(static_cast<std::size_t>(threads));
+  }
+  nextSlot.store(0, std::memory_order_relaxed);
+  nextTicket.store(0, std::memory_order_relaxed);
+  for (std::size_t task = 0; task < count; ++task) {
+    remaining[task].store(dependencies[task], std::memory_order_relaxed);
+    queue[task].store(NO_TASK, std::memory_order_relaxed);
+  }
+  // Tasks without dependencies are queued in increasing order; the pool start publishes them
+  for (std::size_t task = 0; task < count; ++task) {
+    if (dependencies[task] == 0) {
+      queue[nextSlot.fetch_add(1, std::memory_order_relaxed)].store(
+          static_cast<std::uint32_t>(task), std::memory_order_relaxed);
+    }
+  }
+}
+
+std::vector<ThreadLoad> TaskGraph::takeLoad() {
+  std::vector<ThreadLoad> taken;
+  taken.reserve(loads.size());
+  for (PaddedLoad & padded : loads) {
+    taken.push_back(padded.load);
+    padded.load = ThreadLoad{};
+  }
+  return taken;
+}
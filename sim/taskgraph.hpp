@@ -0,0 +1,91 @@
+// taskgraph.hpp
+#pragma once
+
+#include "profile.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Tasks with explicit dependencies, run by all threads of a pool without barriers: a task
+// starts as soon as every task it depends on has finished. Ready tasks enter a shared queue in
+// the order they become ready. Each thread takes the next ticket of the queue and waits until
+// that slot is filled, so a queue slot is never contended and a thread only waits while every
+// remaining task still depends on one that is running.
+class TaskGraph {
+  public:
+    static constexpr std::uint32_t NO_TASK = ~std::uint32_t{0};
+
+    // Empties the graph and gives it `count` tasks without dependencies
+    void reset(std::size_t count);
+
+    // `after` waits for `before`
+    void addDependency(std::uint32_t before, std::uint32_t after) {
+      edges.emplace_back(before, after);
+    }
+
+    // Sorts the dependencies into successor lists; called once they are all added
+    void finalize();
+
+    [[nodiscard]] std::size_t size() const { return dependencies.size(); }
+
+    [[nodiscard]] std::size_t dependencyCount() const { return successors.size(); }
+
+    // Runs body(task, thread) for every task on the threads of `pool`
+    template <typename Body>
+    void execute(ThreadPool & pool, Body && body) {
+      prepareRun(pool.size());
+      const std::uint32_t count = static_cast<std::uint32_t>(size());
+      const int spins           = pool.spinIterations();
+      pool.run([&](int thread) {
+        ThreadLoad & load = loads[static_cast<std::size_t>(thread)].load;
+        while (true) {
+          const std::uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+          if (ticket >= count) { return; }
+          spinThenWait(queue[ticket], NO_TASK, spins);
+          const std::uint32_t task = queue[ticket].load(std::memory_order_acquire);
+          const auto start         = std::chrono::steady_clock::now();
+          body(task, thread);
+          load.busySeconds +=
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          ++load.tasks;
+          for (std::uint32_t k = successorStart[task]; k < successorStart[task + 1]; ++k) {
+            const std::uint32_t next = successors[k];
+            if (remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1) { push(next); }
+          }
+        }
+      });
+    }
+
+    // Load of each thread since the last call
+    std::vector<ThreadLoad> takeLoad();
+
+  private:
+    struct alignas(64) PaddedLoad {
+        ThreadLoad load;
+    };
+
+    void prepareRun(int threads);
+
+    void push(std::uint32_t task) {
+      const std::uint32_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+      queue[slot].store(task, std::memory_order_release);
+      queue[slot].notify_one();
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::vector<std::uint32_t> dependencies;  // Tasks each task waits for
+    std::vector<std::uint32_t> successorStart{0};
+    std::vector<std::uint32_t> successors;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> remaining;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> queue;
+    std::size_t capacity = 0;
+    alignas(64) std::atomic<std::uint32_t> nextSlot{0};
+    alignas(64) std::atomic<std::uint32_t> nextTicket{0};
+    std::vector<PaddedLoad> loads;
+};
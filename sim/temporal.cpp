@@ -0,0 +1,287 @@
+// temporal.cpp
+#include "temporal.hpp"
+
+#include "cellgrid.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+namespace {
+
+  // Planned displacement over the block as a multiple of the one the current motion gives
+  constexpr float DISPLACEMENT_MARGIN = 2.0F;
+  // Rerun displacement as a multiple of the largest one measured
+  constexpr float RERUN_MARGIN = 2.0F;
+  // Largest share of the particles a tile and its halo may hold. Beyond it every tile steps
+  // most of the particles again, and one pass over the whole grid does the block for less.
+  constexpr double TILE_SHARE_LIMIT = 0.5;
+
+  // Cells of a tile and of the tile with its halo, per axis
+  struct TileCells {
+      std::array<int, 3> low{};
+      std::array<int, 3> high{};
+      std::array<int, 3> ownLow{};
+      std::array<int, 3> ownHigh{};
+  };
+
+  TileCells tileCells(CellGrid const & grid, std::array<int, 3> const & tile, int size,
+                      int halo) {
+    const std::array<int, 3> counts{grid.nx, grid.ny, grid.nz};
+    TileCells cells;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      cells.ownLow[axis]  = tile[axis] * size;
+      cells.ownHigh[axis] = std::min(cells.ownLow[axis] + size, counts[axis]) - 1;
+      cells.low[axis]     = std::max(cells.ownLow[axis] - halo, 0);
+      cells.high[axis]    = std::min(cells.ownHigh[axis] + halo, counts[axis] - 1);
+    }
+    return cells;
+  }
+
+  // Calls visit(first, last) for the cellOrder range of every row of cells in [low, high];
+  // rows are contiguous in the sorted order
+  template <typename Policy, typename Visit>
+  void forEachRow(CellGrid const & grid, TileCells const & cells,
+                  TemporalWorkspace<Policy> const & workspace, Visit && visit) {
+    for (int cz = cells.low[2]; cz <= cells.high[2]; ++cz) {
+      for (int cy = cells.low[1]; cy <= cells.high[1]; ++cy) {
+        const std::size_t first = grid.cellIndex(cells.low[0], cy, cz);
+        const std::size_t last  = grid.cellIndex(cells.high[0], cy, cz);
+        visit(workspace.cellStart[first], workspace.cellStart[last + 1]);
+      }
+    }
+  }
+
+  // Cells of every particle at the block start, sorted in increasing particle index per cell
+  template <typename Policy>
+  void sortByCell(std::vector<PolicyParticle<Policy>> const & particles, CellGrid const & grid,
+                  TemporalWorkspace<Policy> & workspace) {
+    workspace.cellStart.assign(grid.cellCount() + 1, 0);
+    std::vector<std::uint32_t> cells(particles.size());
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      const CellOffset c = grid.locate(particles[i]);
+      cells[i]           = static_cast<std::uint32_t>(grid.cellIndex(c[0], c[1], c[2]));
+      ++workspace.cellStart[cells[i] + 1];
+    }
+    std::partial_sum(workspace.cellStart.begin(), workspace.cellStart.end(),
+                     workspace.cellStart.begin());
+    std::vector<std::uint32_t> next(workspace.cellStart.begin(), workspace.cellStart.end() - 1);
+    workspace.cellOrder.resize(particles.size());
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      workspace.cellOrder[next[cells[i]]++] = static_cast<std::uint32_t>(i);
+    }
+  }
+
+  // Displacement bound of the block from the current half-step velocities and accelerations,
+  // assuming the accelerations stay within their current range
+  template <typename Policy>
+  float plannedDisplacement(std::vector<PolicyParticle<Policy>> const & particles, int steps) {
+    double speed        = 0.0;
+    double acceleration = 0.0;
+    for (auto const & p : particles) {
+      speed = std::max({speed, std::abs(static_cast<double>(p.hvx)),
+                        std::abs(static_cast<double>(p.hvy)),
+                        std::abs(static_cast<double>(p.hvz))});
+      acceleration = std::max({acceleration, std::abs(static_cast<double>(p.ax)),
+                               std::abs(static_cast<double>(p.ay)),
+                               std::abs(static_cast<double>(p.az))});
+    }
+    const double time = static_cast<double>(steps) * static_cast<double>(delta_t);
+    return DISPLACEMENT_MARGIN * static_cast<float>(speed * time + acceleration * time * time);
+  }
+
+  // Halo of cells for `steps` steps: the exact region shrinks by r cells per step. A halo as
+  // wide as the grid holds every particle, so it is exact whatever the motion (NaN included).
+  int haloCells(ParticleParameters const & params, CellGrid const & grid, float displacement,
+                int steps) {
+    const double width = std::min({grid.width[0], grid.width[1], grid.width[2]});
+    const double reach = 2.0 * static_cast<double>(params.smoothingLength) +
+                         2.0 * static_cast<double>(displacement);
+    const double halo  = static_cast<double>(steps) * (std::floor(reach / width) + 1.0);
+    const int widest   = std::max({grid.nx, grid.ny, grid.nz});
+    return halo < static_cast<double>(widest) ? static_cast<int>(halo) : widest;
+  }
+
+  // Chebyshev distance moved since the block start
+  template <typename T>
+  float distance(BasicParticle<T> const & a, BasicParticle<T> const & b) {
+    return static_cast<float>(std::max({std::abs(a.px - b.px), std::abs(a.py - b.py),
+                                        std::abs(a.pz - b.pz)}));
+  }
+
+  template <typename Policy>
+  StepWorkspace<Policy> & threadWorkspace(TemporalWorkspace<Policy> & workspace, int thread) {
+    return *workspace.threadWorkspaces[static_cast<std::size_t>(thread)];
+  }
+
+  // Whether the tiles do less work than the whole grid with `halo`: the halo leaves part of the
+  // grid out and no tile with its halo holds more than TILE_SHARE_LIMIT of the particles
+  template <typename Policy>
+  bool tilesPay(CellGrid const & grid, std::array<int, 3> const & tiles, int size, int halo,
+                TemporalWorkspace<Policy> const & workspace, std::size_t particles) {
+    if (halo >= std::max({grid.nx, grid.ny, grid.nz})) { return false; }
+    const auto limit = static_cast<std::size_t>(TILE_SHARE_LIMIT * static_cast<double>(particles));
+    for (int tz = 0; tz < tiles[2]; ++tz) {
+      for (int ty = 0; ty < tiles[1]; ++ty) {
+        for (int tx = 0; tx < tiles[0]; ++tx) {
+          std::size_t held = 0;
+          forEachRow(grid, tileCells(grid, {tx, ty, tz}, size, halo), workspace,
+                     [&held](std::uint32_t first, std::uint32_t last) { held += last - first; });
+          if (held > limit) { return false; }
+        }
+      }
+    }
+    return true;
+  }
+
+  // Runs the block for one tile and keeps the particles the tile owns
+  template <typename Policy>
+  std::uint64_t runTile(std::vector<PolicyParticle<Policy>> const & particles,
+                        ParticleParameters const & params, int steps,
+                        SimulationOptions const & options, CellGrid const & grid,
+                        std::array<int, 3> const & tile, int halo,
+                        TemporalWorkspace<Policy> & workspace, StepWorkspace<Policy> & local) {
+    const TileCells cells = tileCells(grid, tile, options.temporalTileCells, halo);
+    // Local particles keep the order of their indices, so cells list them as the full run does
+    std::vector<std::uint32_t> indices;
+    forEachRow(grid, cells, workspace, [&](std::uint32_t first, std::uint32_t last) {
+      indices.insert(indices.end(), workspace.cellOrder.begin() + first,
+                     workspace.cellOrder.begin() + last);
+    });
+    std::sort(indices.begin(), indices.end());
+    std::vector<PolicyParticle<Policy>> copy;
+    copy.reserve(indices.size());
+    for (const std::uint32_t i : indices) { copy.push_back(particles[i]); }
+    std::vector<PolicyParticle<Policy>> const start = copy;
+    std::vector<float> moved(copy.size(), 0.0F);
+    for (int step = 0; step < steps; ++step) {
+      stepParticles(copy, params, local, options);
+      for (std::size_t k = 0; k < copy.size(); ++k) {
+        moved[k] = std::max(moved[k], distance(copy[k], start[k]));
+      }
+    }
+    for (std::size_t k = 0; k < copy.size(); ++k) {
+      const CellOffset c = grid.locate(start[k]);
+      bool owned         = true;
+      for (std::size_t axis = 0; axis < 3; ++axis) {
+        owned = owned && c[axis] >= cells.ownLow[axis] && c[axis] <= cells.ownHigh[axis];
+      }
+      if (owned) {
+        workspace.next[indices[k]]         = copy[k];
+        workspace.displacement[indices[k]] = moved[k];
+      }
+    }
+    return copy.size();
+  }
+
+}  // namespace
+
+bool usesTemporalBlocking(SimulationOptions const & options) {
+  return options.temporalSteps > 1 && options.neighbors != NeighborSearch::allPairs &&
+         options.sleepSteps == 0;
+}
+
+template <typename Policy>
+void advanceTemporalBlock(std::vector<PolicyParticle<Policy>> & particles,
+                          ParticleParameters const & params, int steps,
+                          SimulationOptions const & options,
+                          TemporalWorkspace<Policy> & workspace) {
+  const int threads = std::max(options.threads, 1);
+  if (!workspace.pool || workspace.pool->size() != threads) {
+    workspace.pool = std::make_unique<ThreadPool>(threads, options.pinThreads);
+    workspace.threadWorkspaces.clear();
+    for (int thread = 0; thread < threads; ++thread) {
+      workspace.threadWorkspaces.push_back(std::make_unique<StepWorkspace<Policy>>());
+    }
+  }
+  // Each tile runs on one thread, with memory placement left to the thread that touches it
+  SimulationOptions tileOptions = options;
+  tileOptions.threads           = 1;
+  tileOptions.numa              = NumaPlacement::off;
+  tileOptions.profile           = false;
+
+  const CellGrid grid = makeCellGrid(params.blockSize, params.blocks);
+  sortByCell<Policy>(particles, grid, workspace);
+  const int size = std::max(options.temporalTileCells, 1);
+  const std::array<int, 3> tiles{(grid.nx + size - 1) / size, (grid.ny + size - 1) / size,
+                                 (grid.nz + size - 1) / size};
+  const auto tileCount = static_cast<std::size_t>(tiles[0] * tiles[1] * tiles[2]);
+  float planned        = plannedDisplacement<Policy>(particles, steps);
+  workspace.next       = particles;
+  workspace.displacement.assign(particles.size(), 0.0F);
+  while (true) {
+    const int halo = haloCells(params, grid, planned, steps);
+    if (!tilesPay(grid, tiles, size, halo, workspace, particles.size())) {
+      // Stepping the whole grid is exact whatever the motion, so no rerun is needed
+      for (int step = 0; step < steps; ++step) {
+        stepParticles(particles, params, workspace.wholeGrid, options);
+      }
+      ++workspace.stats.blocks;
+      ++workspace.stats.wholeGridBlocks;
+      const std::uint64_t updates =
+          static_cast<std::uint64_t>(particles.size()) * static_cast<std::uint64_t>(steps);
+      workspace.stats.localParticleSteps += updates;
+      workspace.stats.ownedParticleSteps += updates;
+      return;
+    }
+    std::atomic<std::size_t> nextTile{0};
+    std::atomic<std::uint64_t> local{0};
+    workspace.pool->run([&](int thread) {
+      std::uint64_t computed = 0;
+      for (std::size_t t = nextTile.fetch_add(1); t < tileCount; t = nextTile.fetch_add(1)) {
+        const auto index = static_cast<int>(t);
+        const std::array<int, 3> tile{index % tiles[0], index / tiles[0] % tiles[1],
+                                      index / tiles[0] / tiles[1]};
+        computed += runTile<Policy>(particles, params, steps, tileOptions, grid, tile, halo,
+                                    workspace, threadWorkspace(workspace, thread));
+      }
+      local += computed;
+    });
+    workspace.stats.tiles              += tileCount;
+    workspace.stats.localParticleSteps += local.load() * static_cast<std::uint64_t>(steps);
+    workspace.stats.largestHalo         = std::max(workspace.stats.largestHalo, halo);
+    const float moved =
+        workspace.displacement.empty()
+            ? 0.0F
+            : *std::max_element(workspace.displacement.begin(), workspace.displacement.end());
+    if (moved <= planned) { break; }
+    // Some particle moved further than the halo allowed for: its neighbours may be wrong
+    ++workspace.stats.reruns;
+    planned = RERUN_MARGIN * moved;
+  }
+  ++workspace.stats.blocks;
+  workspace.stats.ownedParticleSteps +=
+      static_cast<std::uint64_t>(particles.size()) * static_cast<std::uint64_t>(steps);
+  particles.swap(workspace.next);
+}
+
+void printTemporalStats(TemporalStats const & stats, std::ostream & output) {
+  const double redundant =
+      stats.ownedParticleSteps == 0
+          ? 0.0
+          : static_cast<double>(stats.localParticleSteps) /
+                static_cast<double>(stats.ownedParticleSteps);
+  output << "Temporal blocking: " << stats.blocks << " blocks (" << stats.wholeGridBlocks
+         << " over the whole grid), " << stats.tiles << " tile runs, " << stats.reruns
+         << " reruns, halo up to " << stats.largestHalo
+         << " cells, " << std::fixed << std::setprecision(2) << redundant
+         << " particle updates computed per update kept\n"
+         << std::defaultfloat;
+}
+
+template void advanceTemporalBlock<FloatPrecision>(std::vector<Particle> &,
+                                                   ParticleParameters const &, int,
+                                                   SimulationOptions const &,
+                                                   TemporalWorkspace<FloatPrecision> &);
+template void advanceTemporalBlock<MixedPrecision>(std::vector<Particle> &,
+                                                   ParticleParameters const &, int,
+                                                   SimulationOptions const &,
+                                                   TemporalWorkspace<MixedPrecision> &);
+template void advanceTemporalBlock<DoublePrecision>(std::vector<BasicParticle<double>> &,
+                                                    ParticleParameters const &, int,
+                                                    SimulationOptions const &,
+                                                    TemporalWorkspace<DoublePrecision> &);
@@ -0,0 +1,63 @@
+// temporal.hpp
+#pragma once
+
+#include "options.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+#include "threadpool.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Work of the temporal blocks over a run
+struct TemporalStats {
+    std::uint64_t blocks             = 0;  // Runs of SimulationOptions::temporalSteps steps
+    std::uint64_t reruns             = 0;  // Blocks repeated with a wider halo
+    std::uint64_t wholeGridBlocks    = 0;  // Blocks stepped over the whole grid, without tiles
+    std::uint64_t tiles              = 0;  // Tile runs, reruns included
+    std::uint64_t ownedParticleSteps = 0;  // Particle updates kept
+    std::uint64_t localParticleSteps = 0;  // Particle updates computed, halos included
+    int largestHalo                  = 0;  // Cells around a tile, per axis
+};
+
+// Scratch memory reused between blocks
+template <typename Policy>
+struct TemporalWorkspace {
+    std::vector<PolicyParticle<Policy>> next;   // Particles at the end of the block
+    std::vector<float> displacement;            // Largest displacement of each particle
+    std::vector<std::uint32_t> cellStart;       // Particles sorted by cell at the block start
+    std::vector<std::uint32_t> cellOrder;
+    std::vector<std::unique_ptr<StepWorkspace<Policy>>> threadWorkspaces;
+    std::unique_ptr<ThreadPool> pool;
+    StepWorkspace<Policy> wholeGrid;  // Blocks whose halo leaves the tiles no gain
+    TemporalStats stats;
+};
+
+// Whether runs with `options` advance in temporal blocks: the cell searches without sleeping,
+// whose state belongs to the whole grid
+bool usesTemporalBlocking(SimulationOptions const & options);
+
+// Advances `steps` steps tile by tile. The interior cells are cut into tiles of
+// options.temporalTileCells cells per axis, and each tile advances all the steps on its own
+// copy of the particles within a halo of cells, which can stay in cache. A particle's step
+// reads the particles within two smoothing lengths, so the halo where the copy is exact shrinks
+// by r = floor((2h + 2d) / w) + 1 cells per step, where d bounds how far any particle moves
+// during the block and w is the narrowest cell. The halo is steps * r cells, so the tile's own
+// particles (kept; the halo is thrown away) end exactly where the step-by-step run puts them.
+// Binning and pair order only depend on the cell and the particle index, so the result is
+// bit-identical. d is planned from the velocities and accelerations and checked against the
+// motion of every particle; a block whose particles moved further runs again with a wider
+// halo. When the halo covers the grid, or a tile with its halo holds more than half the
+// particles, each tile would step most of the particles again, so the block is stepped over the
+// whole grid instead.
+template <typename Policy>
+void advanceTemporalBlock(std::vector<PolicyParticle<Policy>> & particles,
+                          ParticleParameters const & params, int steps,
+                          SimulationOptions const & options,
+                          TemporalWorkspace<Policy> & workspace);
+
+// One summary line of the blocks, redundant work and reruns
+void printTemporalStats(TemporalStats const & stats, std::ostream & output);
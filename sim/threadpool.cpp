@@ -0,0 +1,92 @@
+// threadpool.cpp
+#include "threadpool.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+  std::atomic<std::uint64_t> nextSerial{0};
+
+  std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) { return cpus; }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) { cpus.push_back(cpu); }
+    }
+    return cpus;
+  }
+
+  void pinToCpu(std::thread & thread, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+  }
+
+}  // namespace
+
+void SpinBarrier::arriveAndWait() {
+  if (count <= 1) { return; }
+  const std::uint32_t current = generation.load(std::memory_order_acquire);
+  if (arrived.fetch_add(1, std::memory_order_acq_rel) == count - 1) {
+    arrived.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    return;
+  }
+  spinThenWait(generation, current, spins);
+}
+
+ThreadPool::ThreadPool(int threads, bool pin)
+  : threads(std::max(threads, 1)),
+    spins(static_cast<int>(allowedCpus().size()) >= this->threads ? SPIN_ITERATIONS : 0),
+    serial(nextSerial.fetch_add(1) + 1), phaseBarrier(this->threads, spins) {
+  // Workers are pinned only when each one can have a CPU of its own; pinning an oversubscribed
+  // pool would stack threads that the scheduler could otherwise spread. The calling thread runs
+  // share 0 but belongs to the caller (an embedding program's host thread), so its affinity is
+  // left alone: worker t takes the t-th allowed CPU and the first one stays free for it.
+  const std::vector<int> cpus = allowedCpus();
+  pinnedThreads = pin && this->threads > 1 && spins > 0;
+  workers.reserve(static_cast<std::size_t>(this->threads - 1));
+  for (int thread = 1; thread < this->threads; ++thread) {
+    workers.emplace_back(&ThreadPool::workerLoop, this, thread);
+    if (pinnedThreads) { pinToCpu(workers.back(), cpus[static_cast<std::size_t>(thread)]); }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  stopping = true;
+  generation.fetch_add(1, std::memory_order_release);
+  generation.notify_all();
+  for (auto & worker : workers) { worker.join(); }
+}
+
+void ThreadPool::dispatch(Job job) {
+  if (threads == 1) {
+    job.invoke(job.context, 0);
+    return;
+  }
+  current = job;
+  pending.store(threads - 1, std::memory_order_relaxed);
+  generation.fetch_add(1, std::memory_order_release);
+  generation.notify_all();
+  job.invoke(job.context, 0);
+  for (int left = pending.load(std::memory_order_acquire); left != 0;
+       left = pending.load(std::memory_order_acquire)) {
+    spinThenWait(pending, left, spins);
+  }
+}
+
+void ThreadPool::workerLoop(int thread) {
+  std::uint64_t seen = 0;
+  while (true) {
+    spinThenWait(generation, seen, spins);
+    seen = generation.load(std::memory_order_acquire);
+    if (stopping) { return; }
+    current.invoke(current.context, thread);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { pending.notify_one(); }
+  }
+}
@@ -0,0 +1,147 @@
+// threadpool.hpp
+#pragma once
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pause iterations a waiter spins before it parks, when every thread has a CPU of its own
+constexpr int SPIN_ITERATIONS = 2048;
+
+// Spins up to `spins` times and then sleeps on the atomic until it no longer holds `old`
+template <typename T>
+void spinThenWait(std::atomic<T> const & value, T old, int spins) {
+  for (int spin = 0; spin < spins; ++spin) {
+    if (value.load(std::memory_order_acquire) != old) { return; }
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+  }
+  while (value.load(std::memory_order_acquire) == old) {
+    value.wait(old, std::memory_order_acquire);
+  }
+}
+
+// Reusable barrier for a fixed number of threads; waiters spin before they park
+class SpinBarrier {
+  public:
+    SpinBarrier(int count, int spins) : count(count), spins(spins) { }
+
+    void arriveAndWait();
+
+  private:
+    int count;
+    int spins;
+    std::atomic<int> arrived{0};
+    std::atomic<std::uint32_t> generation{0};
+};
+
+enum class Partition {
+  staticRange,  // One contiguous range per thread
+  guided        // Threads take shrinking chunks of the remaining range from a shared counter
+};
+
+// Workers started once and reused by every parallel phase. run() wakes them through a
+// generation counter and the calling thread takes part as thread 0, so a phase costs a wake-up
+// and a join instead of creating threads. Waiters spin before parking only when the pool has
+// no more threads than available CPUs; otherwise a spinning thread would hold the CPU that the
+// thread it waits for needs. Pinning applies to the workers only; the calling thread keeps its
+// affinity, and the first allowed CPU is left to it.
+class ThreadPool {
+  public:
+    explicit ThreadPool(int threads, bool pin = true);
+    ~ThreadPool();
+    ThreadPool(ThreadPool const &)             = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+    ThreadPool(ThreadPool &&)                  = delete;
+    ThreadPool & operator=(ThreadPool &&)      = delete;
+
+    [[nodiscard]] int size() const { return threads; }
+
+    [[nodiscard]] bool pinned() const { return pinnedThreads; }
+
+    // Pause iterations a waiter of this pool spins before it parks
+    [[nodiscard]] int spinIterations() const { return spins; }
+
+    // Distinct for every pool created by the program
+    [[nodiscard]] std::uint64_t id() const { return serial; }
+
+    // Runs body(thread) on every thread of the pool and returns when all have finished
+    template <typename Body>
+    void run(Body && body) {
+      using Callable = std::remove_reference_t<Body>;
+      void * context = const_cast<void *>(static_cast<void const *>(&body));
+      dispatch({context, [](void * target, int thread) {
+                  (*static_cast<Callable *>(target))(thread);
+                }});
+    }
+
+    // Waits for every thread of the pool; only valid inside run()
+    void barrier() { phaseBarrier.arriveAndWait(); }
+
+    // Runs body(begin, end) over [0, count); guided chunks are never smaller than minChunk.
+    // A body taking (begin, end, thread) also receives the pool thread running the range.
+    template <typename Body>
+    void parallelFor(std::size_t count, Body && body, Partition partition = Partition::staticRange,
+                     std::size_t minChunk = 64) {
+      if (partition == Partition::staticRange || threads == 1) {
+        run([&](int thread) {
+          const IndexRange range = threadRange(count, thread, threads);
+          if (range.begin < range.end) { invokeRange(body, range.begin, range.end, thread); }
+        });
+        return;
+      }
+      nextIndex.store(0, std::memory_order_relaxed);
+      const std::size_t divisor = 2 * static_cast<std::size_t>(threads);
+      run([&](int thread) {
+        while (true) {
+          std::size_t begin = nextIndex.load(std::memory_order_relaxed);
+          std::size_t chunk = 0;
+          do {
+            if (begin >= count) { return; }
+            chunk = std::max((count - begin) / divisor, minChunk);
+          } while (
+              !nextIndex.compare_exchange_weak(begin, begin + chunk, std::memory_order_relaxed));
+          invokeRange(body, begin, std::min(begin + chunk, count), thread);
+        }
+      });
+    }
+
+  private:
+    template <typename Body>
+    static void invokeRange(Body & body, std::size_t begin, std::size_t end, int thread) {
+      if constexpr (std::is_invocable_v<Body &, std::size_t, std::size_t, int>) {
+        body(begin, end, thread);
+      } else {
+        body(begin, end);
+      }
+    }
+
+    struct Job {
+        void * context;
+        void (*invoke)(void *, int);
+    };
+
+    void dispatch(Job job);
+    void workerLoop(int thread);
+
+    int threads;
+    int spins;
+    std::uint64_t serial;
+    bool pinnedThreads = false;
+    std::vector<std::thread> workers;
+    Job current{nullptr, nullptr};
+    std::atomic<std::uint64_t> generation{0};
+    std::atomic<int> pending{0};
+    std::atomic<std::size_t> nextIndex{0};
+    bool stopping = false;
+    SpinBarrier phaseBarrier;
+};
@@ -0,0 +1,183 @@
+// trajectory.cpp
+#include "trajectory.hpp"
+
+#include "entropy.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+  constexpr std::size_t PLANES = sizeof(std::uint32_t);
+
+  // Fields of a frame: the selected ones but the id
+  OutputFields frameFields(OutputFields fields) {
+    fields.id = false;
+    return fields;
+  }
+
+  template <typename T>
+  void writeArray(std::ofstream & output, T const * data, std::size_t count) {
+    output.write(reinterpret_cast<char const *>(data),
+                 static_cast<std::streamsize>(count * sizeof(T)));
+  }
+
+  template <typename T>
+  bool readArray(std::ifstream & input, T * data, std::size_t count) {
+    input.read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(input);
+  }
+
+}  // namespace
+
+TrajectoryWriter::TrajectoryWriter(std::string const & filename, Header const & input,
+                                   OutputFilter const & filter, int keyframeInterval)
+  : output(filename, std::ios::binary), fields(frameFields(filter.fields)),
+    columns(selectedOutputColumns(fields)),
+    indices(sampleOutputIndices(static_cast<std::size_t>(std::max(input.np, 0)), filter)) {
+  header.columns          = static_cast<std::uint32_t>(columns.size());
+  header.ppm              = input.ppm;
+  header.particles        = static_cast<std::uint32_t>(indices.size());
+  header.keyframeInterval = static_cast<std::uint32_t>(std::max(keyframeInterval, 1));
+  header.fields           = outputFieldMask(fields);
+  if (!output.is_open()) {
+    std::cerr << "Could not open trajectory file: " << filename << '\n';
+    return;
+  }
+  writeArray(output, &header, 1);
+  writeArray(output, indices.data(), indices.size());
+}
+
+bool TrajectoryWriter::writeFrame(int step, std::vector<Particle> const & particles) {
+  if (!isOpen()) { return false; }
+  values.resize(columns.size() * indices.size());
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const * base = reinterpret_cast<char const *>(particles.data());
+  for (std::size_t c = 0; c < columns.size(); ++c) {
+    std::uint32_t * column = values.data() + c * indices.size();
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+      std::memcpy(&column[k], base + indices[k] * sizeof(Particle) + columns[c].member,
+                  sizeof(std::uint32_t));
+    }
+  }
+  const bool keyframe = index.size() % header.keyframeInterval == 0;
+  plane.resize(values.size());
+  encoded.clear();
+  for (std::size_t b = 0; b < PLANES; ++b) {
+    const auto shift = static_cast<unsigned>(8 * b);
+    for (std::size_t k = 0; k < values.size(); ++k) {
+      const std::uint32_t word = keyframe ? values[k] : values[k] ^ previous[k];
+      plane[k]                 = static_cast<std::uint8_t>(word >> shift);
+    }
+    encodeBytes(plane, encoded);
+  }
+  previous.swap(values);
+
+  TrajectoryFrameEntry entry;
+  entry.step     = static_cast<std::uint32_t>(step);
+  entry.keyframe = keyframe ? 1 : 0;
+  entry.offset   = static_cast<std::uint64_t>(output.tellp());
+  entry.bytes    = encoded.size();
+  writeArray(output, encoded.data(), encoded.size());
+  index.push_back(entry);
+  ++totals.frames;
+  if (keyframe) { ++totals.keyframes; }
+  totals.rawBytes     += previous.size() * sizeof(std::uint32_t);
+  totals.encodedBytes += encoded.size();
+  return isOpen();
+}
+
+bool TrajectoryWriter::finish() {
+  if (!isOpen()) { return false; }
+  TrajectoryFooter footer;
+  footer.indexOffset = static_cast<std::uint64_t>(output.tellp());
+  footer.frames      = static_cast<std::uint32_t>(index.size());
+  writeArray(output, index.data(), index.size());
+  writeArray(output, &footer, 1);
+  output.close();
+  return !output.fail();
+}
+
+TrajectoryReader::TrajectoryReader(std::string const & filename)
+  : input(filename, std::ios::binary) {
+  if (!readArray(input, &fileHeader, 1) || fileHeader.magic != TRAJECTORY_MAGIC ||
+      fileHeader.version != TRAJECTORY_VERSION || fileHeader.keyframeInterval == 0 ||
+      fileHeader.columns != selectedOutputColumns(outputFieldsOfMask(fileHeader.fields)).size()) {
+    return;
+  }
+  indices.resize(fileHeader.particles);
+  TrajectoryFooter footer;
+  if (!readArray(input, indices.data(), indices.size()) ||
+      !input.seekg(-static_cast<std::streamoff>(sizeof(TrajectoryFooter)), std::ios::end) ||
+      !readArray(input, &footer, 1) || footer.version != TRAJECTORY_VERSION) {
+    return;
+  }
+  index.resize(footer.frames);
+  input.seekg(static_cast<std::streamoff>(footer.indexOffset));
+  opened = readArray(input, index.data(), index.size()) && !index.empty() &&
+           index.front().keyframe == 1;
+}
+
+bool TrajectoryReader::readFrame(std::size_t frame, std::vector<float> & values) {
+  if (!opened || frame >= index.size()) { return false; }
+  std::size_t keyframe = frame;
+  while (index[keyframe].keyframe == 0) { --keyframe; }
+  // Playing forwards continues from the frame in memory instead of the keyframe
+  std::size_t next = keyframe;
+  if (currentFrame != std::numeric_limits<std::size_t>::max() && currentFrame >= keyframe &&
+      currentFrame <= frame) {
+    next = currentFrame + 1;
+  } else if (!decodeFrame(keyframe, true)) {
+    return false;
+  } else {
+    next = keyframe + 1;
+  }
+  for (; next <= frame; ++next) {
+    if (!decodeFrame(next, false)) { return false; }
+  }
+  values.resize(current.size());
+  std::memcpy(values.data(), current.data(), current.size() * sizeof(float));
+  return true;
+}
+
+bool TrajectoryReader::decodeFrame(std::size_t frame, bool keyframe) {
+  currentFrame                       = std::numeric_limits<std::size_t>::max();
+  TrajectoryFrameEntry const & entry = index[frame];
+  bytes.resize(entry.bytes);
+  input.clear();
+  input.seekg(static_cast<std::streamoff>(entry.offset));
+  if (!readArray(input, bytes.data(), bytes.size())) { return false; }
+  const std::size_t count = static_cast<std::size_t>(fileHeader.columns) * fileHeader.particles;
+  if (keyframe) { current.assign(count, 0); }
+  if (current.size() != count) { return false; }
+  std::size_t position = 0;
+  for (std::size_t b = 0; b < PLANES; ++b) {
+    const std::size_t size =
+        decodeBytes(std::span<std::uint8_t const>(bytes).subspan(position), plane);
+    if (size == 0 || plane.size() != count) { return false; }
+    position        += size;
+    const auto shift = static_cast<unsigned>(8 * b);
+    for (std::size_t k = 0; k < count; ++k) {
+      current[k] ^= static_cast<std::uint32_t>(plane[k]) << shift;
+    }
+  }
+  ++decoded;
+  currentFrame = frame;
+  return true;
+}
+
+void printTrajectoryStats(TrajectoryStats const & stats, std::string const & filename,
+                          std::ostream & output) {
+  const double ratio = stats.encodedBytes == 0 ? 0.0
+                                               : static_cast<double>(stats.rawBytes) /
+                                                     static_cast<double>(stats.encodedBytes);
+  output << "Trajectory: " << stats.frames << " frames (" << stats.keyframes
+         << " keyframes) written to " << filename << ", " << stats.rawBytes
+         << " bytes of values in " << stats.encodedBytes << " (" << std::fixed
+         << std::setprecision(2) << ratio << "x)\n"
+         << std::defaultfloat;
+}
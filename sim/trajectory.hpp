@@ -0,0 +1,136 @@
+// trajectory.hpp
+#pragma once
+
+#include "options.hpp"
+#include "outputfilter.hpp"
+#include "particle.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Trajectory file: a header, the input indices of the particles of every frame, the frames
+// and an index of them. A frame holds the selected fields of the particles as columns of
+// 32-bit values. A keyframe stores the values themselves and the frames after it the XOR of
+// their bits with the previous frame, which zeroes the sign, exponent and high mantissa
+// bits of a slowly moving value. The values are then split into four planes of their first,
+// second, third and fourth bytes (byte shuffle), and each plane is entropy coded
+// (entropy.hpp). The index at the end of the file gives the offset of every frame, so
+// frame k costs one keyframe and at most keyframeInterval - 1 deltas.
+constexpr std::array<char, 8> TRAJECTORY_MAGIC{'F', 'L', 'D', 'T', 'R', 'A', 'J', '\0'};
+constexpr std::uint32_t TRAJECTORY_VERSION = 1;
+
+struct TrajectoryHeader {
+    std::array<char, 8> magic      = TRAJECTORY_MAGIC;
+    std::uint32_t version          = TRAJECTORY_VERSION;
+    std::uint32_t columns          = 0;  // Scalar fields per particle
+    float ppm                      = 0.0F;
+    std::uint32_t particles        = 0;  // Particles per frame
+    std::uint32_t keyframeInterval = 1;
+    // Mask of the fields (outputFieldMask): position 1, half velocity 2, velocity 4, density 8,
+    // acceleration 16
+    std::uint32_t fields           = 0;
+};
+
+struct TrajectoryFrameEntry {
+    std::uint32_t step     = 0;
+    std::uint32_t keyframe = 0;  // 1 for keyframes
+    std::uint64_t offset   = 0;
+    std::uint64_t bytes    = 0;
+};
+
+// Last bytes of the file: where the index starts and how many frames it lists
+struct TrajectoryFooter {
+    std::uint64_t indexOffset = 0;
+    std::uint32_t frames      = 0;
+    std::uint32_t version     = TRAJECTORY_VERSION;
+};
+
+static_assert(sizeof(TrajectoryHeader) == 32 && sizeof(TrajectoryFrameEntry) == 24 &&
+              sizeof(TrajectoryFooter) == 16);
+
+// Bytes of the frames written so far: raw values and encoded planes
+struct TrajectoryStats {
+    std::uint64_t frames       = 0;
+    std::uint64_t keyframes    = 0;
+    std::uint64_t rawBytes     = 0;
+    std::uint64_t encodedBytes = 0;
+};
+
+// Writes the frames of a run. The particles of a frame are chosen by the sampling of
+// `filter`, which depends on their indices only, and the columns by its fields; the region
+// and the id field do not apply.
+class TrajectoryWriter {
+  public:
+    TrajectoryWriter(std::string const & filename, Header const & header,
+                     OutputFilter const & filter, int keyframeInterval);
+
+    [[nodiscard]] bool isOpen() const { return output.is_open() && output.good(); }
+
+    [[nodiscard]] TrajectoryStats const & stats() const { return totals; }
+
+    // Appends the frame of `particles` after `step` steps
+    bool writeFrame(int step, std::vector<Particle> const & particles);
+
+    // Writes the index and the footer; the file is unreadable without them
+    bool finish();
+
+  private:
+    std::ofstream output;
+    TrajectoryHeader header;
+    OutputFields fields;
+    std::vector<OutputColumn> columns;  // Columns of every frame
+    std::vector<std::uint32_t> indices;
+    std::vector<std::uint32_t> previous;  // Values of the last frame
+    std::vector<std::uint32_t> values;
+    std::vector<std::uint8_t> plane;
+    std::vector<std::uint8_t> encoded;
+    std::vector<TrajectoryFrameEntry> index;
+    TrajectoryStats totals;
+};
+
+// Random access to the frames of a trajectory file
+class TrajectoryReader {
+  public:
+    explicit TrajectoryReader(std::string const & filename);
+
+    [[nodiscard]] bool isOpen() const { return opened; }
+
+    [[nodiscard]] TrajectoryHeader const & header() const { return fileHeader; }
+
+    [[nodiscard]] std::vector<TrajectoryFrameEntry> const & frames() const { return index; }
+
+    // Input indices of the particles of every frame
+    [[nodiscard]] std::vector<std::uint32_t> const & particleIndices() const { return indices; }
+
+    // Values of frame `frame` as header().columns columns of header().particles floats,
+    // decoded from the keyframe at or before it, or from the frame read last when that lies
+    // between them. Returns false on a bad frame or file.
+    bool readFrame(std::size_t frame, std::vector<float> & values);
+
+    // Frames decoded by the reads so far, keyframes included
+    [[nodiscard]] std::uint64_t decodedFrames() const { return decoded; }
+
+  private:
+    std::ifstream input;
+    TrajectoryHeader fileHeader;
+    std::vector<std::uint32_t> indices;
+    std::vector<TrajectoryFrameEntry> index;
+    std::vector<std::uint32_t> current;  // Values of frame currentFrame
+    std::size_t currentFrame = std::numeric_limits<std::size_t>::max();
+    std::vector<std::uint8_t> bytes;
+    std::vector<std::uint8_t> plane;
+    std::uint64_t decoded = 0;
+    bool opened           = false;
+
+    bool decodeFrame(std::size_t frame, bool keyframe);
+};
+
+// One summary line of the frames written and their compression
+void printTrajectoryStats(TrajectoryStats const & stats, std::string const & filename,
+                          std::ostream & output);
@@ -1,176 +1,344 @@
-// utils.cpp
-#include "utils.hpp"
-
-#include "block.hpp"
-#include "particle.hpp"
-
-#include <array>
-#include <chrono>
-#include <cmath>
-#include <cstring>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <vector>
-#include <algorithm>
-#include <cctype>
-#include <string>
-
-constexpr size_t ParticleDataSize = sizeof(float) * 9;
-
-bool readHeader(std::ifstream & inFile, Header & header) {
-  std::array<char, sizeof(header.ppm)> buffer{};
-  inFile.read(buffer.data(), sizeof(header.ppm));
-  memcpy(&header.ppm, buffer.data(), sizeof(header.ppm));
-
-  inFile.read(buffer.data(), sizeof(header.np));
-  memcpy(&header.np, buffer.data(), sizeof(header.np));
-
-  return !inFile.fail();
-}
-
-bool readParticleData(std::ifstream & inFile, std::vector<Particle> & particles, int np) {
-  std::vector<char> buffer(ParticleDataSize * np);
-  inFile.read(buffer.data(), static_cast<std::streamsize>(ParticleDataSize * np));
-
-  if (inFile.fail()) {
-    std::cerr << "Error reading particles from file.\n";
-    return false;
-  }
-
-  particles.clear();
-  particles.reserve(np);
-  for (int i = 0; i < np; ++i) {
-    Particle particle{};
-    memcpy(&particle, &buffer[i * ParticleDataSize], ParticleDataSize);
-    particles.push_back(particle);
-  }
-
-  return true;
-}
-
-bool readParticlesFromFile(std::ifstream & inFile, Header & header,
-                           std::vector<Particle> & particles) {
-  if (!readHeader(inFile, header)) {
-    std::cerr << "Error reading header from file.\n";
-    return false;
-  }
-  return readParticleData(inFile, particles, header.np);
-}
-
-bool writeParticlesToFile(std::string const & filename, Header const & header,
-                          std::vector<Particle> const & particles) {
-  std::ofstream outFile(filename, std::ios::binary);
-  if (!outFile.is_open()) {
-    std::cerr << "Could not open output file: " << filename << '\n';
-    return false;
-  }
-
-  std::array<char, sizeof(Header)> headerBuffer{};
-  memcpy(headerBuffer.data(), &header, sizeof(Header));
-  outFile.write(headerBuffer.data(), sizeof(Header));
-
-  std::vector<char> particleBuffer(particles.size() * sizeof(Particle));
-  for (size_t i = 0; i < particles.size(); ++i) {
-    memcpy(&particleBuffer[i * sizeof(Particle)], &particles[i], sizeof(Particle));
-  }
-  outFile.write(particleBuffer.data(), static_cast<std::streamsize>(particleBuffer.size()));
-
-  outFile.close();
-  return true;
-}
-
-bool readInputFile(const std::string & filename, Header & header,
-                   std::vector<Particle> & particles) {
-  std::ifstream inFile(filename, std::ios::binary);
-  if (!inFile.is_open()) {
-    std::cerr << "Could not open input file: " << filename << '\n';
-    exit(-3);
-  }
-
-  if (!readParticlesFromFile(inFile, header, particles)) { // Corrected function call
-    exit(-3);
-  }
-
-  return true;
-}
-
-void updateParticles(std::vector<Particle> & particles, ParticleParameters params) {
-  for (size_t i = 0; i < particles.size(); ++i) {
-    Particle & particle = particles[i];
-    repositionParticle(particle, params.blockSize, params.blocks);
-    for (size_t j = i + 1; j < particles.size(); ++j) {
-      Particle & particle2 = particles[j];
-      updateParticlePair(particle, particle2, params.smoothingLength, params.mass);
-    }
-
-    processCollisions(particle);
-    updateParticleMotion(particle);
-  }
-}
-
-void updateParticlePair(Particle & particle1, Particle & particle2, float smoothingLength,
-                        float mass) {
-  updateDensity(particle1, particle2, smoothingLength);
-  transformDensity(particle1, smoothingLength, mass);
-  updateAcceleration(particle1, particle2, smoothingLength, mass);
-}
-
-void simulationWithIterations(std::vector<Particle> & particles, const SimulationParameters & params) {
-  auto start = std::chrono::high_resolution_clock::now();
-
-  const ParticleParameters particleParams = {params.parametros[0], params.parametros[1],
-                                             params.bloques[0], params.bloques[1]}; // const added
-
-  for (Particle & particle : particles) {
-    initializeDensitiesAndAccelerations(particle);
-  }
-
-  for (int it = 0; it < params.iterations; ++it) {
-    updateParticles(particles, particleParams);
-  }
-
-  auto finish = std::chrono::high_resolution_clock::now();
-  const std::chrono::duration<double> elapsed = finish - start; // const added
-  std::cout << "La función de simulacion tardó: " << elapsed.count() << " segundos.\n";
-}
-
-
-bool isInteger(const std::string &s) {
-    if (s.empty()) {
-        return false;
-    }
-
-    auto start = s.begin();
-    if (s[0] == '-' || s[0] == '+') {
-        start++;
-        if (start == s.end()) {
-            return false;
-        }
-    }
-
-    return std::all_of(start, s.end(), ::isdigit);
-}
-
-
-bool salida(const SalidaParameters & params) {
-    const auto length = params.parametros[0];
-    const auto mass = params.parametros[1];
-    const auto &blocks = params.bloques[0];
-    const auto &blockSize = params.bloques[1];
-
-    const int totalBlocks =
-        static_cast<int>(blocks.nx) * static_cast<int>(blocks.ny) * static_cast<int>(blocks.nz);
-
-    std::ostringstream output;
-    output << "Number of particles: " << params.np << '\n'
-           << "Particles per meter: " << params.ppm << '\n'
-           << "Smoothing length: " << length << '\n'
-           << "Mass of particles: " << mass << '\n'
-           << "Grid size: " << blocks.nx << " x " << blocks.ny << " x " << blocks.nz << '\n'
-           << "Number of blocks: " << totalBlocks << '\n'
-           << "Block size: " << blockSize.nx << " x " << blockSize.ny << " x " << blockSize.nz << '\n';
-    std::cout << output.str();
-
-    return true;
-}
+// utils.cpp
+#include "utils.hpp"
+
+#include "analytics.hpp"
+#include "block.hpp"
+#include "constants.hpp"
+#include "particle.hpp"
+#include "shmring.hpp"
+#include "step.hpp"
+#include "temporal.hpp"
+#include "trajectory.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+constexpr size_t ParticleDataSize = FLD_RECORD_SIZE;
+
+bool readHeader(std::ifstream & inFile, Header & header) {
+  std::array<char, sizeof(header.ppm)> buffer{};
+  inFile.read(buffer.data(), sizeof(header.ppm));
+  memcpy(&header.ppm, buffer.data(), sizeof(header.ppm));
+
+  inFile.read(buffer.data(), sizeof(header.np));
+  memcpy(&header.np, buffer.data(), sizeof(header.np));
+
+  return !inFile.fail();
+}
+
+bool readParticleData(std::ifstream & inFile, std::vector<Particle> & particles, int np) {
+  std::vector<char> buffer(ParticleDataSize * np);
+  inFile.read(buffer.data(), static_cast<std::streamsize>(ParticleDataSize * np));
+
+  if (inFile.fail()) {
+    std::cerr << "Error reading particles from file.\n";
+    return false;
+  }
+
+  particles.clear();
+  particles.reserve(np);
+  for (int i = 0; i < np; ++i) {
+    Particle particle{};
+    memcpy(&particle, &buffer[i * ParticleDataSize], ParticleDataSize);
+    particles.push_back(particle);
+  }
+
+  return true;
+}
+
+bool readParticlesFromFile(std::ifstream & inFile, Header & header,
+                           std::vector<Particle> & particles) {
+  if (!readHeader(inFile, header)) {
+    std::cerr << "Error reading header from file.\n";
+    return false;
+  }
+  return readParticleData(inFile, particles, header.np);
+}
+
+bool inspectInputFile(std::string const & filename, FldFileLayout & layout) {
+  std::ifstream inFile(filename, std::ios::binary);
+  if (!inFile.is_open()) {
+    std::cerr << "Could not open input file: " << filename << '\n';
+    return false;
+  }
+  std::error_code error;
+  layout.size = std::filesystem::file_size(filename, error);
+  if (error || layout.size < FLD_HEADER_SIZE || !readHeader(inFile, layout.header)) {
+    std::cerr << "Error reading header from file.\n";
+    return false;
+  }
+  layout.records      = (layout.size - FLD_HEADER_SIZE) / FLD_RECORD_SIZE;
+  layout.partialBytes = (layout.size - FLD_HEADER_SIZE) % FLD_RECORD_SIZE;
+  return true;
+}
+
+bool writeParticlesToFile(std::string const & filename, Header const & header,
+                          std::vector<Particle> const & particles) {
+  std::ofstream outFile(filename, std::ios::binary);
+  if (!outFile.is_open()) {
+    std::cerr << "Could not open output file: " << filename << '\n';
+    return false;
+  }
+
+  std::array<char, sizeof(Header)> headerBuffer{};
+  memcpy(headerBuffer.data(), &header, sizeof(Header));
+  outFile.write(headerBuffer.data(), sizeof(Header));
+
+  std::vector<char> particleBuffer(particles.size() * sizeof(Particle));
+  for (size_t i = 0; i < particles.size(); ++i) {
+    memcpy(&particleBuffer[i * sizeof(Particle)], &particles[i], sizeof(Particle));
+  }
+  outFile.write(particleBuffer.data(), static_cast<std::streamsize>(particleBuffer.size()));
+
+  outFile.close();
+  return true;
+}
+
+bool readInputFile(const std::string & filename, Header & header,
+                   std::vector<Particle> & particles) {
+  std::ifstream inFile(filename, std::ios::binary);
+  if (!inFile.is_open()) {
+    std::cerr << "Could not open input file: " << filename << '\n';
+    exit(-3);
+  }
+
+  if (!readParticlesFromFile(inFile, header, particles)) { // Corrected function call
+    exit(-3);
+  }
+
+  return true;
+}
+
+void updateParticles(std::vector<Particle> & particles, ParticleParameters params,
+                     StepWorkspace<FloatPrecision> & workspace) {
+  stepParticles(particles, params, workspace);
+}
+
+void updateParticlePair(Particle & particle1, Particle & particle2, float smoothingLength,
+                        float mass) {
+  updateDensity(particle1, particle2, smoothingLength);
+  transformDensity(particle1, smoothingLength, mass);
+  updateAcceleration(particle1, particle2, smoothingLength, mass);
+}
+
+namespace {
+
+  // Whether a multiple of `interval` lies in (from, to], so that a frame is due after
+  // stepping from step `from` to step `to`
+  bool frameDue(int from, int to, int interval) {
+    return interval > 0 && to / interval > from / interval;
+  }
+
+  // Opens options.analyticsFile with the header of the selected columns for a run with
+  // options.analyticsInterval; nothing without one
+  void openAnalytics(std::ofstream & output, AnalyticsState & analytics,
+                     SimulationOptions const & options, ParticleParameters const & particleParams) {
+    if (options.analyticsInterval <= 0) { return; }
+    output.open(options.analyticsFile);
+    if (!output.is_open()) {
+      std::cerr << "Could not open analytics file: " << options.analyticsFile << '\n';
+      exit(ERROR_OUTPUT_FILE_OPEN);
+    }
+    analytics.selection = options.analytics;
+    analytics.mass      = static_cast<double>(particleParams.mass);
+    writeAnalyticsHeader(analytics.selection, output);
+  }
+
+  void finishAnalytics(AnalyticsState const & analytics, SimulationOptions const & options) {
+    if (options.analyticsInterval <= 0) { return; }
+    std::cout << "Analytics: " << analytics.samples << " samples written to "
+              << options.analyticsFile << '\n';
+  }
+
+  // Trajectory writer of a run with options.trajectoryInterval, holding the frame before step
+  // 1; null without one
+  std::unique_ptr<TrajectoryWriter> openTrajectory(std::vector<Particle> const & particles,
+                                                   SimulationParameters const & params) {
+    SimulationOptions const & options = params.options;
+    if (options.trajectoryInterval <= 0) { return nullptr; }
+    const Header header{params.ppm, static_cast<int>(particles.size())};
+    auto trajectory = std::make_unique<TrajectoryWriter>(options.trajectoryFile, header,
+                                                         options.output,
+                                                         options.trajectoryKeyframes);
+    if (!trajectory->isOpen()) { exit(ERROR_OUTPUT_FILE_OPEN); }
+    trajectory->writeFrame(0, particles);
+    return trajectory;
+  }
+
+  void finishTrajectory(TrajectoryWriter * trajectory, SimulationOptions const & options) {
+    if (trajectory == nullptr) { return; }
+    if (!trajectory->finish()) {
+      std::cerr << "Could not write trajectory file: " << options.trajectoryFile << '\n';
+      exit(ERROR_OUTPUT_FILE_OPEN);
+    }
+    printTrajectoryStats(trajectory->stats(), options.trajectoryFile, std::cout);
+  }
+
+  // Shared memory ring of a run with options.publishInterval, holding the frame before step 1;
+  // null without one
+  std::unique_ptr<ShmRingWriter> openRing(std::vector<Particle> const & particles,
+                                          SimulationParameters const & params) {
+    SimulationOptions const & options = params.options;
+    if (options.publishInterval <= 0) { return nullptr; }
+    auto ring = std::make_unique<ShmRingWriter>(
+        options.publishName, static_cast<std::size_t>(options.publishSlots), particles.size(),
+        params.ppm);
+    if (!ring->isOpen()) {
+      std::cerr << "Could not create shared memory ring: " << options.publishName << '\n';
+      exit(ERROR_OUTPUT_FILE_OPEN);
+    }
+    ring->publish(0, particles);
+    return ring;
+  }
+
+  void finishRing(ShmRingWriter const * ring, SimulationOptions const & options) {
+    if (ring == nullptr) { return; }
+    std::cout << "Published: " << ring->published() << " frames to " << options.publishName
+              << '\n';
+  }
+
+  // Steps with an in-situ analytics sample every options.analyticsInterval steps, a
+  // trajectory frame every options.trajectoryInterval steps and a frame published to the
+  // shared memory ring every options.publishInterval steps; the first frames before step 1
+  void stepWithInSituOutput(std::vector<Particle> & particles,
+                            ParticleParameters const & particleParams,
+                            SimulationParameters const & params,
+                            StepWorkspace<FloatPrecision> & workspace) {
+    SimulationOptions const & options = params.options;
+    std::ofstream output;
+    AnalyticsState analytics;
+    openAnalytics(output, analytics, options, particleParams);
+    std::unique_ptr<TrajectoryWriter> const trajectory = openTrajectory(particles, params);
+    std::unique_ptr<ShmRingWriter> const ring = openRing(particles, params);
+    for (int it = 1; it <= params.iterations; ++it) {
+      const bool due = analyticsDue(it, options.analyticsInterval);
+      if (due) { beginAnalyticsSample(analytics, options.threads); }
+      workspace.analytics = due ? &analytics : nullptr;
+      stepParticles(particles, particleParams, workspace, options);
+      if (due) { writeAnalyticsSample(analytics, it, output); }
+      if (trajectory && frameDue(it - 1, it, options.trajectoryInterval)) {
+        trajectory->writeFrame(it, particles);
+      }
+      if (ring && frameDue(it - 1, it, options.publishInterval)) { ring->publish(it, particles); }
+    }
+    workspace.analytics = nullptr;
+    finishAnalytics(analytics, options);
+    finishTrajectory(trajectory.get(), options);
+    finishRing(ring.get(), options);
+  }
+
+}  // namespace
+
+void simulationWithIterations(std::vector<Particle> & particles, const SimulationParameters & params,
+                              StepProfile * profile) {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // bloques holds {number of blocks, block size}
+  const ParticleParameters particleParams = {params.parametros[0], params.parametros[1],
+                                             params.bloques[1], params.bloques[0]};
+
+  for (Particle & particle : particles) {
+    initializeDensitiesAndAccelerations(particle);
+  }
+
+  StepWorkspace<FloatPrecision> workspace;
+  workspace.profile = profile;
+  if (usesTemporalBlocking(params.options)) {
+    // The particles are only whole between blocks, so analytics samples, trajectory and
+    // published frames fall on the first block boundary at or after every multiple of their
+    // interval. The tiles step copies of the particles, so a sample takes a pass of its own.
+    TemporalWorkspace<FloatPrecision> temporal;
+    std::ofstream output;
+    AnalyticsState analytics;
+    openAnalytics(output, analytics, params.options, particleParams);
+    std::unique_ptr<TrajectoryWriter> const trajectory = openTrajectory(particles, params);
+    std::unique_ptr<ShmRingWriter> const ring          = openRing(particles, params);
+    const int blockSteps = params.options.temporalSteps;
+    for (int it = 0; it < params.iterations; it += blockSteps) {
+      const int steps = std::min(blockSteps, params.iterations - it);
+      advanceTemporalBlock(particles, particleParams, steps, params.options, temporal);
+      if (frameDue(it, it + steps, params.options.analyticsInterval)) {
+        beginAnalyticsSample(analytics, 1);
+        sampleParticles(analytics, particles);
+        writeAnalyticsSample(analytics, it + steps, output);
+      }
+      if (trajectory && frameDue(it, it + steps, params.options.trajectoryInterval)) {
+        trajectory->writeFrame(it + steps, particles);
+      }
+      if (ring && frameDue(it, it + steps, params.options.publishInterval)) {
+        ring->publish(it + steps, particles);
+      }
+    }
+    printTemporalStats(temporal.stats, std::cout);
+    finishAnalytics(analytics, params.options);
+    finishTrajectory(trajectory.get(), params.options);
+    finishRing(ring.get(), params.options);
+  } else if (params.options.analyticsInterval > 0 || params.options.trajectoryInterval > 0 ||
+             params.options.publishInterval > 0) {
+    stepWithInSituOutput(particles, particleParams, params, workspace);
+  } else {
+    for (int it = 0; it < params.iterations; ++it) {
+      stepParticles(particles, particleParams, workspace, params.options);
+    }
+  }
+  if (profile != nullptr) {
+    profile->recordResidency(residentBytesPerNode(particles, workspace), hugePageBytes());
+  }
+  if (params.options.sleepSteps > 0) { printSleepStats(workspace.sleep.stats, std::cout); }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  const std::chrono::duration<double> elapsed = finish - start; // const added
+  std::cout << "La función de simulacion tardó: " << elapsed.count() << " segundos.\n";
+}
+
+
+bool isInteger(const std::string &s) {
+    if (s.empty()) {
+        return false;
+    }
+
+    auto start = s.begin();
+    if (s[0] == '-' || s[0] == '+') {
+        start++;
+        if (start == s.end()) {
+            return false;
+        }
+    }
+
+    return std::all_of(start, s.end(), ::isdigit);
+}
+
+
+bool salida(const SalidaParameters & params) {
+    const auto length = params.parametros[0];
+    const auto mass = params.parametros[1];
+    const auto &blocks = params.bloques[0];
+    const auto &blockSize = params.bloques[1];
+
+    const int totalBlocks =
+        static_cast<int>(blocks.nx) * static_cast<int>(blocks.ny) * static_cast<int>(blocks.nz);
+
+    std::ostringstream output;
+    output << "Number of particles: " << params.np << '\n'
+           << "Particles per meter: " << params.ppm << '\n'
+           << "Smoothing length: " << length << '\n'
+           << "Mass of particles: " << mass << '\n'
+           << "Grid size: " << blocks.nx << " x " << blocks.ny << " x " << blocks.nz << '\n'
+           << "Number of blocks: " << totalBlocks << '\n'
+           << "Block size: " << blockSize.nx << " x " << blockSize.ny << " x " << blockSize.nz << '\n';
+    if (params.profile != nullptr) { printStepProfile(*params.profile, output); }
+    std::cout << output.str();
+
+    return true;
+}
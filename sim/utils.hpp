@@ -1,48 +1,78 @@
-// utils.hpp
-#pragma once
-#include "particle.hpp"
-
-#include <string>
-#include <vector>
-
-struct SimulationParameters {
-    int iterations;
-    std::vector<float> parametros;
-    std::vector<GridSize> bloques;
-};
-
-struct SalidaParameters {
-    int np;
-    double ppm;
-    std::vector<float> const & parametros;
-    std::vector<GridSize> const & bloques;
-};
-
-struct ParticleParameters {
-    float smoothingLength;
-    float mass;
-    GridSize blockSize;
-    GridSize blocks;
-};
-
-bool readHeader(std::ifstream & inFile, Header & header);
-bool readParticleData(std::ifstream & inFile, std::vector<Particle> & particles, int np);
-
-// Function to check if a string is an integer
-bool isInteger(std::string const & s);
-
-// Function to read particles from a file
-bool readParticlesFromFile(std::string const & filename, Header & header,
-                           std::vector<Particle> & particles);
-
-// Function to write particles to a file
-bool writeParticlesToFile(std::string const & filename, Header const & header,
-                          std::vector<Particle> const & particles);
-bool readInputFile(std::string const & filename, Header & header,
-                   std::vector<Particle> & particles);
-void updateParticles(std::vector<Particle> & particles, ParticleParameters params);
-void updateParticlePair(Particle & particle1, Particle & particle2, float smoothingLength,
-                        float mass);
-void simulationWithIterations(std::vector<Particle> & particles, const SimulationParameters & params);
-bool isInteger(std::string const & s);
-bool salida(const SalidaParameters & params);
+// utils.hpp
+#pragma once
+#include "options.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "profile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+template <typename Policy>
+struct StepWorkspace;
+
+struct SimulationParameters {
+    int iterations;
+    std::vector<float> parametros;
+    std::vector<GridSize> bloques;
+    SimulationOptions options{};
+    float ppm = 0.0F;  // Of the input, for the headers of the files written during the run
+};
+
+struct SalidaParameters {
+    int np;
+    double ppm;
+    std::vector<float> const & parametros;
+    std::vector<GridSize> const & bloques;
+    StepProfile const * profile = nullptr;
+};
+
+struct ParticleParameters {
+    float smoothingLength;
+    float mass;
+    GridSize blockSize;
+    GridSize blocks;
+};
+
+// Size of one particle record and of the header of an .fld file, in bytes
+constexpr std::uintmax_t FLD_RECORD_SIZE = sizeof(float) * 9;
+constexpr std::uintmax_t FLD_HEADER_SIZE = sizeof(float) + sizeof(int);
+
+// An .fld input as its size shows it: whole particle records and the bytes of a truncated one
+struct FldFileLayout {
+    Header header;
+    std::uintmax_t size;          // File size in bytes
+    std::uintmax_t records;       // Whole particle records after the header
+    std::uintmax_t partialBytes;  // Bytes of a last, truncated record
+};
+
+bool readHeader(std::ifstream & inFile, Header & header);
+bool readParticleData(std::ifstream & inFile, std::vector<Particle> & particles, int np);
+
+// Function to check if a string is an integer
+bool isInteger(std::string const & s);
+
+// Function to read particles from a file
+bool readParticlesFromFile(std::string const & filename, Header & header,
+                           std::vector<Particle> & particles);
+
+// Reads the header of an .fld file and takes the particle count from the file size, without
+// reading the particles
+bool inspectInputFile(std::string const & filename, FldFileLayout & layout);
+
+// Function to write particles to a file
+bool writeParticlesToFile(std::string const & filename, Header const & header,
+                          std::vector<Particle> const & particles);
+bool readInputFile(std::string const & filename, Header & header,
+                   std::vector<Particle> & particles);
+// One step of `particles`; `workspace` keeps the thread pool and buffers from one call to the
+// next, so callers stepping in a loop pass the same one every time
+void updateParticles(std::vector<Particle> & particles, ParticleParameters params,
+                     StepWorkspace<FloatPrecision> & workspace);
+void updateParticlePair(Particle & particle1, Particle & particle2, float smoothingLength,
+                        float mass);
+void simulationWithIterations(std::vector<Particle> & particles, const SimulationParameters & params,
+                              StepProfile * profile = nullptr);
+bool isInteger(std::string const & s);
+bool salida(const SalidaParameters & params);
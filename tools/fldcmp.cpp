@@ -0,0 +1,68 @@
+// fldcmp.cpp
+// Compares two .fld files field by field and reports the largest error of each field.
+// Exit status: 0 within tolerance, 1 outside tolerance, 2 files cannot be compared.
+#include "compare.hpp"
+
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  bool readDouble(std::string const & arg, std::string const & prefix, double & value) {
+    if (!arg.starts_with(prefix)) { return false; }
+    std::string const text = arg.substr(prefix.size());
+    try {
+      std::size_t used = 0;
+      value            = std::stod(text, &used);
+      return used == text.size();
+    } catch (std::exception const &) { return false; }
+  }
+
+}  // namespace
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  if (args.size() < 3) {
+    std::cerr << "Usage: " << args[0]
+              << " <expected>.fld <actual>.fld [--abs=<tol>] [--rel=<tol>] [--threads=<n>]\n";
+    return 2;
+  }
+  CompareTolerance tolerance;
+  int threads = 1;
+  for (std::size_t i = 3; i < args.size(); ++i) {
+    double threadValue = 0.0;
+    if (readDouble(args[i], "--abs=", tolerance.absolute) ||
+        readDouble(args[i], "--rel=", tolerance.relative)) {
+      continue;
+    }
+    if (readDouble(args[i], "--threads=", threadValue) && threadValue >= 1.0) {
+      threads = static_cast<int>(threadValue);
+      continue;
+    }
+    std::cerr << "Error: Invalid option '" << args[i] << "'.\n";
+    return 2;
+  }
+
+  const CompareReport report = compareFldFiles(args[1], args[2], tolerance, threads);
+  if (!report.comparable) {
+    std::cerr << "Error: " << report.error << ".\n";
+    return 2;
+  }
+  std::cout << "Particles: " << report.particles << ", fields: " << report.fieldCount
+            << (report.headerMatches ? "" : " (ppm differs)") << '\n'
+            << std::left << std::setw(6) << "field" << std::right << std::setw(14) << "max abs"
+            << std::setw(14) << "max rel" << std::setw(10) << "worst" << std::setw(12)
+            << "mismatches" << '\n';
+  for (int field = 0; field < report.fieldCount; ++field) {
+    auto const & error = report.fields[static_cast<std::size_t>(field)];
+    std::cout << std::left << std::setw(6) << fieldNames()[static_cast<std::size_t>(field)]
+              << std::right << std::setprecision(6) << std::setw(14) << error.maxAbsolute
+              << std::setw(14) << error.maxRelative << std::setw(10) << error.worstIndex
+              << std::setw(12) << error.mismatches << '\n';
+  }
+  std::cout << (report.withinTolerance() ? "PASS" : "FAIL") << '\n';
+  return report.withinTolerance() ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// shmwatch.cpp
+// Reference consumer of the shared memory ring of a run started with --publish: follows the
+// newest frame and prints the particle count, centre of mass and largest speed of each new
+// one, read in place from the ring. Stops when the run ends or after the given frame count.
+// Waits up to 5 s for the ring to appear. Exit status: 0 on success, 2 when the ring cannot
+// be opened.
+#include "shmring.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  constexpr int OPEN_ATTEMPTS          = 50;
+  constexpr int OPEN_WAIT_MILLISECONDS = 100;
+
+  struct FrameSummary {
+      double cx       = 0.0;
+      double cy       = 0.0;
+      double cz       = 0.0;
+      double maxSpeed = 0.0;
+  };
+
+  FrameSummary summarize(std::span<Particle const> particles) {
+    FrameSummary summary;
+    double maxSquared = 0.0;
+    for (Particle const & particle : particles) {
+      summary.cx += particle.px;
+      summary.cy += particle.py;
+      summary.cz += particle.pz;
+      const double squared = static_cast<double>(particle.vx) * particle.vx +
+                             static_cast<double>(particle.vy) * particle.vy +
+                             static_cast<double>(particle.vz) * particle.vz;
+      maxSquared = std::max(maxSquared, squared);
+    }
+    if (!particles.empty()) {
+      const auto count  = static_cast<double>(particles.size());
+      summary.cx       /= count;
+      summary.cy       /= count;
+      summary.cz       /= count;
+    }
+    summary.maxSpeed = std::sqrt(maxSquared);
+    return summary;
+  }
+
+  bool readInteger(std::string const & text, int & value) {
+    try {
+      std::size_t used = 0;
+      value            = std::stoi(text, &used);
+      return used == text.size() && value >= 0;
+    } catch (std::exception const &) { return false; }
+  }
+
+}  // namespace
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
+  int pollMilliseconds = 10;
+  int frameLimit       = 0;
+  if (args.size() < 2 || args.size() > 4 ||
+      (args.size() > 2 && !readInteger(args[2], pollMilliseconds)) ||
+      (args.size() > 3 && !readInteger(args[3], frameLimit))) {
+    std::cerr << "Usage: " << args[0] << " /<name> [poll milliseconds] [frames]\n";
+    return 2;
+  }
+  // The run may not have created the ring yet
+  std::unique_ptr<ShmRingReader> reader;
+  for (int attempt = 0; attempt < OPEN_ATTEMPTS; ++attempt) {
+    reader = std::make_unique<ShmRingReader>(args[1]);
+    if (reader->isOpen()) { break; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(OPEN_WAIT_MILLISECONDS));
+  }
+  if (!reader->isOpen()) {
+    std::cerr << "Error: Could not open shared memory ring " << args[1] << ".\n";
+    return 2;
+  }
+  ShmRingReader const & ring = *reader;
+  std::cout << "Ring " << args[1] << ": " << ring.header().slots << " slots of "
+            << ring.header().capacity << " particles, ppm " << ring.header().ppm << '\n';
+  std::uint64_t seen  = 0;
+  std::uint64_t shown = 0;
+  std::uint64_t torn  = 0;
+  for (;;) {
+    // Read before the frame, so that a frame published just before the run ends is shown
+    const bool closed = ring.closed();
+    ShmFrame frame;
+    if (ring.published() > seen && ring.acquireLatest(frame)) {
+      const FrameSummary summary = summarize(frame.particles);
+      if (ShmRingReader::stillValid(frame)) {
+        seen = frame.frame + 1;
+        ++shown;
+        std::cout << "frame " << frame.frame << " step " << frame.step << ": "
+                  << frame.particles.size() << " particles, centre (" << std::setprecision(6)
+                  << summary.cx << ", " << summary.cy << ", " << summary.cz
+                  << "), max speed " << summary.maxSpeed << '\n';
+        if (frameLimit > 0 && shown >= static_cast<std::uint64_t>(frameLimit)) { break; }
+      } else {
+        // The writer overwrote the slot while it was read; the next frame is newer anyway
+        ++torn;
+      }
+      continue;
+    }
+    if (closed) { break; }
+    std::this_thread::sleep_for(std::chrono::milliseconds(pollMilliseconds));
+  }
+  std::cout << "Frames shown: " << shown << ", published: " << ring.published()
+            << ", torn reads: " << torn << '\n';
+  return 0;
+}
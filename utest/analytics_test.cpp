@@ -0,0 +1,114 @@
+#include "analytics.hpp"
+#include "constants.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+static constexpr int ANALYTICS_PARTICLES = 400;
+static constexpr float ANALYTICS_PPM     = 204.0F;
+
+TEST(AnalyticsTest, PartialsCombineIntoOneRow) {
+  AnalyticsState state;
+  state.selection = {true, true, false, false};
+  state.mass      = 0.5;
+  beginAnalyticsSample(state, 2);
+  Particle slow{};
+  slow.vx = 1.0F;
+  Particle fast{};
+  fast.px = 2.0F;
+  fast.py = 4.0F;
+  fast.pz = 6.0F;
+  fast.vy = 2.0F;
+  state.partials[0].addMotion(slow);
+  state.partials[1].addMotion(fast);
+  std::ostringstream output;
+  writeAnalyticsHeader(state.selection, output);
+  writeAnalyticsSample(state, 3, output);
+  EXPECT_EQ(output.str(), "step,particles,kinetic_energy,com_x,com_y,com_z\n3,2,1.25,1,2,3\n");
+  EXPECT_EQ(state.samples, 1U);
+}
+
+TEST(AnalyticsTest, DensitiesFillTheHistogram) {
+  AnalyticsPartial partial;
+  for (const float density : {0.0F, rho, 5.0F * rho}) {
+    Particle particle{};
+    particle.rho = density;
+    partial.addDensity(particle);
+  }
+  EXPECT_EQ(partial.histogram[0], 1U);
+  EXPECT_EQ(partial.histogram[ANALYTICS_DENSITY_BINS / 2], 1U);
+  // Past the range: the last bin
+  EXPECT_EQ(partial.histogram[ANALYTICS_DENSITY_BINS - 1], 1U);
+  EXPECT_DOUBLE_EQ(partial.densityMin, 0.0);
+  EXPECT_DOUBLE_EQ(partial.densityMax, 5.0 * rho);
+  EXPECT_DOUBLE_EQ(partial.densitySum, 6.0 * rho);
+}
+
+TEST(AnalyticsTest, StepPassesSampleEveryParticle) {
+  const float height    = calculateSmoothingLength(r, ANALYTICS_PPM);
+  const GridSize blocks = calculateNumberOfBlocks(height);
+  const ParticleParameters params{height, calculateParticleMass(rho, ANALYTICS_PPM),
+                                  calculateBlockSize(blocks), blocks};
+  std::vector<Particle> input;
+  unsigned int seed = 12345U;
+  auto next         = [&seed]() {
+    seed = seed * 1664525U + 1013904223U;
+    return static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U);
+  };
+  for (int i = 0; i < ANALYTICS_PARTICLES; ++i) {
+    Particle particle{};
+    particle.px = xmin + height * next();
+    particle.py = ymin + height * next();
+    particle.pz = zmin + height * next();
+    initializeDensitiesAndAccelerations(particle);
+    input.push_back(particle);
+  }
+  for (const CellSchedule schedule : {CellSchedule::stealing, CellSchedule::graph}) {
+    SimulationOptions options;
+    options.threads   = 3;
+    options.schedule  = schedule;
+    options.reduction = ReductionMode::deterministic;
+    std::vector<Particle> reference = input;
+    StepWorkspace<FloatPrecision> plain;
+    stepParticles(reference, params, plain, options);
+
+    std::vector<Particle> sampled = input;
+    StepWorkspace<FloatPrecision> workspace;
+    AnalyticsState analytics;
+    beginAnalyticsSample(analytics, options.threads);
+    workspace.analytics = &analytics;
+    stepParticles(sampled, params, workspace, options);
+    // Sampling leaves the particles alone
+    ASSERT_EQ(std::memcmp(sampled.data(), reference.data(), sampled.size() * sizeof(Particle)),
+              0);
+
+    std::uint64_t particles = 0;
+    std::uint64_t binned    = 0;
+    double speedSquared     = 0.0;
+    double maxSpeedSquared  = 0.0;
+    for (AnalyticsPartial const & partial : analytics.partials) {
+      particles       += partial.particles;
+      speedSquared    += partial.speedSquared;
+      maxSpeedSquared  = std::max(maxSpeedSquared, partial.maxSpeedSquared);
+      for (const std::uint64_t bin : partial.histogram) { binned += bin; }
+    }
+    double expectedSpeedSquared    = 0.0;
+    double expectedMaxSpeedSquared = 0.0;
+    for (Particle const & p : reference) {
+      const auto speed = static_cast<double>(p.vx * p.vx + p.vy * p.vy + p.vz * p.vz);
+      expectedSpeedSquared   += speed;
+      expectedMaxSpeedSquared = std::max(expectedMaxSpeedSquared, speed);
+    }
+    EXPECT_EQ(particles, input.size());
+    EXPECT_EQ(binned, input.size());
+    EXPECT_NEAR(speedSquared, expectedSpeedSquared, 1e-9 * expectedSpeedSquared);
+    EXPECT_DOUBLE_EQ(maxSpeedSquared, expectedMaxSpeedSquared);
+  }
+}
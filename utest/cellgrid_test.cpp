@@ -0,0 +1,69 @@
+#include "block.hpp"
+#include "cellgrid.hpp"
+#include "constants.hpp"
+#include "particle.hpp"
+
+#include <gtest/gtest.h>
+
+static constexpr int TEST_NX = 5;
+static constexpr int TEST_NY = 4;
+static constexpr int TEST_NZ = 3;
+
+class CellGridTest : public ::testing::Test {
+  protected:
+    GridSize blockSize{1, 1, 1};
+    GridSize blocks{TEST_NX, TEST_NY, TEST_NZ};
+    CellGrid grid;
+
+    void SetUp() override {
+      blockSize.nx = (xmax - xmin) / TEST_NX;
+      blockSize.ny = (ymax - ymin) / TEST_NY;
+      blockSize.nz = (zmax - zmin) / TEST_NZ;
+      grid         = makeCellGrid(blockSize, blocks);
+    }
+};
+
+TEST_F(CellGridTest, LinearOffsetsMatchTheStencils) {
+  const std::size_t cell = grid.cellIndex(2, 1, 1);
+  for (std::size_t k = 0; k < FULL_STENCIL_SIZE; ++k) {
+    CellOffset const & offset = fullStencil()[k];
+    EXPECT_EQ(cell + static_cast<std::size_t>(grid.fullOffsets[k]),
+              grid.cellIndex(2 + offset[0], 1 + offset[1], 1 + offset[2]));
+  }
+  for (std::size_t k = 0; k < HALF_STENCIL_SIZE; ++k) {
+    CellOffset const & offset = halfStencil()[k];
+    EXPECT_EQ(cell + static_cast<std::size_t>(grid.halfOffsets[k]),
+              grid.cellIndex(2 + offset[0], 1 + offset[1], 1 + offset[2]));
+  }
+}
+
+TEST_F(CellGridTest, StencilOfCornerCellsStaysInsideThePaddedGrid) {
+  for (const int cz : {0, TEST_NZ - 1}) {
+    for (const int cx : {0, TEST_NX - 1}) {
+      const std::size_t cell = grid.cellIndex(cx, TEST_NY - 1, cz);
+      EXPECT_EQ(grid.cellCoordinates(cell), (CellOffset{cx, TEST_NY - 1, cz}));
+      for (const std::ptrdiff_t offset : grid.fullOffsets) {
+        EXPECT_LT(cell + static_cast<std::size_t>(offset), grid.cellCount());
+      }
+    }
+  }
+}
+
+TEST_F(CellGridTest, LocateMatchesBlockIndices) {
+  for (int cx = 0; cx < TEST_NX; ++cx) {
+    Particle particle{};
+    particle.px = xmin + (static_cast<float>(cx) + 0.5F) * blockSize.nx;
+    particle.py = ymin + 0.25F * blockSize.ny;
+    particle.pz = zmax;
+    const auto expected = getBlockIndices(particle, blockSize, blocks);
+    EXPECT_EQ(grid.locate(particle), (CellOffset{expected[0], expected[1], expected[2]}));
+  }
+}
+
+TEST_F(CellGridTest, LocateKeepsOutsidePositionsInTheInterior) {
+  Particle particle{};
+  particle.px = xmin - 1.0F;
+  particle.py = ymax + 1.0F;
+  particle.pz = zmin - SMALL_NUMBER;
+  EXPECT_EQ(grid.locate(particle), (CellOffset{0, TEST_NY - 1, 0}));
+}
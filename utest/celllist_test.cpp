@@ -0,0 +1,205 @@
+#include "celllist.hpp"
+#include "particle.hpp"
+
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <set>
+#include <utility>
+#include <vector>
+
+static constexpr int TEST_CELLS   = 4;
+static constexpr float TEST_WIDTH = 1.0F;
+
+TEST(CellListTest, HalfStencilCoversEachNeighbourPairOnce) {
+  std::set<CellOffset> offsets;
+  for (CellOffset const & offset : halfStencil()) {
+    EXPECT_TRUE(offsets.insert(offset).second);
+    const CellOffset opposite = {-offset[0], -offset[1], -offset[2]};
+    EXPECT_EQ(offsets.count(opposite), 0U);
+  }
+  for (CellOffset const & offset : halfStencil()) {
+    offsets.insert({-offset[0], -offset[1], -offset[2]});
+  }
+  offsets.insert({0, 0, 0});
+  EXPECT_EQ(offsets.size(), FULL_STENCIL_SIZE);
+}
+
+TEST(CellListTest, SameColorCellsWriteDisjointCells) {
+  CellList cells;
+  setCellGrid(cells, GridSize(1, 1, 1), GridSize(7, 7, 6));
+  for (std::size_t a = 0; a < cells.colorCells.size(); ++a) {
+    const CellOffset ca = cells.grid.cellCoordinates(cells.colorCells[a]);
+    for (std::size_t b = a + 1; b < cells.colorCells.size(); ++b) {
+      const CellOffset cb = cells.grid.cellCoordinates(cells.colorCells[b]);
+      if (cellColor(ca[0], ca[1], ca[2]) != cellColor(cb[0], cb[1], cb[2])) { continue; }
+      // Write sets are [x - 1, x + 1] x [y - 1, y + 1] x [z, z + 1]
+      const bool disjoint = std::abs(ca[0] - cb[0]) > 2 || std::abs(ca[1] - cb[1]) > 2 ||
+                            std::abs(ca[2] - cb[2]) > 1;
+      ASSERT_TRUE(disjoint) << "cells " << cells.colorCells[a] << " and " << cells.colorCells[b];
+    }
+  }
+}
+
+TEST(CellListTest, BuildSortsParticlesByCell) {
+  std::vector<Particle> particles(3);
+  particles[0].px = xmin + 2.5F * TEST_WIDTH;
+  particles[1].px = xmin + 0.5F * TEST_WIDTH;
+  particles[2].px = xmin + 2.2F * TEST_WIDTH;
+  for (Particle & particle : particles) {
+    particle.py = ymin;
+    particle.pz = zmin;
+  }
+  const GridSize blockSize(1, 1, 1);
+  const GridSize blocks(TEST_CELLS, TEST_CELLS, TEST_CELLS);
+  CellList cells;
+  buildCellList(particles, blockSize, blocks, cells);
+  EXPECT_EQ(cells.cellStart.back(), 3U);
+  EXPECT_EQ(cells.particleOrder[0], 1U);
+  EXPECT_EQ(cells.particleCell[0], cells.grid.cellIndex(2, 0, 0));
+  EXPECT_EQ(cells.particleCell[2], cells.grid.cellIndex(2, 0, 0));
+  // Every interior cell has a colour, no ghost cell does
+  EXPECT_EQ(cells.colorStart.back(), TEST_CELLS * TEST_CELLS * TEST_CELLS);
+}
+
+namespace {
+
+  // Particles in a few scattered cells of a TEST_SPARSE_CELLS^3 grid
+  constexpr int TEST_SPARSE_CELLS     = 9;
+  constexpr int TEST_SPARSE_PARTICLES = 60;
+
+  std::vector<Particle> sparseParticles(GridSize const & blockSize) {
+    std::vector<Particle> particles;
+    unsigned int seed = 777U;
+    auto next         = [&seed]() {
+      seed = seed * 1664525U + 1013904223U;
+      return static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U);
+    };
+    for (int i = 0; i < TEST_SPARSE_PARTICLES; ++i) {
+      // Clumps around three corners of cells, so neighbours are partly occupied
+      const float corner = static_cast<float>(1 + 3 * (i % 3));
+      Particle particle{};
+      particle.px = xmin + (corner + 2.0F * next()) * blockSize.nx;
+      particle.py = ymin + (corner + 2.0F * next()) * blockSize.ny;
+      particle.pz = zmin + (corner + 2.0F * next()) * blockSize.nz;
+      particles.push_back(particle);
+    }
+    return particles;
+  }
+
+  template <typename Visit>
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> pairSequence(CellList const & cells,
+                                                                    Visit visit) {
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    for (std::size_t cell = 0; cell < cells.cellCount(); ++cell) {
+      visit(cells, cell, [&](std::uint32_t i, std::uint32_t j) { pairs.emplace_back(i, j); });
+    }
+    return pairs;
+  }
+
+}  // namespace
+
+TEST(CellListTest, HashedLayoutVisitsTheDensePairsInOrder) {
+  const GridSize blocks(TEST_SPARSE_CELLS, TEST_SPARSE_CELLS, TEST_SPARSE_CELLS);
+  const GridSize blockSize((xmax - xmin) / TEST_SPARSE_CELLS, (ymax - ymin) / TEST_SPARSE_CELLS,
+                           (zmax - zmin) / TEST_SPARSE_CELLS);
+  const std::vector<Particle> particles = sparseParticles(blockSize);
+  CellList dense;
+  CellList hashed;
+  buildCellList(particles, blockSize, blocks, dense);
+  buildCellList(particles, blockSize, blocks, hashed, CellLayout::hashed);
+  ASSERT_EQ(hashed.occupiedCells, dense.occupiedCells);
+  EXPECT_EQ(hashed.cellCount(), hashed.occupiedCells + 1);
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    EXPECT_EQ(hashed.cellKey(hashed.particleCell[i]), dense.particleCell[i]);
+  }
+  const auto half = [](CellList const & cells, std::size_t cell, auto && visit) {
+    visitHalfStencilPairs(cells, cell, visit);
+  };
+  const auto full = [](CellList const & cells, std::size_t cell, auto && visit) {
+    visitFullStencilPairs(cells, cell, visit);
+  };
+  EXPECT_FALSE(pairSequence(dense, half).empty());
+  EXPECT_EQ(pairSequence(hashed, half), pairSequence(dense, half));
+  EXPECT_EQ(pairSequence(hashed, full), pairSequence(dense, full));
+  // Colours hold the occupied cells in the dense order
+  for (int color = 0; color < CELL_COLOR_COUNT; ++color) {
+    std::vector<std::uint64_t> denseKeys;
+    for (std::size_t k = dense.colorStart[color]; k < dense.colorStart[color + 1]; ++k) {
+      const std::uint32_t cell = dense.colorCells[k];
+      if (dense.cellStart[cell + 1] != dense.cellStart[cell]) { denseKeys.push_back(cell); }
+    }
+    std::vector<std::uint64_t> hashedKeys;
+    for (std::size_t k = hashed.colorStart[color]; k < hashed.colorStart[color + 1]; ++k) {
+      hashedKeys.push_back(hashed.cellKey(hashed.colorCells[k]));
+    }
+    EXPECT_EQ(hashedKeys, denseKeys) << "colour " << color;
+  }
+}
+
+TEST(CellListTest, HashTableFindsEveryKeyAfterGrowing) {
+  CellHashTable table;
+  table.reset(4);
+  constexpr std::uint32_t keyCount = 1000;
+  for (std::uint32_t k = 0; k < keyCount; ++k) { EXPECT_EQ(table.insert(7ULL * k, k), k); }
+  EXPECT_EQ(table.size, keyCount);
+  EXPECT_LE(2 * table.size, table.keys.size());
+  for (std::uint32_t k = 0; k < keyCount; ++k) {
+    EXPECT_EQ(table.insert(7ULL * k, keyCount), k);
+    EXPECT_EQ(table.find(7ULL * k), k);
+  }
+  EXPECT_EQ(table.find(3), CellHashTable::NO_CELL);
+}
+
+TEST(CellListTest, AutomaticLayoutFollowsOccupancy) {
+  const GridSize blocks(TEST_CELLS, TEST_CELLS, TEST_CELLS);
+  const GridSize blockSize(TEST_WIDTH, TEST_WIDTH, TEST_WIDTH);
+  SimulationOptions options;
+  options.hashedOccupancy = 0.5F;
+  CellList cells;
+  // Before any binning the particle count bounds the occupied cells
+  EXPECT_EQ(chooseCellLayout(cells, blockSize, blocks, 16, options), CellLayout::hashed);
+  EXPECT_EQ(chooseCellLayout(cells, blockSize, blocks, 48, options), CellLayout::dense);
+  // 48 particles in one cell
+  std::vector<Particle> particles(48);
+  for (Particle & particle : particles) {
+    particle.px = xmin;
+    particle.py = ymin;
+    particle.pz = zmin;
+  }
+  buildCellList(particles, blockSize, blocks, cells);
+  EXPECT_EQ(cells.occupiedCells, 1U);
+  EXPECT_EQ(chooseCellLayout(cells, blockSize, blocks, 48, options), CellLayout::hashed);
+  options.cellLayout = CellLayout::dense;
+  EXPECT_EQ(chooseCellLayout(cells, blockSize, blocks, 48, options), CellLayout::dense);
+}
+
+TEST(CellListTest, CellBlocksGroupTheOccupiedCells) {
+  const GridSize blocks(TEST_SPARSE_CELLS, TEST_SPARSE_CELLS, TEST_SPARSE_CELLS);
+  const GridSize blockSize((xmax - xmin) / TEST_SPARSE_CELLS, (ymax - ymin) / TEST_SPARSE_CELLS,
+                           (zmax - zmin) / TEST_SPARSE_CELLS);
+  const std::vector<Particle> particles = sparseParticles(blockSize);
+  for (const CellLayout layout : {CellLayout::dense, CellLayout::hashed}) {
+    CellList cells;
+    buildCellList(particles, blockSize, blocks, cells, layout);
+    CellBlocks cellBlocks;
+    buildCellBlocks(cells, 2, cellBlocks);
+    EXPECT_EQ(cellBlocks.counts[0], (TEST_SPARSE_CELLS + 1) / 2);
+    EXPECT_EQ(cellBlocks.cells.size(), cells.occupiedCells);
+    for (std::size_t block = 0; block < cellBlocks.count(); ++block) {
+      const std::array<int, 3> b = cellBlocks.coordinates(block);
+      EXPECT_EQ(cellBlocks.find(b[0], b[1], b[2]), block);
+      EXPECT_LT(cellBlocks.blockStart[block], cellBlocks.blockStart[block + 1]);
+      for (std::uint32_t k = cellBlocks.blockStart[block]; k < cellBlocks.blockStart[block + 1];
+           ++k) {
+        const std::uint32_t cell = cellBlocks.cells[k];
+        const CellOffset c       = cells.grid.cellCoordinates(cells.cellKey(cell));
+        EXPECT_NE(cells.cellStart[cell], cells.cellStart[cell + 1]);
+        EXPECT_EQ(c[0] / 2, b[0]);
+        EXPECT_EQ(c[1] / 2, b[1]);
+        EXPECT_EQ(c[2] / 2, b[2]);
+        if (k > cellBlocks.blockStart[block]) { EXPECT_LT(cellBlocks.cells[k - 1], cell); }
+      }
+    }
+    EXPECT_EQ(cellBlocks.find(-1, 0, 0), CellBlocks::NO_BLOCK);
+  }
+}
@@ -0,0 +1,114 @@
+#include "celllist.hpp"
+#include "cluster.hpp"
+#include "constants.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "threadpool.hpp"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr int TEST_CELLS   = 4;
+static constexpr float TEST_WIDTH = 0.01F;
+
+class ClusterTest : public ::testing::Test {
+  protected:
+    std::vector<Particle> particles;
+    CellList cells;
+    ThreadPool pool{2};
+
+    void SetUp() override {
+      // Five particles in cell (0, 0, 0), one in (1, 0, 0), one in (3, 3, 3)
+      for (int i = 0; i < 5; ++i) {
+        addParticle(0.1F + 0.15F * static_cast<float>(i), 0.5F, 0.5F);
+      }
+      addParticle(1.5F, 0.5F, 0.5F);
+      addParticle(3.5F, 3.5F, 3.5F);
+      buildCellList(particles, blockSize(), GridSize(TEST_CELLS, TEST_CELLS, TEST_CELLS), cells);
+    }
+
+  private:
+    static GridSize blockSize() {
+      GridSize size;
+      size.nx = TEST_WIDTH;
+      size.ny = TEST_WIDTH;
+      size.nz = TEST_WIDTH;
+      return size;
+    }
+
+    void addParticle(float x, float y, float z) {
+      Particle particle{};
+      particle.px = xmin + x * TEST_WIDTH;
+      particle.py = ymin + y * TEST_WIDTH;
+      particle.pz = zmin + z * TEST_WIDTH;
+      particles.push_back(particle);
+    }
+};
+
+TEST_F(ClusterTest, EveryParticleHasOneLane) {
+  ClusterList<FloatPrecision> clusters;
+  buildClusters(particles, cells, TEST_WIDTH, true, pool, clusters);
+  // Two clusters for the five particles of the first cell, one for each other occupied cell
+  EXPECT_EQ(clusters.clusterCount(), 4U);
+  std::vector<int> seen(particles.size(), 0);
+  std::size_t empty = 0;
+  for (const std::uint32_t particle : clusters.particle) {
+    if (particle == NO_PARTICLE) {
+      ++empty;
+    } else {
+      ++seen[particle];
+    }
+  }
+  EXPECT_EQ(empty, 4 * CLUSTER_SIZE - particles.size());
+  for (const int count : seen) { EXPECT_EQ(count, 1); }
+}
+
+TEST_F(ClusterTest, PairListsFollowTheStencil) {
+  ClusterList<FloatPrecision> clusters;
+  buildClusters(particles, cells, TEST_WIDTH, true, pool, clusters);
+  const std::uint32_t first = clusters.cellClusters[cells.grid.cellIndex(0, 0, 0)];
+  const std::uint32_t far   = clusters.cellClusters[cells.grid.cellIndex(3, 3, 3)];
+  // The half list of the first cluster holds itself, the second cluster of its cell and the
+  // cluster of the next cell, but never the far corner
+  std::vector<std::uint32_t> list(clusters.pairCluster.begin() + clusters.pairStart[first],
+                                   clusters.pairCluster.begin() + clusters.pairStart[first + 1]);
+  EXPECT_EQ(list.front(), first);
+  EXPECT_EQ(list.size(), 3U);
+  EXPECT_EQ(clusters.pairStart[far + 1] - clusters.pairStart[far], 1U);
+
+  ClusterList<FloatPrecision> full;
+  buildClusters(particles, cells, TEST_WIDTH, false, pool, full);
+  // The full list of the second cell's cluster also sees both clusters of the first cell
+  const std::uint32_t second = full.cellClusters[cells.grid.cellIndex(1, 0, 0)];
+  EXPECT_EQ(full.pairStart[second + 1] - full.pairStart[second], 3U);
+}
+
+TEST_F(ClusterTest, HalfAndFullListsGiveTheSameDensities) {
+  ClusterList<FloatPrecision> half;
+  ClusterList<FloatPrecision> full;
+  buildClusters(particles, cells, TEST_WIDTH, true, pool, half);
+  buildClusters(particles, cells, TEST_WIDTH, false, pool, full);
+  half.rho.assign(half.particle.size(), 0.0F);
+  full.rho.assign(full.particle.size(), 0.0F);
+  for (std::uint32_t ci = 0; ci < half.clusterCount(); ++ci) {
+    clusterDensities(half, ci, TEST_WIDTH);
+    clusterDensities(full, ci, TEST_WIDTH);
+  }
+  std::vector<float> halfRho(particles.size(), 0.0F);
+  std::vector<float> fullRho(particles.size(), 0.0F);
+  for (std::size_t lane = 0; lane < half.particle.size(); ++lane) {
+    if (half.particle[lane] != NO_PARTICLE) { halfRho[half.particle[lane]] = half.rho[lane]; }
+    if (full.particle[lane] != NO_PARTICLE) { fullRho[full.particle[lane]] = full.rho[lane]; }
+  }
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    float expected = 0.0F;
+    for (std::size_t j = 0; j < particles.size(); ++j) {
+      if (j != i) {
+        expected += calculateIncrementedDensity(particles[i], particles[j], TEST_WIDTH);
+      }
+    }
+    EXPECT_NEAR(halfRho[i], expected, std::abs(expected) * 1e-5F + 1e-30F) << "particle " << i;
+    EXPECT_NEAR(fullRho[i], expected, std::abs(expected) * 1e-5F + 1e-30F) << "particle " << i;
+  }
+}
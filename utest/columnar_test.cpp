@@ -0,0 +1,94 @@
+#include "columnar.hpp"
+#include "mappedfile.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class ColumnarTest : public ::testing::Test {
+  protected:
+    std::vector<Particle> particles;
+    std::string outputFile{"columnar_output.fld"};
+
+    void SetUp() override {
+      for (int i = 0; i < 1000; ++i) {
+        const auto value = static_cast<float>(i);
+        particles.push_back({value, value + 0.1F, value + 0.2F, 1.0F, 2.0F, 3.0F, 4.0F, 5.0F,
+                             6.0F, 1000.0F + value, 7.0F, 8.0F, -value});
+      }
+    }
+
+    void TearDown() override { (void) std::remove(outputFile.c_str()); }
+};
+
+TEST_F(ColumnarTest, ColumnsHoldTheSelectedParticles) {
+  OutputFields fields;
+  fields.id = true;
+  std::vector<std::uint32_t> const indices{1, 17, 500, 999};
+  ASSERT_TRUE(writeColumnarParticles(outputFile, Header{204.0F, 1000}, particles, indices, fields));
+
+  const ColumnarReader reader(outputFile);
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_EQ(reader.header().np, 4);
+  EXPECT_EQ(reader.header().ppm, 204.0F);
+  ASSERT_EQ(reader.directory().size(), 14U);
+  for (ColumnEntry const & entry : reader.directory()) {
+    EXPECT_EQ(entry.offset % COLUMN_ALIGNMENT, 0U);
+    EXPECT_EQ(entry.bytes, indices.size() * entry.elementSize);
+  }
+
+  const MappedColumn ids = reader.column("id");
+  const MappedColumn py  = reader.column("py");
+  const MappedColumn az  = reader.column("az");
+  ASSERT_TRUE(ids.isOpen() && py.isOpen() && az.isOpen());
+  ASSERT_EQ(py.values<float>().size(), indices.size());
+  for (std::size_t k = 0; k < indices.size(); ++k) {
+    EXPECT_EQ(ids.values<std::uint32_t>()[k], indices[k]);
+    EXPECT_EQ(py.values<float>()[k], particles[indices[k]].py);
+    EXPECT_EQ(az.values<float>()[k], particles[indices[k]].az);
+  }
+  // The element size is checked
+  EXPECT_TRUE(py.values<double>().empty());
+}
+
+TEST_F(ColumnarTest, ReaderMapsOnlyTheColumnsOfTheSelectedFields) {
+  const OutputFields fields{false, true, false, false, true, false};
+  std::vector<std::uint32_t> indices(particles.size());
+  for (std::uint32_t i = 0; i < indices.size(); ++i) { indices[i] = i; }
+  ASSERT_TRUE(writeColumnarParticles(outputFile, Header{204.0F, 1000}, particles, indices, fields));
+
+  const ColumnarReader reader(outputFile);
+  ASSERT_EQ(reader.directory().size(), 4U);
+  EXPECT_FALSE(reader.column("vx").isOpen());
+  EXPECT_FALSE(reader.column("r").isOpen());
+  const MappedColumn rho = reader.column("rho");
+  ASSERT_EQ(rho.size(), particles.size());
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    ASSERT_EQ(rho.values<float>()[i], particles[i].rho);
+  }
+  // A row file is not a columnar one
+  ASSERT_TRUE(writeParticlesToFile(outputFile, Header{204.0F, 1000}, particles));
+  EXPECT_FALSE(ColumnarReader(outputFile).isOpen());
+}
+
+TEST(MappedFileTest, RangeMapsFromAnyOffset) {
+  std::string const filename = "mappedfile_range.bin";
+  {
+    const WritableMappedFile file(filename, 3 * 4096 + 100);
+    ASSERT_TRUE(file.isOpen());
+    for (std::size_t i = 0; i < file.size(); ++i) { file.data()[i] = static_cast<char>(i % 251); }
+  }
+  const MappedFile range(filename, 4096 + 37, 5000);
+  ASSERT_TRUE(range.isOpen());
+  ASSERT_EQ(range.size(), 5000U);
+  for (std::size_t i = 0; i < range.size(); ++i) {
+    ASSERT_EQ(range.data()[i], static_cast<char>((4096 + 37 + i) % 251));
+  }
+  // Cut at the end of the file
+  EXPECT_EQ(MappedFile(filename, 3 * 4096, 1000).size(), 100U);
+  (void) std::remove(filename.c_str());
+}
@@ -0,0 +1,84 @@
+#include "compare.hpp"
+#include "particle.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+static constexpr int COMPARE_PARTICLES  = 64;
+static constexpr float COMPARE_PPM      = 204.0F;
+static constexpr float PERTURBATION     = 1e-3F;
+static constexpr std::size_t PERTURBED  = 17;
+static constexpr std::size_t RHO_FIELD  = 9;
+
+class CompareTest : public ::testing::Test {
+  private:
+    std::string expectedFile{"compare_expected.fld"};
+    std::string actualFile{"compare_actual.fld"};
+    std::vector<Particle> particles;
+
+  public:
+    [[nodiscard]] std::string const & getExpectedFile() const { return expectedFile; }
+
+    [[nodiscard]] std::string const & getActualFile() const { return actualFile; }
+
+    [[nodiscard]] std::vector<Particle> const & getParticles() const { return particles; }
+
+  protected:
+    void SetUp() override {
+      for (int i = 0; i < COMPARE_PARTICLES; ++i) {
+        Particle particle{};
+        particle.px  = static_cast<float>(i);
+        particle.rho = static_cast<float>(i) + 1.0F;
+        particles.push_back(particle);
+      }
+      const Header header{COMPARE_PPM, COMPARE_PARTICLES};
+      writeParticlesToFile(expectedFile, header, particles);
+      std::vector<Particle> perturbed = particles;
+      perturbed[PERTURBED].rho        += PERTURBATION;
+      writeParticlesToFile(actualFile, header, perturbed);
+    }
+
+    void TearDown() override {
+      (void) std::remove(expectedFile.c_str());
+      (void) std::remove(actualFile.c_str());
+    }
+};
+
+TEST_F(CompareTest, IdenticalFilesHaveNoError) {
+  const CompareReport report = compareFldFiles(getExpectedFile(), getExpectedFile(), {});
+  ASSERT_TRUE(report.comparable);
+  EXPECT_EQ(report.fieldCount, OUTPUT_FIELD_COUNT);
+  EXPECT_EQ(report.particles, static_cast<std::size_t>(COMPARE_PARTICLES));
+  EXPECT_TRUE(report.withinTolerance());
+}
+
+TEST_F(CompareTest, ReportsMaxErrorPerField) {
+  const CompareReport report = compareFldFiles(getExpectedFile(), getActualFile(), {}, 3);
+  ASSERT_TRUE(report.comparable);
+  EXPECT_FALSE(report.withinTolerance());
+  EXPECT_EQ(report.fields[RHO_FIELD].mismatches, 1U);
+  EXPECT_EQ(report.fields[RHO_FIELD].worstIndex, PERTURBED);
+  EXPECT_NEAR(report.fields[RHO_FIELD].maxAbsolute, PERTURBATION, 1e-5);
+  EXPECT_EQ(report.fields[0].maxAbsolute, 0.0);
+}
+
+TEST_F(CompareTest, ToleranceAcceptsSmallErrors) {
+  CompareTolerance tolerance;
+  tolerance.absolute = 2.0 * PERTURBATION;
+  EXPECT_TRUE(compareFldFiles(getExpectedFile(), getActualFile(), tolerance).withinTolerance());
+  tolerance.absolute = 0.0;
+  tolerance.relative = 1e-4;
+  EXPECT_TRUE(compareFldFiles(getExpectedFile(), getActualFile(), tolerance).withinTolerance());
+}
+
+TEST_F(CompareTest, RejectsMissingOrTruncatedFiles) {
+  EXPECT_FALSE(compareFldFiles(getExpectedFile(), "missing_file.fld", {}).comparable);
+  const Header header{COMPARE_PPM, COMPARE_PARTICLES + 1};
+  writeParticlesToFile(getActualFile(), header, getParticles());
+  const CompareReport report = compareFldFiles(getExpectedFile(), getActualFile(), {});
+  EXPECT_FALSE(report.comparable);
+  EXPECT_FALSE(report.error.empty());
+}
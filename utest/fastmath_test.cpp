@@ -0,0 +1,60 @@
+#include "fastmath.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+  double relativeError(double approximate, double value) {
+    const double exact = 1.0 / std::sqrt(value);
+    return std::abs(approximate - exact) / exact;
+  }
+
+  float floatFromBits(std::uint32_t bits) {
+    float value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // Every 101st normal float below 2^126
+  constexpr std::uint32_t FIRST_NORMAL = 0x00800000U;
+  constexpr std::uint32_t LAST_SAMPLE  = 0x7E800000U;
+  constexpr std::uint32_t SAMPLE_STEP  = 101;
+
+}  // namespace
+
+TEST(FastMathTest, FloatInverseSqrtIsWithinTheBound) {
+  double worst = 0.0;
+  for (std::uint32_t bits = FIRST_NORMAL; bits < LAST_SAMPLE; bits += SAMPLE_STEP) {
+    const float value = floatFromBits(bits);
+    worst             = std::max(worst, relativeError(fastInverseSqrt(value), value));
+  }
+  EXPECT_LE(worst, FAST_INVERSE_SQRT_ERROR);
+}
+
+TEST(FastMathTest, DoubleInverseSqrtIsWithinTheBound) {
+  double worst = 0.0;
+  for (std::uint32_t bits = FIRST_NORMAL; bits < LAST_SAMPLE; bits += SAMPLE_STEP) {
+    // Values between the floats, so the input rounding is part of the error
+    const double value = static_cast<double>(floatFromBits(bits)) * (1.0 + 1.0e-8);
+    worst              = std::max(worst, relativeError(fastInverseSqrt(value), value));
+  }
+  EXPECT_LE(worst, FAST_INVERSE_SQRT_ERROR);
+}
+
+TEST(FastMathTest, LanesAreWithinTheBound) {
+  const std::array<float, 4> values{1.0e-6F, 2.5e-5F, 0.75F, 3.0e4F};
+  const std::array<float, 4> lanes = fastInverseSqrt(values);
+  const std::array<double, 4> wide =
+      fastInverseSqrt(std::array<double, 4>{1.0e-6, 2.5e-5, 0.75, 3.0e4});
+  for (std::size_t lane = 0; lane < values.size(); ++lane) {
+    EXPECT_LE(relativeError(lanes[lane], values[lane]), FAST_INVERSE_SQRT_ERROR);
+    EXPECT_LE(relativeError(wide[lane], static_cast<double>(values[lane])),
+              FAST_INVERSE_SQRT_ERROR);
+  }
+}
@@ -0,0 +1,45 @@
+#include "hugepages.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+static constexpr std::size_t LARGE_VALUES = 3 * HUGE_PAGE_BYTES / sizeof(int) + 17;
+static constexpr std::size_t SMALL_VALUES = 100;
+
+TEST(HugePagesTest, LargeArraysAreHugePageAligned) {
+  for (const HugePages mode : {HugePages::transparent, HugePages::hugetlb}) {
+    LargeArray<int> values{LargePageAllocator<int>(mode)};
+    values.resize(LARGE_VALUES);
+    std::iota(values.begin(), values.end(), 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.data()) % HUGE_PAGE_BYTES, 0U);
+    EXPECT_EQ(values.back(), static_cast<int>(LARGE_VALUES - 1));
+  }
+}
+
+TEST(HugePagesTest, SmallArraysAndOffModeUseTheHeap) {
+  LargeArray<int> small{LargePageAllocator<int>(HugePages::transparent)};
+  small.assign(SMALL_VALUES, 1);
+  LargeArray<int> off;
+  off.assign(LARGE_VALUES, 2);
+  EXPECT_EQ(small.size(), SMALL_VALUES);
+  EXPECT_EQ(off.get_allocator().hugePages(), HugePages::off);
+  EXPECT_EQ(off[LARGE_VALUES - 1], 2);
+}
+
+TEST(HugePagesTest, MoveAssignmentTakesTheNewMode) {
+  LargeArray<int> values(LARGE_VALUES, 3);
+  values = LargeArray<int>(LargePageAllocator<int>(HugePages::transparent));
+  EXPECT_EQ(values.get_allocator().hugePages(), HugePages::transparent);
+  values.assign(LARGE_VALUES, 4);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.data()) % HUGE_PAGE_BYTES, 0U);
+}
+
+TEST(HugePagesTest, AdviceNeedsAWholeHugePage) {
+  std::vector<int> small(SMALL_VALUES, 1);
+  EXPECT_FALSE(adviseHugePages(small.data(), small.size() * sizeof(int)));
+  std::vector<int> large(LARGE_VALUES, 1);
+  (void) adviseHugePages(large.data(), large.size() * sizeof(int));
+  EXPECT_EQ(std::accumulate(large.begin(), large.end(), std::size_t{0}), LARGE_VALUES);
+}
@@ -0,0 +1,44 @@
+#include "numa.hpp"
+#include "threadpool.hpp"
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+static constexpr std::size_t NUMA_VALUES = 1U << 18U;
+static constexpr int NUMA_THREADS        = 3;
+
+TEST(NumaTest, CurrentNodeIsOnline) {
+  ASSERT_GE(numaNodeCount(), 1);
+  EXPECT_GE(currentNumaNode(), 0);
+  EXPECT_LT(currentNumaNode(), numaNodeCount());
+}
+
+TEST(NumaTest, ResidentBytesCoverTouchedArray) {
+  std::vector<int> values(NUMA_VALUES, 1);
+  const std::vector<std::uint64_t> resident =
+      residentBytesPerNode(values.data(), values.size() * sizeof(int));
+  ASSERT_EQ(resident.size(), static_cast<std::size_t>(numaNodeCount()));
+  const std::uint64_t total = std::accumulate(resident.begin(), resident.end(), std::uint64_t{0});
+  // Queries may be refused (no move_pages); when they answer, every page is counted
+  if (total > 0) { EXPECT_GE(total, values.size() * sizeof(int)); }
+}
+
+TEST(NumaTest, PlacementKeepsContents) {
+  std::vector<int> values(NUMA_VALUES);
+  std::iota(values.begin(), values.end(), 0);
+  ThreadPool pool(NUMA_THREADS);
+  for (const NumaPlacement placement :
+       {NumaPlacement::local, NumaPlacement::interleave, NumaPlacement::bind, NumaPlacement::off}) {
+    (void) placeArray(values, pool, placement, 0);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(values[i], static_cast<int>(i));
+    }
+  }
+}
+
+TEST(NumaTest, BindingToMissingNodeFails) {
+  std::vector<int> values(NUMA_VALUES, 1);
+  EXPECT_FALSE(placePages(values.data(), values.size() * sizeof(int), NumaPlacement::bind, -1));
+  EXPECT_TRUE(placePages(values.data(), values.size() * sizeof(int), NumaPlacement::off, 0));
+}
@@ -0,0 +1,99 @@
+#include "constants.hpp"
+#include "mappedfile.hpp"
+#include "outofcore.hpp"
+#include "particle.hpp"
+#include "step.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr float SLAB_PPM = 80.0F;
+static constexpr int SLAB_STEPS = 3;
+
+class OutOfCoreTest : public ::testing::Test {
+  protected:
+    std::vector<Particle> particles;
+    ParticleParameters params{};
+    std::string inputFile{"outofcore_input.fld"};
+    std::string outputFile{"outofcore_output.fld"};
+
+    void SetUp() override {
+      const float height    = calculateSmoothingLength(r, SLAB_PPM);
+      const GridSize blocks = calculateNumberOfBlocks(height);
+      params                = {height, calculateParticleMass(rho, SLAB_PPM),
+                               calculateBlockSize(blocks), blocks};
+      // Jittered lattice written in reverse, so the slab sort has work to do
+      const float spacing = 1.0F / SLAB_PPM;
+      unsigned int seed   = 12345U;
+      auto jitter         = [&seed, spacing]() {
+        seed = seed * 1664525U + 1013904223U;
+        return (static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U) - 0.5F) * 0.1F *
+               spacing;
+      };
+      for (float z = zmax - spacing; z > zmin + spacing; z -= spacing) {
+        for (float y = ymax - spacing; y > ymin + spacing; y -= spacing) {
+          for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+            Particle particle{};
+            particle.px = x + jitter();
+            particle.py = y + jitter();
+            particle.pz = z + jitter();
+            particles.push_back(particle);
+          }
+        }
+      }
+      std::ofstream input(inputFile, std::ios::binary);
+      const Header header{SLAB_PPM, static_cast<int>(particles.size())};
+      input.write(reinterpret_cast<char const *>(&header), sizeof(Header));
+      for (Particle const & particle : particles) {
+        input.write(reinterpret_cast<char const *>(&particle),
+                    static_cast<std::streamsize>(FLD_RECORD_SIZE));
+      }
+    }
+
+    void TearDown() override {
+      (void) std::remove(inputFile.c_str());
+      (void) std::remove(outputFile.c_str());
+    }
+};
+
+TEST_F(OutOfCoreTest, SlabsGiveTheInMemoryParticles) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.reduction          = reduction;
+    options.outOfCoreDirectory = std::filesystem::temp_directory_path().string();
+    options.outOfCoreSlabCells = 1;
+    std::vector<Particle> reference = particles;
+    for (Particle & particle : reference) { initializeDensitiesAndAccelerations(particle); }
+    StepWorkspace<FloatPrecision> workspace;
+    for (int it = 0; it < SLAB_STEPS; ++it) {
+      stepParticles(reference, params, workspace, options);
+    }
+
+    OutOfCoreStats stats;
+    ASSERT_TRUE(
+        simulateOutOfCore(SLAB_STEPS, inputFile, outputFile, params, options, nullptr, stats));
+    const MappedFile output(outputFile);
+    ASSERT_EQ(output.size(), sizeof(Header) + reference.size() * sizeof(Particle));
+    EXPECT_EQ(std::memcmp(output.data() + sizeof(Header), reference.data(),
+                          reference.size() * sizeof(Particle)),
+              0);
+    // Slabs are at least as thick as the halo, and every window holds a halo
+    EXPECT_GE(stats.slabCells, stats.haloCells);
+    EXPECT_GT(stats.slabs, 1);
+    EXPECT_EQ(stats.ownedParticleSteps, reference.size() * SLAB_STEPS);
+    EXPECT_GT(stats.windowParticleSteps, stats.ownedParticleSteps);
+    EXPECT_LT(stats.largestWindow, reference.size());
+  }
+}
+
+TEST_F(OutOfCoreTest, MissingWorkingDirectoryFails) {
+  SimulationOptions options;
+  options.outOfCoreDirectory = "no_such_directory";
+  OutOfCoreStats stats;
+  EXPECT_FALSE(simulateOutOfCore(1, inputFile, outputFile, params, options, nullptr, stats));
+}
@@ -0,0 +1,127 @@
+#include "celllist.hpp"
+#include "constants.hpp"
+#include "outputfilter.hpp"
+#include "particle.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr float FILTER_PPM     = 204.0F;
+static constexpr int FILTER_PARTICLES = 5000;
+
+class OutputFilterTest : public ::testing::Test {
+  protected:
+    std::vector<Particle> particles;
+    ParticleParameters params{};
+    std::string outputFile{"outputfilter_output.fld"};
+
+    void SetUp() override {
+      const float height    = calculateSmoothingLength(r, FILTER_PPM);
+      const GridSize blocks = calculateNumberOfBlocks(height);
+      params                = {height, calculateParticleMass(rho, FILTER_PPM),
+                               calculateBlockSize(blocks), blocks};
+      // Random positions over the box and a little beyond it
+      unsigned int seed = 12345U;
+      auto next         = [&seed](float low, float high) {
+        seed = seed * 1664525U + 1013904223U;
+        const float unit = static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U);
+        const float pad  = 0.05F * (high - low);
+        return low - pad + unit * (high - low + 2.0F * pad);
+      };
+      for (int i = 0; i < FILTER_PARTICLES; ++i) {
+        Particle particle{};
+        particle.px  = next(xmin, xmax);
+        particle.py  = next(ymin, ymax);
+        particle.pz  = next(zmin, zmax);
+        particle.rho = static_cast<float>(i);
+        particles.push_back(particle);
+      }
+    }
+
+    void TearDown() override { (void) std::remove(outputFile.c_str()); }
+};
+
+TEST_F(OutputFilterTest, DefaultFilterKeepsTheFullLayout) {
+  EXPECT_FALSE(usesOutputFilter(OutputFilter{}));
+  EXPECT_EQ(outputRecordSize(OutputFields{}), sizeof(Particle));
+  OutputFilter filter;
+  filter.fields.id = true;
+  EXPECT_TRUE(usesOutputFilter(filter));
+}
+
+TEST_F(OutputFilterTest, StrideKeepsMultiplesOfIt) {
+  OutputFilter filter;
+  filter.sampling = OutputSampling::stride;
+  filter.stride   = 3;
+  EXPECT_EQ(sampleOutputIndices(10, filter), (std::vector<std::uint32_t>{0, 3, 6, 9}));
+}
+
+TEST_F(OutputFilterTest, RandomShareDependsOnTheSeedOnly) {
+  OutputFilter filter;
+  filter.sampling = OutputSampling::random;
+  filter.fraction = 0.1;
+  filter.seed     = 7;
+  std::vector<std::uint32_t> const indices = sampleOutputIndices(100000, filter);
+  EXPECT_NEAR(static_cast<double>(indices.size()), 10000.0, 600.0);
+  EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+  EXPECT_EQ(std::adjacent_find(indices.begin(), indices.end()), indices.end());
+  EXPECT_LT(indices.back(), 100000U);
+  EXPECT_EQ(sampleOutputIndices(100000, filter), indices);
+  filter.seed = 8;
+  EXPECT_NE(sampleOutputIndices(100000, filter), indices);
+}
+
+TEST_F(OutputFilterTest, RegionCellsGiveTheParticlesInside) {
+  for (const CellLayout layout : {CellLayout::dense, CellLayout::hashed}) {
+    CellList cells;
+    buildCellList(particles, params.blockSize, params.blocks, cells, layout);
+    for (const OutputSampling sampling :
+         {OutputSampling::all, OutputSampling::stride, OutputSampling::random}) {
+      OutputFilter filter;
+      filter.region    = true;
+      // A corner of the box, crossing its lower faces
+      filter.regionMin = {xmin - 1.0F, ymin - 1.0F, zmin - 1.0F};
+      filter.regionMax = {0.5F * (xmin + xmax), ymin + 0.3F * (ymax - ymin), 0.0F};
+      filter.sampling  = sampling;
+      filter.stride    = 4;
+      filter.fraction  = 0.5;
+      std::vector<std::uint32_t> const sample = sampleOutputIndices(particles.size(), filter);
+      std::vector<std::uint32_t> expected;
+      for (const std::uint32_t i : sample) {
+        Particle const & p = particles[i];
+        if (p.px >= filter.regionMin[0] && p.px <= filter.regionMax[0] &&
+            p.py >= filter.regionMin[1] && p.py <= filter.regionMax[1] &&
+            p.pz >= filter.regionMin[2] && p.pz <= filter.regionMax[2]) {
+          expected.push_back(i);
+        }
+      }
+      ASSERT_FALSE(expected.empty());
+      EXPECT_EQ(selectOutputParticles(particles, cells, filter), expected);
+    }
+  }
+}
+
+TEST_F(OutputFilterTest, RecordsHoldTheSelectedFields) {
+  const OutputFields fields{true, false, false, false, true, false};
+  std::vector<std::uint32_t> const indices{2, 40, 4999};
+  ASSERT_TRUE(writeSelectedParticles(outputFile, Header{FILTER_PPM, FILTER_PARTICLES},
+                                     particles, indices, fields));
+  std::ifstream input(outputFile, std::ios::binary);
+  Header header{};
+  input.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  EXPECT_EQ(header.np, 3);
+  EXPECT_EQ(header.ppm, FILTER_PPM);
+  for (const std::uint32_t i : indices) {
+    std::uint32_t id = 0;
+    float density    = 0.0F;
+    input.read(reinterpret_cast<char *>(&id), sizeof(id));
+    input.read(reinterpret_cast<char *>(&density), sizeof(density));
+    EXPECT_EQ(id, i);
+    EXPECT_EQ(density, particles[i].rho);
+  }
+  EXPECT_EQ(input.peek(), std::char_traits<char>::eof());
+}
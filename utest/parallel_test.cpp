@@ -0,0 +1,33 @@
+#include "parallel.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr std::size_t RANGE_COUNT = 103;
+static constexpr int RANGE_THREADS       = 4;
+
+TEST(ParallelTest, ThreadRangesCoverCountOnce) {
+  std::size_t expectedBegin = 0;
+  for (int thread = 0; thread < RANGE_THREADS; ++thread) {
+    const IndexRange range = threadRange(RANGE_COUNT, thread, RANGE_THREADS);
+    EXPECT_EQ(range.begin, expectedBegin);
+    EXPECT_GE(range.end - range.begin, RANGE_COUNT / RANGE_THREADS);
+    expectedBegin = range.end;
+  }
+  EXPECT_EQ(expectedBegin, RANGE_COUNT);
+}
+
+TEST(ParallelTest, RunOnThreadsRunsEveryThreadIndex) {
+  std::vector<std::atomic<int>> calls(RANGE_THREADS);
+  runOnThreads(RANGE_THREADS, [&](int thread) { ++calls[static_cast<std::size_t>(thread)]; });
+  for (auto const & count : calls) { EXPECT_EQ(count.load(), 1); }
+}
+
+TEST(ParallelTest, ParallelForVisitsEveryIndex) {
+  std::vector<int> visits(RANGE_COUNT, 0);
+  parallelFor(RANGE_THREADS, RANGE_COUNT, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) { ++visits[i]; }
+  });
+  for (int visit : visits) { EXPECT_EQ(visit, 1); }
+}
@@ -0,0 +1,68 @@
+#include "profile.hpp"
+#include "step.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static constexpr int PROFILE_STEPS     = 3;
+static constexpr int PROFILE_PARTICLES = 27;
+static constexpr float PROFILE_SPACING = 0.004F;
+static constexpr float PROFILE_HEIGHT  = 0.0084F;
+static constexpr float PROFILE_MASS    = 2.2e-4F;
+
+TEST(ProfileTest, DisabledCountersReportWallTimeOnly) {
+  StepProfile profile(false);
+  {
+    const PhaseScope scope(&profile, StepPhase::densities);
+  }
+  EXPECT_FALSE(profile.countersAvailable(PerfEvent::cycles));
+  EXPECT_EQ(profile.totals(StepPhase::densities).calls, 1U);
+  EXPECT_GE(profile.totals(StepPhase::densities).seconds, 0.0);
+  EXPECT_EQ(profile.totals(StepPhase::densities).events[0], 0U);
+  EXPECT_EQ(profile.totals(StepPhase::motion).calls, 0U);
+
+  std::ostringstream output;
+  printStepProfile(profile, output);
+  EXPECT_NE(output.str().find("densities"), std::string::npos);
+  EXPECT_NE(output.str().find("n/a"), std::string::npos);
+  EXPECT_NE(output.str().find("unavailable (disabled)"), std::string::npos);
+}
+
+TEST(ProfileTest, NullProfileScopeDoesNothing) {
+  const PhaseScope scope(nullptr, StepPhase::reposition);
+  SUCCEED();
+}
+
+// Passes with or without access to the PMU: unavailable counters must read as zero
+TEST(ProfileTest, StepRecordsEveryPhase) {
+  std::vector<Particle> particles;
+  for (int i = 0; i < PROFILE_PARTICLES; ++i) {
+    Particle particle{};
+    particle.px = static_cast<float>(i % 3) * PROFILE_SPACING;
+    particle.py = static_cast<float>((i / 3) % 3) * PROFILE_SPACING;
+    particle.pz = static_cast<float>(i / 9) * PROFILE_SPACING;
+    particles.push_back(particle);
+  }
+  const ParticleParameters params{PROFILE_HEIGHT, PROFILE_MASS, GridSize(1, 1, 1),
+                                  GridSize(1, 1, 1)};
+  StepProfile profile;
+  StepWorkspace<FloatPrecision> workspace;
+  workspace.profile = &profile;
+  for (int step = 0; step < PROFILE_STEPS; ++step) {
+    stepParticles(particles, params, workspace);
+  }
+  // The phase graph only runs with CellSchedule::graph
+  for (std::size_t index = 0; index < STEP_PHASE_COUNT; ++index) {
+    const auto phase = static_cast<StepPhase>(index);
+    EXPECT_EQ(profile.totals(phase).calls,
+              phase == StepPhase::phaseGraph ? 0U : static_cast<std::uint64_t>(PROFILE_STEPS));
+  }
+  if (!profile.countersAvailable(PerfEvent::instructions)) {
+    EXPECT_EQ(profile.totals(StepPhase::densities).events[1], 0U);
+    EXPECT_FALSE(profile.unavailableReason().empty());
+  } else {
+    EXPECT_GT(profile.totals(StepPhase::densities).events[1], 0U);
+  }
+}
@@ -0,0 +1,62 @@
+#include "scheduler.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr int SCHEDULER_THREADS       = 4;
+static constexpr std::size_t SCHEDULER_ITEMS = 200;
+static constexpr std::size_t HEAVY_ITEM      = 3;
+static constexpr std::uint64_t HEAVY_WEIGHT  = 1000;
+static constexpr int SCHEDULER_GROUPS        = 5;
+
+TEST(SchedulerTest, WeightedGroupsCoverItemsInOrder) {
+  std::vector<std::uint64_t> weights(SCHEDULER_ITEMS, 1);
+  weights[HEAVY_ITEM] = HEAVY_WEIGHT;
+  TaskGroups groups;
+  appendWeightedGroup(weights, SCHEDULER_THREADS, groups);
+  appendWeightedGroup(std::vector<std::uint64_t>(SCHEDULER_ITEMS, 0), SCHEDULER_THREADS, groups);
+  ASSERT_EQ(groups.groupCount(), 2U);
+  std::size_t next = 0;
+  for (std::uint32_t task = groups.groupStart[0]; task < groups.groupStart[1]; ++task) {
+    EXPECT_EQ(groups.tasks[task].begin, next);
+    next = groups.tasks[task].end;
+  }
+  EXPECT_EQ(next, SCHEDULER_ITEMS);
+  // The heavy item closes its own task
+  EXPECT_EQ(groups.tasks[0].end, HEAVY_ITEM + 1);
+  EXPECT_EQ(groups.groupStart[2] - groups.groupStart[1], 1U);
+}
+
+TEST(SchedulerTest, EveryTaskRunsOnceAndIdleThreadsSteal) {
+  TaskGroups groups;
+  for (int group = 0; group < SCHEDULER_GROUPS; ++group) {
+    appendWeightedGroup(std::vector<std::uint64_t>(SCHEDULER_ITEMS, 1), SCHEDULER_ITEMS, groups);
+  }
+  ThreadPool pool(SCHEDULER_THREADS);
+  WorkStealingScheduler scheduler;
+  scheduler.prepare(SCHEDULER_THREADS);
+  std::vector<std::atomic<int>> runs(groups.tasks.size());
+  pool.run([&](int thread) {
+    scheduler.seed(thread, groups, 0, 0);
+    pool.barrier();
+    for (std::size_t group = 0; group < groups.groupCount(); ++group) {
+      const auto slot = static_cast<int>(group % 2);
+      scheduler.execute(thread, groups, slot, [&](IndexRange items) {
+        ++runs[groups.groupStart[group] + items.begin];
+        // Thread 0 is slow, so the others run out first and steal its tasks
+        if (thread == 0) { std::this_thread::yield(); }
+      });
+      if (group + 1 < groups.groupCount()) {
+        scheduler.seed(thread, groups, group + 1, static_cast<int>((group + 1) % 2));
+      }
+      pool.barrier();
+    }
+  });
+  for (auto const & count : runs) { EXPECT_EQ(count.load(), 1); }
+  std::uint64_t tasks = 0;
+  for (ThreadLoad const & load : scheduler.takeLoad()) { tasks += load.tasks; }
+  EXPECT_EQ(tasks, groups.tasks.size());
+  for (ThreadLoad const & load : scheduler.takeLoad()) { EXPECT_EQ(load.tasks, 0U); }
+}
@@ -0,0 +1,85 @@
+#include "particle.hpp"
+#include "shmring.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+class ShmRingTest : public ::testing::Test {
+  protected:
+    std::string name{"/shmring-test-" + std::to_string(getpid())};
+    std::vector<Particle> particles;
+
+    void SetUp() override {
+      particles.resize(100);
+      for (std::size_t i = 0; i < particles.size(); ++i) {
+        const auto x = static_cast<float>(i);
+        particles[i] = {x, 2.0F * x, 3.0F * x, 0.0F, 0.0F, 0.0F, 0.1F, 0.2F, 0.3F, 1000.0F,
+                        0.0F, -9.8F, 0.0F};
+      }
+    }
+
+    // Every particle moved by `step`
+    std::vector<Particle> frameAt(int step) const {
+      std::vector<Particle> frame = particles;
+      for (Particle & particle : frame) { particle.px += static_cast<float>(step); }
+      return frame;
+    }
+};
+
+TEST_F(ShmRingTest, ReadersSeeTheNewestFrameInPlace) {
+  ShmRingWriter writer(name, 3, particles.size(), 204.0F);
+  ASSERT_TRUE(writer.isOpen());
+  ShmRingReader const reader(name);
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_EQ(reader.header().slots, 3U);
+  EXPECT_EQ(reader.header().capacity, 100U);
+  EXPECT_EQ(reader.header().ppm, 204.0F);
+  ShmFrame frame;
+  EXPECT_FALSE(reader.acquireLatest(frame));
+
+  for (int step = 0; step < 5; ++step) { ASSERT_TRUE(writer.publish(10 * step, frameAt(step))); }
+  EXPECT_EQ(reader.published(), 5U);
+  ASSERT_TRUE(reader.acquireLatest(frame));
+  EXPECT_EQ(frame.frame, 4U);
+  EXPECT_EQ(frame.step, 40);
+  ASSERT_EQ(frame.particles.size(), particles.size());
+  EXPECT_EQ(frame.particles[7].px, 11.0F);
+  EXPECT_EQ(frame.particles[7].py, 14.0F);
+  EXPECT_TRUE(ShmRingReader::stillValid(frame));
+  EXPECT_FALSE(reader.closed());
+}
+
+TEST_F(ShmRingTest, ReadsOfAnOverwrittenSlotAreInvalid) {
+  ShmRingWriter writer(name, 2, particles.size(), 204.0F);
+  ShmRingReader const reader(name);
+  ASSERT_TRUE(writer.publish(0, frameAt(0)));
+  ShmFrame frame;
+  ASSERT_TRUE(reader.acquireLatest(frame));
+  // The next frame goes to the other slot
+  ASSERT_TRUE(writer.publish(1, frameAt(1)));
+  EXPECT_TRUE(ShmRingReader::stillValid(frame));
+  // and the one after it over the frame being read
+  ASSERT_TRUE(writer.publish(2, frameAt(2)));
+  EXPECT_FALSE(ShmRingReader::stillValid(frame));
+  // Frames larger than a slot are refused
+  std::vector<Particle> larger = particles;
+  larger.emplace_back();
+  EXPECT_FALSE(writer.publish(3, larger));
+  EXPECT_EQ(writer.published(), 3U);
+}
+
+TEST_F(ShmRingTest, RingOutlivesItsNameWhileMapped) {
+  auto writer = std::make_unique<ShmRingWriter>(name, 2, particles.size(), 204.0F);
+  ShmRingReader const reader(name);
+  ASSERT_TRUE(writer->publish(6, frameAt(6)));
+  writer.reset();
+  EXPECT_TRUE(reader.closed());
+  ShmFrame frame;
+  ASSERT_TRUE(reader.acquireLatest(frame));
+  EXPECT_EQ(frame.step, 6);
+  EXPECT_EQ(frame.particles[1].px, 7.0F);
+  EXPECT_FALSE(ShmRingReader(name).isOpen());
+}
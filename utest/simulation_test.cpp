@@ -1,46 +1,114 @@
-#include "simulation.hpp"
-#include "utils.hpp"
-
-#include "gtest/gtest.h"
-#include <filesystem>
-#include <fstream>
-
-class SimulationTest : public ::testing::Test {
-  private:
-    std::string testInputFile;
-    std::string testOutputFile;
-
-  public:
-    [[nodiscard]] std::string getTestInputFile() const { return testInputFile; }
-
-    [[nodiscard]] std::string getTestOutputFile() const { return testOutputFile; }
-
-    void setTestInputFile(std::string const & inputFile) { testInputFile = inputFile; }
-
-    void setTestOutputFile(std::string const & outputFile) { testOutputFile = outputFile; }
-
-  protected:
-    void SetUp() override {
-      testInputFile  = "/in/small.fld";
-      testOutputFile = "/out/small_output.fld";
-    }
-};
-
-TEST_F(SimulationTest, ValidInput) {
-  ASSERT_NO_THROW(runSimulation(10, getTestInputFile(), getTestOutputFile()));
-}
-
-TEST_F(SimulationTest, BoundaryTest) {
-  ASSERT_NO_THROW(runSimulation(0, getTestInputFile(), getTestOutputFile()));
-  ASSERT_NO_THROW(runSimulation(INT_MAX, getTestInputFile(), getTestOutputFile()));
-}
-
-TEST_F(SimulationTest, ErrorHandling) {
-  ASSERT_THROW(runSimulation(10, "non_existent_input.fld", getTestOutputFile()), std::exception);
-  ASSERT_THROW(runSimulation(10, getTestInputFile(), "non_writable_output.fld"), std::exception);
-}
-
-int simulation_test(int argc, char ** argv) {
-  ::testing::InitGoogleTest(&argc, argv);
-  return RUN_ALL_TESTS();
-}
+#include "simulation.hpp"
+#include "utils.hpp"
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+class SimulationTest : public ::testing::Test {
+  private:
+    std::string testInputFile;
+    std::string testOutputFile;
+
+  public:
+    [[nodiscard]] std::string getTestInputFile() const { return testInputFile; }
+
+    [[nodiscard]] std::string getTestOutputFile() const { return testOutputFile; }
+
+    void setTestInputFile(std::string const & inputFile) { testInputFile = inputFile; }
+
+    void setTestOutputFile(std::string const & outputFile) { testOutputFile = outputFile; }
+
+  protected:
+    void SetUp() override {
+      testInputFile  = "/in/small.fld";
+      testOutputFile = "/out/small_output.fld";
+    }
+};
+
+TEST_F(SimulationTest, ValidInput) {
+  ASSERT_NO_THROW(runSimulation(10, getTestInputFile(), getTestOutputFile()));
+}
+
+TEST_F(SimulationTest, BoundaryTest) {
+  ASSERT_NO_THROW(runSimulation(0, getTestInputFile(), getTestOutputFile()));
+  ASSERT_NO_THROW(runSimulation(INT_MAX, getTestInputFile(), getTestOutputFile()));
+}
+
+TEST_F(SimulationTest, ErrorHandling) {
+  ASSERT_THROW(runSimulation(10, "non_existent_input.fld", getTestOutputFile()), std::exception);
+  ASSERT_THROW(runSimulation(10, getTestInputFile(), "non_writable_output.fld"), std::exception);
+}
+
+// Particles 1.2 smoothing lengths apart at 204 particles per metre, falling under gravity
+static std::vector<Particle> embeddedLattice() {
+  const float spacing = 1.2F * calculateSmoothingLength(r, 204.0F);
+  std::vector<Particle> particles;
+  for (float z = zmin + spacing; z < zmax - spacing; z += spacing) {
+    for (float y = ymin + spacing; y < ymax - spacing; y += spacing) {
+      for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+        Particle particle{};
+        particle.px = x;
+        particle.py = y;
+        particle.pz = z;
+        particles.push_back(particle);
+      }
+    }
+  }
+  return particles;
+}
+
+TEST(EmbeddedSimulationTest, StepsMatchTheStepFunctionAcrossCalls) {
+  std::vector<Particle> expected = embeddedLattice();
+  Simulation simulation(204.0F, expected);
+  Particle const * data = simulation.particles().data();
+  simulation.step(2);
+  simulation.step();
+  EXPECT_EQ(simulation.stepsTaken(), 3);
+  // The view is the simulation's own array
+  EXPECT_EQ(simulation.particles().data(), data);
+
+  for (Particle & particle : expected) { initializeDensitiesAndAccelerations(particle); }
+  StepWorkspace<FloatPrecision> workspace;
+  for (int it = 0; it < 3; ++it) {
+    stepParticles(expected, simulation.parameters(), workspace);
+  }
+  ASSERT_EQ(simulation.particles().size(), expected.size());
+  EXPECT_EQ(std::memcmp(simulation.particles().data(), expected.data(),
+                        expected.size() * sizeof(Particle)),
+            0);
+}
+
+TEST(EmbeddedSimulationTest, ObserversSeeEveryStep) {
+  Simulation simulation(204.0F, embeddedLattice());
+  std::vector<int> seen;
+  simulation.addObserver([&](int step, std::span<Particle const> particles) {
+    seen.push_back(step);
+    EXPECT_EQ(particles.data(), simulation.particles().data());
+  });
+  simulation.step(2);
+  simulation.step(3);
+  EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 4, 5}));
+  simulation.clearObservers();
+  simulation.step();
+  EXPECT_EQ(seen.size(), 5U);
+}
+
+TEST(EmbeddedSimulationTest, TemporalBlocksNotifyOncePerBlock) {
+  SimulationOptions options;
+  options.temporalSteps = 2;
+  Simulation simulation(204.0F, embeddedLattice(), options);
+  std::vector<int> seen;
+  simulation.addObserver([&seen](int step, std::span<Particle const>) { seen.push_back(step); });
+  simulation.step(5);
+  EXPECT_EQ(seen, (std::vector<int>{2, 4, 5}));
+  EXPECT_EQ(simulation.stepsTaken(), 5);
+}
+
+int simulation_test(int argc, char ** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
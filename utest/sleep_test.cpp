@@ -0,0 +1,131 @@
+#include "celllist.hpp"
+#include "constants.hpp"
+#include "particle.hpp"
+#include "sleep.hpp"
+#include "threadpool.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr int TEST_CELLS       = 6;
+static constexpr int TEST_STILL_STEPS = 2;
+
+class SleepTest : public ::testing::Test {
+  protected:
+    GridSize blockSize{1, 1, 1};
+    GridSize blocks{TEST_CELLS, TEST_CELLS, TEST_CELLS};
+    std::vector<Particle> particles;
+    CellList cells;
+    SleepState state;
+    ThreadPool pool{1, false};
+    SleepThresholds thresholds{TEST_STILL_STEPS, 0.1, 1.0};
+    CellLayout layout = CellLayout::dense;
+
+    void SetUp() override {
+      blockSize.nx = (xmax - xmin) / TEST_CELLS;
+      blockSize.ny = (ymax - ymin) / TEST_CELLS;
+      blockSize.nz = (zmax - zmin) / TEST_CELLS;
+      setCellGrid(cells, blockSize, blocks);
+      // One resting particle in the middle of every cell
+      for (int cz = 0; cz < TEST_CELLS; ++cz) {
+        for (int cy = 0; cy < TEST_CELLS; ++cy) {
+          for (int cx = 0; cx < TEST_CELLS; ++cx) {
+            Particle particle{};
+            particle.px = xmin + (static_cast<float>(cx) + 0.5F) * blockSize.nx;
+            particle.py = ymin + (static_cast<float>(cy) + 0.5F) * blockSize.ny;
+            particle.pz = zmin + (static_cast<float>(cz) + 0.5F) * blockSize.nz;
+            particles.push_back(particle);
+          }
+        }
+      }
+    }
+
+    // Binning, marking and the end-of-step update of one step
+    void step(bool halfStencil = true) {
+      buildCellList(particles, blockSize, blocks, cells, layout);
+      markSleepingCells(state, cells, TEST_STILL_STEPS, halfStencil, pool);
+      updateSleepState(state, cells, particles, thresholds, pool);
+    }
+
+    [[nodiscard]] std::size_t cellOf(int cx, int cy, int cz) const {
+      const std::size_t key = cells.grid.cellIndex(cx, cy, cz);
+      return layout == CellLayout::dense ? key : cells.table.find(key);
+    }
+
+    [[nodiscard]] bool frozen(int cx, int cy, int cz) const {
+      return state.frozen[cellOf(cx, cy, cz)] != 0;
+    }
+
+    [[nodiscard]] static std::size_t particleOf(int cx, int cy, int cz) {
+      return static_cast<std::size_t>((cz * TEST_CELLS + cy) * TEST_CELLS + cx);
+    }
+};
+
+TEST_F(SleepTest, StillCellsFreezeAfterTheirStillSteps) {
+  for (int it = 0; it < TEST_STILL_STEPS; ++it) {
+    step();
+    EXPECT_FALSE(frozen(2, 2, 2)) << "step " << it;
+  }
+  step();
+  for (std::size_t i = 0; i < particles.size(); ++i) { EXPECT_TRUE(isFrozen(state, cells, i)); }
+  // Every pair joins two frozen cells
+  for (std::uint32_t cell : cells.colorCells) { EXPECT_NE(state.skipped[cell], 0); }
+  EXPECT_EQ(state.stats.frozenParticleSteps, particles.size());
+  EXPECT_EQ(state.stats.particleSteps, particles.size() * (TEST_STILL_STEPS + 1));
+}
+
+TEST_F(SleepTest, MotionWakesTheNeighbourhood) {
+  for (int it = 0; it <= TEST_STILL_STEPS; ++it) { step(); }
+  ASSERT_TRUE(frozen(2, 1, 1));
+  // The corner particle moves into (1, 0, 0): both cells wake because their population changed
+  Particle & mover = particles[particleOf(0, 0, 0)];
+  mover.px         = particles[particleOf(1, 0, 0)].px;
+  mover.vx         = 1.0F;
+  buildCellList(particles, blockSize, blocks, cells);
+  markSleepingCells(state, cells, TEST_STILL_STEPS, true, pool);
+  EXPECT_FALSE(frozen(1, 0, 0));
+  EXPECT_TRUE(frozen(2, 1, 1));
+  // Its speed then wakes the 26 cells around (1, 0, 0)
+  updateSleepState(state, cells, particles, thresholds, pool);
+  step();
+  EXPECT_FALSE(frozen(2, 1, 1));
+  EXPECT_FALSE(frozen(0, 1, 1));
+  EXPECT_TRUE(frozen(3, 1, 1));
+  EXPECT_TRUE(frozen(4, 4, 4));
+  EXPECT_GT(state.stats.wakeUps, 0U);
+}
+
+TEST_F(SleepTest, HalfStencilWorkIsSkippedOnlyAmongRestingCells) {
+  for (int it = 0; it <= TEST_STILL_STEPS; ++it) { step(); }
+  // Moving the particle of (3, 3, 3) to (3, 3, 2) wakes both cells
+  particles[particleOf(3, 3, 3)].pz -= blockSize.nz;
+  buildCellList(particles, blockSize, blocks, cells);
+  markSleepingCells(state, cells, TEST_STILL_STEPS, true, pool);
+  EXPECT_FALSE(frozen(3, 3, 2));
+  // (2, 2, 2) has (3, 3, 2) in its forward half but (4, 4, 4) has neither cell
+  EXPECT_TRUE(frozen(2, 2, 2));
+  EXPECT_EQ(state.skipped[cells.grid.cellIndex(2, 2, 2)], 0);
+  EXPECT_NE(state.skipped[cells.grid.cellIndex(4, 4, 4)], 0);
+  // The gather only skips frozen cells
+  markSleepingCells(state, cells, TEST_STILL_STEPS, false, pool);
+  EXPECT_NE(state.skipped[cells.grid.cellIndex(2, 2, 2)], 0);
+  EXPECT_EQ(state.skipped[cells.grid.cellIndex(3, 3, 2)], 0);
+}
+
+TEST_F(SleepTest, HashedCellsKeepTheirCountersWhenRenumbered) {
+  layout = CellLayout::hashed;
+  for (int it = 0; it <= TEST_STILL_STEPS; ++it) { step(); }
+  EXPECT_EQ(state.stats.frozenParticleSteps, particles.size());
+  // Emptying the corner cell renumbers every cell after it; only its neighbourhood wakes
+  particles[particleOf(0, 0, 0)].px = particles[particleOf(1, 0, 0)].px;
+  particles[particleOf(0, 0, 0)].vx = 1.0F;
+  step();
+  EXPECT_FALSE(frozen(1, 0, 0));
+  EXPECT_TRUE(frozen(2, 1, 1));
+  EXPECT_TRUE(frozen(4, 4, 4));
+  step();
+  EXPECT_FALSE(frozen(2, 1, 1));
+  EXPECT_TRUE(frozen(3, 1, 1));
+  EXPECT_TRUE(frozen(4, 4, 4));
+  EXPECT_EQ(state.keys.size(), particles.size() - 1);
+}
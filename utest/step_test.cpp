@@ -0,0 +1,360 @@
+#include "constants.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "utils.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr int CLUSTER_PARTICLES = 400;
+static constexpr float CLUSTER_PPM     = 204.0F;
+
+class StepTest : public ::testing::Test {
+  private:
+    std::vector<Particle> particles;
+    ParticleParameters params{};
+
+  public:
+    [[nodiscard]] std::vector<Particle> const & getParticles() const { return particles; }
+
+    [[nodiscard]] ParticleParameters const & getParams() const { return params; }
+
+  protected:
+    void SetUp() override {
+      const float height = calculateSmoothingLength(r, CLUSTER_PPM);
+      const GridSize blocks = calculateNumberOfBlocks(height);
+      params = {height, calculateParticleMass(rho, CLUSTER_PPM), calculateBlockSize(blocks), blocks};
+      // Dense cluster inside one smoothing length so every particle sums many neighbours
+      unsigned int seed = 12345U;
+      auto next         = [&seed]() {
+        seed = seed * 1664525U + 1013904223U;
+        return static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U);
+      };
+      for (int i = 0; i < CLUSTER_PARTICLES; ++i) {
+        Particle particle{};
+        particle.px = height * next();
+        particle.py = height * next();
+        particle.pz = height * next();
+        particles.push_back(particle);
+      }
+    }
+};
+
+TEST_F(StepTest, FloatPolicyMatchesPairFunctions) {
+  std::vector<Particle> stepped(getParticles().begin(), getParticles().begin() + 2);
+  std::vector<Particle> manual = stepped;
+  StepWorkspace<FloatPrecision> workspace;
+  stepParticles(stepped, getParams(), workspace);
+
+  for (Particle & particle : manual) { initializeDensitiesAndAccelerations(particle); }
+  updateDensity(manual[0], manual[1], getParams().smoothingLength);
+  transformDensity(manual[0], getParams().smoothingLength, getParams().mass);
+  transformDensity(manual[1], getParams().smoothingLength, getParams().mass);
+  updateAcceleration(manual[0], manual[1], getParams().smoothingLength, getParams().mass);
+  for (Particle & particle : manual) {
+    processCollisions(particle);
+    updateParticleMotion(particle);
+  }
+
+  for (std::size_t i = 0; i < manual.size(); ++i) {
+    EXPECT_FLOAT_EQ(stepped[i].rho, manual[i].rho);
+    EXPECT_FLOAT_EQ(stepped[i].px, manual[i].px);
+    EXPECT_FLOAT_EQ(stepped[i].vy, manual[i].vy);
+  }
+}
+
+TEST_F(StepTest, MixedPolicyReducesDensityError) {
+  std::vector<Particle> floatParticles = getParticles();
+  std::vector<Particle> mixedParticles = getParticles();
+  StepWorkspace<FloatPrecision> floatWorkspace;
+  StepWorkspace<MixedPrecision> mixedWorkspace;
+  stepParticles(floatParticles, getParams(), floatWorkspace);
+  stepParticles(mixedParticles, getParams(), mixedWorkspace);
+
+  // Reference densities summed in double from the same float positions
+  auto positions = convertParticles<double>(getParticles());
+  const auto height = static_cast<double>(getParams().smoothingLength);
+  double floatError = 0.0;
+  double mixedError = 0.0;
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    double sum = 0.0;
+    for (std::size_t j = 0; j < positions.size(); ++j) {
+      if (i != j) { sum += calculateIncrementedDensity(positions[i], positions[j], height); }
+    }
+    const double reference =
+        calculateTransformedDensity(sum, height, static_cast<double>(getParams().mass));
+    floatError += std::abs(static_cast<double>(floatParticles[i].rho) - reference) / reference;
+    mixedError += std::abs(static_cast<double>(mixedParticles[i].rho) - reference) / reference;
+  }
+  EXPECT_LE(mixedError, floatError);
+}
+
+TEST_F(StepTest, ConvertParticlesRoundTrip) {
+  auto const widened = convertParticles<double>(getParticles());
+  auto const narrowed = convertParticles<float>(widened);
+  ASSERT_EQ(narrowed.size(), getParticles().size());
+  for (std::size_t i = 0; i < narrowed.size(); ++i) {
+    EXPECT_EQ(narrowed[i].px, getParticles()[i].px);
+    EXPECT_EQ(narrowed[i].pz, getParticles()[i].pz);
+  }
+}
+
+TEST_F(StepTest, DeterministicReductionIsIndependentOfThreadCount) {
+  std::vector<Particle> reference = getParticles();
+  StepWorkspace<FloatPrecision> workspace;
+  SimulationOptions options;
+  options.reduction = ReductionMode::deterministic;
+  stepParticles(reference, getParams(), workspace, options);
+
+  for (int threads : {2, 3, 4, 7}) {
+    std::vector<Particle> particles = getParticles();
+    options.threads                 = threads;
+    stepParticles(particles, getParams(), workspace, options);
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      ASSERT_EQ(std::memcmp(&particles[i], &reference[i], sizeof(Particle)), 0)
+          << "particle " << i << " differs with " << threads << " threads";
+    }
+  }
+}
+
+TEST_F(StepTest, FastReductionMatchesSerialWithinRounding) {
+  std::vector<Particle> serial = getParticles();
+  std::vector<Particle> parallel = getParticles();
+  StepWorkspace<FloatPrecision> workspace;
+  SimulationOptions options;
+  stepParticles(serial, getParams(), workspace, options);
+  options.threads = 4;
+  stepParticles(parallel, getParams(), workspace, options);
+  for (std::size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_NEAR(parallel[i].rho, serial[i].rho, std::abs(serial[i].rho) * 1e-4F);
+  }
+}
+
+TEST_F(StepTest, CellListMatchesAllPairs) {
+  std::vector<Particle> allPairs = getParticles();
+  std::vector<Particle> cells    = getParticles();
+  StepWorkspace<FloatPrecision> workspace;
+  SimulationOptions options;
+  options.neighbors = NeighborSearch::allPairs;
+  stepParticles(allPairs, getParams(), workspace, options);
+  options.neighbors = NeighborSearch::cells;
+  stepParticles(cells, getParams(), workspace, options);
+  for (std::size_t i = 0; i < cells.size(); ++i) {
+    EXPECT_NEAR(cells[i].rho, allPairs[i].rho, std::abs(allPairs[i].rho) * 1e-4F);
+    EXPECT_NEAR(cells[i].ax, allPairs[i].ax, std::abs(allPairs[i].ax) * 1e-3F + 1e-3F);
+  }
+}
+
+TEST_F(StepTest, HalfStencilIsIndependentOfThreadCount) {
+  std::vector<Particle> reference = getParticles();
+  StepWorkspace<FloatPrecision> workspace;
+  SimulationOptions options;
+  stepParticles(reference, getParams(), workspace, options);
+  for (int threads : {2, 5}) {
+    std::vector<Particle> particles = getParticles();
+    options.threads                 = threads;
+    stepParticles(particles, getParams(), workspace, options);
+    EXPECT_EQ(std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)),
+              0);
+  }
+}
+
+TEST_F(StepTest, WorkStealingMatchesStaticSchedule) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.reduction = reduction;
+    options.threads   = 4;
+    options.schedule  = CellSchedule::staticRange;
+    std::vector<Particle> reference = getParticles();
+    StepWorkspace<FloatPrecision> workspace;
+    stepParticles(reference, getParams(), workspace, options);
+    options.schedule                = CellSchedule::stealing;
+    std::vector<Particle> particles = getParticles();
+    stepParticles(particles, getParams(), workspace, options);
+    EXPECT_EQ(std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)),
+              0);
+  }
+}
+
+TEST_F(StepTest, TaskGraphGivesTheSameSums) {
+  for (const bool pairCache : {false, true}) {
+    SimulationOptions options;
+    options.pairCache       = pairCache;
+    options.threads         = 3;
+    options.graphBlockCells = 2;
+    // The 27-cell gather is bit-identical to the phase by phase schedule
+    options.reduction               = ReductionMode::deterministic;
+    std::vector<Particle> reference = getParticles();
+    StepWorkspace<FloatPrecision> workspace;
+    stepParticles(reference, getParams(), workspace, options);
+    options.schedule                = CellSchedule::graph;
+    std::vector<Particle> particles = getParticles();
+    stepParticles(particles, getParams(), workspace, options);
+    EXPECT_EQ(std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)),
+              0);
+    // The half stencil adds in block colour order, the same for any thread count
+    options.reduction                = ReductionMode::fast;
+    std::vector<Particle> oneThread  = getParticles();
+    StepWorkspace<FloatPrecision> single;
+    options.threads = 1;
+    stepParticles(oneThread, getParams(), single, options);
+    options.threads                  = 3;
+    std::vector<Particle> threeThreads = getParticles();
+    stepParticles(threeThreads, getParams(), workspace, options);
+    EXPECT_EQ(
+        std::memcmp(oneThread.data(), threeThreads.data(), oneThread.size() * sizeof(Particle)), 0);
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+      EXPECT_NEAR(oneThread[i].rho, reference[i].rho, std::abs(reference[i].rho) * 1e-5F);
+    }
+  }
+}
+
+TEST_F(StepTest, HugePageModesGiveTheSameStep) {
+  std::vector<Particle> reference = getParticles();
+  StepWorkspace<FloatPrecision> workspace;
+  SimulationOptions options;
+  stepParticles(reference, getParams(), workspace, options);
+  for (const HugePages mode : {HugePages::transparent, HugePages::hugetlb}) {
+    options.hugePages               = mode;
+    std::vector<Particle> particles = getParticles();
+    stepParticles(particles, getParams(), workspace, options);
+    EXPECT_EQ(workspace.accumulators.get_allocator().hugePages(), mode);
+    EXPECT_EQ(std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)),
+              0);
+  }
+}
+
+TEST_F(StepTest, PairCacheGivesTheSameStep) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    for (const CellSchedule schedule : {CellSchedule::stealing, CellSchedule::staticRange}) {
+      for (int threads : {1, 3}) {
+        SimulationOptions options;
+        options.reduction               = reduction;
+        options.schedule                = schedule;
+        options.threads                 = threads;
+        std::vector<Particle> reference = getParticles();
+        StepWorkspace<FloatPrecision> workspace;
+        stepParticles(reference, getParams(), workspace, options);
+        options.pairCache               = true;
+        std::vector<Particle> particles = getParticles();
+        stepParticles(particles, getParams(), workspace, options);
+        EXPECT_EQ(
+            std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)), 0)
+            << threads << " threads";
+      }
+    }
+  }
+}
+
+TEST_F(StepTest, ClustersMatchCellList) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.reduction              = reduction;
+    std::vector<Particle> cells    = getParticles();
+    StepWorkspace<FloatPrecision> workspace;
+    stepParticles(cells, getParams(), workspace, options);
+    options.neighbors              = NeighborSearch::clusters;
+    std::vector<Particle> clusters = getParticles();
+    stepParticles(clusters, getParams(), workspace, options);
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+      EXPECT_NEAR(clusters[i].rho, cells[i].rho, std::abs(cells[i].rho) * 1e-4F);
+      EXPECT_NEAR(clusters[i].ax, cells[i].ax, std::abs(cells[i].ax) * 1e-3F + 1e-3F);
+    }
+  }
+}
+
+TEST_F(StepTest, ClustersAreIndependentOfThreadCount) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.neighbors               = NeighborSearch::clusters;
+    options.reduction               = reduction;
+    std::vector<Particle> reference = getParticles();
+    StepWorkspace<FloatPrecision> workspace;
+    stepParticles(reference, getParams(), workspace, options);
+    for (int threads : {2, 5}) {
+      std::vector<Particle> particles = getParticles();
+      options.threads                 = threads;
+      stepParticles(particles, getParams(), workspace, options);
+      EXPECT_EQ(
+          std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)), 0)
+          << threads << " threads";
+    }
+  }
+}
+
+TEST_F(StepTest, HashedCellGridGivesTheSameSteps) {
+  for (const NeighborSearch neighbors : {NeighborSearch::cells, NeighborSearch::clusters}) {
+    for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+      // The fast reduction splits colours by cell count, which differs between the layouts
+      const int threads = reduction == ReductionMode::deterministic ? 3 : 1;
+      SimulationOptions options;
+      options.neighbors = neighbors;
+      options.reduction = reduction;
+      options.threads   = threads;
+      std::vector<Particle> reference = getParticles();
+      StepWorkspace<FloatPrecision> dense;
+      options.cellLayout              = CellLayout::hashed;
+      std::vector<Particle> particles = getParticles();
+      StepWorkspace<FloatPrecision> hashed;
+      for (int it = 0; it < 2; ++it) {
+        options.cellLayout = CellLayout::dense;
+        stepParticles(reference, getParams(), dense, options);
+        options.cellLayout = CellLayout::hashed;
+        stepParticles(particles, getParams(), hashed, options);
+      }
+      EXPECT_EQ(dense.cells.layout, CellLayout::dense);
+      EXPECT_EQ(hashed.cells.layout, CellLayout::hashed);
+      EXPECT_EQ(
+          std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)), 0)
+          << threads << " threads";
+    }
+  }
+}
+
+TEST_F(StepTest, SleepingWithoutRestGivesTheSameSteps) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    SimulationOptions options;
+    options.reduction               = reduction;
+    const SimulationOptions plainOptions = options;
+    std::vector<Particle> reference = getParticles();
+    StepWorkspace<FloatPrecision> plain;
+    options.sleepSteps              = 1;
+    options.sleepVelocity           = 0.0F;
+    options.sleepAcceleration       = 0.0F;
+    std::vector<Particle> particles = getParticles();
+    StepWorkspace<FloatPrecision> sleeping;
+    for (int it = 0; it < 2; ++it) {
+      stepParticles(reference, getParams(), plain, plainOptions);
+      stepParticles(particles, getParams(), sleeping, options);
+    }
+    EXPECT_EQ(std::memcmp(particles.data(), reference.data(), particles.size() * sizeof(Particle)),
+              0);
+    EXPECT_EQ(sleeping.sleep.stats.frozenParticleSteps, 0U);
+  }
+}
+
+TEST_F(StepTest, FrozenParticlesKeepTheirState) {
+  SimulationOptions options;
+  options.sleepSteps        = 1;
+  options.sleepVelocity     = 1.0F;
+  options.sleepAcceleration = 100.0F;
+  // Isolated particles falling from rest stay in their cells for a few steps
+  std::vector<Particle> particles;
+  for (int i = 0; i < 8; ++i) {
+    Particle particle{};
+    particle.px = xmin + 0.01F + 0.015F * static_cast<float>(i);
+    particle.py = 0.0F;
+    particle.pz = zmin + 0.02F;
+    particles.push_back(particle);
+  }
+  StepWorkspace<FloatPrecision> workspace;
+  stepParticles(particles, getParams(), workspace, options);
+  const std::vector<Particle> settled = particles;
+  stepParticles(particles, getParams(), workspace, options);
+  EXPECT_EQ(std::memcmp(particles.data(), settled.data(), particles.size() * sizeof(Particle)), 0);
+  EXPECT_EQ(workspace.sleep.stats.frozenParticleSteps, particles.size());
+  EXPECT_EQ(workspace.sleep.stats.particleSteps, 2 * particles.size());
+}
@@ -0,0 +1,51 @@
+#include "taskgraph.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+static constexpr int GRAPH_THREADS        = 4;
+static constexpr std::uint32_t GRAPH_ROWS = 50;
+static constexpr std::uint32_t GRAPH_COLS = 20;
+static constexpr int GRAPH_RUNS           = 3;
+
+// Grid of tasks where (row, col) waits for (row - 1, col - 1 .. col + 1): every row is a phase
+// and each task only waits for its neighbourhood in the previous one
+TEST(TaskGraphTest, TasksRunOnceAfterTheirDependencies) {
+  const auto task = [](std::uint32_t row, std::uint32_t col) { return row * GRAPH_COLS + col; };
+  TaskGraph graph;
+  graph.reset(GRAPH_ROWS * GRAPH_COLS);
+  for (std::uint32_t row = 1; row < GRAPH_ROWS; ++row) {
+    for (std::uint32_t col = 0; col < GRAPH_COLS; ++col) {
+      for (std::uint32_t before = col == 0 ? 0 : col - 1;
+           before <= col + 1 && before < GRAPH_COLS; ++before) {
+        graph.addDependency(task(row - 1, before), task(row, col));
+      }
+    }
+  }
+  graph.finalize();
+  EXPECT_EQ(graph.size(), GRAPH_ROWS * GRAPH_COLS);
+  EXPECT_EQ(graph.dependencyCount(), (GRAPH_ROWS - 1) * (3 * GRAPH_COLS - 2));
+  ThreadPool pool(GRAPH_THREADS);
+  for (int run = 0; run < GRAPH_RUNS; ++run) {
+    std::vector<std::atomic<int>> done(graph.size());
+    std::atomic<int> violations{0};
+    graph.execute(pool, [&](std::uint32_t t, int /*thread*/) {
+      const std::uint32_t row = t / GRAPH_COLS;
+      const std::uint32_t col = t % GRAPH_COLS;
+      if (row > 0) {
+        for (std::uint32_t before = col == 0 ? 0 : col - 1;
+             before <= col + 1 && before < GRAPH_COLS; ++before) {
+          if (done[task(row - 1, before)].load() == 0) { ++violations; }
+        }
+      }
+      ++done[t];
+    });
+    EXPECT_EQ(violations.load(), 0);
+    for (auto const & count : done) { EXPECT_EQ(count.load(), 1); }
+  }
+  std::uint64_t tasks = 0;
+  for (ThreadLoad const & load : graph.takeLoad()) { tasks += load.tasks; }
+  EXPECT_EQ(tasks, static_cast<std::uint64_t>(GRAPH_RUNS) * graph.size());
+}
@@ -0,0 +1,121 @@
+#include "constants.hpp"
+#include "particle.hpp"
+#include "precision.hpp"
+#include "step.hpp"
+#include "temporal.hpp"
+#include "utils.hpp"
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Cells a smoothing length wide, 23 x 31 x 23 of them, so that a tile of 3 cells with the halo
+// of 2 steps holds a small share of the lattice
+static constexpr float GRID_PPM     = 300.0F;
+static constexpr int TEMPORAL_STEPS = 4;
+
+class TemporalTest : public ::testing::Test {
+  protected:
+    std::vector<Particle> particles;
+    ParticleParameters params{};
+
+    void SetUp() override {
+      const float height    = calculateSmoothingLength(r, GRID_PPM);
+      const GridSize blocks = calculateNumberOfBlocks(height);
+      params                = {height, calculateParticleMass(rho, GRID_PPM),
+                               calculateBlockSize(blocks), blocks};
+      // Jittered lattice filling the box, falling under gravity. Its particles are two
+      // smoothing lengths apart, which keeps the run bounded with the current kernels; denser
+      // lattices blow up within a step, and the halo of their blocks covers the grid.
+      const float spacing = 2.0F * height;
+      unsigned int seed   = 12345U;
+      auto jitter         = [&seed, spacing]() {
+        seed = seed * 1664525U + 1013904223U;
+        return (static_cast<float>(seed >> 8U) / static_cast<float>(1U << 24U) - 0.5F) * 0.1F *
+               spacing;
+      };
+      for (float z = zmin + spacing; z < zmax - spacing; z += spacing) {
+        for (float y = ymin + spacing; y < ymax - spacing; y += spacing) {
+          for (float x = xmin + spacing; x < xmax - spacing; x += spacing) {
+            Particle particle{};
+            particle.px = x + jitter();
+            particle.py = y + jitter();
+            particle.pz = z + jitter();
+            initializeDensitiesAndAccelerations(particle);
+            particles.push_back(particle);
+          }
+        }
+      }
+    }
+
+    [[nodiscard]] std::vector<Particle> stepByStep(SimulationOptions const & options,
+                                                   int steps = TEMPORAL_STEPS) const {
+      std::vector<Particle> reference = particles;
+      StepWorkspace<FloatPrecision> workspace;
+      for (int it = 0; it < steps; ++it) {
+        stepParticles(reference, params, workspace, options);
+      }
+      return reference;
+    }
+};
+
+TEST_F(TemporalTest, TilesGiveTheStepByStepParticles) {
+  for (const ReductionMode reduction : {ReductionMode::fast, ReductionMode::deterministic}) {
+    for (const int steps : {1, 2}) {
+      SimulationOptions options;
+      options.reduction               = reduction;
+      options.threads                 = 2;
+      options.temporalSteps           = steps;
+      options.temporalTileCells       = 3;
+      std::vector<Particle> const reference = stepByStep(options);
+      std::vector<Particle> blocked         = particles;
+      TemporalWorkspace<FloatPrecision> workspace;
+      for (int it = 0; it < TEMPORAL_STEPS; it += steps) {
+        advanceTemporalBlock<FloatPrecision>(blocked, params, steps, options, workspace);
+      }
+      EXPECT_EQ(std::memcmp(blocked.data(), reference.data(), blocked.size() * sizeof(Particle)),
+                0)
+          << "steps " << steps;
+      TemporalStats const & stats = workspace.stats;
+      EXPECT_EQ(stats.blocks, static_cast<std::uint64_t>(TEMPORAL_STEPS / steps));
+      EXPECT_EQ(stats.ownedParticleSteps, particles.size() * TEMPORAL_STEPS);
+      // Every tile also computes its halo
+      EXPECT_EQ(stats.wholeGridBlocks, 0U);
+      EXPECT_GT(stats.localParticleSteps, stats.ownedParticleSteps);
+      EXPECT_GE(stats.largestHalo, steps);
+    }
+  }
+}
+
+// Blocks of 12 steps need a halo of at least 36 cells, more than the grid has: tiles would each
+// step every particle, so the block steps the whole grid once instead
+TEST_F(TemporalTest, HaloCoveringTheGridStepsTheWholeGridOnce) {
+  constexpr int steps = 12;
+  SimulationOptions options;
+  options.threads                       = 2;
+  options.temporalSteps                 = steps;
+  options.temporalTileCells             = 3;
+  std::vector<Particle> const reference = stepByStep(options, steps);
+  std::vector<Particle> blocked         = particles;
+  TemporalWorkspace<FloatPrecision> workspace;
+  advanceTemporalBlock<FloatPrecision>(blocked, params, steps, options, workspace);
+  EXPECT_EQ(std::memcmp(blocked.data(), reference.data(), blocked.size() * sizeof(Particle)), 0);
+  TemporalStats const & stats = workspace.stats;
+  EXPECT_EQ(stats.blocks, 1U);
+  EXPECT_EQ(stats.wholeGridBlocks, 1U);
+  EXPECT_EQ(stats.tiles, 0U);
+  EXPECT_EQ(stats.localParticleSteps, particles.size() * steps);
+  EXPECT_EQ(stats.ownedParticleSteps, particles.size() * steps);
+}
+
+TEST_F(TemporalTest, BlockingNeedsTheCellSearchWithoutSleeping) {
+  SimulationOptions options;
+  EXPECT_FALSE(usesTemporalBlocking(options));
+  options.temporalSteps = 4;
+  EXPECT_TRUE(usesTemporalBlocking(options));
+  options.sleepSteps = 2;
+  EXPECT_FALSE(usesTemporalBlocking(options));
+  options.sleepSteps = 0;
+  options.neighbors  = NeighborSearch::allPairs;
+  EXPECT_FALSE(usesTemporalBlocking(options));
+}
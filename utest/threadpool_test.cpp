@@ -0,0 +1,73 @@
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <vector>
+
+static constexpr std::size_t POOL_COUNT = 1000;
+static constexpr int POOL_THREADS       = 4;
+static constexpr int POOL_PHASES        = 50;
+static constexpr std::size_t POOL_CHUNK = 7;
+
+TEST(ThreadPoolTest, RunReusesWorkersForEveryPhase) {
+  ThreadPool pool(POOL_THREADS);
+  std::vector<std::atomic<int>> calls(POOL_THREADS);
+  for (int phase = 0; phase < POOL_PHASES; ++phase) {
+    pool.run([&](int thread) { ++calls[static_cast<std::size_t>(thread)]; });
+  }
+  for (auto const & count : calls) { EXPECT_EQ(count.load(), POOL_PHASES); }
+}
+
+TEST(ThreadPoolTest, StaticAndGuidedPartitionsVisitEveryIndexOnce) {
+  ThreadPool pool(POOL_THREADS);
+  for (const Partition partition : {Partition::staticRange, Partition::guided}) {
+    std::vector<std::atomic<int>> visits(POOL_COUNT);
+    pool.parallelFor(POOL_COUNT, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) { ++visits[i]; }
+    }, partition, POOL_CHUNK);
+    for (auto const & count : visits) { EXPECT_EQ(count.load(), 1); }
+  }
+}
+
+TEST(ThreadPoolTest, BarrierSeparatesPhases) {
+  ThreadPool pool(POOL_THREADS);
+  std::atomic<int> arrived{0};
+  std::atomic<bool> early{false};
+  pool.run([&](int /*thread*/) {
+    for (int phase = 1; phase <= POOL_PHASES; ++phase) {
+      ++arrived;
+      pool.barrier();
+      if (arrived.load() < phase * POOL_THREADS) { early = true; }
+      pool.barrier();
+    }
+  });
+  EXPECT_FALSE(early.load());
+  EXPECT_EQ(arrived.load(), POOL_PHASES * POOL_THREADS);
+}
+
+TEST(ThreadPoolTest, SingleThreadRunsInline) {
+  ThreadPool pool(1);
+  int calls = 0;
+  pool.run([&](int thread) { calls += thread + 1; });
+  pool.barrier();
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(pool.pinned());
+}
+
+namespace {
+
+  int callerCpuCount() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    return CPU_COUNT(&set);
+  }
+
+}  // namespace
+
+TEST(ThreadPoolTest, PinningLeavesTheCallerAffinity) {
+  const int before = callerCpuCount();
+  ThreadPool const pool(2);
+  EXPECT_EQ(callerCpuCount(), before);
+}
@@ -0,0 +1,150 @@
+#include "entropy.hpp"
+#include "options.hpp"
+#include "particle.hpp"
+#include "trajectory.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+static constexpr int TRAJECTORY_FRAMES    = 25;
+static constexpr int TRAJECTORY_KEYFRAMES = 8;
+
+TEST(EntropyTest, StreamsDecodeToTheirInput) {
+  unsigned int seed = 12345U;
+  std::vector<std::uint8_t> uniform(5000);
+  std::vector<std::uint8_t> skewed(5000);
+  for (std::size_t i = 0; i < uniform.size(); ++i) {
+    seed       = seed * 1664525U + 1013904223U;
+    uniform[i] = static_cast<std::uint8_t>(seed >> 24U);
+    skewed[i]  = (seed >> 20U) % 16 == 0 ? static_cast<std::uint8_t>(seed >> 8U) : 0;
+  }
+  std::vector<std::uint8_t> zeros(100000, 0);
+  std::vector<std::uint8_t> empty;
+  for (std::vector<std::uint8_t> const * input : {&uniform, &skewed, &zeros, &empty}) {
+    std::vector<std::uint8_t> stream;
+    encodeBytes(*input, stream);
+    std::vector<std::uint8_t> decoded;
+    EXPECT_EQ(decodeBytes(stream, decoded), stream.size());
+    EXPECT_EQ(decoded, *input);
+    if (!input->empty()) {
+      // Cut short
+      stream.pop_back();
+      EXPECT_EQ(decodeBytes(stream, decoded), 0U);
+    }
+  }
+  std::vector<std::uint8_t> stream;
+  encodeBytes(zeros, stream);
+  EXPECT_EQ(stream.size(), 524U);
+  stream.clear();
+  encodeBytes(skewed, stream);
+  EXPECT_LT(stream.size(), skewed.size() / 2);
+}
+
+class TrajectoryTest : public ::testing::Test {
+  protected:
+    std::vector<std::vector<Particle>> frames;
+    std::string trajectoryFile{"trajectory_test.trj"};
+
+    void SetUp() override {
+      // Particles drifting a little further every frame
+      std::vector<Particle> particles(2000);
+      for (std::size_t i = 0; i < particles.size(); ++i) {
+        const auto x = static_cast<float>(i);
+        particles[i] = {0.01F * std::sin(x), 0.02F * std::cos(x), 0.001F * x, 0.1F, 0.2F, 0.3F,
+                        0.1F, 0.2F, 0.3F, 1000.0F + x, 0.0F, -9.8F, 0.0F};
+      }
+      for (int frame = 0; frame < TRAJECTORY_FRAMES; ++frame) {
+        frames.push_back(particles);
+        for (Particle & particle : particles) {
+          particle.px  += 1.0e-5F * particle.vx;
+          particle.py  += 1.0e-5F * particle.vy;
+          particle.pz  += 1.0e-5F * particle.vz;
+          particle.rho *= 1.0001F;
+        }
+      }
+    }
+
+    void TearDown() override { (void) std::remove(trajectoryFile.c_str()); }
+
+    TrajectoryStats write(OutputFilter const & filter) {
+      TrajectoryWriter writer(trajectoryFile, Header{204.0F, 2000}, filter, TRAJECTORY_KEYFRAMES);
+      EXPECT_TRUE(writer.isOpen());
+      for (std::size_t frame = 0; frame < frames.size(); ++frame) {
+        EXPECT_TRUE(writer.writeFrame(static_cast<int>(3 * frame), frames[frame]));
+      }
+      EXPECT_TRUE(writer.finish());
+      return writer.stats();
+    }
+};
+
+TEST_F(TrajectoryTest, FramesReadBackBitExactInAnyOrder) {
+  const TrajectoryStats stats = write(OutputFilter{});
+  EXPECT_EQ(stats.frames, static_cast<std::uint64_t>(TRAJECTORY_FRAMES));
+  EXPECT_EQ(stats.keyframes, 4U);
+  EXPECT_LT(stats.encodedBytes, stats.rawBytes);
+
+  TrajectoryReader reader(trajectoryFile);
+  ASSERT_TRUE(reader.isOpen());
+  ASSERT_EQ(reader.frames().size(), frames.size());
+  EXPECT_EQ(reader.header().columns, 13U);
+  EXPECT_EQ(reader.frames()[5].step, 15U);
+  const std::size_t particles = reader.header().particles;
+  std::vector<float> values;
+  for (const std::size_t frame : {20UL, 3UL, 24UL, 0UL, 9UL, 10UL, 11UL}) {
+    ASSERT_TRUE(reader.readFrame(frame, values));
+    ASSERT_EQ(values.size(), 13 * particles);
+    for (std::size_t i = 0; i < particles; ++i) {
+      Particle const & expected = frames[frame][i];
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      auto const * fields = reinterpret_cast<float const *>(&expected);
+      for (std::size_t c = 0; c < 13; ++c) {
+        ASSERT_EQ(std::memcmp(&values[c * particles + i], &fields[c], sizeof(float)), 0);
+      }
+    }
+  }
+  EXPECT_FALSE(reader.readFrame(frames.size(), values));
+}
+
+TEST_F(TrajectoryTest, SeekingDecodesOneKeyframeAndItsDeltas) {
+  const TrajectoryStats stats = write(OutputFilter{});
+  TrajectoryReader reader(trajectoryFile);
+  std::vector<float> values;
+  // Frame 23: keyframe 16 and 7 deltas
+  ASSERT_TRUE(reader.readFrame(23, values));
+  EXPECT_EQ(reader.decodedFrames(), 8U);
+  // The next frame continues from it
+  ASSERT_TRUE(reader.readFrame(24, values));
+  EXPECT_EQ(reader.decodedFrames(), 9U);
+  // Deltas take less room than keyframes
+  std::uint64_t keyframeBytes = 0;
+  std::uint64_t deltaBytes    = 0;
+  for (TrajectoryFrameEntry const & entry : reader.frames()) {
+    (entry.keyframe == 1 ? keyframeBytes : deltaBytes) += entry.bytes;
+  }
+  EXPECT_LT(deltaBytes / (stats.frames - stats.keyframes), keyframeBytes / stats.keyframes);
+}
+
+TEST_F(TrajectoryTest, FramesHoldTheSampledParticlesAndFields) {
+  OutputFilter filter;
+  filter.sampling = OutputSampling::stride;
+  filter.stride   = 7;
+  filter.fields   = {false, true, false, false, true, false};
+  write(filter);
+  TrajectoryReader reader(trajectoryFile);
+  ASSERT_TRUE(reader.isOpen());
+  EXPECT_EQ(reader.header().columns, 4U);
+  ASSERT_EQ(reader.particleIndices().size(), 286U);
+  EXPECT_EQ(reader.particleIndices()[1], 7U);
+  std::vector<float> values;
+  ASSERT_TRUE(reader.readFrame(13, values));
+  const std::size_t particles = reader.header().particles;
+  for (std::size_t k = 0; k < particles; ++k) {
+    Particle const & expected = frames[13][reader.particleIndices()[k]];
+    EXPECT_EQ(values[k], expected.px);
+    EXPECT_EQ(values[3 * particles + k], expected.rho);
+  }
+}